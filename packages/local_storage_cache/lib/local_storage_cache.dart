@@ -33,7 +33,10 @@ export 'src/enums/data_type.dart';
 export 'src/enums/encryption_algorithm.dart';
 export 'src/enums/error_code.dart';
 export 'src/enums/eviction_policy.dart';
+export 'src/enums/journal_mode.dart';
 export 'src/enums/log_level.dart';
+export 'src/enums/synchronous_mode.dart';
+export 'src/enums/temp_store.dart';
 // Exceptions
 export 'src/exceptions/storage_exception.dart';
 // Managers
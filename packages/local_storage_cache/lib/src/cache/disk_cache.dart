@@ -2,14 +2,22 @@ import 'dart:convert';
 import 'dart:io';
 
 import 'package:crypto/crypto.dart';
+import 'package:flutter/services.dart' show MissingPluginException;
 import 'package:local_storage_cache/src/enums/eviction_policy.dart';
 import 'package:local_storage_cache/src/models/cache_entry.dart';
+import 'package:local_storage_cache/src/models/cache_expiration_event.dart';
+import 'package:local_storage_cache_platform_interface/local_storage_cache_platform_interface.dart';
 import 'package:path/path.dart' as path;
 import 'package:path_provider/path_provider.dart';
 
 // ignore_for_file: avoid_slow_async_io
 
 /// Disk-based persistent cache.
+///
+/// Where the platform has a native disk cache, entries go to its append-only
+/// segment log in the cache directory, which looks keys up in memory and
+/// evicts in constant time, and which removes entries as they expire.
+/// Elsewhere each entry is a JSON file named after the hash of its key.
 class DiskCache {
   /// Creates a disk cache.
   DiskCache({
@@ -33,6 +41,39 @@ class DiskCache {
   /// Whether the cache is initialized.
   bool _initialized = false;
 
+  /// Whether entries are kept by the platform's native disk cache.
+  bool _native = false;
+
+  LocalStorageCachePlatform get _platform => LocalStorageCachePlatform.instance;
+
+  /// Whether expired entries are removed as they expire and reported
+  /// through [expirations], rather than left for [clearExpired].
+  bool get expiresNatively => _native;
+
+  /// Batches of entries removed as they expired, one event per entry.
+  ///
+  /// Empty unless [expiresNatively].
+  Stream<List<CacheExpirationEvent>> get expirations {
+    _ensureInitialized();
+
+    if (!_native) return const Stream.empty();
+
+    return _platform
+        .diskCacheExpirations()
+        .where((batch) => batch['directory'] == _cacheDir.path)
+        .map((batch) {
+      final keys = (batch['keys'] as List).cast<String>();
+      final expiredAt = (batch['expiredAt'] as List).cast<int>();
+      return [
+        for (var i = 0; i < keys.length; i++)
+          CacheExpirationEvent(
+            key: keys[i],
+            expiredAt: DateTime.fromMillisecondsSinceEpoch(expiredAt[i]),
+          ),
+      ];
+    });
+  }
+
   /// Initializes the disk cache.
   Future<void> initialize() async {
     if (_initialized) return;
@@ -44,6 +85,20 @@ class DiskCache {
       _cacheDir.createSync(recursive: true);
     }
 
+    try {
+      await _platform.diskCacheOpen(
+        _cacheDir.path,
+        maxEntries: maxSize,
+        evictionPolicy: evictionPolicy.name,
+      );
+      _native = true;
+      await _deleteEntryFiles();
+    } on UnimplementedError {
+      _native = false;
+    } on MissingPluginException {
+      _native = false;
+    }
+
     _initialized = true;
   }
 
@@ -51,6 +106,18 @@ class DiskCache {
   Future<T?> get<T>(String key) async {
     _ensureInitialized();
 
+    if (_native) {
+      final json = await _platform.diskCacheGet(_cacheDir.path, key);
+      if (json == null) return null;
+      try {
+        final map = jsonDecode(json) as Map<String, dynamic>;
+        return CacheEntry<T>.fromMap(map).value;
+      } catch (e) {
+        await remove(key);
+        return null;
+      }
+    }
+
     final file = _getFile(key);
     if (!await file.exists()) return null;
 
@@ -83,12 +150,6 @@ class DiskCache {
   Future<void> put(String key, dynamic value, {Duration? ttl}) async {
     _ensureInitialized();
 
-    // Enforce max size
-    final currentSize = await size;
-    if (currentSize >= maxSize) {
-      await _evictOldest();
-    }
-
     final entry = CacheEntry<dynamic>(
       key: key,
       value: value,
@@ -96,6 +157,23 @@ class DiskCache {
       ttl: ttl,
     );
 
+    // The native cache evicts on its own
+    if (_native) {
+      await _platform.diskCachePut(
+        _cacheDir.path,
+        key,
+        jsonEncode(entry.toMap()),
+        expiresAt: entry.expiresAt?.millisecondsSinceEpoch,
+      );
+      return;
+    }
+
+    // Enforce max size
+    final currentSize = await size;
+    if (currentSize >= maxSize) {
+      await _evictOldest();
+    }
+
     await _saveEntry(entry);
   }
 
@@ -103,6 +181,10 @@ class DiskCache {
   Future<bool> remove(String key) async {
     _ensureInitialized();
 
+    if (_native) {
+      return _platform.diskCacheRemove(_cacheDir.path, key);
+    }
+
     final file = _getFile(key);
     if (await file.exists()) {
       await file.delete();
@@ -115,6 +197,11 @@ class DiskCache {
   Future<void> clear() async {
     _ensureInitialized();
 
+    if (_native) {
+      await _platform.diskCacheClear(_cacheDir.path);
+      return;
+    }
+
     if (await _cacheDir.exists()) {
       await for (final entity in _cacheDir.list()) {
         if (entity is File) {
@@ -128,6 +215,10 @@ class DiskCache {
   Future<bool> containsKey(String key) async {
     _ensureInitialized();
 
+    if (_native) {
+      return await _platform.diskCacheGet(_cacheDir.path, key) != null;
+    }
+
     final file = _getFile(key);
     if (!await file.exists()) return false;
 
@@ -152,6 +243,10 @@ class DiskCache {
   Future<List<String>> get keys async {
     _ensureInitialized();
 
+    if (_native) {
+      return _platform.diskCacheKeys(_cacheDir.path);
+    }
+
     final keys = <String>[];
 
     if (await _cacheDir.exists()) {
@@ -172,6 +267,10 @@ class DiskCache {
   Future<int> get size async {
     _ensureInitialized();
 
+    if (_native) {
+      return _platform.diskCacheSize(_cacheDir.path);
+    }
+
     var count = 0;
 
     if (await _cacheDir.exists()) {
@@ -189,6 +288,10 @@ class DiskCache {
   Future<int> clearExpired() async {
     _ensureInitialized();
 
+    if (_native) {
+      return _platform.diskCacheRemoveExpired(_cacheDir.path);
+    }
+
     var removed = 0;
 
     if (await _cacheDir.exists()) {
@@ -221,6 +324,18 @@ class DiskCache {
 
     final entries = <CacheEntry<dynamic>>[];
 
+    if (_native) {
+      for (final json in await _platform.diskCacheValues(_cacheDir.path)) {
+        try {
+          final map = jsonDecode(json) as Map<String, dynamic>;
+          entries.add(CacheEntry<dynamic>.fromMap(map));
+        } catch (e) {
+          // Skip corrupted entries
+        }
+      }
+      return entries;
+    }
+
     if (await _cacheDir.exists()) {
       await for (final entity in _cacheDir.list()) {
         if (entity is File && entity.path.endsWith('.cache')) {
@@ -264,6 +379,16 @@ class DiskCache {
     await file.writeAsString(json);
   }
 
+  /// Deletes the per-entry files left by a cache kept without the native
+  /// disk cache.
+  Future<void> _deleteEntryFiles() async {
+    await for (final entity in _cacheDir.list()) {
+      if (entity is File && entity.path.endsWith('.cache')) {
+        await entity.delete();
+      }
+    }
+  }
+
   /// Evicts an entry based on the eviction policy.
   Future<void> _evictOldest() async {
     final allEntries = await entries;
@@ -274,6 +399,7 @@ class DiskCache {
 
     switch (evictionPolicy) {
       case EvictionPolicy.lru:
+      case EvictionPolicy.wTinyLfu:
         // Evict least recently used
         allEntries.sort((a, b) => a.lastAccessedAt.compareTo(b.lastAccessedAt));
         entryToEvict = allEntries.first;
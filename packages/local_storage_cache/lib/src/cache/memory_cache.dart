@@ -1,5 +1,3 @@
-import 'dart:collection';
-
 import 'package:local_storage_cache/src/enums/eviction_policy.dart';
 import 'package:local_storage_cache/src/models/cache_entry.dart';
 
@@ -17,15 +15,13 @@ class MemoryCache {
   /// Eviction policy.
   final EvictionPolicy evictionPolicy;
 
-  /// Cache storage.
+  /// Cache storage, oldest first.
+  ///
+  /// Map literals keep insertion order, which is also FIFO order. For LRU
+  /// an accessed entry is removed and re-added, so the least recently used
+  /// entry is always first; both are O(1).
   final Map<String, CacheEntry<dynamic>> _cache = {};
 
-  /// Access order queue for LRU.
-  final Queue<String> _accessQueue = Queue<String>();
-
-  /// Insertion order queue for FIFO.
-  final Queue<String> _insertionQueue = Queue<String>();
-
   /// Frequency map for LFU optimization.
   /// Maps frequency count to set of keys with that frequency.
   final Map<int, Set<String>> _frequencyMap = {};
@@ -46,11 +42,12 @@ class MemoryCache {
     // Update access metadata
     entry.markAccessed();
 
-    // Update LRU queue
-    if (evictionPolicy == EvictionPolicy.lru) {
-      _accessQueue
+    // Move to the most recently used end
+    if (evictionPolicy == EvictionPolicy.lru ||
+        evictionPolicy == EvictionPolicy.wTinyLfu) {
+      _cache
         ..remove(key)
-        ..addLast(key);
+        ..[key] = entry;
     }
 
     // Update LFU frequency map
@@ -83,14 +80,6 @@ class MemoryCache {
 
     _cache[key] = entry;
 
-    // Update queues
-    if (evictionPolicy == EvictionPolicy.lru) {
-      _accessQueue.addLast(key);
-    }
-    if (evictionPolicy == EvictionPolicy.fifo) {
-      _insertionQueue.addLast(key);
-    }
-
     // Update LFU frequency map (new entries start at frequency 0)
     if (evictionPolicy == EvictionPolicy.lfu) {
       _frequencyMap.putIfAbsent(0, () => {}).add(key);
@@ -102,9 +91,6 @@ class MemoryCache {
     final entry = _cache[key];
     final removed = _cache.remove(key) != null;
     if (removed) {
-      _accessQueue.remove(key);
-      _insertionQueue.remove(key);
-
       // Remove from LFU frequency map
       if (evictionPolicy == EvictionPolicy.lfu && entry != null) {
         final freq = entry.accessCount;
@@ -120,8 +106,7 @@ class MemoryCache {
   /// Clears all entries.
   void clear() {
     _cache.clear();
-    _accessQueue.clear();
-    _insertionQueue.clear();
+    _frequencyMap.clear();
   }
 
   /// Checks if a key exists.
@@ -135,6 +120,10 @@ class MemoryCache {
     return true;
   }
 
+  /// When the entry of [key] expires, or null if it has no TTL or there is
+  /// none. Unlike [get], this does not count as an access.
+  DateTime? expiresAtOf(String key) => _cache[key]?.expiresAt;
+
   /// Gets all keys.
   List<String> get keys => _cache.keys.toList();
 
@@ -175,8 +164,9 @@ class MemoryCache {
 
     switch (evictionPolicy) {
       case EvictionPolicy.lru:
+      case EvictionPolicy.wTinyLfu:
         // Evict least recently used
-        keyToEvict = _accessQueue.isNotEmpty ? _accessQueue.first : null;
+        keyToEvict = _cache.keys.first;
 
       case EvictionPolicy.lfu:
         // Evict least frequently used using optimized frequency map
@@ -191,7 +181,7 @@ class MemoryCache {
 
       case EvictionPolicy.fifo:
         // Evict first in
-        keyToEvict = _insertionQueue.isNotEmpty ? _insertionQueue.first : null;
+        keyToEvict = _cache.keys.first;
     }
 
     if (keyToEvict != null) {
@@ -5,11 +5,14 @@ class CacheConfig {
   /// Creates a cache configuration.
   const CacheConfig({
     this.maxMemoryCacheSize = 100,
+    this.maxMemoryCacheBytes = 8 * 1024 * 1024,
     this.maxDiskCacheSize = 1000,
     this.defaultTTL = const Duration(hours: 1),
     this.evictionPolicy = EvictionPolicy.lru,
     this.enableQueryCache = true,
     this.enableWarmCache = false,
+    this.profile = 'default',
+    this.pageCacheSizeKb,
   });
 
   /// Creates a default cache configuration.
@@ -21,9 +24,11 @@ class CacheConfig {
   factory CacheConfig.highPerformance() {
     return const CacheConfig(
       maxMemoryCacheSize: 500,
+      maxMemoryCacheBytes: 32 * 1024 * 1024,
       maxDiskCacheSize: 5000,
       defaultTTL: Duration(minutes: 30),
       enableWarmCache: true,
+      profile: 'highPerformance',
     );
   }
 
@@ -31,10 +36,12 @@ class CacheConfig {
   factory CacheConfig.minimal() {
     return const CacheConfig(
       maxMemoryCacheSize: 50,
+      maxMemoryCacheBytes: 1024 * 1024,
       maxDiskCacheSize: 200,
       defaultTTL: Duration(minutes: 15),
       evictionPolicy: EvictionPolicy.fifo,
       enableQueryCache: false,
+      profile: 'minimal',
     );
   }
 
@@ -42,17 +49,28 @@ class CacheConfig {
   factory CacheConfig.fromMap(Map<String, dynamic> map) {
     return CacheConfig(
       maxMemoryCacheSize: map['maxMemoryCacheSize'] as int? ?? 100,
+      maxMemoryCacheBytes:
+          map['maxMemoryCacheBytes'] as int? ?? 8 * 1024 * 1024,
       maxDiskCacheSize: map['maxDiskCacheSize'] as int? ?? 1000,
       defaultTTL: Duration(milliseconds: map['defaultTTL'] as int? ?? 3600000),
       evictionPolicy: _parseEvictionPolicy(map['evictionPolicy'] as String?),
       enableQueryCache: map['enableQueryCache'] as bool? ?? true,
       enableWarmCache: map['enableWarmCache'] as bool? ?? false,
+      profile: map['profile'] as String? ?? 'default',
+      pageCacheSizeKb: map['pageCacheSizeKb'] as int?,
     );
   }
 
   /// Maximum number of items in memory cache.
   final int maxMemoryCacheSize;
 
+  /// Maximum size of the memory cache in bytes, counting keys, values and
+  /// bookkeeping; 0 leaves it bounded by [maxMemoryCacheSize] alone.
+  ///
+  /// Only the native memory cache of platforms that have one is sized in
+  /// bytes.
+  final int maxMemoryCacheBytes;
+
   /// Maximum number of items in disk cache.
   final int maxDiskCacheSize;
 
@@ -68,15 +86,26 @@ class CacheConfig {
   /// Whether to enable cache warming on startup.
   final bool enableWarmCache;
 
+  /// Name of the native tuning profile that sizes the SQLite page cache.
+  final String profile;
+
+  /// SQLite page cache size in KiB (`PRAGMA cache_size`).
+  ///
+  /// Overrides the size chosen by [profile] when set.
+  final int? pageCacheSizeKb;
+
   /// Converts this configuration to a map.
   Map<String, dynamic> toMap() {
     return {
       'maxMemoryCacheSize': maxMemoryCacheSize,
+      'maxMemoryCacheBytes': maxMemoryCacheBytes,
       'maxDiskCacheSize': maxDiskCacheSize,
       'defaultTTL': defaultTTL.inMilliseconds,
       'evictionPolicy': evictionPolicy.name,
       'enableQueryCache': enableQueryCache,
       'enableWarmCache': enableWarmCache,
+      'profile': profile,
+      if (pageCacheSizeKb != null) 'pageCacheSizeKb': pageCacheSizeKb,
     };
   }
 
@@ -86,6 +115,8 @@ class CacheConfig {
         return EvictionPolicy.lfu;
       case 'fifo':
         return EvictionPolicy.fifo;
+      case 'wTinyLfu':
+        return EvictionPolicy.wTinyLfu;
       default:
         return EvictionPolicy.lru;
     }
@@ -94,19 +125,25 @@ class CacheConfig {
   /// Creates a copy of this configuration with the given fields replaced.
   CacheConfig copyWith({
     int? maxMemoryCacheSize,
+    int? maxMemoryCacheBytes,
     int? maxDiskCacheSize,
     Duration? defaultTTL,
     EvictionPolicy? evictionPolicy,
     bool? enableQueryCache,
     bool? enableWarmCache,
+    String? profile,
+    int? pageCacheSizeKb,
   }) {
     return CacheConfig(
       maxMemoryCacheSize: maxMemoryCacheSize ?? this.maxMemoryCacheSize,
+      maxMemoryCacheBytes: maxMemoryCacheBytes ?? this.maxMemoryCacheBytes,
       maxDiskCacheSize: maxDiskCacheSize ?? this.maxDiskCacheSize,
       defaultTTL: defaultTTL ?? this.defaultTTL,
       evictionPolicy: evictionPolicy ?? this.evictionPolicy,
       enableQueryCache: enableQueryCache ?? this.enableQueryCache,
       enableWarmCache: enableWarmCache ?? this.enableWarmCache,
+      profile: profile ?? this.profile,
+      pageCacheSizeKb: pageCacheSizeKb ?? this.pageCacheSizeKb,
     );
   }
 }
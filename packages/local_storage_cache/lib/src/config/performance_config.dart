@@ -1,4 +1,11 @@
+import 'package:local_storage_cache/src/enums/journal_mode.dart';
+import 'package:local_storage_cache/src/enums/synchronous_mode.dart';
+import 'package:local_storage_cache/src/enums/temp_store.dart';
+
 /// Configuration for performance optimizations.
+///
+/// The SQLite tuning fields are applied by the native layer when the database
+/// is opened. Fields left `null` take their value from [profile].
 class PerformanceConfig {
   /// Creates a performance configuration with the specified settings.
   const PerformanceConfig({
@@ -7,20 +14,36 @@ class PerformanceConfig {
     this.enableQueryOptimization = true,
     this.enableBatchOptimization = true,
     this.batchSize = 100,
+    this.profile = 'default',
+    this.journalMode,
+    this.synchronous,
+    this.tempStore,
+    this.mmapSize,
+    this.pageSize,
+    this.walAutoCheckpoint,
+    this.busyTimeout,
+    this.cursorIdleTimeout,
   });
 
   /// Creates a default performance configuration.
   factory PerformanceConfig.defaultConfig() => const PerformanceConfig();
 
   /// Creates a high-performance configuration with optimized settings.
+  ///
+  /// Natively this also keeps temporary structures in memory, memory-maps up
+  /// to 256 MB of the database and checkpoints the WAL less often.
   factory PerformanceConfig.highPerformance() {
     return const PerformanceConfig(
       connectionPoolSize: 10,
       batchSize: 500,
+      profile: 'highPerformance',
     );
   }
 
   /// Size of the database connection pool.
+  ///
+  /// On platforms with a native pool this is the number of read-only
+  /// connections serving queries alongside the single writer.
   final int connectionPoolSize;
 
   /// Whether to enable prepared statement caching.
@@ -35,6 +58,33 @@ class PerformanceConfig {
   /// Default batch size for batch operations.
   final int batchSize;
 
+  /// Name of the native tuning profile the SQLite settings start from.
+  final String profile;
+
+  /// `PRAGMA journal_mode`.
+  final JournalMode? journalMode;
+
+  /// `PRAGMA synchronous`.
+  final SynchronousMode? synchronous;
+
+  /// `PRAGMA temp_store`.
+  final TempStore? tempStore;
+
+  /// `PRAGMA mmap_size`, in bytes. Zero disables memory-mapped I/O.
+  final int? mmapSize;
+
+  /// `PRAGMA page_size`, in bytes. Only takes effect for new databases.
+  final int? pageSize;
+
+  /// `PRAGMA wal_autocheckpoint`, in pages.
+  final int? walAutoCheckpoint;
+
+  /// How long a connection waits on a locked database (`PRAGMA busy_timeout`).
+  final Duration? busyTimeout;
+
+  /// How long a streaming cursor may go unread before it is closed natively.
+  final Duration? cursorIdleTimeout;
+
   /// Converts the configuration to a map representation.
   Map<String, dynamic> toMap() {
     return {
@@ -43,6 +93,16 @@ class PerformanceConfig {
       'enableQueryOptimization': enableQueryOptimization,
       'enableBatchOptimization': enableBatchOptimization,
       'batchSize': batchSize,
+      'profile': profile,
+      if (journalMode != null) 'journalMode': journalMode!.name,
+      if (synchronous != null) 'synchronous': synchronous!.name,
+      if (tempStore != null) 'tempStore': tempStore!.name,
+      if (mmapSize != null) 'mmapSize': mmapSize,
+      if (pageSize != null) 'pageSize': pageSize,
+      if (walAutoCheckpoint != null) 'walAutoCheckpoint': walAutoCheckpoint,
+      if (busyTimeout != null) 'busyTimeout': busyTimeout!.inMilliseconds,
+      if (cursorIdleTimeout != null)
+        'cursorIdleTimeout': cursorIdleTimeout!.inMilliseconds,
     };
   }
 }
@@ -8,4 +8,12 @@ enum EvictionPolicy {
 
   /// First In First Out - Evicts the oldest items first
   fifo,
+
+  /// Window TinyLFU - Admits items to the cache only if they are used more
+  /// often than the item they would evict, which keeps one-off scans from
+  /// flushing frequently used items.
+  ///
+  /// Only the native memory cache admits by frequency; other caches evict
+  /// like [lru].
+  wTinyLfu,
 }
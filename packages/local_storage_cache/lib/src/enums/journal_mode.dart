@@ -0,0 +1,20 @@
+/// SQLite journal modes applied through `PRAGMA journal_mode`.
+enum JournalMode {
+  /// Rollback journal deleted at the end of each transaction.
+  delete,
+
+  /// Rollback journal truncated instead of deleted.
+  truncate,
+
+  /// Rollback journal kept with its header zeroed.
+  persist,
+
+  /// Rollback journal kept in memory.
+  memory,
+
+  /// Write-ahead log, which lets readers run concurrently with the writer.
+  wal,
+
+  /// No journal; transactions cannot be rolled back safely.
+  off,
+}
@@ -0,0 +1,14 @@
+/// SQLite durability levels applied through `PRAGMA synchronous`.
+enum SynchronousMode {
+  /// Never waits for data to reach storage.
+  off,
+
+  /// Syncs at critical moments; durable in WAL mode except on power loss.
+  normal,
+
+  /// Syncs on every commit.
+  full,
+
+  /// Like [full], and also syncs the directory after unlinking a journal.
+  extra,
+}
@@ -0,0 +1,11 @@
+/// Where SQLite keeps temporary tables and indices (`PRAGMA temp_store`).
+enum TempStore {
+  /// Use the compile-time default.
+  defaultStore,
+
+  /// Temporary files on disk.
+  file,
+
+  /// Temporary structures in memory.
+  memory,
+}
@@ -1,7 +1,9 @@
 import 'dart:async';
+import 'dart:collection';
 import 'dart:convert';
 
 import 'package:crypto/crypto.dart';
+import 'package:flutter/services.dart' show MissingPluginException;
 
 import 'package:local_storage_cache/src/cache/disk_cache.dart';
 import 'package:local_storage_cache/src/cache/memory_cache.dart';
@@ -10,6 +12,7 @@ import 'package:local_storage_cache/src/enums/cache_level.dart';
 import 'package:local_storage_cache/src/models/cache_expiration_event.dart';
 import 'package:local_storage_cache/src/models/cache_stats.dart';
 import 'package:local_storage_cache/src/models/warm_cache_entry.dart';
+import 'package:local_storage_cache_platform_interface/local_storage_cache_platform_interface.dart';
 
 /// Manages multi-level caching with TTL and eviction policies.
 class CacheManager {
@@ -35,9 +38,30 @@ class CacheManager {
   /// Whether the manager is initialized.
   bool _initialized = false;
 
-  /// Expiration check timer.
+  /// Expiration check timer, used when the disk cache does not expire
+  /// entries itself.
   Timer? _expirationTimer;
 
+  /// Expirations pushed by the native disk cache.
+  StreamSubscription<List<CacheExpirationEvent>>? _diskExpirations;
+
+  /// Fires once the earliest memory entry has expired.
+  Timer? _memoryExpirationTimer;
+
+  /// When [_memoryExpirationTimer] fires.
+  DateTime? _memoryExpirationDue;
+
+  /// Keys of the memory entries with a TTL by when they expire, in
+  /// milliseconds since the epoch, so the due ones are found without a
+  /// scan of the cache.
+  final SplayTreeMap<int, Set<String>> _memoryExpirations = SplayTreeMap();
+
+  /// When each key in [_memoryExpirations] expires.
+  final Map<String, int> _memoryExpiryOf = {};
+
+  /// The query each query cache key was derived from.
+  final Map<String, String> _cachedQueries = {};
+
   /// Initializes the cache manager.
   Future<void> initialize() async {
     if (_initialized) return;
@@ -49,15 +73,23 @@ class CacheManager {
 
     _diskCache = DiskCache(
       maxSize: config.maxDiskCacheSize,
+      evictionPolicy: config.evictionPolicy,
     );
 
     await _diskCache.initialize();
 
-    // Start expiration check timer (every minute)
-    _expirationTimer = Timer.periodic(
-      const Duration(minutes: 1),
-      (_) => _checkExpirations(),
-    );
+    if (_diskCache.expiresNatively) {
+      // The native disk cache reports entries as they expire
+      _diskExpirations = _diskCache.expirations.listen((events) {
+        events.forEach(_expirationController.add);
+      });
+    } else {
+      // Start expiration check timer (every minute)
+      _expirationTimer = Timer.periodic(
+        const Duration(minutes: 1),
+        (_) => _checkExpirations(),
+      );
+    }
 
     _initialized = true;
   }
@@ -79,6 +111,7 @@ class CacheManager {
         effectiveLevel == CacheLevel.both) {
       _memoryCache.put(key, value, ttl: effectiveTTL);
       _stats.memoryCacheSize = _memoryCache.size;
+      _trackMemoryExpiry(key);
     }
 
     // Store in disk cache
@@ -116,6 +149,7 @@ class CacheManager {
         if (effectiveLevel == CacheLevel.both) {
           _memoryCache.put(key, diskValue);
           _stats.memoryCacheSize = _memoryCache.size;
+          _trackMemoryExpiry(key);
         }
 
         return diskValue;
@@ -136,6 +170,7 @@ class CacheManager {
         effectiveLevel == CacheLevel.both) {
       _memoryCache.remove(key);
       _stats.memoryCacheSize = _memoryCache.size;
+      _untrackMemoryExpiry(key);
     }
 
     if (effectiveLevel == CacheLevel.disk ||
@@ -155,6 +190,8 @@ class CacheManager {
         effectiveLevel == CacheLevel.both) {
       _memoryCache.clear();
       _stats.memoryCacheSize = 0;
+      _memoryExpirations.clear();
+      _memoryExpiryOf.clear();
     }
 
     if (effectiveLevel == CacheLevel.disk ||
@@ -175,6 +212,7 @@ class CacheManager {
     _ensureInitialized();
 
     final cacheKey = _generateQueryCacheKey(queryKey);
+    _cachedQueries[cacheKey] = queryKey;
     await put(cacheKey, result, ttl: ttl);
   }
 
@@ -192,19 +230,35 @@ class CacheManager {
     return cached.cast<Map<String, dynamic>>();
   }
 
-  /// Invalidates query cache entries matching a pattern.
-  Future<void> invalidateQueryCache(String pattern) async {
+  /// Invalidates the cached results of queries reading the table named
+  /// [tableName], which must be the exact name, not a pattern.
+  ///
+  /// A cached query reads the table if its text names it as a whole word.
+  /// Results the native query cache holds for the table are invalidated as
+  /// well. Those already stay in step with every write to the tables they
+  /// read, so this is only needed after the database was written by
+  /// something else.
+  Future<void> invalidateQueryCache(String tableName) async {
     _ensureInitialized();
 
-    final memoryKeys = _memoryCache.keys;
-    final diskKeys = await _diskCache.keys;
-
-    final allKeys = {...memoryKeys, ...diskKeys};
+    try {
+      await LocalStorageCachePlatform.instance.invalidateQueryCache(
+        tables: [tableName],
+      );
+    } on UnimplementedError {
+      // Only the keys cached here
+    } on MissingPluginException {
+      // Only the keys cached here
+    }
 
-    for (final key in allKeys) {
-      if (key.startsWith('query_') && key.contains(pattern)) {
-        await remove(key);
-      }
+    final table = RegExp('\\b${RegExp.escape(tableName)}\\b');
+    final keys = [
+      for (final query in _cachedQueries.entries)
+        if (table.hasMatch(query.value)) query.key,
+    ];
+    for (final key in keys) {
+      _cachedQueries.remove(key);
+      await remove(key);
     }
   }
 
@@ -334,6 +388,8 @@ class CacheManager {
   /// Disposes the cache manager.
   Future<void> dispose() async {
     _expirationTimer?.cancel();
+    _memoryExpirationTimer?.cancel();
+    await _diskExpirations?.cancel();
     await _expirationController.close();
   }
 
@@ -343,21 +399,85 @@ class CacheManager {
     return 'query_${hash.toString().substring(0, 16)}';
   }
 
-  /// Checks for expired entries and emits events.
-  Future<void> _checkExpirations() async {
-    if (!_initialized) return;
+  /// Arms [_memoryExpirationTimer] for an entry expiring at [expiresAt],
+  /// unless it already fires by then.
+  ///
+  /// The timer fires on a whole second, one to two seconds after the
+  /// expiry, so that entries expiring close together are removed in one
+  /// pass.
+  void _scheduleMemoryExpiration(DateTime expiresAt) {
+    final due = DateTime.fromMillisecondsSinceEpoch(
+      (expiresAt.millisecondsSinceEpoch ~/ 1000 + 2) * 1000,
+    );
+    final current = _memoryExpirationDue;
+    if (current != null && !due.isBefore(current)) return;
+
+    _memoryExpirationTimer?.cancel();
+    _memoryExpirationDue = due;
+    _memoryExpirationTimer = Timer(
+      due.difference(DateTime.now()),
+      _expireMemoryEntries,
+    );
+  }
 
-    // Check memory cache
-    for (final entry in _memoryCache.entries) {
-      if (entry.isExpired) {
+  /// Records when the memory entry of [key] expires, replacing what was
+  /// recorded for an earlier entry of the key, and arms the timer for it.
+  void _trackMemoryExpiry(String key) {
+    _untrackMemoryExpiry(key);
+    final expiresAt = _memoryCache.expiresAtOf(key);
+    if (expiresAt == null) return;
+
+    final due = expiresAt.millisecondsSinceEpoch;
+    _memoryExpiryOf[key] = due;
+    _memoryExpirations.putIfAbsent(due, () => <String>{}).add(key);
+    _scheduleMemoryExpiration(expiresAt);
+  }
+
+  /// Forgets when the memory entry of [key] expires.
+  void _untrackMemoryExpiry(String key) {
+    final due = _memoryExpiryOf.remove(key);
+    if (due == null) return;
+
+    final keys = _memoryExpirations[due]!..remove(key);
+    if (keys.isEmpty) _memoryExpirations.remove(due);
+  }
+
+  /// Removes the expired memory entries, emits their events and arms the
+  /// timer for the next one to expire.
+  ///
+  /// Only the entries that are due are visited. Keys evicted since they
+  /// were recorded are dropped without an event.
+  void _expireMemoryEntries() {
+    _memoryExpirationTimer = null;
+    _memoryExpirationDue = null;
+
+    final now = DateTime.now();
+    while (_memoryExpirations.isNotEmpty &&
+        _memoryExpirations.firstKey()! <= now.millisecondsSinceEpoch) {
+      final keys = _memoryExpirations.remove(_memoryExpirations.firstKey())!;
+      for (final key in keys) {
+        _memoryExpiryOf.remove(key);
+        if (!_memoryCache.remove(key)) continue;
         _expirationController.add(
-          CacheExpirationEvent(
-            key: entry.key,
-            expiredAt: DateTime.now(),
-          ),
+          CacheExpirationEvent(key: key, expiredAt: now),
         );
       }
     }
+    _stats.memoryCacheSize = _memoryCache.size;
+
+    if (_memoryExpirations.isNotEmpty) {
+      _scheduleMemoryExpiration(
+        DateTime.fromMillisecondsSinceEpoch(_memoryExpirations.firstKey()!),
+      );
+    }
+  }
+
+  /// Checks for expired disk entries and emits events.
+  ///
+  /// Only used when the disk cache does not expire entries itself; memory
+  /// entries are expired by [_memoryExpirationTimer].
+  Future<void> _checkExpirations() async {
+    if (!_initialized) return;
 
     // Check disk cache
     for (final entry in await _diskCache.entries) {
@@ -22,6 +22,8 @@ class SchemaManager {
     required this.executeRawInsert,
     required this.executeRawUpdate,
     required this.executeRawDelete,
+    this.createVectorIndex,
+    this.createFullTextIndex,
   });
 
   /// Function to execute raw SQL queries.
@@ -42,6 +44,20 @@ class SchemaManager {
   final Future<int> Function(String sql, [List<dynamic>? arguments])
       executeRawDelete;
 
+  /// Function to build a native index for a vector index of a table.
+  ///
+  /// Returns false if the platform has no native index of that kind, in
+  /// which case a plain index is created over the field instead.
+  final Future<bool> Function(TableSchema schema, IndexSchema index)?
+      createVectorIndex;
+
+  /// Function to build the native full-text index of a table.
+  ///
+  /// Returns false if the platform has no full-text search, in which case a
+  /// plain index is created over the fields instead.
+  final Future<bool> Function(TableSchema schema, IndexSchema index)?
+      createFullTextIndex;
+
   static const String _schemaVersionTable = '_schema_versions';
   static const String _migrationHistoryTable = '_migration_history';
 
@@ -115,6 +131,16 @@ class SchemaManager {
 
     // Create indexes
     for (final index in schema.indexes) {
+      if (index.type == IndexType.vector &&
+          createVectorIndex != null &&
+          await createVectorIndex!(schema, index)) {
+        continue;
+      }
+      if (index.type == IndexType.fullText &&
+          createFullTextIndex != null &&
+          await createFullTextIndex!(schema, index)) {
+        continue;
+      }
       await _createIndex(schema.name, index);
     }
 
@@ -155,7 +181,9 @@ class SchemaManager {
 
   /// Generates field definition SQL.
   String _generateFieldSql(FieldSchema field) {
-    final buffer = StringBuffer('${field.name} ${_dataTypeToSql(field.type)}');
+    final buffer = StringBuffer(
+      '${field.name} ${field.vectorConfig?.sqlType ?? _dataTypeToSql(field.type)}',
+    );
 
     if (!field.nullable) {
       buffer.write(' NOT NULL');
@@ -579,7 +607,10 @@ class SchemaManager {
 
     final typeName = fieldMap['type'] as String;
     final dataType = DataType.values.firstWhere((t) => t.name == typeName);
-    buffer.write(_dataTypeToSql(dataType));
+    final vectorConfig = dataType == DataType.vector
+        ? VectorFieldConfig.fromMap(fieldMap['vectorConfig'] as Map?)
+        : null;
+    buffer.write(vectorConfig?.sqlType ?? _dataTypeToSql(dataType));
 
     if (fieldMap['nullable'] == false) {
       buffer.write(' NOT NULL');
@@ -1,3 +1,5 @@
+import 'package:local_storage_cache/src/enums/eviction_policy.dart';
+
 /// Statistics about cache usage.
 class CacheStats {
   /// Creates cache statistics with the specified values.
@@ -7,7 +9,9 @@ class CacheStats {
     this.cacheEvictions = 0,
     this.memoryCacheSize = 0,
     this.diskCacheSize = 0,
-  });
+    this.evictionPolicy,
+    Map<EvictionPolicy, double>? policyHitRates,
+  }) : policyHitRates = policyHitRates ?? {};
 
   /// Total cache hits.
   int cacheHits;
@@ -24,12 +28,30 @@ class CacheStats {
   /// Current disk cache size.
   int diskCacheSize;
 
+  /// Eviction policy of the cache, if known.
+  EvictionPolicy? evictionPolicy;
+
+  /// Hit rate (0.0 to 1.0) each eviction policy reaches when the same
+  /// lookups are replayed against an empty cache of the same size.
+  ///
+  /// Empty unless a comparison was requested.
+  Map<EvictionPolicy, double> policyHitRates;
+
   /// Cache hit rate (0.0 to 1.0).
   double get hitRate {
     final total = cacheHits + cacheMisses;
     return total > 0 ? cacheHits / total : 0.0;
   }
 
+  /// How much higher the replayed hit rate of [evictionPolicy] is than that
+  /// of [baseline], or null if either was not replayed.
+  double? hitRateDifference(EvictionPolicy baseline) {
+    final current = policyHitRates[evictionPolicy];
+    final other = policyHitRates[baseline];
+    if (current == null || other == null) return null;
+    return current - other;
+  }
+
   /// Resets all statistics.
   void reset() {
     cacheHits = 0;
@@ -46,6 +68,12 @@ class CacheStats {
       'memoryCacheSize': memoryCacheSize,
       'diskCacheSize': diskCacheSize,
       'hitRate': hitRate,
+      if (evictionPolicy != null) 'evictionPolicy': evictionPolicy!.name,
+      if (policyHitRates.isNotEmpty)
+        'policyHitRates': {
+          for (final entry in policyHitRates.entries)
+            entry.key.name: entry.value,
+        },
     };
   }
 }
@@ -64,10 +64,16 @@ class DataChangeEvent extends StorageEvent {
     required this.tableName,
     required this.space,
     this.recordId,
+    this.recordIds,
     this.data,
   });
 
-  /// Table that was modified.
+  /// Table name of the events reporting rows the platform could not
+  /// attribute to a table, such as those of a `WITHOUT ROWID` table, after
+  /// which any table may have changed.
+  static const unknownTable = '*';
+
+  /// Table that was modified, or [unknownTable].
   final String tableName;
 
   /// Space where the change occurred.
@@ -76,6 +82,10 @@ class DataChangeEvent extends StorageEvent {
   /// ID of the affected record (if applicable).
   final dynamic recordId;
 
+  /// Row IDs of every affected record, when the platform reports a batch of
+  /// changes (if applicable).
+  final List<int>? recordIds;
+
   /// Data that was changed (if applicable).
   final Map<String, dynamic>? data;
 }
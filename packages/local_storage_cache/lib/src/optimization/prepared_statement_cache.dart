@@ -71,6 +71,15 @@ class PreparedStatementCache {
 
   final PreparedStatementCacheConfig _config;
   final LinkedHashMap<String, CachedStatement> _cache = LinkedHashMap();
+  Map<String, dynamic>? _nativeStats;
+
+  /// Records the counters reported by the platform's native statement cache.
+  ///
+  /// The native cache holds the actual compiled statements; its hit, miss
+  /// and eviction counters are included in [getStats] under `native`.
+  void recordNativeStats(Map<String, dynamic> stats) {
+    _nativeStats = Map<String, dynamic>.unmodifiable(stats);
+  }
 
   /// Gets a cached statement or creates a new one.
   CachedStatement getOrCreate(String sql) {
@@ -142,6 +151,7 @@ class PreparedStatementCache {
           'idleMs': s.idleMs,
         };
       }).toList(),
+      if (_nativeStats != null) 'native': _nativeStats,
     };
   }
 
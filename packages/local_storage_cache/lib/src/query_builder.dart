@@ -1,8 +1,22 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart' show MissingPluginException;
 import 'package:local_storage_cache/src/models/query_condition.dart';
+import 'package:local_storage_cache/src/schema/field_schema.dart';
+import 'package:local_storage_cache/src/schema/index_schema.dart';
 import 'package:local_storage_cache_platform_interface/local_storage_cache_platform_interface.dart';
 
 export 'package:local_storage_cache/src/models/query_condition.dart'
     show ClauseType;
+export 'package:local_storage_cache_platform_interface/local_storage_cache_platform_interface.dart'
+    show
+        ColumnarResult,
+        PackedColumnType,
+        PackedResult,
+        VectorIndexBenchmark,
+        VectorIndexBenchmarkRun,
+        VectorMatch;
 
 /// Fluent query builder for constructing and executing queries.
 ///
@@ -158,6 +172,65 @@ class QueryBuilder {
     orderBy(field, ascending: false);
   }
 
+  /// Orders results by the distance of vector [field] to [queryVector] under
+  /// [metric], closest first.
+  ///
+  /// Distances are computed natively by the `vec_cosine`, `vec_l2` and
+  /// `vec_dot` SQL functions, which [whereCustom] and raw queries can use
+  /// too. [precision] must be the precision [field] is stored with. Records
+  /// without a vector have no distance and are not left out; exclude them
+  /// with [whereNotNull].
+  ///
+  /// Unlike `vectorSearch`, this combines with any other clause, but never
+  /// uses a vector index and so compares every matching record.
+  ///
+  /// Example:
+  /// ```dart
+  /// final query = storage.query('documents')
+  ///   ..whereNotNull('embedding')
+  ///   ..orderByVectorDistance('embedding', queryEmbedding)
+  ///   ..limit = 10;
+  /// final documents = await query.get();
+  /// ```
+  void orderByVectorDistance(
+    String field,
+    List<double> queryVector, {
+    VectorDistanceMetric metric = VectorDistanceMetric.cosine,
+    VectorPrecision precision = VectorPrecision.float32,
+  }) {
+    final String function;
+    switch (metric) {
+      case VectorDistanceMetric.cosine:
+        function = 'vec_cosine';
+      case VectorDistanceMetric.euclidean:
+        function = 'vec_l2';
+      case VectorDistanceMetric.dotProduct:
+        function = 'vec_dot';
+    }
+
+    // The function reads float32 vectors unless told the column's type
+    var type = '';
+    switch (precision) {
+      case VectorPrecision.float16:
+        type = ", 'F16_BLOB'";
+      case VectorPrecision.float32:
+        break;
+      case VectorPrecision.float64:
+        type = ", 'F64_BLOB'";
+      case VectorPrecision.int8:
+        type = ", 'I8_BLOB'";
+    }
+
+    _orderBy.add(
+      _OrderByClause(
+        '$function($field, ?$type)',
+        // A larger dot product is closer
+        ascending: metric != VectorDistanceMetric.dotProduct,
+        arguments: [Float32List.fromList(queryVector)],
+      ),
+    );
+  }
+
   /// Adds a JOIN clause.
   void join(
     String table,
@@ -192,11 +265,34 @@ class QueryBuilder {
   /// Executes the query and returns all matching records.
   Future<List<Map<String, dynamic>>> get() async {
     final sql = _buildSelectSQL();
-    final arguments = _buildArguments();
+    final arguments = _buildSelectArguments();
     final platform = LocalStorageCachePlatform.instance;
     return platform.query(sql, arguments, _space);
   }
 
+  /// Executes the query and returns all matching records in columnar form.
+  ///
+  /// Cheaper than [get] for wide or large results, since column names are
+  /// only transferred once and rows are turned into maps only on demand.
+  Future<ColumnarResult> getColumnar() async {
+    final sql = _buildSelectSQL();
+    final arguments = _buildSelectArguments();
+    final platform = LocalStorageCachePlatform.instance;
+    return platform.queryColumnar(sql, arguments, _space);
+  }
+
+  /// Executes the query and returns all matching records packed into a
+  /// single buffer.
+  ///
+  /// Numeric columns can be read as typed lists without decoding each cell;
+  /// see [PackedResult].
+  Future<PackedResult> getPacked() async {
+    final sql = _buildSelectSQL();
+    final arguments = _buildSelectArguments();
+    final platform = LocalStorageCachePlatform.instance;
+    return platform.queryPacked(sql, arguments, _space);
+  }
+
   /// Executes the query and returns the first matching record.
   Future<Map<String, dynamic>?> first() async {
     limit = 1;
@@ -232,7 +328,11 @@ class QueryBuilder {
   /// Executes the query and returns a stream of matching records.
   ///
   /// This is memory-efficient for large datasets as it doesn't load
-  /// all records into memory at once.
+  /// all records into memory at once. Records are read from a native cursor
+  /// [pageSize] at a time; the cursor is closed when the stream completes
+  /// or its subscription is cancelled.
+  ///
+  /// Platforms without cursor support fall back to a single query.
   ///
   /// Example:
   /// ```dart
@@ -240,13 +340,116 @@ class QueryBuilder {
   ///   print(record);
   /// }
   /// ```
-  Stream<Map<String, dynamic>> stream() async* {
-    final results = await get();
-    for (final record in results) {
-      yield record;
+  Stream<Map<String, dynamic>> stream({int pageSize = 500}) async* {
+    final sql = _buildSelectSQL();
+    final arguments = _buildSelectArguments();
+    final platform = LocalStorageCachePlatform.instance;
+
+    final int cursorId;
+    try {
+      cursorId = await platform.openCursor(sql, arguments, _space);
+    } on UnimplementedError {
+      yield* Stream.fromIterable(await get());
+      return;
+    } on MissingPluginException {
+      yield* Stream.fromIterable(await get());
+      return;
+    }
+
+    var isDone = false;
+    try {
+      while (!isDone) {
+        final page = await platform.fetch(cursorId, pageSize);
+        isDone = page.isDone;
+        for (final record in page.rows) {
+          yield record;
+        }
+      }
+    } finally {
+      if (!isDone) {
+        await platform.closeCursor(cursorId);
+      }
     }
   }
 
+  /// Executes the query and yields its results, then yields them again each
+  /// time they change.
+  ///
+  /// The platform re-runs the query only once a committed write touches a
+  /// table it reads, including tables beneath views, joins and subqueries,
+  /// and sends only the rows that were inserted, removed or changed,
+  /// matched by [keyColumn]. The query is no longer watched once the
+  /// subscription is cancelled.
+  ///
+  /// Platforms without watched queries yield the results once.
+  ///
+  /// Example:
+  /// ```dart
+  /// final query = storage.query('todos')..where('done', '=', 0);
+  /// query.watch().listen((todos) => setState(() => _todos = todos));
+  /// ```
+  Stream<List<Map<String, dynamic>>> watch({String keyColumn = 'id'}) {
+    final sql = _buildSelectSQL();
+    final arguments = _buildSelectArguments();
+    final platform = LocalStorageCachePlatform.instance;
+
+    late final StreamController<List<Map<String, dynamic>>> controller;
+    StreamSubscription<QueryDiff>? diffs;
+    int? watchId;
+    var cancelled = false;
+    var rows = <Map<String, dynamic>>[];
+
+    Future<void> fallBackToQuery() async {
+      controller.add(await get());
+      await controller.close();
+    }
+
+    controller = StreamController(
+      onListen: () async {
+        final QueryDiff first;
+        try {
+          first = await platform.watchQuery(
+            sql,
+            arguments,
+            _space,
+            keyColumn: keyColumn,
+          );
+        } on UnimplementedError {
+          return fallBackToQuery();
+        } on MissingPluginException {
+          return fallBackToQuery();
+        } catch (error, stackTrace) {
+          controller.addError(error, stackTrace);
+          await controller.close();
+          return;
+        }
+
+        if (cancelled) {
+          await platform.unwatchQuery(first.watchId);
+          return;
+        }
+        watchId = first.watchId;
+        rows = first.apply(rows, keyColumn);
+        controller.add(rows);
+
+        // The platform only sends diffs of a watch after its first result
+        diffs = platform.queryDiffs().listen((diff) {
+          if (diff.watchId != watchId) return;
+          rows = diff.apply(rows, keyColumn);
+          controller.add(rows);
+        });
+      },
+      onCancel: () async {
+        cancelled = true;
+        await diffs?.cancel();
+        if (watchId != null) {
+          await platform.unwatchQuery(watchId!);
+        }
+      },
+    );
+    return controller.stream;
+  }
+
   /// Builds the SELECT SQL query.
   String _buildSelectSQL() {
     final buffer = StringBuffer();
@@ -496,6 +699,15 @@ class QueryBuilder {
     return arguments;
   }
 
+  /// Builds the arguments list for the SELECT query, whose ORDER BY clause
+  /// may take arguments of its own.
+  List<dynamic> _buildSelectArguments() {
+    return [
+      ..._buildArguments(),
+      for (final order in _orderBy) ...order.arguments,
+    ];
+  }
+
   /// Builds arguments list from a QueryCondition.
   ///
   /// Recursively extracts arguments from nested conditions.
@@ -593,9 +805,14 @@ class _WhereClause {
 }
 
 class _OrderByClause {
-  _OrderByClause(this.field, {required this.ascending});
+  _OrderByClause(
+    this.field, {
+    required this.ascending,
+    this.arguments = const [],
+  });
   final String field;
   final bool ascending;
+  final List<dynamic> arguments;
 }
 
 class _JoinClause {
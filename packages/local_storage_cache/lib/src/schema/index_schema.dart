@@ -5,6 +5,26 @@ enum IndexType {
 
   /// Vector index for similarity search.
   vector,
+
+  /// Full-text index over text fields, searched with `search`.
+  fullText,
+}
+
+/// Configuration for full-text indexes.
+class FullTextIndexConfig {
+  /// Creates a full-text index configuration with the specified settings.
+  const FullTextIndexConfig({
+    this.tokenizer = 'unicode61',
+    this.prefixLengths = const [],
+  });
+
+  /// FTS5 tokenizer splitting text into terms, e.g. `unicode61`, or
+  /// `porter unicode61` to also match other forms of English words.
+  final String tokenizer;
+
+  /// Prefix lengths to index, which speed up prefix queries such as `app*`
+  /// of these lengths at the cost of a larger index.
+  final List<int> prefixLengths;
 }
 
 /// Configuration for vector indexes.
@@ -23,6 +43,18 @@ class VectorIndexConfig {
   final VectorDistanceMetric distanceMetric;
 
   /// Additional algorithm-specific parameters.
+  ///
+  /// HNSW takes `m` (links per node, default 16), `efConstruction`
+  /// (candidate list size while building, default 200) and `efSearch`
+  /// (candidate list size while searching, default 64).
+  ///
+  /// IVF-Flat takes `nlist` (number of k-means clusters, default about the
+  /// square root of the row count) and `nprobe` (clusters scanned per
+  /// search, default 8). Its vectors are stored uncompressed unless
+  /// `quantization` is `int8` (a quarter of the memory) or `pq` (product
+  /// quantization into `pqSubvectors` bytes per vector, default half the
+  /// dimensions); compressed searches re-rank `rerank` times as many
+  /// candidates as requested (default 4) against the stored rows.
   final Map<String, dynamic> parameters;
 }
 
@@ -56,6 +88,7 @@ class IndexSchema {
     this.unique = false,
     this.name,
     this.vectorConfig,
+    this.fullTextConfig,
   });
 
   /// Type of index.
@@ -73,6 +106,10 @@ class IndexSchema {
   /// Vector index configuration (for vector type).
   final VectorIndexConfig? vectorConfig;
 
+  /// Full-text index configuration (for fullText type); defaults apply if
+  /// omitted.
+  final FullTextIndexConfig? fullTextConfig;
+
   /// Converts the index schema to a map representation.
   Map<String, dynamic> toMap() {
     return {
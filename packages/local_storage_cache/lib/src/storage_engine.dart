@@ -1,14 +1,20 @@
+import 'dart:async';
 import 'dart:convert';
 import 'dart:math';
 
 import 'package:flutter/foundation.dart' show kIsWeb;
+import 'package:flutter/services.dart' show MissingPluginException;
 import 'package:local_storage_cache/src/config/storage_config.dart';
+import 'package:local_storage_cache/src/enums/eviction_policy.dart';
 import 'package:local_storage_cache/src/managers/event_manager.dart';
 import 'package:local_storage_cache/src/managers/performance_metrics_manager.dart';
 import 'package:local_storage_cache/src/managers/storage_logger.dart';
+import 'package:local_storage_cache/src/models/cache_stats.dart';
 import 'package:local_storage_cache/src/models/storage_event.dart';
 import 'package:local_storage_cache/src/models/storage_stats.dart';
+import 'package:local_storage_cache/src/optimization/prepared_statement_cache.dart';
 import 'package:local_storage_cache/src/query_builder.dart';
+import 'package:local_storage_cache/src/schema/field_schema.dart';
 import 'package:local_storage_cache/src/schema/index_schema.dart';
 import 'package:local_storage_cache/src/schema/primary_key_config.dart';
 import 'package:local_storage_cache/src/schema/table_schema.dart';
@@ -65,12 +71,30 @@ class StorageEngine {
   /// Database path.
   String? _databasePath;
 
+  /// Whether the platform has the native key-value methods; falls back to
+  /// SQL through [LocalStorageCachePlatform.query] once it turns out not to.
+  bool _nativeKeyValue = true;
+
+  /// Batches of committed row changes pushed by the platform. While set,
+  /// [insert], [update] and [delete] leave their events to it.
+  StreamSubscription<Map<String, dynamic>>? _dataChanges;
+
+  /// Number of [insert] and [update] calls in flight per table.
+  final Map<String, int> _writesInFlight = {};
+
+  /// Events of tables with writes in flight, held until those return so
+  /// that the events of their rows carry the data written.
+  final Map<String, List<DataChangeEvent>> _heldDataChanges = {};
+
   /// Event manager for monitoring storage events.
   final EventManager _eventManager = EventManager();
 
   /// Performance metrics manager.
   final PerformanceMetricsManager _metricsManager = PerformanceMetricsManager();
 
+  /// Prepared statement cache, which holds the counters of the native one.
+  final PreparedStatementCache _statementCache = PreparedStatementCache();
+
   /// Storage logger.
   late final StorageLogger _logger;
 
@@ -80,6 +104,9 @@ class StorageEngine {
   /// Gets the performance metrics manager.
   PerformanceMetricsManager get metricsManager => _metricsManager;
 
+  /// Gets the prepared statement cache.
+  PreparedStatementCache get statementCache => _statementCache;
+
   /// Initializes the storage engine.
   ///
   /// Must be called before any other operations.
@@ -106,6 +133,9 @@ class StorageEngine {
     final initTime = DateTime.now().difference(startTime).inMilliseconds;
     _logger.info('Platform storage initialized in ${initTime}ms');
 
+    // Report every committed row change, not only those made here
+    await _enableDataChanges();
+
     // Setup encryption if enabled
     if (config.encryption.enabled) {
       _logger.info('Setting up encryption...');
@@ -127,6 +157,128 @@ class StorageEngine {
     );
   }
 
+  /// Subscribes to the platform's batches of committed row changes, if it
+  /// reports them.
+  Future<void> _enableDataChanges() async {
+    try {
+      await _platform!.setDataChangesEnabled(enabled: true);
+    } on UnimplementedError {
+      return;
+    } on MissingPluginException {
+      return;
+    }
+    _dataChanges = _platform!.dataChanges().listen(_emitDataChanges);
+  }
+
+  /// Emits one [DataChangeEvent] per table and kind of change in [batch],
+  /// and one for [DataChangeEvent.unknownTable] if rows the platform could
+  /// not attribute to a table changed.
+  void _emitDataChanges(Map<String, dynamic> batch) {
+    final timestamp = DateTime.now();
+    final tables = (batch['tables'] as List).cast<Map<dynamic, dynamic>>();
+    for (final table in tables) {
+      final tableName = _tableNameOf(table['name'] as String);
+      for (final change in _dataChangeTypes.entries) {
+        final rowIds = (table[change.key] as List? ?? const []).cast<int>();
+        if (rowIds.isEmpty) continue;
+        final event = DataChangeEvent(
+          type: change.value,
+          timestamp: timestamp,
+          tableName: tableName,
+          space: _currentSpace,
+          recordId: rowIds.length == 1 ? rowIds.first : null,
+          recordIds: List.unmodifiable(rowIds),
+        );
+        if (_writesInFlight.containsKey(tableName)) {
+          _heldDataChanges.putIfAbsent(tableName, () => []).add(event);
+        } else {
+          _eventManager.emit(event);
+        }
+      }
+    }
+    if (batch['unknownTables'] == true) {
+      _eventManager.emit(
+        DataChangeEvent(
+          type: StorageEventType.dataUpdated,
+          timestamp: timestamp,
+          tableName: DataChangeEvent.unknownTable,
+          space: _currentSpace,
+        ),
+      );
+    }
+  }
+
+  /// The name [insert] and the other methods take for the platform's table
+  /// [nativeName], which carries the space prefix unless the table is
+  /// global.
+  String _tableNameOf(String nativeName) {
+    final prefix = '${_currentSpace}_';
+    final schemas = this.schemas ?? const <TableSchema>[];
+    final isGlobal =
+        schemas.any((schema) => schema.isGlobal && schema.name == nativeName);
+    if (isGlobal || !nativeName.startsWith(prefix)) return nativeName;
+    return nativeName.substring(prefix.length);
+  }
+
+  /// Holds the platform's events of [tableName] back until [_endWrite].
+  void _beginWrite(String tableName) {
+    _writesInFlight.update(tableName, (count) => count + 1, ifAbsent: () => 1);
+  }
+
+  /// Ends a write of [tableName] begun by [_beginWrite], which [event]
+  /// describes unless it failed.
+  ///
+  /// Without the platform's events, [event] is emitted. Otherwise the data
+  /// of [event] is added to the held event of the platform reporting the
+  /// same rows, which it sends before the write returns, and once no write
+  /// of the table is left in flight the other held events are emitted.
+  void _endWrite(String tableName, [DataChangeEvent? event]) {
+    final count = _writesInFlight[tableName]! - 1;
+    if (count > 0) {
+      _writesInFlight[tableName] = count;
+    } else {
+      _writesInFlight.remove(tableName);
+    }
+    if (_dataChanges == null) {
+      if (event != null) _eventManager.emit(event);
+      return;
+    }
+
+    final held = _heldDataChanges[tableName] ?? [];
+    final own = event == null
+        ? -1
+        : held.indexWhere(
+            (change) =>
+                change.type == event.type &&
+                (event.recordId == null ||
+                    (change.recordIds?.contains(event.recordId) ?? false)),
+          );
+    if (own >= 0) {
+      final change = held.removeAt(own);
+      _eventManager.emit(
+        DataChangeEvent(
+          type: change.type,
+          timestamp: change.timestamp,
+          tableName: tableName,
+          space: change.space,
+          recordId: change.recordId,
+          recordIds: change.recordIds,
+          data: event!.data,
+        ),
+      );
+    }
+    if (count <= 0) {
+      _heldDataChanges.remove(tableName)?.forEach(_eventManager.emit);
+    }
+  }
+
+  /// Event types of the row lists in a batch of data changes.
+  static const _dataChangeTypes = {
+    'inserted': StorageEventType.dataInserted,
+    'updated': StorageEventType.dataUpdated,
+    'deleted': StorageEventType.dataDeleted,
+  };
+
   /// Gets the database path based on configuration and platform.
   Future<String> _getDatabasePath() async {
     if (config.databasePath != null) {
@@ -192,12 +344,83 @@ class StorageEngine {
 
       // Create indexes
       for (final index in schema.indexes) {
+        if (index.type == IndexType.vector &&
+            await _createVectorIndex(schema, index)) {
+          continue;
+        }
+        if (index.type == IndexType.fullText &&
+            await _createFullTextIndex(schema, index)) {
+          continue;
+        }
         final indexSql = _generateCreateIndexSQL(schema.name, index);
         await _platform!.query(indexSql, [], _currentSpace);
       }
     }
   }
 
+  /// Builds the native index for a vector [index] of [schema].
+  ///
+  /// Returns false if the index type has no native implementation on this
+  /// platform, in which case a plain index is created instead.
+  Future<bool> _createVectorIndex(TableSchema schema, IndexSchema index) async {
+    final config = index.vectorConfig;
+    if (config == null) {
+      return false;
+    }
+
+    final field = index.fields.first;
+    final vectorField = schema.fields.where((f) => f.name == field);
+    try {
+      await _platform!.createVectorIndex(
+        _vectorIndexName(schema.name, index),
+        _getTableName(schema.name),
+        field,
+        indexType: config.indexType.name,
+        dimensions: vectorField.isEmpty
+            ? null
+            : vectorField.first.vectorConfig?.dimensions,
+        metric: config.distanceMetric.name,
+        parameters: config.parameters,
+      );
+      return true;
+    } on UnimplementedError {
+      return false;
+    } on MissingPluginException {
+      return false;
+    }
+  }
+
+  /// Builds the native full-text index for a fullText [index] of [schema].
+  ///
+  /// Returns false if the platform has no full-text search, in which case a
+  /// plain index is created instead.
+  Future<bool> _createFullTextIndex(
+    TableSchema schema,
+    IndexSchema index,
+  ) async {
+    final config = index.fullTextConfig ?? const FullTextIndexConfig();
+    try {
+      await _platform!.createFullTextIndex(
+        _getTableName(schema.name),
+        index.fields,
+        tokenizer: config.tokenizer,
+        prefixes: config.prefixLengths,
+      );
+      return true;
+    } on UnimplementedError {
+      return false;
+    } on MissingPluginException {
+      return false;
+    }
+  }
+
+  /// Native name of the vector [index] of [tableName], unique across spaces.
+  String _vectorIndexName(String tableName, IndexSchema index) {
+    final name = index.name ??
+        '${index.fields.first}_${index.vectorConfig!.indexType.name}';
+    return '${_getTableName(tableName)}_$name';
+  }
+
   /// Generates CREATE TABLE SQL from schema.
   String _generateCreateTableSQL(TableSchema schema) {
     final buffer = StringBuffer()
@@ -213,7 +436,8 @@ class StorageEngine {
 
     // Fields
     for (final field in schema.fields) {
-      buffer.write(', ${field.name} ${_getDataTypeSQL(field.type)}');
+      final type = field.vectorConfig?.sqlType ?? _getDataTypeSQL(field.type);
+      buffer.write(', ${field.name} $type');
       if (!field.nullable) {
         buffer.write(' NOT NULL');
       }
@@ -308,6 +532,25 @@ class StorageEngine {
     return '${_currentSpace}_$tableName';
   }
 
+  /// Encodes vector field values as the typed data stored in their BLOB
+  /// column, according to each field's [VectorFieldConfig].
+  Map<String, dynamic> _encodeVectorFields(
+    String tableName,
+    Map<String, dynamic> data,
+  ) {
+    final schema = schemas?.where((s) => s.name == tableName).firstOrNull;
+    if (schema == null) return data;
+
+    Map<String, dynamic>? encoded;
+    for (final field in schema.fields) {
+      final config = field.vectorConfig;
+      final value = data[field.name];
+      if (config == null || value is! List<num>) continue;
+      (encoded ??= Map.of(data))[field.name] = config.encode(value);
+    }
+    return encoded ?? data;
+  }
+
   /// Creates a query builder for the specified table.
   QueryBuilder query(String tableName) {
     _ensureInitialized();
@@ -320,9 +563,17 @@ class StorageEngine {
   Future<dynamic> insert(String tableName, Map<String, dynamic> data) async {
     _ensureInitialized();
     final fullTableName = _getTableName(tableName);
+    final values = _encodeVectorFields(tableName, data);
 
     final startTime = DateTime.now();
-    final id = await _platform!.insert(fullTableName, data, _currentSpace);
+    _beginWrite(tableName);
+    final dynamic id;
+    try {
+      id = await _platform!.insert(fullTableName, values, _currentSpace);
+    } catch (_) {
+      _endWrite(tableName);
+      rethrow;
+    }
     final executionTime = DateTime.now().difference(startTime).inMilliseconds;
 
     // Log operation
@@ -334,8 +585,9 @@ class StorageEngine {
       executionTime,
     );
 
-    // Emit event
-    _eventManager.emit(
+    // Emit event, or add its data to the platform's
+    _endWrite(
+      tableName,
       DataChangeEvent(
         type: StorageEventType.dataInserted,
         timestamp: DateTime.now(),
@@ -373,12 +625,20 @@ class StorageEngine {
     final fullTableName = _getTableName(tableName);
 
     // Build UPDATE SQL
-    final fields = data.keys.map((k) => '$k = ?').join(', ');
+    final values = _encodeVectorFields(tableName, data);
+    final fields = values.keys.map((k) => '$k = ?').join(', ');
     final sql = 'UPDATE $fullTableName SET $fields';
 
     final startTime = DateTime.now();
-    final count =
-        await _platform!.update(sql, data.values.toList(), _currentSpace);
+    _beginWrite(tableName);
+    final int count;
+    try {
+      count =
+          await _platform!.update(sql, values.values.toList(), _currentSpace);
+    } catch (_) {
+      _endWrite(tableName);
+      rethrow;
+    }
     final executionTime = DateTime.now().difference(startTime).inMilliseconds;
 
     // Log operation
@@ -387,8 +647,9 @@ class StorageEngine {
     // Record metrics
     _metricsManager.recordQueryExecution(sql, executionTime);
 
-    // Emit event
-    _eventManager.emit(
+    // Emit event, or add its data to the platform's
+    _endWrite(
+      tableName,
       DataChangeEvent(
         type: StorageEventType.dataUpdated,
         timestamp: DateTime.now(),
@@ -420,15 +681,17 @@ class StorageEngine {
     // Record metrics
     _metricsManager.recordQueryExecution(sql, executionTime);
 
-    // Emit event
-    _eventManager.emit(
-      DataChangeEvent(
-        type: StorageEventType.dataDeleted,
-        timestamp: DateTime.now(),
-        tableName: tableName,
-        space: _currentSpace,
-      ),
-    );
+    // Emit event, unless the platform reports the change itself
+    if (_dataChanges == null) {
+      _eventManager.emit(
+        DataChangeEvent(
+          type: StorageEventType.dataDeleted,
+          timestamp: DateTime.now(),
+          tableName: tableName,
+          space: _currentSpace,
+        ),
+      );
+    }
 
     return count;
   }
@@ -452,7 +715,7 @@ class StorageEngine {
           (data) => BatchOperation(
             type: 'insert',
             tableName: fullTableName,
-            data: data,
+            data: _encodeVectorFields(tableName, data),
           ),
         )
         .toList();
@@ -461,22 +724,42 @@ class StorageEngine {
   }
 
   /// Executes a batch of update operations.
+  ///
+  /// Each map updates the record it names by its primary key or, lacking
+  /// that, by the first unique field it holds, setting its other fields.
   Future<void> batchUpdate(
     String tableName,
     List<Map<String, dynamic>> dataList,
   ) async {
     _ensureInitialized();
     final fullTableName = _getTableName(tableName);
-
-    final operations = dataList
-        .map(
-          (data) => BatchOperation(
-            type: 'update',
-            tableName: fullTableName,
-            data: data,
-          ),
-        )
-        .toList();
+    final schema = schemas?.firstWhere(
+      (s) => s.name == tableName,
+      orElse: () => TableSchema(name: tableName, fields: []),
+    );
+    final keyNames = [
+      schema?.primaryKeyConfig.name ?? 'id',
+      ...?schema?.fields.where((f) => f.unique).map((f) => f.name),
+    ];
+
+    final operations = dataList.map((data) {
+      final keyName = keyNames.firstWhere(
+        data.containsKey,
+        orElse: () => throw ArgumentError(
+          'Each update of $tableName needs one of ${keyNames.join(', ')}',
+        ),
+      );
+      final values = Map<String, dynamic>.of(
+        _encodeVectorFields(tableName, data),
+      )..remove(keyName);
+      final fields = values.keys.map((k) => '$k = ?').join(', ');
+      return BatchOperation(
+        type: 'update',
+        tableName: fullTableName,
+        sql: 'UPDATE $fullTableName SET $fields WHERE $keyName = ?',
+        arguments: [...values.values, data[keyName]],
+      );
+    }).toList();
 
     await _platform!.executeBatch(operations, _currentSpace);
   }
@@ -529,33 +812,74 @@ class StorageEngine {
     bool isGlobal = false,
   }) async {
     _ensureInitialized();
+    final tableName = _getKVTableName(isGlobal);
+    final valueStr = _serializeValue(value);
 
-    // Create key-value table if it doesn't exist
-    final createTableSQL = '''
-      CREATE TABLE IF NOT EXISTS ${_getKVTableName(isGlobal)} (
-        key TEXT PRIMARY KEY,
-        value TEXT NOT NULL,
-        updated_at INTEGER NOT NULL
-      )
-    ''';
-    await _platform!.query(createTableSQL, [], _currentSpace);
+    if (_nativeKeyValue) {
+      try {
+        await _platform!.kvSet(tableName, key, valueStr);
+        return;
+      } on UnimplementedError {
+        _nativeKeyValue = false;
+      } on MissingPluginException {
+        _nativeKeyValue = false;
+      }
+    }
 
-    // Insert or replace the value
-    final valueStr = _serializeValue(value);
-    final timestamp = DateTime.now().millisecondsSinceEpoch;
-    final sql = '''
-      INSERT OR REPLACE INTO ${_getKVTableName(isGlobal)} (key, value, updated_at)
-      VALUES (?, ?, ?)
-    ''';
-    await _platform!.query(sql, [key, valueStr, timestamp], _currentSpace);
+    await _createKVTable(tableName);
+    await _platform!.query(
+      _kvUpsertSQL(tableName),
+      [key, valueStr, DateTime.now().millisecondsSinceEpoch],
+      _currentSpace,
+    );
+  }
+
+  /// Sets several key-value pairs at once.
+  ///
+  /// With native key-value support they are written in one transaction.
+  Future<void> setValues(
+    Map<String, dynamic> values, {
+    bool isGlobal = false,
+  }) async {
+    _ensureInitialized();
+    final tableName = _getKVTableName(isGlobal);
+    final entries = values.map(
+      (key, value) => MapEntry(key, _serializeValue(value)),
+    );
+
+    if (_nativeKeyValue) {
+      try {
+        await _platform!.kvMultiSet(tableName, entries);
+        return;
+      } on UnimplementedError {
+        _nativeKeyValue = false;
+      } on MissingPluginException {
+        _nativeKeyValue = false;
+      }
+    }
+
+    for (final entry in values.entries) {
+      await setValue(entry.key, entry.value, isGlobal: isGlobal);
+    }
   }
 
   /// Gets a value by key.
   Future<T?> getValue<T>(String key, {bool isGlobal = false}) async {
     _ensureInitialized();
+    final tableName = _getKVTableName(isGlobal);
 
-    final sql =
-        'SELECT value FROM ${_getKVTableName(isGlobal)} WHERE key = ? LIMIT 1';
+    if (_nativeKeyValue) {
+      try {
+        final valueStr = await _platform!.kvGet(tableName, key);
+        return valueStr == null ? null : _deserializeValue<T>(valueStr);
+      } on UnimplementedError {
+        _nativeKeyValue = false;
+      } on MissingPluginException {
+        _nativeKeyValue = false;
+      }
+    }
+
+    final sql = 'SELECT value FROM $tableName WHERE key = ? LIMIT 1';
     try {
       final results = await _platform!.query(sql, [key], _currentSpace);
       if (results.isEmpty) return null;
@@ -568,13 +892,75 @@ class StorageEngine {
     }
   }
 
+  /// Gets the values of several keys at once. Missing keys map to null.
+  Future<Map<String, T?>> getValues<T>(
+    List<String> keys, {
+    bool isGlobal = false,
+  }) async {
+    _ensureInitialized();
+    final tableName = _getKVTableName(isGlobal);
+
+    if (_nativeKeyValue) {
+      try {
+        final values = await _platform!.kvMultiGet(tableName, keys);
+        return {
+          for (final key in keys)
+            key: values[key] == null
+                ? null
+                : _deserializeValue<T>(values[key]!),
+        };
+      } on UnimplementedError {
+        _nativeKeyValue = false;
+      } on MissingPluginException {
+        _nativeKeyValue = false;
+      }
+    }
+
+    return {
+      for (final key in keys) key: await getValue<T>(key, isGlobal: isGlobal),
+    };
+  }
+
   /// Deletes a key-value pair.
   Future<void> deleteValue(String key, {bool isGlobal = false}) async {
     _ensureInitialized();
-    final sql = 'DELETE FROM ${_getKVTableName(isGlobal)} WHERE key = ?';
+    final tableName = _getKVTableName(isGlobal);
+
+    if (_nativeKeyValue) {
+      try {
+        await _platform!.kvDelete(tableName, key);
+        return;
+      } on UnimplementedError {
+        _nativeKeyValue = false;
+      } on MissingPluginException {
+        _nativeKeyValue = false;
+      }
+    }
+
+    final sql = 'DELETE FROM $tableName WHERE key = ?';
     await _platform!.delete(sql, [key], _currentSpace);
   }
 
+  /// Creates the key-value table [tableName] if it doesn't exist.
+  Future<void> _createKVTable(String tableName) async {
+    final createTableSQL = '''
+      CREATE TABLE IF NOT EXISTS $tableName (
+        key TEXT PRIMARY KEY,
+        value TEXT NOT NULL,
+        updated_at INTEGER NOT NULL
+      )
+    ''';
+    await _platform!.query(createTableSQL, [], _currentSpace);
+  }
+
+  /// SQL inserting or replacing a key, value and timestamp in [tableName].
+  String _kvUpsertSQL(String tableName) {
+    return '''
+      INSERT OR REPLACE INTO $tableName (key, value, updated_at)
+      VALUES (?, ?, ?)
+    ''';
+  }
+
   /// Gets the key-value table name.
   String _getKVTableName(bool isGlobal) {
     if (isGlobal) {
@@ -636,16 +1022,78 @@ class StorageEngine {
   Future<StorageStats> getStats() async {
     _ensureInitialized();
     final info = await _platform!.getStorageInfo();
+    final cacheStats = await getCacheStats();
     return StorageStats(
       storageSize: (info['totalSize'] as int?) ?? 0,
       recordCount: (info['recordCount'] as int?) ?? 0,
       tableCount: (info['tableCount'] as int?) ?? 0,
       spaceCount: 1, // Will be enhanced in Phase 4
-      cacheHitRate: 0, // Will be enhanced in Phase 4
+      cacheHitRate: cacheStats.hitRate,
       averageQueryTime: 0, // Will be enhanced in Phase 7
     );
   }
 
+  /// Gets statistics of the native memory cache that fronts key-value and
+  /// query lookups.
+  ///
+  /// With [comparePolicies], the cache's recent lookups are also replayed
+  /// under every eviction policy, filling [CacheStats.policyHitRates] so that
+  /// [CacheStats.hitRateDifference] tells how the configured policy compares
+  /// on the app's actual workload.
+  ///
+  /// All counters are zero on platforms without one.
+  Future<CacheStats> getCacheStats({bool comparePolicies = false}) async {
+    _ensureInitialized();
+    Map<String, dynamic> stats;
+    var hitRates = <String, double>{};
+    try {
+      stats = await _platform!.getMemoryCacheStats();
+      if (comparePolicies) {
+        hitRates = await _platform!.compareEvictionPolicies();
+      }
+    } on UnimplementedError {
+      return CacheStats();
+    } on MissingPluginException {
+      return CacheStats();
+    }
+
+    final policyHitRates = <EvictionPolicy, double>{};
+    EvictionPolicy? evictionPolicy;
+    for (final policy in EvictionPolicy.values) {
+      final rate = hitRates[policy.name];
+      if (rate != null) policyHitRates[policy] = rate;
+      if (stats['evictionPolicy'] == policy.name) evictionPolicy = policy;
+    }
+
+    return CacheStats(
+      cacheHits: (stats['hits'] as int?) ?? 0,
+      cacheMisses: (stats['misses'] as int?) ?? 0,
+      cacheEvictions: (stats['evictions'] as int?) ?? 0,
+      memoryCacheSize: (stats['size'] as int?) ?? 0,
+      evictionPolicy: evictionPolicy,
+      policyHitRates: policyHitRates,
+    );
+  }
+
+  /// Gets statistics of the prepared statement cache.
+  ///
+  /// The hit, miss and eviction counters of the platform's native statement
+  /// cache, which holds the compiled statements, are pulled into
+  /// [statementCache] first and reported under `native`. Platforms without
+  /// one report no `native` counters.
+  Future<Map<String, dynamic>> getStatementCacheStats() async {
+    _ensureInitialized();
+    try {
+      _statementCache
+          .recordNativeStats(await _platform!.getStatementCacheStats());
+    } on UnimplementedError {
+      _logger.debug('Native statement cache stats are not available');
+    } on MissingPluginException {
+      _logger.debug('Native statement cache stats are not available');
+    }
+    return _statementCache.getStats();
+  }
+
   /// Performs a VACUUM operation to reclaim unused space.
   Future<void> vacuum() async {
     _ensureInitialized();
@@ -676,6 +1124,13 @@ class StorageEngine {
 
     _logger.info('Closing storage engine...');
 
+    // Stop the platform reporting row changes
+    if (_dataChanges != null) {
+      await _dataChanges!.cancel();
+      _dataChanges = null;
+      await _platform?.setDataChangesEnabled(enabled: false);
+    }
+
     // Close platform connection
     await _platform?.close();
 
@@ -693,7 +1148,8 @@ class StorageEngine {
   /// Executes a streaming query for memory-efficient processing of large datasets.
   ///
   /// Returns a stream that yields records one at a time without loading
-  /// all data into memory at once.
+  /// all data into memory at once. Records are paged in from a native
+  /// cursor [pageSize] at a time.
   ///
   /// Example:
   /// ```dart
@@ -701,10 +1157,199 @@ class StorageEngine {
   ///   await processRecord(record);
   /// }
   /// ```
-  Stream<Map<String, dynamic>> streamQuery(String tableName) async* {
+  Stream<Map<String, dynamic>> streamQuery(
+    String tableName, {
+    int pageSize = 500,
+  }) async* {
     _ensureInitialized();
     final queryBuilder = query(tableName);
-    yield* queryBuilder.stream();
+    yield* queryBuilder.stream(pageSize: pageSize);
+  }
+
+  /// Finds the [k] records of [tableName] whose vector [field] is closest to
+  /// [queryVector] under [metric], closest first.
+  ///
+  /// The scan runs natively and is split across the reader connections.
+  /// [where] is an optional SQL condition, with positional [whereArguments],
+  /// that records must satisfy to be considered.
+  ///
+  /// If [field] has a vector index with the same [metric], unfiltered
+  /// searches are answered approximately from the index instead. [efSearch]
+  /// (HNSW) and [nprobe] (IVF-Flat) trade latency for recall per search;
+  /// [exact] forces a full scan.
+  ///
+  /// Example:
+  /// ```dart
+  /// final matches = await storage.vectorSearch(
+  ///   'documents',
+  ///   'embedding',
+  ///   queryEmbedding,
+  ///   k: 5,
+  ///   where: 'language = ?',
+  ///   whereArguments: ['en'],
+  /// );
+  /// ```
+  Future<List<VectorMatch>> vectorSearch(
+    String tableName,
+    String field,
+    List<double> queryVector, {
+    int k = 10,
+    VectorDistanceMetric metric = VectorDistanceMetric.cosine,
+    String? where,
+    List<dynamic> whereArguments = const [],
+    int? efSearch,
+    int? nprobe,
+    bool exact = false,
+  }) async {
+    _ensureInitialized();
+    final fullTableName = _getTableName(tableName);
+
+    final startTime = DateTime.now();
+    final matches = await _platform!.vectorSearch(
+      fullTableName,
+      field,
+      queryVector,
+      k: k,
+      metric: metric.name,
+      filterSql: where,
+      filterArguments: whereArguments,
+      efSearch: efSearch,
+      nprobe: nprobe,
+      exact: exact,
+    );
+    final executionTime = DateTime.now().difference(startTime).inMilliseconds;
+
+    _logger.debug(
+      'Vector search on $tableName.$field returned ${matches.length} '
+      'matches in ${executionTime}ms',
+    );
+    _metricsManager.recordQueryExecution(
+      'VECTOR SEARCH $fullTableName.$field',
+      executionTime,
+    );
+
+    return matches;
+  }
+
+  /// Measures recall@[k] and latency of the vector index on [field] of
+  /// [tableName] against exact search: at each of the [efSearch] values for
+  /// an HNSW index, at each of the [nprobe] values for an IVF-Flat index.
+  ///
+  /// Use it to pick the smallest value that reaches the recall you need;
+  /// set it as the matching parameter of the index's [VectorIndexConfig],
+  /// or pass it to [vectorSearch].
+  ///
+  /// Example:
+  /// ```dart
+  /// final benchmark = await storage.benchmarkVectorIndex(
+  ///   'documents',
+  ///   'embedding',
+  ///   efSearch: [16, 64, 256],
+  /// );
+  /// for (final run in benchmark.runs) {
+  ///   print('ef ${run.efSearch}: recall ${run.recall}, ${run.meanMicros}us');
+  /// }
+  /// ```
+  Future<VectorIndexBenchmark> benchmarkVectorIndex(
+    String tableName,
+    String field, {
+    List<int> efSearch = const [16, 32, 64, 128, 256],
+    List<int> nprobe = const [1, 4, 16, 64],
+    int queries = 100,
+    int k = 10,
+  }) async {
+    _ensureInitialized();
+
+    final indexes = (schemas ?? const <TableSchema>[])
+        .where((schema) => schema.name == tableName)
+        .expand((schema) => schema.indexes)
+        .where(
+          (index) =>
+              index.type == IndexType.vector &&
+              index.vectorConfig != null &&
+              index.fields.first == field,
+        );
+    if (indexes.isEmpty) {
+      throw ArgumentError('No vector index on $tableName.$field');
+    }
+
+    return _platform!.benchmarkVectorIndex(
+      _vectorIndexName(tableName, indexes.first),
+      efSearch: efSearch,
+      nprobe: nprobe,
+      queries: queries,
+      k: k,
+    );
+  }
+
+  /// Finds the records of [tableName] matching [query] in its full-text
+  /// index, best match first.
+  ///
+  /// [query] uses the FTS5 query syntax: `apple pie` matches records with
+  /// both terms, `"apple pie"` the phrase, `apple OR pear` either term and
+  /// `app*` any term starting with `app`. Records are ranked natively by
+  /// bm25, and each match carries a snippet of the best matching text and
+  /// every indexed field with the matched terms wrapped in [highlightStart]
+  /// and [highlightEnd]. [where] is an optional SQL condition, with
+  /// positional [whereArguments], that records must satisfy.
+  ///
+  /// The table needs an index of type [IndexType.fullText]. Records already
+  /// stored when the index was created are indexed in the background, and
+  /// are only found once indexed.
+  ///
+  /// Example:
+  /// ```dart
+  /// final matches = await storage.search('articles', 'flutter AND cache*');
+  /// for (final match in matches) {
+  ///   print('${match.row['title']}: ${match.snippet}');
+  /// }
+  /// ```
+  Future<List<FullTextMatch>> search(
+    String tableName,
+    String query, {
+    int limit = 20,
+    String? where,
+    List<dynamic> whereArguments = const [],
+    String highlightStart = '<b>',
+    String highlightEnd = '</b>',
+    int snippetTokens = 16,
+  }) async {
+    _ensureInitialized();
+    final fullTableName = _getTableName(tableName);
+
+    final startTime = DateTime.now();
+    final matches = await _platform!.fullTextSearch(
+      fullTableName,
+      query,
+      limit: limit,
+      filterSql: where,
+      filterArguments: whereArguments,
+      highlightStart: highlightStart,
+      highlightEnd: highlightEnd,
+      snippetTokens: snippetTokens,
+    );
+    final executionTime = DateTime.now().difference(startTime).inMilliseconds;
+
+    _logger.debug(
+      'Full-text search on $tableName returned ${matches.length} '
+      'matches in ${executionTime}ms',
+    );
+    _metricsManager.recordQueryExecution(
+      'FULL TEXT SEARCH $fullTableName',
+      executionTime,
+    );
+
+    return matches;
+  }
+
+  /// Reindexes every record of [tableName] in its full-text index, in the
+  /// background.
+  ///
+  /// Only needed if the table was written to without the index's triggers,
+  /// for instance by another program.
+  Future<void> rebuildFullTextIndex(String tableName) async {
+    _ensureInitialized();
+    await _platform!.rebuildFullTextIndex(_getTableName(tableName));
   }
 
   void _ensureInitialized() {
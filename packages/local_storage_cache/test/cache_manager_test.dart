@@ -191,6 +191,28 @@ void main() {
       expect(await manager.get<String>('key2'), equals('value2'));
     });
 
+    test('should emit disk expirations pushed by the native cache', () async {
+      final events = <String>[];
+      manager.expirationStream.listen((event) {
+        events.add(event.key);
+      });
+
+      await manager.put(
+        'test_key',
+        'test_value',
+        ttl: const Duration(milliseconds: 100),
+        level: CacheLevel.disk,
+      );
+      await Future<void>.delayed(const Duration(milliseconds: 150));
+
+      // Stands in for the native cache's timing wheel
+      expireMockDiskCacheEntries();
+      await Future<void>.delayed(const Duration(milliseconds: 10));
+
+      expect(events, equals(['test_key']));
+      expect(await manager.getCurrentSize(level: CacheLevel.disk), equals(0));
+    });
+
     test('should emit expiration events', () async {
       final events = <String>[];
       manager.expirationStream.listen((event) {
@@ -219,6 +241,42 @@ void main() {
     });
   });
 
+  group('CacheManager - Memory Expiration', () {
+    test('should expire only the due memory entries', () async {
+      final manager = CacheManager(const CacheConfig());
+      await manager.initialize();
+      final events = <String>[];
+      manager.expirationStream.listen((event) => events.add(event.key));
+
+      const short = Duration(milliseconds: 100);
+      await manager.put('short', 1, ttl: short, level: CacheLevel.memory);
+      await manager.put('replaced', 2, ttl: short, level: CacheLevel.memory);
+      await manager.put(
+        'replaced',
+        3,
+        ttl: const Duration(hours: 1),
+        level: CacheLevel.memory,
+      );
+      await manager.put(
+        'long',
+        4,
+        ttl: const Duration(hours: 1),
+        level: CacheLevel.memory,
+      );
+
+      // The timer fires on a whole second, up to two seconds after the expiry
+      await Future<void>.delayed(const Duration(milliseconds: 2200));
+
+      expect(events, equals(['short']));
+      expect(
+        await manager.getKeys(level: CacheLevel.memory),
+        unorderedEquals(['replaced', 'long']),
+      );
+
+      await manager.dispose();
+    });
+  });
+
   group('CacheManager - Eviction Policies', () {
     test('should evict LRU entry when cache is full', () async {
       const config = CacheConfig(
@@ -335,7 +393,7 @@ void main() {
       expect(cached, isNull);
     });
 
-    test('should invalidate query cache by pattern', () async {
+    test('should invalidate cached queries reading the table', () async {
       await manager.cacheQuery(
         'SELECT * FROM users',
         [
@@ -355,17 +413,35 @@ void main() {
       expect(await manager.getCachedQuery('SELECT * FROM users'), isNotNull);
       expect(await manager.getCachedQuery('SELECT * FROM posts'), isNotNull);
 
-      // Invalidate by pattern - this uses the hash, so it won't match the pattern
-      // The invalidation looks for keys that start with 'query_' and contain the pattern
-      // But the hash doesn't contain 'users', so this test needs adjustment
       await manager.invalidateQueryCache('users');
 
-      // Since the hash doesn't contain 'users', both queries should still exist
-      // This is a limitation of the current implementation
-      expect(await manager.getCachedQuery('SELECT * FROM users'), isNotNull);
+      expect(await manager.getCachedQuery('SELECT * FROM users'), isNull);
       expect(await manager.getCachedQuery('SELECT * FROM posts'), isNotNull);
     });
 
+    test('should match the table name as a whole word', () async {
+      await manager.cacheQuery(
+        'SELECT * FROM users_archive',
+        [
+          <String, dynamic>{'id': 1},
+        ],
+        null,
+      );
+
+      await manager.invalidateQueryCache('users');
+
+      expect(
+        await manager.getCachedQuery('SELECT * FROM users_archive'),
+        isNotNull,
+      );
+    });
+
+    test('should invalidate native query results of the table', () async {
+      await manager.invalidateQueryCache('users');
+
+      expect(getMockMethodCalls(), contains('invalidateQueryCache'));
+    });
+
     test('should not cache when query caching is disabled', () async {
       const config = CacheConfig(enableQueryCache: false);
       final disabledManager = CacheManager(config);
@@ -548,6 +624,18 @@ void main() {
       final size = await manager.getCurrentSize();
       expect(size, lessThanOrEqualTo(10)); // maxMemory + maxDisk
     });
+
+    test('should keep disk entries in the native disk cache', () async {
+      for (var i = 0; i < 10; i++) {
+        await manager.put('key$i', 'value$i', level: CacheLevel.disk);
+      }
+
+      final diskSize = await manager.getCurrentSize(level: CacheLevel.disk);
+      expect(diskSize, equals(5));
+      expect(await manager.get<String>('key9'), equals('value9'));
+      expect(await manager.get<String>('key0'), isNull);
+      expect(getMockMethodCalls(), contains('diskCachePut'));
+    });
   });
 
   group('CacheManager - Data Types', () {
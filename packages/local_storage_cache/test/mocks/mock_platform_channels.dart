@@ -1,4 +1,5 @@
 import 'dart:convert';
+import 'dart:math';
 
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
@@ -20,17 +21,48 @@ void setupMockPlatformChannels() {
     },
   );
 
+  TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+      .setMockStreamHandler(
+    const EventChannel('local_storage_cache/cache_expirations'),
+    MockStreamHandler.inline(
+      onListen: (arguments, events) => _mockExpirationSink = events,
+      onCancel: (arguments) => _mockExpirationSink = null,
+    ),
+  );
+
+  TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+      .setMockStreamHandler(
+    const EventChannel('local_storage_cache/data_changes'),
+    MockStreamHandler.inline(
+      onListen: (arguments, events) => _mockDataChangeSink = events,
+      onCancel: (arguments) => _mockDataChangeSink = null,
+    ),
+  );
+
+  TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+      .setMockStreamHandler(
+    const EventChannel('local_storage_cache/query_diffs'),
+    MockStreamHandler.inline(
+      onListen: (arguments, events) => _mockQueryDiffSink = events,
+      onCancel: (arguments) => _mockQueryDiffSink = null,
+    ),
+  );
+
   TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
       .setMockMethodCallHandler(
     const MethodChannel('local_storage_cache'),
     (MethodCall methodCall) async {
       final args = methodCall.arguments as Map<dynamic, dynamic>?;
+      _mockMethodCalls.add(methodCall.method);
 
       switch (methodCall.method) {
         case 'initialize':
           return null;
         case 'close':
           return null;
+        case 'setDataChangesEnabled':
+          _mockDataChangesEnabled = args!['enabled'] as bool;
+          return null;
         case 'insert':
           // Store the inserted data by table name
           final tableName = args!['tableName'] as String;
@@ -42,6 +74,10 @@ void setupMockPlatformChannels() {
             _transactionBuffer.add({'table': tableName, 'data': data});
           } else {
             _mockDatabaseByTable.putIfAbsent(tableName, () => []).add(data);
+            _reportMockChanges(inserted: {
+              tableName: [id],
+            });
+            _rerunMockWatches({tableName});
           }
           return id;
         case 'query':
@@ -160,7 +196,8 @@ void setupMockPlatformChannels() {
               var filtered = _filterRecords(sql, arguments, tableRecords);
 
               // Handle ORDER BY
-              filtered = _applyOrderBy(sql, filtered);
+              filtered = _applyVectorOrderBy(sql, arguments, filtered) ??
+                  _applyOrderBy(sql, filtered);
 
               // Handle LIMIT and OFFSET
               filtered = _applyLimitOffset(sql, filtered);
@@ -171,51 +208,257 @@ void setupMockPlatformChannels() {
 
           // Fallback for queries without table name
           return [];
-        case 'update':
-          // Handle update with or without WHERE clause
+        case 'watchQuery':
           final sql = args!['sql'] as String;
           final arguments = (args['arguments'] as List?) ?? [];
+          final watchId = _mockNextWatchId++;
+          _mockWatches[watchId] = {'sql': sql, 'arguments': arguments};
+          return {
+            'watchId': watchId,
+            'rows': _runMockWatch(sql, arguments),
+          };
+        case 'unwatchQuery':
+          return _mockWatches.remove(args!['watchId'] as int) != null;
+        case 'queryColumnar':
+          final rows = await const MethodChannel('local_storage_cache')
+                  .invokeMethod<List<dynamic>>('query', args) ??
+              [];
+          final columns = rows.isEmpty
+              ? <String>[]
+              : (rows.first as Map).keys.cast<String>().toList();
+          return {
+            'columns': columns,
+            'rows': [
+              for (final row in rows)
+                [for (final column in columns) (row as Map)[column]],
+            ],
+          };
+        case 'openCursor':
+          // Evaluate the query up front and hand its rows out page by page
+          final rows = await const MethodChannel('local_storage_cache')
+              .invokeMethod<List<dynamic>>('query', args);
+          final cursorId = _mockNextCursorId++;
+          _mockCursors[cursorId] = List<dynamic>.from(rows ?? []);
+          return cursorId;
+        case 'fetch':
+          final cursorId = args!['cursorId'] as int;
+          final pageSize = args['pageSize'] as int;
+          final rows = _mockCursors[cursorId];
+          if (rows == null) {
+            throw PlatformException(
+              code: 'CURSOR_NOT_FOUND',
+              message: 'Cursor is closed or has expired',
+            );
+          }
+          final page = rows.take(pageSize).toList();
+          rows.removeRange(0, page.length);
+          final done = page.length < pageSize;
+          if (done) {
+            _mockCursors.remove(cursorId);
+          }
+          return {'rows': page, 'done': done};
+        case 'closeCursor':
+          _mockCursors.remove(args!['cursorId'] as int);
+          return null;
+        case 'vectorSearch':
+          // Brute-force search over the stored rows
+          final tableName = args!['tableName'] as String;
+          final column = args['column'] as String;
+          final queryVector = (args['queryVector'] as List).cast<num>();
+          final filterSql = args['filterSql'] as String?;
+          var records = _mockDatabaseByTable[tableName] ?? [];
+          if (filterSql != null) {
+            records = _filterRecords(
+              'SELECT * FROM $tableName WHERE $filterSql',
+              (args['filterArguments'] as List?) ?? [],
+              records,
+            );
+          }
 
-          // Extract table name
-          final tableMatch = RegExp(r'UPDATE\s+([\w_]+)', caseSensitive: false)
-              .firstMatch(sql);
-          if (tableMatch == null) return 0;
-
-          final tableName = tableMatch.group(1)!;
-          final tableRecords = _mockDatabaseByTable[tableName] ?? [];
-
-          // Extract SET values (first N arguments) and WHERE arguments (remaining)
-          final setMatch =
-              RegExp(r'SET\s+(.+?)(?:\s+WHERE|$)', caseSensitive: false)
-                  .firstMatch(sql);
-          if (setMatch != null) {
-            final setClause = setMatch.group(1) ?? '';
-            final setFieldCount = ','.allMatches(setClause).length + 1;
-
-            final setValues = arguments.take(setFieldCount).toList();
-            final whereArguments = arguments.skip(setFieldCount).toList();
-
-            // Get fields to update
-            final fields = setClause
-                .split(',')
-                .map((s) => s.trim().split('=')[0].trim())
-                .toList();
-
-            // Filter records (all if no WHERE clause)
-            final filtered = sql.toUpperCase().contains('WHERE')
-                ? _filterRecords(sql, whereArguments, tableRecords)
-                : tableRecords;
-
-            var updated = 0;
-            for (final record in filtered) {
-              for (var i = 0; i < fields.length && i < setValues.length; i++) {
-                record[fields[i]] = setValues[i];
-              }
-              updated++;
+          final matches = <Map<String, dynamic>>[];
+          for (final record in records) {
+            final vector = record[column];
+            if (vector is! List || vector.length != queryVector.length) {
+              continue;
+            }
+            matches.add({
+              'row': record,
+              'distance': _vectorDistance(
+                args['metric'] as String,
+                queryVector,
+                vector.cast<num>(),
+              ),
+            });
+          }
+          matches.sort(
+            (a, b) => (a['distance'] as double).compareTo(b['distance'] as double),
+          );
+          return matches.take(args['k'] as int).toList();
+        case 'createVectorIndex':
+          _mockVectorIndexes[args!['indexName'] as String] =
+              Map<String, dynamic>.from(args);
+          return null;
+        case 'dropVectorIndex':
+          _mockVectorIndexes.remove(args!['indexName'] as String);
+          return null;
+        case 'benchmarkVectorIndex':
+          // The mock search is exact, so every run has perfect recall
+          final index = _mockVectorIndexes[args!['indexName'] as String];
+          if (index == null) {
+            throw PlatformException(
+              code: 'VECTOR_INDEX_ERROR',
+              message: 'No vector index named ${args['indexName']}',
+            );
+          }
+          final records = _mockDatabaseByTable[index['tableName']] ?? [];
+          final widthKey =
+              index['indexType'] == 'ivfFlat' ? 'nprobe' : 'efSearch';
+          return {
+            'size': records.length,
+            'queries': min(records.length, args['queries'] as int),
+            'exactMicros': 0.0,
+            'runs': [
+              for (final width in args[widthKey] as List)
+                {
+                  widthKey: width,
+                  'recall': 1.0,
+                  'meanMicros': 0.0,
+                  'p99Micros': 0.0,
+                },
+            ],
+          };
+        case 'kvGet':
+          final entry =
+              _mockKeyValueStore['${args!['tableName']}:${args['key']}'];
+          if (entry is Map) {
+            _mockCacheHits++;
+          } else {
+            _mockCacheMisses++;
+          }
+          return entry is Map ? entry['value'] as String : null;
+        case 'kvSet':
+          _mockKeyValueStore['${args!['tableName']}:${args['key']}'] = {
+            'key': args['key'],
+            'value': args['value'],
+            'updated_at': DateTime.now().millisecondsSinceEpoch,
+          };
+          return null;
+        case 'kvDelete':
+          return _mockKeyValueStore
+                  .remove('${args!['tableName']}:${args['key']}') !=
+              null;
+        case 'kvMultiGet':
+          final values = <String, String>{};
+          for (final key in (args!['keys'] as List).cast<String>()) {
+            final entry = _mockKeyValueStore['${args['tableName']}:$key'];
+            if (entry is Map) {
+              values[key] = entry['value'] as String;
             }
-            return updated;
           }
-          return 0;
+          return values;
+        case 'kvMultiSet':
+          final entries = (args!['entries'] as Map).cast<String, String>();
+          for (final entry in entries.entries) {
+            _mockKeyValueStore['${args['tableName']}:${entry.key}'] = {
+              'key': entry.key,
+              'value': entry.value,
+              'updated_at': DateTime.now().millisecondsSinceEpoch,
+            };
+          }
+          return null;
+        case 'diskCacheOpen':
+          _mockDiskCaches.putIfAbsent(args!['directory'] as String, () => {});
+          _mockDiskCacheLimits[args['directory'] as String] =
+              args['maxEntries'] as int;
+          return null;
+        case 'diskCacheGet':
+          final cache = _mockDiskCaches[args!['directory']]!;
+          final entry = cache.remove(args['key']);
+          if (entry == null || _isMockDiskCacheEntryExpired(entry)) {
+            return null;
+          }
+          // Reinserted to keep the map in LRU order
+          cache[args['key'] as String] = entry;
+          return entry['value'] as String;
+        case 'diskCachePut':
+          final directory = args!['directory'] as String;
+          final cache = _mockDiskCaches[directory]!;
+          cache
+            ..remove(args['key'])
+            ..[args['key'] as String] = {
+              'value': args['value'],
+              'expiresAt': args['expiresAt'],
+            };
+          while (cache.length > _mockDiskCacheLimits[directory]!) {
+            cache.remove(cache.keys.first);
+          }
+          return null;
+        case 'diskCacheRemove':
+          return _mockDiskCaches[args!['directory']]!.remove(args['key']) !=
+              null;
+        case 'diskCacheClear':
+          _mockDiskCaches[args!['directory']]!.clear();
+          return null;
+        case 'diskCacheKeys':
+          return _mockDiskCaches[args!['directory']]!
+              .entries
+              .where((entry) => !_isMockDiskCacheEntryExpired(entry.value))
+              .map((entry) => entry.key)
+              .toList();
+        case 'diskCacheValues':
+          return _mockDiskCaches[args!['directory']]!
+              .values
+              .where((entry) => !_isMockDiskCacheEntryExpired(entry))
+              .map((entry) => entry['value'] as String)
+              .toList();
+        case 'diskCacheSize':
+          return _mockDiskCaches[args!['directory']]!.length;
+        case 'diskCacheRemoveExpired':
+          return _expireMockDiskCache(args!['directory'] as String);
+        case 'createFullTextIndex':
+          _mockFullTextIndexes[args!['tableName'] as String] =
+              Map<String, dynamic>.from(args);
+          return null;
+        case 'dropFullTextIndex':
+          _mockFullTextIndexes.remove(args!['tableName'] as String);
+          return null;
+        case 'rebuildFullTextIndex':
+          return null;
+        case 'fullTextSearch':
+          // Matches every term of the query against the indexed columns
+          final tableName = args!['tableName'] as String;
+          final index = _mockFullTextIndexes[tableName];
+          if (index == null) {
+            throw PlatformException(
+              code: 'FULL_TEXT_SEARCH_ERROR',
+              message: 'No full-text index on $tableName',
+            );
+          }
+          final filterSql = args['filterSql'] as String?;
+          var records = _mockDatabaseByTable[tableName] ?? [];
+          if (filterSql != null) {
+            records = _filterRecords(
+              'SELECT * FROM $tableName WHERE $filterSql',
+              (args['filterArguments'] as List?) ?? [],
+              records,
+            );
+          }
+          return _fullTextSearch(
+            records,
+            (index['columns'] as List).cast<String>(),
+            args['query'] as String,
+            args['highlightStart'] as String,
+            args['highlightEnd'] as String,
+          ).take(args['limit'] as int).toList();
+        case 'update':
+          final updated = <String, List<int>>{};
+          final count = _runMockUpdate(
+            args!['sql'] as String,
+            (args['arguments'] as List?) ?? [],
+            updated,
+          );
+          _reportMockChanges(updated: updated);
+          return count;
         case 'delete':
           // Handle delete with WHERE clause
           final sql = args!['sql'] as String;
@@ -276,6 +519,8 @@ void setupMockPlatformChannels() {
         case 'executeBatch':
           // Handle batch operations
           final operations = args!['operations'] as List;
+          final inserted = <String, List<int>>{};
+          final updated = <String, List<int>>{};
           for (final op in operations) {
             final operation = op as Map;
             final type = operation['type'] as String;
@@ -286,20 +531,21 @@ void setupMockPlatformChannels() {
               final id = _mockInsertId++;
               data['id'] = id;
               _mockDatabaseByTable.putIfAbsent(tableName, () => []).add(data);
+              inserted.putIfAbsent(tableName, () => []).add(id);
             } else if (type == 'update') {
-              final tableName = operation['tableName'] as String;
-              final data = Map<String, dynamic>.from(operation['data'] as Map);
-              final tableRecords = _mockDatabaseByTable[tableName] ?? [];
-              // For batch update, we expect the data to contain the ID or WHERE condition
-              // Update all matching records
-              for (final record in tableRecords) {
-                if (data.containsKey('id') && record['id'] == data['id']) {
-                  record.addAll(data);
-                } else if (data.containsKey('username') &&
-                    record['username'] == data['username']) {
-                  record.addAll(data);
-                }
+              // Like the native platforms, updates run their own SQL
+              final sql = operation['sql'] as String?;
+              if (sql == null) {
+                throw PlatformException(
+                  code: 'BATCH_ERROR',
+                  message: 'update requires sql',
+                );
               }
+              _runMockUpdate(
+                sql,
+                (operation['arguments'] as List?) ?? [],
+                updated,
+              );
             } else if (type == 'delete') {
               final sql = operation['sql'] as String?;
               final arguments = (operation['arguments'] as List?) ?? [];
@@ -321,6 +567,7 @@ void setupMockPlatformChannels() {
               }
             }
           }
+          _reportMockChanges(inserted: inserted, updated: updated);
           return null;
         case 'transaction':
           final action = args?['action'] as String?;
@@ -330,11 +577,16 @@ void setupMockPlatformChannels() {
             _transactionBuffer = [];
           } else if (action == 'commit') {
             if (_inTransaction) {
+              final inserted = <String, List<int>>{};
               for (final item in _transactionBuffer) {
                 final tableName = item['table'] as String;
                 final data = item['data'] as Map<String, dynamic>;
                 _mockDatabaseByTable.putIfAbsent(tableName, () => []).add(data);
+                inserted
+                    .putIfAbsent(tableName, () => [])
+                    .add(data['id'] as int);
               }
+              _reportMockChanges(inserted: inserted);
               _transactionBuffer = [];
               _inTransaction = false;
             }
@@ -368,6 +620,32 @@ void setupMockPlatformChannels() {
           return null;
         case 'vacuum':
           return null;
+        case 'getStatementCacheStats':
+          return {
+            'hits': 3,
+            'misses': 1,
+            'evictions': 0,
+            'size': 1,
+            'capacity': 64,
+          };
+        case 'getMemoryCacheStats':
+          return {
+            'hits': _mockCacheHits,
+            'misses': _mockCacheMisses,
+            'evictions': 0,
+            'size': _mockKeyValueStore.length,
+            'bytes': 0,
+            'capacity': 100,
+            'maxBytes': 8 * 1024 * 1024,
+            'evictionPolicy': 'wTinyLfu',
+          };
+        case 'compareEvictionPolicies':
+          return {
+            'lru': 0.5,
+            'lfu': 0.6,
+            'fifo': 0.4,
+            'wTinyLfu': 0.65,
+          };
         case 'getStorageInfo':
           var totalRecords = 0;
           _mockDatabaseByTable.forEach((_, records) {
@@ -417,6 +695,22 @@ void setupMockPlatformChannels() {
   );
 }
 
+/// Removes the expired entries of every mock disk cache and reports them on
+/// the expiration channel, as the native cache does once they fall due.
+void expireMockDiskCacheEntries() {
+  _mockDiskCaches.keys.forEach(_expireMockDiskCache);
+}
+
+/// Pushes a batch of data changes of rows no table was known for, as the
+/// native platforms do for writes to WITHOUT ROWID tables.
+void reportMockUnknownTableChanges() {
+  if (!_mockDataChangesEnabled) return;
+  _mockDataChangeSink?.success({
+    'tables': <Map<String, dynamic>>[],
+    'unknownTables': true,
+  });
+}
+
 /// Resets mock data between tests.
 void resetMockData() {
   _mockInsertId = 1;
@@ -425,6 +719,17 @@ void resetMockData() {
   _mockKeyValueStore = {};
   _inTransaction = false;
   _transactionBuffer = [];
+  _mockCursors = {};
+  _mockVectorIndexes = {};
+  _mockFullTextIndexes = {};
+  _mockMethodCalls = [];
+  _mockCacheHits = 0;
+  _mockCacheMisses = 0;
+  _mockDataChangesEnabled = false;
+  _mockWatches = {};
+  for (final cache in _mockDiskCaches.values) {
+    cache.clear();
+  }
 }
 
 /// Sets mock query results for the next query.
@@ -456,6 +761,19 @@ dynamic getMockKeyValue(String key) {
   return _mockKeyValueStore[key];
 }
 
+/// Gets the number of cursors that are still open.
+int getMockOpenCursorCount() => _mockCursors.length;
+
+/// Gets the createVectorIndex arguments of each vector index, by name.
+Map<String, Map<String, dynamic>> getMockVectorIndexes() => _mockVectorIndexes;
+
+/// Gets the names of the methods called on the plugin channel, in order.
+List<String> getMockMethodCalls() => _mockMethodCalls;
+
+/// Gets the createFullTextIndex arguments of each full-text index, by table.
+Map<String, Map<String, dynamic>> getMockFullTextIndexes() =>
+    _mockFullTextIndexes;
+
 // Private state
 int _mockInsertId = 1;
 Map<String, List<Map<String, dynamic>>> _mockDatabaseByTable = {};
@@ -463,8 +781,134 @@ Map<String, String> _mockSecureStorage = {};
 Map<String, dynamic> _mockKeyValueStore = {};
 bool _inTransaction = false;
 List<Map<String, dynamic>> _transactionBuffer = [];
+int _mockNextCursorId = 1;
+Map<int, List<dynamic>> _mockCursors = {};
+Map<String, Map<String, dynamic>> _mockVectorIndexes = {};
+Map<String, Map<String, dynamic>> _mockFullTextIndexes = {};
+List<String> _mockMethodCalls = [];
+int _mockCacheHits = 0;
+int _mockCacheMisses = 0;
+// Kept across resets, like the directories of open disk caches
+final Map<String, Map<String, Map<String, dynamic>>> _mockDiskCaches = {};
+final Map<String, int> _mockDiskCacheLimits = {};
+
+MockStreamHandlerEventSink? _mockExpirationSink;
+MockStreamHandlerEventSink? _mockDataChangeSink;
+bool _mockDataChangesEnabled = false;
+MockStreamHandlerEventSink? _mockQueryDiffSink;
+int _mockNextWatchId = 1;
+Map<int, Map<String, dynamic>> _mockWatches = {};
+
+/// Pushes one batch of data changes holding the rows inserted and updated
+/// per table.
+void _reportMockChanges({
+  Map<String, List<int>> inserted = const {},
+  Map<String, List<int>> updated = const {},
+}) {
+  final tables = [
+    for (final name in {...inserted.keys, ...updated.keys})
+      if ((inserted[name]?.isNotEmpty ?? false) ||
+          (updated[name]?.isNotEmpty ?? false))
+        {
+          'name': name,
+          'inserted': inserted[name] ?? <int>[],
+          'updated': updated[name] ?? <int>[],
+          'deleted': <int>[],
+        },
+  ];
+  if (!_mockDataChangesEnabled || tables.isEmpty) return;
+  _mockDataChangeSink?.success({
+    'tables': tables,
+    'unknownTables': false,
+  });
+}
+
+List<Map<String, dynamic>> _runMockWatch(
+  String sql,
+  List<dynamic> arguments,
+) {
+  final tableMatch =
+      RegExp(r'FROM\s+([\w_]+)', caseSensitive: false).firstMatch(sql);
+  final tableRecords = _mockDatabaseByTable[tableMatch?.group(1)] ?? [];
+  final filtered = _filterRecords(sql, arguments, tableRecords);
+  return _applyOrderBy(sql, filtered).map(Map<String, dynamic>.from).toList();
+}
+
+/// Re-runs the watched queries reading any of [tables] and pushes each
+/// result whole, as the native watcher does for results it cannot diff.
+void _rerunMockWatches(Set<String> tables) {
+  _mockWatches.forEach((watchId, watch) {
+    final sql = watch['sql'] as String;
+    if (!tables.any((table) => RegExp('\\b$table\\b').hasMatch(sql))) return;
+    _mockQueryDiffSink?.success({
+      'watchId': watchId,
+      'rows': _runMockWatch(sql, watch['arguments'] as List<dynamic>),
+    });
+  });
+}
+
+int _expireMockDiskCache(String directory) {
+  final keys = <String>[];
+  final expiredAt = <int>[];
+  _mockDiskCaches[directory]!.removeWhere((key, entry) {
+    if (!_isMockDiskCacheEntryExpired(entry)) return false;
+    keys.add(key);
+    expiredAt.add(entry['expiresAt'] as int);
+    return true;
+  });
+  if (keys.isNotEmpty) {
+    _mockExpirationSink?.success({
+      'directory': directory,
+      'keys': keys,
+      'expiredAt': expiredAt,
+    });
+  }
+  return keys.length;
+}
+
+bool _isMockDiskCacheEntryExpired(Map<String, dynamic> entry) {
+  final expiresAt = entry['expiresAt'] as int?;
+  return expiresAt != null &&
+      expiresAt <= DateTime.now().millisecondsSinceEpoch;
+}
 
 /// Filters records based on SQL WHERE clause.
+/// Runs the UPDATE [sql] with [arguments] on the mock database, adding the
+/// ids of the rows it updated to [updated] by table. Returns their number.
+int _runMockUpdate(
+  String sql,
+  List<dynamic> arguments,
+  Map<String, List<int>> updated,
+) {
+  final tableMatch =
+      RegExp(r'UPDATE\s+([\w_]+)', caseSensitive: false).firstMatch(sql);
+  final setMatch = RegExp(r'SET\s+(.+?)(?:\s+WHERE|$)', caseSensitive: false)
+      .firstMatch(sql);
+  if (tableMatch == null || setMatch == null) return 0;
+
+  final tableName = tableMatch.group(1)!;
+  final tableRecords = _mockDatabaseByTable[tableName] ?? [];
+
+  // SET values come first in the arguments, WHERE arguments after them
+  final setClause = setMatch.group(1) ?? '';
+  final fields =
+      setClause.split(',').map((s) => s.trim().split('=')[0].trim()).toList();
+  final setValues = arguments.take(fields.length).toList();
+  final whereArguments = arguments.skip(fields.length).toList();
+
+  // Filter records (all if no WHERE clause)
+  final filtered = _filterRecords(sql, whereArguments, tableRecords);
+  for (final record in filtered) {
+    for (var i = 0; i < fields.length && i < setValues.length; i++) {
+      record[fields[i]] = setValues[i];
+    }
+    if (record['id'] is int) {
+      updated.putIfAbsent(tableName, () => []).add(record['id'] as int);
+    }
+  }
+  return filtered.length;
+}
+
 List<Map<String, dynamic>> _filterRecords(
     String sql, List<dynamic> arguments, List<Map<String, dynamic>> records) {
   final normalizedSql = sql.toUpperCase();
@@ -721,6 +1165,31 @@ List<Map<String, dynamic>> _applyOrderBy(
   return sorted;
 }
 
+/// Applies an ORDER BY on a vec_cosine, vec_l2 or vec_dot call whose query
+/// vector is the last argument. Returns null for any other ordering.
+List<Map<String, dynamic>>? _applyVectorOrderBy(
+  String sql,
+  List<dynamic> arguments,
+  List<Map<String, dynamic>> records,
+) {
+  final match = RegExp(
+    r'ORDER\s+BY\s+vec_(cosine|l2|dot)\((\w+),',
+    caseSensitive: false,
+  ).firstMatch(sql);
+  if (match == null) return null;
+
+  const metrics = {'cosine': 'cosine', 'l2': 'euclidean', 'dot': 'dotProduct'};
+  final metric = metrics[match.group(1)!.toLowerCase()]!;
+  final column = match.group(2)!;
+  final queryVector = (arguments.last as List).cast<num>();
+
+  double distance(Map<String, dynamic> record) =>
+      _vectorDistance(metric, queryVector, (record[column] as List).cast<num>());
+
+  return records.where((record) => record[column] is List).toList()
+    ..sort((a, b) => distance(a).compareTo(distance(b)));
+}
+
 /// Applies LIMIT and OFFSET clauses to results.
 List<Map<String, dynamic>> _applyLimitOffset(
   String sql,
@@ -746,3 +1215,89 @@ List<Map<String, dynamic>> _applyLimitOffset(
 
   return result;
 }
+
+/// Finds the records whose [columns] contain every term of [query], scored
+/// by the number of occurrences. Terms ending in `*` match as prefixes.
+List<Map<String, dynamic>> _fullTextSearch(
+  List<Map<String, dynamic>> records,
+  List<String> columns,
+  String query,
+  String highlightStart,
+  String highlightEnd,
+) {
+  final terms = query
+      .toLowerCase()
+      .split(RegExp(r'\s+'))
+      .where((term) => term.isNotEmpty && term != 'and')
+      .toList();
+  bool termMatches(String term, String word) => term.endsWith('*')
+      ? word.startsWith(term.substring(0, term.length - 1))
+      : word == term;
+
+  final results = <Map<String, dynamic>>[];
+  for (final record in records) {
+    final highlights = <String, String?>{};
+    final found = <String>{};
+    var snippet = '';
+    var score = 0;
+    for (final column in columns) {
+      final text = record[column] as String?;
+      if (text == null) {
+        highlights[column] = null;
+        continue;
+      }
+      final highlighted = text.splitMapJoin(
+        RegExp(r'\w+'),
+        onMatch: (m) {
+          final word = m[0]!.toLowerCase();
+          final matched = terms.where((term) => termMatches(term, word));
+          if (matched.isEmpty) return m[0]!;
+          found.addAll(matched);
+          score++;
+          return '$highlightStart${m[0]}$highlightEnd';
+        },
+      );
+      highlights[column] = highlighted;
+      if (snippet.isEmpty && highlighted != text) {
+        snippet = highlighted;
+      }
+    }
+    if (terms.isEmpty || found.length < terms.toSet().length) {
+      continue;
+    }
+    results.add({
+      'row': record,
+      'score': score.toDouble(),
+      'snippet': snippet,
+      'highlights': highlights,
+    });
+  }
+  results.sort(
+    (a, b) => (b['score'] as double).compareTo(a['score'] as double),
+  );
+  return results;
+}
+
+/// Distance between two vectors; smaller is closer for every metric.
+double _vectorDistance(String metric, List<num> a, List<num> b) {
+  var dot = 0.0;
+  var squaredL2 = 0.0;
+  var normA = 0.0;
+  var normB = 0.0;
+  for (var i = 0; i < a.length; i++) {
+    dot += a[i] * b[i];
+    squaredL2 += (a[i] - b[i]) * (a[i] - b[i]);
+    normA += a[i] * a[i];
+    normB += b[i] * b[i];
+  }
+
+  switch (metric) {
+    case 'euclidean':
+      return sqrt(squaredL2);
+    case 'dotProduct':
+      return -dot;
+    default:
+      final denominator = sqrt(normA) * sqrt(normB);
+      return denominator > 0 ? 1 - dot / denominator : 1;
+  }
+}
@@ -194,6 +194,17 @@ void main() {
         expect(statements.first['sql'], endsWith('...'));
       });
 
+      test('should include recorded native statistics', () {
+        expect(cache.getStats().containsKey('native'), isFalse);
+
+        cache.recordNativeStats({'hits': 8, 'misses': 2, 'evictions': 1});
+
+        final native = cache.getStats()['native'] as Map<String, dynamic>;
+        expect(native['hits'], equals(8));
+        expect(native['misses'], equals(2));
+        expect(native['evictions'], equals(1));
+      });
+
       test('getMostUsed should return statements sorted by use count', () {
         cache
           ..getOrCreate('SELECT * FROM users')
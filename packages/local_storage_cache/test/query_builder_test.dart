@@ -407,6 +407,55 @@ void main() {
         }
 
         expect(count, equals(2));
+        expect(getMockOpenCursorCount(), equals(0));
+      });
+
+      test('watch yields the results again once they change', () async {
+        final query = storage.query('users')..where('status', '=', 'active');
+
+        final results = <List<Map<String, dynamic>>>[];
+        final subscription = query.watch().listen(results.add);
+        await pumpEventQueue();
+        expect(results.single.length, equals(3));
+
+        await storage.insert('users', {
+          'username': 'carol',
+          'email': 'carol@example.com',
+          'age': 28,
+          'status': 'active',
+          'role': 'user',
+        });
+        await pumpEventQueue();
+        expect(results.length, equals(2));
+        expect(results.last.length, equals(4));
+        expect(results.last.last['username'], equals('carol'));
+
+        await subscription.cancel();
+        expect(getMockMethodCalls(), contains('unwatchQuery'));
+      });
+
+      test('getColumnar returns rows in columnar form', () async {
+        final query = storage.query('users')..orderByAsc('age');
+
+        final result = await query.getColumnar();
+
+        expect(result.length, equals(4));
+        expect(result.columns, contains('age'));
+        expect(result.rowAt(0)['age'], equals(20));
+        expect(result.toMaps().length, equals(4));
+      });
+
+      test('stream reads every page of the cursor', () async {
+        final query = storage.query('users')..orderByAsc('age');
+
+        final streamedRecords = <Map<String, dynamic>>[];
+        await for (final record in query.stream(pageSize: 1)) {
+          streamedRecords.add(record);
+        }
+
+        expect(streamedRecords.length, equals(4));
+        expect(streamedRecords.first['age'], equals(20));
+        expect(getMockOpenCursorCount(), equals(0));
       });
 
       test('stream with WHERE conditions', () async {
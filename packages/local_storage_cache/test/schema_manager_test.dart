@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:flutter_test/flutter_test.dart';
 import 'package:local_storage_cache/local_storage_cache.dart';
 
@@ -268,6 +270,58 @@ void main() {
         expect(mockDatabase.containsKey('users'), isTrue);
       });
 
+      test('should hand vector indexes to createVectorIndex', () async {
+        final executed = <String>[];
+        final created = <IndexSchema>[];
+        final manager = SchemaManager(
+          executeRawQuery: (sql, [arguments]) {
+            executed.add(sql);
+            return schemaManager.executeRawQuery(sql, arguments);
+          },
+          executeRawInsert: schemaManager.executeRawInsert,
+          executeRawUpdate: schemaManager.executeRawUpdate,
+          executeRawDelete: schemaManager.executeRawDelete,
+          createVectorIndex: (schema, index) async {
+            created.add(index);
+            return true;
+          },
+        );
+        await manager.initialize();
+
+        final schema = TableSchema(
+          name: 'documents',
+          fields: [
+            FieldSchema.text(name: 'title'),
+            const FieldSchema(
+              name: 'embedding',
+              type: DataType.vector,
+              vectorConfig: VectorFieldConfig(dimensions: 3),
+            ),
+          ],
+          indexes: [
+            const IndexSchema(fields: ['title']),
+            const IndexSchema(
+              fields: ['embedding'],
+              type: IndexType.vector,
+              vectorConfig: VectorIndexConfig(
+                indexType: VectorIndexType.hnsw,
+                distanceMetric: VectorDistanceMetric.cosine,
+                parameters: {'m': 8},
+              ),
+            ),
+          ],
+        );
+
+        await manager.createTable(schema);
+
+        expect(created, hasLength(1));
+        expect(created.single.fields, equals(['embedding']));
+        expect(
+          executed.where((sql) => sql.contains('INDEX')),
+          hasLength(1),
+        );
+      });
+
       test('should create table with foreign keys', () async {
         await schemaManager.initialize();
 
@@ -826,4 +880,76 @@ void main() {
       });
     });
   });
+
+  group('VectorFieldConfig', () {
+    test('declares a vector column type per precision', () {
+      expect(
+        const VectorFieldConfig(
+          dimensions: 3,
+          precision: VectorPrecision.float16,
+        ).sqlType,
+        equals('F16_BLOB(3)'),
+      );
+      expect(
+        const VectorFieldConfig(dimensions: 3).sqlType,
+        equals('F32_BLOB(3)'),
+      );
+      expect(
+        const VectorFieldConfig(
+          dimensions: 3,
+          precision: VectorPrecision.float64,
+        ).sqlType,
+        equals('F64_BLOB(3)'),
+      );
+      expect(
+        const VectorFieldConfig(
+          dimensions: 3,
+          precision: VectorPrecision.int8,
+        ).sqlType,
+        equals('I8_BLOB(3)'),
+      );
+    });
+
+    test('encodes values as typed data', () {
+      const float32 = VectorFieldConfig(dimensions: 2);
+      expect(float32.encode([1, 2.5]), isA<Float32List>());
+      expect(float32.encode([1, 2.5]), equals([1.0, 2.5]));
+
+      const float64 = VectorFieldConfig(
+        dimensions: 2,
+        precision: VectorPrecision.float64,
+      );
+      expect(float64.encode([1, 2.5]), isA<Float64List>());
+    });
+
+    test('encodes float16 values as half-precision bytes', () {
+      const config = VectorFieldConfig(
+        dimensions: 4,
+        precision: VectorPrecision.float16,
+      );
+      final bytes = config.encode([1, -2, 0.5, 65504]) as Uint8List;
+      final halves = ByteData.sublistView(bytes);
+
+      expect(bytes.lengthInBytes, equals(8));
+      expect(halves.getUint16(0, Endian.host), equals(0x3c00));
+      expect(halves.getUint16(2, Endian.host), equals(0xc000));
+      expect(halves.getUint16(4, Endian.host), equals(0x3800));
+      expect(halves.getUint16(6, Endian.host), equals(0x7bff));
+    });
+
+    test('encodes int8 values as a scale followed by codes', () {
+      const config = VectorFieldConfig(
+        dimensions: 3,
+        precision: VectorPrecision.int8,
+      );
+      final bytes = config.encode([127, -63.5, 0]) as Uint8List;
+      final data = ByteData.sublistView(bytes);
+
+      expect(bytes.lengthInBytes, equals(7));
+      expect(data.getFloat32(0, Endian.little), equals(1.0));
+      expect(data.getInt8(4), equals(127));
+      expect(data.getInt8(5), equals(-64));
+      expect(data.getInt8(6), equals(0));
+    });
+  });
 }
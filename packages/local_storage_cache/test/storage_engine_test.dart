@@ -1,7 +1,13 @@
+import 'dart:math';
+import 'dart:typed_data';
+
 import 'package:flutter_test/flutter_test.dart';
 import 'package:local_storage_cache/src/config/storage_config.dart';
 import 'package:local_storage_cache/src/enums/data_type.dart';
+import 'package:local_storage_cache/src/enums/eviction_policy.dart';
+import 'package:local_storage_cache/src/models/storage_event.dart';
 import 'package:local_storage_cache/src/schema/field_schema.dart';
+import 'package:local_storage_cache/src/schema/index_schema.dart';
 import 'package:local_storage_cache/src/schema/table_schema.dart';
 import 'package:local_storage_cache/src/storage_engine.dart';
 
@@ -42,6 +48,84 @@ void main() {
               ),
             ],
           ),
+          const TableSchema(
+            name: 'documents',
+            fields: [
+              FieldSchema(
+                name: 'title',
+                type: DataType.text,
+              ),
+              FieldSchema(
+                name: 'embedding',
+                type: DataType.vector,
+                vectorConfig: VectorFieldConfig(dimensions: 3),
+              ),
+            ],
+            indexes: [
+              IndexSchema(
+                fields: ['embedding'],
+                type: IndexType.vector,
+                vectorConfig: VectorIndexConfig(
+                  indexType: VectorIndexType.hnsw,
+                  distanceMetric: VectorDistanceMetric.cosine,
+                  parameters: {'m': 8, 'efSearch': 32},
+                ),
+              ),
+            ],
+          ),
+          const TableSchema(
+            name: 'images',
+            fields: [
+              FieldSchema(
+                name: 'features',
+                type: DataType.vector,
+                vectorConfig: VectorFieldConfig(dimensions: 2),
+              ),
+            ],
+            indexes: [
+              IndexSchema(
+                fields: ['features'],
+                type: IndexType.vector,
+                vectorConfig: VectorIndexConfig(
+                  indexType: VectorIndexType.ivfFlat,
+                  distanceMetric: VectorDistanceMetric.euclidean,
+                  parameters: {
+                    'nlist': 4,
+                    'nprobe': 2,
+                    'quantization': 'int8',
+                    'rerank': 2,
+                  },
+                ),
+              ),
+            ],
+          ),
+          const TableSchema(
+            name: 'articles',
+            fields: [
+              FieldSchema(
+                name: 'title',
+                type: DataType.text,
+              ),
+              FieldSchema(
+                name: 'body',
+                type: DataType.text,
+              ),
+              FieldSchema(
+                name: 'language',
+                type: DataType.text,
+              ),
+            ],
+            indexes: [
+              IndexSchema(
+                fields: ['title', 'body'],
+                type: IndexType.fullText,
+                fullTextConfig: FullTextIndexConfig(
+                  tokenizer: 'porter unicode61',
+                  prefixLengths: [2, 3],
+                ),
+              ),
+            ],
+          ),
         ],
       );
     });
@@ -151,6 +235,68 @@ void main() {
         expect(results.length, equals(3));
       });
 
+      test('batchInsert should report its rows as one data change event',
+          () async {
+        final events = <DataChangeEvent>[];
+        final subscription =
+            storage.eventManager.dataChangeEvents.listen(events.add);
+
+        await storage.batchInsert('users', [
+          {'username': 'user1', 'email': 'user1@example.com'},
+          {'username': 'user2', 'email': 'user2@example.com'},
+          {'username': 'user3', 'email': 'user3@example.com'},
+        ]);
+        await Future<void>.delayed(const Duration(milliseconds: 10));
+
+        expect(events, hasLength(1));
+        expect(events.single.type, equals(StorageEventType.dataInserted));
+        expect(events.single.tableName, equals('users'));
+        expect(events.single.recordIds, hasLength(3));
+
+        await subscription.cancel();
+      });
+
+      test('insert and update events should carry the data written',
+          () async {
+        final events = <DataChangeEvent>[];
+        final subscription =
+            storage.eventManager.dataChangeEvents.listen(events.add);
+
+        final id = await storage.insert('users', {
+          'username': 'user1',
+          'email': 'user1@example.com',
+        });
+        await storage.update('users', {'age': 30});
+        await Future<void>.delayed(const Duration(milliseconds: 10));
+
+        expect(events, hasLength(2));
+        expect(events[0].type, equals(StorageEventType.dataInserted));
+        expect(events[0].tableName, equals('users'));
+        expect(events[0].recordId, equals(id));
+        expect(events[0].data, containsPair('username', 'user1'));
+        expect(events[1].type, equals(StorageEventType.dataUpdated));
+        expect(events[1].tableName, equals('users'));
+        expect(events[1].recordIds, equals([id]));
+        expect(events[1].data, equals({'age': 30}));
+
+        await subscription.cancel();
+      });
+
+      test('should report rows of unknown tables as one data change event',
+          () async {
+        final events = <DataChangeEvent>[];
+        final subscription =
+            storage.eventManager.dataChangeEvents.listen(events.add);
+
+        reportMockUnknownTableChanges();
+        await Future<void>.delayed(const Duration(milliseconds: 10));
+
+        expect(events, hasLength(1));
+        expect(events.single.tableName, equals(DataChangeEvent.unknownTable));
+
+        await subscription.cancel();
+      });
+
       test('batchUpdate should update multiple records', () async {
         final users = [
           {'username': 'user1', 'email': 'user1@example.com', 'age': 20},
@@ -170,6 +316,38 @@ void main() {
         expect(results.any((r) => r['age'] == 25), isTrue);
       });
 
+      test('batchUpdate should update each record by its primary key',
+          () async {
+        final id1 = await storage.insert('users', {
+          'username': 'user1',
+          'email': 'user1@example.com',
+        });
+        final id2 = await storage.insert('users', {
+          'username': 'user2',
+          'email': 'user2@example.com',
+        });
+
+        await storage.batchUpdate('users', [
+          {'id': id1, 'email': 'new1@example.com'},
+          {'id': id2, 'email': 'new2@example.com'},
+        ]);
+
+        final user1 = await storage.findById('users', id1);
+        final user2 = await storage.findById('users', id2);
+        expect(user1!['email'], equals('new1@example.com'));
+        expect(user1['username'], equals('user1'));
+        expect(user2!['email'], equals('new2@example.com'));
+      });
+
+      test('batchUpdate should reject records without a key', () async {
+        expect(
+          () => storage.batchUpdate('users', [
+            {'email': 'new@example.com'},
+          ]),
+          throwsArgumentError,
+        );
+      });
+
       test('batchDelete should remove multiple records', () async {
         final id1 = await storage.insert('users', {
           'username': 'user1',
@@ -270,6 +448,25 @@ void main() {
         final value = await storage.getValue<String>('temp_key');
         expect(value, isNull);
       });
+
+      test('should use one native call per key-value operation', () async {
+        getMockMethodCalls().clear();
+        await storage.setValue('fast_key', {'a': 1});
+        await storage.getValue<Map<String, dynamic>>('fast_key');
+        await storage.deleteValue('fast_key');
+
+        expect(
+          getMockMethodCalls(),
+          equals(['kvSet', 'kvGet', 'kvDelete']),
+        );
+      });
+
+      test('setValues and getValues should handle several keys', () async {
+        await storage.setValues({'a': 1, 'b': 'two'});
+        final values = await storage.getValues<dynamic>(['a', 'b', 'c']);
+
+        expect(values, equals({'a': 1, 'b': 'two', 'c': null}));
+      });
     });
 
     group('Stream Operations', () {
@@ -319,6 +516,178 @@ void main() {
       });
     });
 
+    group('Vector Search', () {
+      setUp(() async {
+        await storage.initialize();
+        await storage.insert('documents', {
+          'title': 'north',
+          'embedding': [0.0, 1.0, 0.0],
+        });
+        await storage.insert('documents', {
+          'title': 'east',
+          'embedding': [1.0, 0.0, 0.0],
+        });
+        await storage.insert('documents', {
+          'title': 'north-east',
+          'embedding': [0.7, 0.7, 0.0],
+        });
+      });
+
+      test('should store vectors as typed data', () async {
+        final records = getMockDatabase()['default_documents']!;
+        expect(records.first['embedding'], isA<Float32List>());
+      });
+
+      test('should return the closest records first', () async {
+        final matches = await storage.vectorSearch(
+          'documents',
+          'embedding',
+          [0.9, 0.1, 0.0],
+          k: 2,
+        );
+
+        expect(matches.length, equals(2));
+        expect(matches[0].row['title'], equals('east'));
+        expect(matches[1].row['title'], equals('north-east'));
+        expect(matches[0].distance, lessThan(matches[1].distance));
+      });
+
+      test('should apply the metric and filter', () async {
+        final matches = await storage.vectorSearch(
+          'documents',
+          'embedding',
+          [0.0, 1.0, 0.0],
+          metric: VectorDistanceMetric.euclidean,
+          where: 'title = ?',
+          whereArguments: ['east'],
+        );
+
+        expect(matches.length, equals(1));
+        expect(matches.single.distance, closeTo(sqrt(2), 1e-6));
+      });
+
+      test('should order query results by vector distance', () async {
+        final query = storage.query('documents')
+          ..whereNotNull('embedding')
+          ..orderByVectorDistance(
+            'embedding',
+            [0.9, 0.1, 0.0],
+            metric: VectorDistanceMetric.euclidean,
+          )
+          ..limit = 2;
+        final records = await query.get();
+
+        expect(
+          records.map((record) => record['title']),
+          equals(['east', 'north-east']),
+        );
+      });
+
+      test('should build an HNSW index for vector indexes', () async {
+        final index = getMockVectorIndexes()['default_documents_embedding_hnsw'];
+
+        expect(index, isNotNull);
+        expect(index!['tableName'], equals('default_documents'));
+        expect(index['column'], equals('embedding'));
+        expect(index['dimensions'], equals(3));
+        expect(index['m'], equals(8));
+        expect(index['efSearch'], equals(32));
+      });
+
+      test('should benchmark the HNSW index', () async {
+        final benchmark = await storage.benchmarkVectorIndex(
+          'documents',
+          'embedding',
+          efSearch: [8, 32],
+        );
+
+        expect(benchmark.size, equals(3));
+        expect(benchmark.runs.map((run) => run.efSearch), equals([8, 32]));
+        expect(benchmark.runs.first.recall, equals(1.0));
+      });
+
+      test('should build an IVF-Flat index for vector indexes', () async {
+        final index = getMockVectorIndexes()['default_images_features_ivfFlat'];
+
+        expect(index, isNotNull);
+        expect(index!['indexType'], equals('ivfFlat'));
+        expect(index['metric'], equals('euclidean'));
+        expect(index['nlist'], equals(4));
+        expect(index['nprobe'], equals(2));
+        expect(index['quantization'], equals('int8'));
+        expect(index['rerank'], equals(2));
+      });
+
+      test('should benchmark the IVF-Flat index by nprobe', () async {
+        final benchmark = await storage.benchmarkVectorIndex(
+          'images',
+          'features',
+          nprobe: [1, 4],
+        );
+
+        expect(benchmark.runs.map((run) => run.nprobe), equals([1, 4]));
+        expect(benchmark.runs.first.efSearch, isNull);
+      });
+    });
+
+    group('Full-Text Search', () {
+      setUp(() async {
+        await storage.initialize();
+        await storage.insert('articles', {
+          'title': 'Caching in Flutter',
+          'body': 'A cache keeps flutter apps fast',
+          'language': 'en',
+        });
+        await storage.insert('articles', {
+          'title': 'SQLite tuning',
+          'body': 'Indexes make queries fast',
+          'language': 'en',
+        });
+        await storage.insert('articles', {
+          'title': 'Flutter en français',
+          'body': 'Un cache rend les apps flutter rapides',
+          'language': 'fr',
+        });
+      });
+
+      test('should build a full-text index for fullText indexes', () async {
+        final index = getMockFullTextIndexes()['default_articles'];
+
+        expect(index, isNotNull);
+        expect(index!['columns'], equals(['title', 'body']));
+        expect(index['tokenizer'], equals('porter unicode61'));
+        expect(index['prefixes'], equals([2, 3]));
+      });
+
+      test('should return the best matches first with highlights', () async {
+        final matches = await storage.search('articles', 'flutter cache');
+
+        expect(matches.length, equals(2));
+        expect(matches.first.score, greaterThanOrEqualTo(matches.last.score));
+        expect(
+          matches.first.highlights['title'],
+          contains('<b>Flutter</b>'),
+        );
+        expect(matches.first.snippet, contains('<b>'));
+      });
+
+      test('should apply the filter and limit', () async {
+        final matches = await storage.search(
+          'articles',
+          'fast',
+          where: 'language = ?',
+          whereArguments: ['en'],
+          limit: 1,
+          highlightStart: '[',
+          highlightEnd: ']',
+        );
+
+        expect(matches.length, equals(1));
+        expect(matches.single.row['language'], equals('en'));
+        expect(matches.single.snippet, contains('[fast]'));
+      });
+    });
+
     group('Transaction Management', () {
       setUp(() async {
         await storage.initialize();
@@ -379,6 +748,42 @@ void main() {
         expect(stats.recordCount, greaterThanOrEqualTo(0));
         expect(stats.tableCount, greaterThanOrEqualTo(0));
       });
+
+      test('getCacheStats should report native memory cache counters',
+          () async {
+        await storage.setValue('theme', 'dark');
+        await storage.getValue<String>('theme');
+        await storage.getValue<String>('theme');
+        await storage.getValue<String>('missing');
+
+        final stats = await storage.getCacheStats();
+        expect(stats.cacheHits, equals(2));
+        expect(stats.cacheMisses, equals(1));
+        expect(stats.hitRate, closeTo(2 / 3, 1e-9));
+      });
+
+      test('getCacheStats should compare eviction policies on request',
+          () async {
+        final stats = await storage.getCacheStats(comparePolicies: true);
+        expect(stats.evictionPolicy, equals(EvictionPolicy.wTinyLfu));
+        expect(stats.policyHitRates, hasLength(4));
+        expect(
+          stats.hitRateDifference(EvictionPolicy.lru),
+          closeTo(0.15, 1e-9),
+        );
+        expect(getMockMethodCalls(), contains('compareEvictionPolicies'));
+
+        final plain = await storage.getCacheStats();
+        expect(plain.policyHitRates, isEmpty);
+      });
+
+      test('getStatementCacheStats should include native counters', () async {
+        final stats = await storage.getStatementCacheStats();
+        final native = stats['native'] as Map<String, dynamic>;
+        expect(native['hits'], equals(3));
+        expect(native['misses'], equals(1));
+        expect(storage.statementCache.getStats()['native'], equals(native));
+      });
     });
 
     group('Cleanup', () {
@@ -0,0 +1,103 @@
+#include "change_feed.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// The rows of one table, in the order they were first changed, with the
+// position of each in `operations`
+struct TableChanges {
+  std::string name;
+  std::vector<int64_t> rowids;
+  std::vector<int> operations;  // 0 once a row's changes cancel out
+  std::unordered_map<int64_t, size_t> positions;
+};
+
+// The net change of a row changed by `previous` and then by `next`
+int Fold(int previous, int next) {
+  if (previous == 0) {
+    return next;
+  }
+  if (previous == SQLITE_INSERT) {
+    return next == SQLITE_DELETE ? 0 : SQLITE_INSERT;
+  }
+  if (previous == SQLITE_DELETE && next == SQLITE_INSERT) {
+    return SQLITE_UPDATE;
+  }
+  return next;
+}
+
+}  // namespace
+
+FlValue* EncodeChangeBatch(const std::vector<RowChange>& changes) {
+  std::vector<TableChanges> tables;
+  std::unordered_map<std::string, size_t> table_positions;
+  bool unknown_tables = false;
+
+  for (const RowChange& change : changes) {
+    if (change.table_name.empty()) {
+      unknown_tables = true;
+      continue;
+    }
+
+    auto table = table_positions.emplace(change.table_name, tables.size());
+    if (table.second) {
+      tables.emplace_back();
+      tables.back().name = change.table_name;
+    }
+    TableChanges& rows = tables[table.first->second];
+
+    auto row = rows.positions.emplace(change.rowid, rows.rowids.size());
+    if (row.second) {
+      rows.rowids.push_back(change.rowid);
+      rows.operations.push_back(change.operation);
+    } else {
+      int& operation = rows.operations[row.first->second];
+      operation = Fold(operation, change.operation);
+    }
+  }
+
+  FlValue* table_list = fl_value_new_list();
+  for (const TableChanges& rows : tables) {
+    std::vector<int64_t> inserted;
+    std::vector<int64_t> updated;
+    std::vector<int64_t> deleted;
+    for (size_t i = 0; i < rows.rowids.size(); i++) {
+      switch (rows.operations[i]) {
+        case SQLITE_INSERT:
+          inserted.push_back(rows.rowids[i]);
+          break;
+        case SQLITE_UPDATE:
+          updated.push_back(rows.rowids[i]);
+          break;
+        case SQLITE_DELETE:
+          deleted.push_back(rows.rowids[i]);
+          break;
+      }
+    }
+    if (inserted.empty() && updated.empty() && deleted.empty()) {
+      continue;
+    }
+
+    FlValue* table = fl_value_new_map();
+    fl_value_set_string_take(table, "name", fl_value_new_string(rows.name.c_str()));
+    fl_value_set_string_take(table, "inserted",
+                             fl_value_new_int64_list(inserted.data(), inserted.size()));
+    fl_value_set_string_take(table, "updated",
+                             fl_value_new_int64_list(updated.data(), updated.size()));
+    fl_value_set_string_take(table, "deleted",
+                             fl_value_new_int64_list(deleted.data(), deleted.size()));
+    fl_value_append_take(table_list, table);
+  }
+
+  if (fl_value_get_length(table_list) == 0 && !unknown_tables) {
+    fl_value_unref(table_list);
+    return nullptr;
+  }
+  FlValue* batch = fl_value_new_map();
+  fl_value_set_string_take(batch, "tables", table_list);
+  fl_value_set_string_take(batch, "unknownTables", fl_value_new_bool(unknown_tables));
+  return batch;
+}
@@ -0,0 +1,23 @@
+#ifndef CHANGE_FEED_H_
+#define CHANGE_FEED_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <vector>
+
+#include "change_tracker.h"
+
+// Folds the rows handed to a ChangeTracker listener into one batch for Dart,
+// so that a write touching thousands of rows costs one message.
+//
+// Each row appears once, with its net change over the batch: a row inserted
+// then updated counts as inserted, one inserted then deleted is left out, and
+// one deleted then inserted again under the same rowid counts as updated.
+// The batch is a map holding a `tables` list of {name, inserted, updated,
+// deleted} maps, in the order the tables were first changed, each list
+// holding rowids, and an `unknownTables` bool telling whether rows of tables
+// the tracker could not tell apart changed as well, such as those of a
+// WITHOUT ROWID table. Returns null if nothing is left to report.
+FlValue* EncodeChangeBatch(const std::vector<RowChange>& changes);
+
+#endif  // CHANGE_FEED_H_
@@ -0,0 +1,93 @@
+#include "change_tracker.h"
+
+#include <utility>
+
+ChangeTracker::ChangeTracker(sqlite3* database)
+    : database_(database), total_changes_(sqlite3_total_changes(database)) {
+  sqlite3_update_hook(database_, &ChangeTracker::OnUpdate, this);
+  sqlite3_commit_hook(database_, &ChangeTracker::OnCommit, this);
+  sqlite3_rollback_hook(database_, &ChangeTracker::OnRollback, this);
+}
+
+ChangeTracker::~ChangeTracker() {
+  sqlite3_update_hook(database_, nullptr, nullptr);
+  sqlite3_commit_hook(database_, nullptr, nullptr);
+  sqlite3_rollback_hook(database_, nullptr, nullptr);
+}
+
+int ChangeTracker::AddListener(Listener listener) {
+  int id = next_listener_id_++;
+  listeners_.emplace(id, std::move(listener));
+  return id;
+}
+
+void ChangeTracker::RemoveListener(int id) {
+  listeners_.erase(id);
+}
+
+void ChangeTracker::Flush() {
+  if (!sqlite3_get_autocommit(database_)) {
+    return;
+  }
+
+  for (;;) {
+    // SQLite truncates the count to an int, so it is compared modulo 2^32
+    int total_changes = sqlite3_total_changes(database_);
+    uint32_t counted =
+        static_cast<uint32_t>(total_changes) - static_cast<uint32_t>(total_changes_);
+    if (counted > reported_changes_) {
+      committed_.push_back(RowChange{0, std::string(), 0});
+    }
+    total_changes_ = total_changes;
+    reported_changes_ = 0;
+
+    if (committed_.empty()) {
+      return;
+    }
+    std::vector<RowChange> changes;
+    changes.swap(committed_);
+    for (auto& listener : listeners_) {
+      listener.second(changes);
+    }
+  }
+}
+
+void ChangeTracker::BeginSavepoint() {
+  savepoints_.push_back(uncommitted_.size());
+}
+
+void ChangeTracker::RollbackToSavepoint() {
+  // A rollback of the whole transaction may have dropped the rows already
+  if (!savepoints_.empty() && savepoints_.back() < uncommitted_.size()) {
+    uncommitted_.erase(uncommitted_.begin() + savepoints_.back(), uncommitted_.end());
+  }
+}
+
+void ChangeTracker::ReleaseSavepoint() {
+  if (!savepoints_.empty()) {
+    savepoints_.pop_back();
+  }
+}
+
+void ChangeTracker::OnUpdate(void* user_data,
+                             int operation,
+                             const char* /* database_name */,
+                             const char* table_name,
+                             sqlite3_int64 rowid) {
+  ChangeTracker* tracker = static_cast<ChangeTracker*>(user_data);
+  tracker->uncommitted_.push_back(RowChange{operation, table_name, rowid});
+  tracker->reported_changes_++;
+}
+
+int ChangeTracker::OnCommit(void* user_data) {
+  ChangeTracker* tracker = static_cast<ChangeTracker*>(user_data);
+  tracker->committed_.insert(tracker->committed_.end(),
+                             std::make_move_iterator(tracker->uncommitted_.begin()),
+                             std::make_move_iterator(tracker->uncommitted_.end()));
+  tracker->uncommitted_.clear();
+  return 0;  // Let the commit go ahead
+}
+
+void ChangeTracker::OnRollback(void* user_data) {
+  static_cast<ChangeTracker*>(user_data)->uncommitted_.clear();
+}
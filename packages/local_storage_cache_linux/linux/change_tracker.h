@@ -0,0 +1,85 @@
+#ifndef CHANGE_TRACKER_H_
+#define CHANGE_TRACKER_H_
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// A row written through the writer connection. An empty `table_name`, with
+// an operation and rowid of 0, stands for rows SQLite changed without
+// reporting them, in tables that could be any.
+struct RowChange {
+  int operation;  // SQLITE_INSERT, SQLITE_UPDATE or SQLITE_DELETE
+  std::string table_name;
+  int64_t rowid;
+};
+
+// Collects the rows each transaction changes, through the connection's
+// update, commit and rollback hooks, and hands them to listeners once the
+// transaction has committed.
+//
+// SQLite allows one update hook per connection, so everything that reacts to
+// writes listens here. SQLite does not report a ROLLBACK TO, so code that
+// rolls back to a savepoint marks it through BeginSavepoint() and its
+// siblings for the rows it undid to be dropped; listeners should still
+// re-read the rows they are given rather than trust the operation. Nor does
+// SQLite call the hook for WITHOUT ROWID tables, or for a table emptied by a
+// DELETE without WHERE unless QueryCache::Install() keeps it from
+// truncating, but it does count those rows in sqlite3_total_changes(), so
+// any rows counted beyond those reported are delivered as one change of an
+// unknown table.
+class ChangeTracker {
+ public:
+  using Listener = std::function<void(const std::vector<RowChange>& changes)>;
+
+  // Installs the hooks on `database`, the writer connection.
+  explicit ChangeTracker(sqlite3* database);
+  ~ChangeTracker();
+
+  // Disallow copy and assign.
+  ChangeTracker(const ChangeTracker&) = delete;
+  ChangeTracker& operator=(const ChangeTracker&) = delete;
+
+  // Returns an id for RemoveListener().
+  int AddListener(Listener listener);
+  void RemoveListener(int id);
+
+  // Delivers the changes of every transaction committed since the last call.
+  // Listeners may write to the database themselves; those changes are
+  // delivered in turn. Does nothing while a transaction is open.
+  void Flush();
+
+  // Called once a savepoint was opened, once it was rolled back to with
+  // ROLLBACK TO, which drops the rows changed since it was opened, and once
+  // it was released. Savepoints nest.
+  void BeginSavepoint();
+  void RollbackToSavepoint();
+  void ReleaseSavepoint();
+
+ private:
+  static void OnUpdate(void* user_data,
+                       int operation,
+                       const char* database_name,
+                       const char* table_name,
+                       sqlite3_int64 rowid);
+  static int OnCommit(void* user_data);
+  static void OnRollback(void* user_data);
+
+  sqlite3* database_;
+  std::vector<RowChange> uncommitted_;
+  std::vector<size_t> savepoints_;  // Size of `uncommitted_` as each opened
+  std::vector<RowChange> committed_;
+  std::map<int, Listener> listeners_;
+  int next_listener_id_ = 1;
+
+  // sqlite3_total_changes() as of the last flush, and the rows reported
+  // since, rolled back or not
+  int total_changes_;
+  int64_t reported_changes_ = 0;
+};
+
+#endif  // CHANGE_TRACKER_H_
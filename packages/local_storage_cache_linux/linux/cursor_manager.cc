@@ -0,0 +1,135 @@
+#include "cursor_manager.h"
+
+#include "result_encoder.h"
+#include "value_binding.h"
+
+namespace {
+
+constexpr int kCursorSlotBits = 8;
+constexpr int64_t kCursorSlotMask = (1 << kCursorSlotBits) - 1;
+
+}  // namespace
+
+CursorManager::CursorManager(sqlite3* database, int64_t idle_timeout_ms)
+    : database_(database), idle_timeout_(idle_timeout_ms) {}
+
+CursorManager::~CursorManager() {
+  CloseAll();
+}
+
+bool CursorManager::Open(int64_t cursor_id,
+                         const std::string& sql,
+                         FlValue* arguments,
+                         bool read_only,
+                         std::string* error) {
+  // Opening is the natural point to reap cursors that were never closed
+  ExpireIdle();
+  Close(cursor_id);
+  
+  // The statement lives for as long as the cursor, so keep it out of the
+  // statement cache
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v3(database_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT,
+                         &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database_);
+    sqlite3_finalize(statement);
+    return false;
+  }
+  
+  if (statement == nullptr) {
+    *error = "Empty statement";
+    return false;
+  }
+  
+  if (read_only && !sqlite3_stmt_readonly(statement)) {
+    *error = "Statement modifies the database";
+    sqlite3_finalize(statement);
+    return false;
+  }
+  
+  if (!BindArguments(statement, arguments)) {
+    *error = "Failed to bind arguments";
+    sqlite3_finalize(statement);
+    return false;
+  }
+  
+  Cursor cursor;
+  cursor.statement = statement;
+  cursor.arguments = arguments ? fl_value_ref(arguments) : nullptr;
+  cursor.last_used = Clock::now();
+  cursors_[cursor_id] = cursor;
+  return true;
+}
+
+FlValue* CursorManager::Fetch(int64_t cursor_id, int64_t page_size) {
+  auto it = cursors_.find(cursor_id);
+  if (it == cursors_.end()) {
+    return nullptr;
+  }
+  
+  bool done = false;
+  FlValue* rows = EncodeRows(it->second.statement, page_size > 0 ? page_size : 1, &done);
+  it->second.last_used = Clock::now();
+  
+  if (done) {
+    Finalize(it->second);
+    cursors_.erase(it);
+  }
+  
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "rows", rows);
+  fl_value_set_string_take(result, "done", fl_value_new_bool(done));
+  return result;
+}
+
+bool CursorManager::Close(int64_t cursor_id) {
+  auto it = cursors_.find(cursor_id);
+  if (it == cursors_.end()) {
+    return false;
+  }
+  
+  Finalize(it->second);
+  cursors_.erase(it);
+  return true;
+}
+
+void CursorManager::CloseAll() {
+  for (auto& entry : cursors_) {
+    Finalize(entry.second);
+  }
+  cursors_.clear();
+}
+
+size_t CursorManager::ExpireIdle() {
+  Clock::time_point deadline = Clock::now() - idle_timeout_;
+  size_t expired = 0;
+  
+  for (auto it = cursors_.begin(); it != cursors_.end();) {
+    if (it->second.last_used < deadline) {
+      Finalize(it->second);
+      it = cursors_.erase(it);
+      expired++;
+    } else {
+      ++it;
+    }
+  }
+  
+  return expired;
+}
+
+void CursorManager::Finalize(const Cursor& cursor) {
+  // Finalizing ends the statement's read transaction, releasing the WAL
+  // snapshot it was holding
+  sqlite3_finalize(cursor.statement);
+  if (cursor.arguments) {
+    fl_value_unref(cursor.arguments);
+  }
+}
+
+int64_t MakeCursorId(int64_t serial, size_t slot) {
+  return (serial << kCursorSlotBits) | (static_cast<int64_t>(slot) & kCursorSlotMask);
+}
+
+size_t GetCursorSlot(int64_t cursor_id) {
+  return static_cast<size_t>(cursor_id & kCursorSlotMask);
+}
@@ -0,0 +1,76 @@
+#ifndef CURSOR_MANAGER_H_
+#define CURSOR_MANAGER_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Open cursors of a single connection. Each cursor keeps its statement alive
+// between fetches so a result set can be paged through without ever
+// materializing it. Only used from the thread that owns the connection.
+class CursorManager {
+ public:
+  static constexpr int64_t kDefaultIdleTimeoutMs = 60000;
+
+  explicit CursorManager(sqlite3* database,
+                         int64_t idle_timeout_ms = kDefaultIdleTimeoutMs);
+  ~CursorManager();
+
+  // Disallow copy and assign.
+  CursorManager(const CursorManager&) = delete;
+  CursorManager& operator=(const CursorManager&) = delete;
+
+  // Prepares `sql`, binds `arguments` and registers it as `cursor_id`. With
+  // `read_only` set, statements that would modify the database are refused.
+  // Returns false with `*error` set on failure.
+  bool Open(int64_t cursor_id,
+            const std::string& sql,
+            FlValue* arguments,
+            bool read_only,
+            std::string* error);
+
+  // Returns up to `page_size` rows as a {"rows": [...], "done": bool} map, or
+  // nullptr if the cursor does not exist (or has expired). The cursor is
+  // closed once it is done.
+  FlValue* Fetch(int64_t cursor_id, int64_t page_size);
+
+  // Returns false if the cursor does not exist.
+  bool Close(int64_t cursor_id);
+
+  void CloseAll();
+
+  // Closes cursors that have not been fetched from within the idle timeout,
+  // so abandoned streams do not pin a WAL snapshot forever. Returns the
+  // number of cursors closed.
+  size_t ExpireIdle();
+
+  size_t size() const { return cursors_.size(); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Cursor {
+    sqlite3_stmt* statement;
+    FlValue* arguments;  // Kept alive for the statically bound strings.
+    Clock::time_point last_used;
+  };
+
+  void Finalize(const Cursor& cursor);
+
+  sqlite3* database_;
+  std::chrono::milliseconds idle_timeout_;
+  std::unordered_map<int64_t, Cursor> cursors_;
+};
+
+// Cursor ids carry the connection they live on in their low byte: 0 is the
+// writer and n is reader n - 1.
+constexpr size_t kMaxCursorReaders = 255;
+
+int64_t MakeCursorId(int64_t serial, size_t slot);
+size_t GetCursorSlot(int64_t cursor_id);
+
+#endif  // CURSOR_MANAGER_H_
@@ -0,0 +1,172 @@
+#include "database_config.h"
+
+#include <strings.h>
+
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+void ApplyPerformanceProfile(const char* profile, DatabaseConfig* config) {
+  if (strcmp(profile, "highPerformance") == 0) {
+    config->temp_store = "MEMORY";
+    config->mmap_size = 256 * 1024 * 1024;
+    config->wal_autocheckpoint = 4000;
+  }
+}
+
+void ApplyCacheProfile(const char* profile, DatabaseConfig* config) {
+  if (strcmp(profile, "highPerformance") == 0) {
+    config->cache_size_kb = 16000;
+    config->memory_cache_entries = 500;
+    config->memory_cache_bytes = 32 * 1024 * 1024;
+  } else if (strcmp(profile, "minimal") == 0) {
+    config->cache_size_kb = 500;
+    config->statement_cache_size = 25;
+    config->memory_cache_entries = 50;
+    config->memory_cache_bytes = 1024 * 1024;
+    config->eviction_policy = EvictionPolicy::kFifo;
+  }
+}
+
+const char* LookupString(FlValue* map, const char* key) {
+  FlValue* value = map ? fl_value_lookup_string(map, key) : nullptr;
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+    return nullptr;
+  }
+  return fl_value_get_string(value);
+}
+
+bool LookupInt(FlValue* map, const char* key, int64_t* result) {
+  FlValue* value = map ? fl_value_lookup_string(map, key) : nullptr;
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_INT) {
+    return false;
+  }
+  *result = fl_value_get_int(value);
+  return true;
+}
+
+// Upper-cases a Dart enum name; "defaultStore" maps to "DEFAULT"
+std::string ToPragmaKeyword(const char* name) {
+  if (strcmp(name, "defaultStore") == 0) {
+    return "DEFAULT";
+  }
+  
+  std::string keyword;
+  for (const char* c = name; *c; c++) {
+    if (!isalpha(static_cast<unsigned char>(*c))) {
+      return std::string();
+    }
+    keyword.push_back(static_cast<char>(toupper(static_cast<unsigned char>(*c))));
+  }
+  return keyword;
+}
+
+bool Execute(sqlite3* database, const std::string& sql) {
+  return sqlite3_exec(database, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+}  // namespace
+
+DatabaseConfig DatabaseConfig::FromValue(FlValue* config) {
+  DatabaseConfig result;
+  if (config == nullptr || fl_value_get_type(config) != FL_VALUE_TYPE_MAP) {
+    return result;
+  }
+  
+  FlValue* performance = fl_value_lookup_string(config, "performance");
+  FlValue* cache = fl_value_lookup_string(config, "cache");
+  
+  const char* performance_profile = LookupString(performance, "profile");
+  if (performance_profile) {
+    ApplyPerformanceProfile(performance_profile, &result);
+  }
+  const char* cache_profile = LookupString(cache, "profile");
+  if (cache_profile) {
+    ApplyCacheProfile(cache_profile, &result);
+  }
+  
+  // Explicit fields win over the profiles
+  const char* journal_mode = LookupString(performance, "journalMode");
+  if (journal_mode && !ToPragmaKeyword(journal_mode).empty()) {
+    result.journal_mode = ToPragmaKeyword(journal_mode);
+  }
+  const char* synchronous = LookupString(performance, "synchronous");
+  if (synchronous && !ToPragmaKeyword(synchronous).empty()) {
+    result.synchronous = ToPragmaKeyword(synchronous);
+  }
+  const char* temp_store = LookupString(performance, "tempStore");
+  if (temp_store && !ToPragmaKeyword(temp_store).empty()) {
+    result.temp_store = ToPragmaKeyword(temp_store);
+  }
+  
+  LookupInt(performance, "mmapSize", &result.mmap_size);
+  LookupInt(performance, "pageSize", &result.page_size);
+  LookupInt(performance, "walAutoCheckpoint", &result.wal_autocheckpoint);
+  LookupInt(performance, "busyTimeout", &result.busy_timeout_ms);
+  LookupInt(performance, "cursorIdleTimeout", &result.cursor_idle_timeout_ms);
+  LookupInt(cache, "pageCacheSizeKb", &result.cache_size_kb);
+  
+  int64_t memory_cache_entries = 0;
+  if (LookupInt(cache, "maxMemoryCacheSize", &memory_cache_entries) && memory_cache_entries > 0) {
+    result.memory_cache_entries = static_cast<size_t>(memory_cache_entries);
+  }
+  int64_t memory_cache_bytes = 0;
+  if (LookupInt(cache, "maxMemoryCacheBytes", &memory_cache_bytes) && memory_cache_bytes >= 0) {
+    result.memory_cache_bytes = static_cast<size_t>(memory_cache_bytes);
+  }
+  const char* eviction_policy = LookupString(cache, "evictionPolicy");
+  if (eviction_policy) {
+    ParseEvictionPolicy(eviction_policy, &result.eviction_policy);
+  }
+  FlValue* query_cache = cache ? fl_value_lookup_string(cache, "enableQueryCache") : nullptr;
+  if (query_cache != nullptr && fl_value_get_type(query_cache) == FL_VALUE_TYPE_BOOL) {
+    result.query_cache_enabled = fl_value_get_bool(query_cache);
+  }
+  
+  int64_t pool_size = 0;
+  if (LookupInt(performance, "connectionPoolSize", &pool_size) && pool_size > 0) {
+    result.reader_pool_size = static_cast<size_t>(pool_size);
+  }
+  
+  FlValue* prepared_statements =
+      performance ? fl_value_lookup_string(performance, "enablePreparedStatements") : nullptr;
+  if (prepared_statements != nullptr &&
+      fl_value_get_type(prepared_statements) == FL_VALUE_TYPE_BOOL &&
+      !fl_value_get_bool(prepared_statements)) {
+    result.statement_cache_size = 0;
+  }
+  
+  return result;
+}
+
+bool DatabaseConfig::IsWal() const {
+  return strcasecmp(journal_mode.c_str(), "WAL") == 0;
+}
+
+bool DatabaseConfig::ApplyToWriter(sqlite3* database) const {
+  // The page size has to be set before the journal mode switches to WAL
+  if (page_size > 0) {
+    Execute(database, "PRAGMA page_size = " + std::to_string(page_size));
+  }
+  
+  if (!Execute(database, "PRAGMA journal_mode = " + journal_mode)) {
+    return false;
+  }
+  
+  Execute(database, "PRAGMA synchronous = " + synchronous);
+  Execute(database, "PRAGMA wal_autocheckpoint = " + std::to_string(wal_autocheckpoint));
+  ApplyToReader(database);
+  
+  return true;
+}
+
+void DatabaseConfig::ApplyToReader(sqlite3* database) const {
+  // Negative cache_size values are in KiB rather than pages
+  if (cache_size_kb > 0) {
+    Execute(database, "PRAGMA cache_size = -" + std::to_string(cache_size_kb));
+  }
+  Execute(database, "PRAGMA mmap_size = " + std::to_string(mmap_size));
+  Execute(database, "PRAGMA temp_store = " + temp_store);
+  sqlite3_busy_timeout(database, static_cast<int>(busy_timeout_ms));
+}
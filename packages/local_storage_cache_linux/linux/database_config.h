@@ -0,0 +1,46 @@
+#ifndef DATABASE_CONFIG_H_
+#define DATABASE_CONFIG_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <string>
+
+#include "memory_cache.h"
+
+// SQLite tuning derived from the `config` map sent by `initialize`
+// (StorageConfig.toMap()).
+//
+// Values start from the named profiles of PerformanceConfig and CacheConfig
+// and are then overridden by any explicit field in the map.
+struct DatabaseConfig {
+  std::string journal_mode = "WAL";
+  std::string synchronous = "NORMAL";
+  std::string temp_store = "DEFAULT";
+  int64_t cache_size_kb = 2000;
+  int64_t mmap_size = 0;
+  int64_t page_size = 0;  // 0 leaves the database's page size alone.
+  int64_t wal_autocheckpoint = 1000;
+  int64_t busy_timeout_ms = 5000;
+  size_t reader_pool_size = 0;
+  size_t statement_cache_size = 100;
+  int64_t cursor_idle_timeout_ms = 60000;
+  EvictionPolicy eviction_policy = EvictionPolicy::kLru;
+  size_t memory_cache_entries = 100;
+  size_t memory_cache_bytes = 8 * 1024 * 1024;
+  bool query_cache_enabled = true;  // Query results kept in the memory cache
+
+  static DatabaseConfig FromValue(FlValue* config);
+
+  bool IsWal() const;
+
+  // Applies the pragmas that belong to the writer connection, including the
+  // database-wide page size and journal mode.
+  bool ApplyToWriter(sqlite3* database) const;
+
+  // Applies the per-connection pragmas to a read-only connection.
+  void ApplyToReader(sqlite3* database) const;
+};
+
+#endif  // DATABASE_CONFIG_H_
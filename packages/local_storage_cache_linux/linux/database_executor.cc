@@ -0,0 +1,54 @@
+#include "database_executor.h"
+
+#include <utility>
+
+DatabaseExecutor::DatabaseExecutor()
+    : pending_(0), stopping_(false), thread_(&DatabaseExecutor::Run, this) {}
+
+DatabaseExecutor::~DatabaseExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_.store(true);
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+void DatabaseExecutor::Post(Task task) {
+  queue_.Push(std::move(task));
+  
+  // Only the transition from empty needs to wake the worker
+  if (pending_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_.notify_one();
+  }
+}
+
+void DatabaseExecutor::Run() {
+  Task task;
+  
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this]() {
+        return pending_.load(std::memory_order_acquire) > 0 || stopping_.load();
+      });
+    }
+    
+    while (pending_.load(std::memory_order_acquire) > 0) {
+      if (!queue_.TryPop(&task)) {
+        // A producer has claimed a slot but not linked it yet
+        std::this_thread::yield();
+        continue;
+      }
+      
+      pending_.fetch_sub(1, std::memory_order_acq_rel);
+      task();
+      task = nullptr;
+    }
+    
+    if (stopping_.load()) {
+      break;
+    }
+  }
+}
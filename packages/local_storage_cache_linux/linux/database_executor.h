@@ -0,0 +1,45 @@
+#ifndef DATABASE_EXECUTOR_H_
+#define DATABASE_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "mpsc_queue.h"
+
+// Runs database work on a dedicated thread so SQLite calls never block the
+// GLib main loop. Tasks run one at a time, in the order they were posted.
+class DatabaseExecutor {
+ public:
+  using Task = std::function<void()>;
+
+  DatabaseExecutor();
+
+  // Runs any tasks still queued, then joins the worker thread.
+  ~DatabaseExecutor();
+
+  // Disallow copy and assign.
+  DatabaseExecutor(const DatabaseExecutor&) = delete;
+  DatabaseExecutor& operator=(const DatabaseExecutor&) = delete;
+
+  // Queues `task` for the worker thread. Safe to call from any thread.
+  void Post(Task task);
+
+ private:
+  void Run();
+
+  MpscQueue<Task> queue_;
+  std::atomic<int64_t> pending_;
+  std::atomic<bool> stopping_;
+
+  // Only used to park the worker while the queue is empty.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+
+  std::thread thread_;
+};
+
+#endif  // DATABASE_EXECUTOR_H_
@@ -1,5 +1,23 @@
 #include "database_manager.h"
-#include <sstream>
+#include <strings.h>
+#include <cstring>
+#include <vector>
+
+#include "result_encoder.h"
+#include "sql_util.h"
+#include "value_binding.h"
+#include "vector_functions.h"
+
+namespace {
+
+bool IsSchemaChange(const std::string& sql) {
+  size_t start = sql.find_first_not_of(" \t\r\n");
+  return start != std::string::npos &&
+         (strncasecmp(sql.c_str() + start, "DROP", 4) == 0 ||
+          strncasecmp(sql.c_str() + start, "ALTER", 5) == 0);
+}
+
+}  // namespace
 
 DatabaseManager::DatabaseManager(const std::string& database_path)
     : database_path_(database_path), database_(nullptr) {}
@@ -8,7 +26,7 @@ DatabaseManager::~DatabaseManager() {
   Close();
 }
 
-bool DatabaseManager::Initialize() {
+bool DatabaseManager::Initialize(const DatabaseConfig& config) {
   int result = sqlite3_open(database_path_.c_str(), &database_);
   if (result != SQLITE_OK) {
     return false;
@@ -17,115 +35,390 @@ bool DatabaseManager::Initialize() {
   // Enable foreign keys
   sqlite3_exec(database_, "PRAGMA foreign_keys = ON", nullptr, nullptr, nullptr);
   
+  // vec_cosine() and friends for queries that rank rows themselves
+  if (!RegisterVectorFunctions(database_)) {
+    Close();
+    return false;
+  }
+  
+  // Journal mode, durability and memory tuning from the Dart config. WAL
+  // lets the reader connections run alongside this single writer.
+  if (!config.ApplyToWriter(database_)) {
+    Close();
+    return false;
+  }
+  
+  // Installed before anything is prepared, since it expires statements. The
+  // change listeners rely on it even without the query cache, to hear of
+  // rows removed by a DELETE without WHERE.
+  QueryCache::Install(database_);
+  
+  statement_cache_ =
+      std::make_unique<StatementCache>(database_, config.statement_cache_size);
+  cursors_ = std::make_unique<CursorManager>(database_, config.cursor_idle_timeout_ms);
+  
+  // Vector indexes follow every committed write to their tables
+  changes_ = std::make_unique<ChangeTracker>(database_);
+  vector_indexes_ = std::make_shared<VectorIndexManager>(database_, database_path_);
+  vector_indexes_->Load();
+  VectorIndexManager* vector_indexes = vector_indexes_.get();
+  changes_->AddListener([vector_indexes](const std::vector<RowChange>& changes) {
+    vector_indexes->ApplyChanges(changes);
+  });
+  
+  // Shared by every lookup of the plugin, on the writer and the readers
+  memory_cache_ = std::make_shared<MemoryCache>(
+      config.eviction_policy, config.memory_cache_entries, config.memory_cache_bytes);
+  
+  // Query results are invalidated by every committed write to their tables
+  if (config.query_cache_enabled) {
+    query_cache_ = std::make_shared<QueryCache>(memory_cache_);
+    QueryCache* query_cache = query_cache_.get();
+    changes_->AddListener([query_cache](const std::vector<RowChange>& changes) {
+      query_cache->ApplyChanges(changes);
+    });
+  }
+  
+  // Cached values are dropped once others write to their table
+  key_values_ = std::make_unique<KeyValueStore>(database_, statement_cache_.get(),
+                                                memory_cache_.get(), changes_.get());
+  KeyValueStore* key_values = key_values_.get();
+  changes_->AddListener([key_values](const std::vector<RowChange>& changes) {
+    key_values->ApplyChanges(changes);
+  });
+  
+  // Watched queries are re-run once their tables change
+  query_watcher_ = std::make_unique<QueryWatcher>(database_);
+  QueryWatcher* query_watcher = query_watcher_.get();
+  changes_->AddListener([query_watcher](const std::vector<RowChange>& changes) {
+    query_watcher->ApplyChanges(changes);
+  });
+  
+  // Full-text indexes are kept in sync by triggers; this only builds them
+  full_text_indexes_ = std::make_unique<FullTextIndexManager>(database_, changes_.get());
+  
   return true;
 }
 
 void DatabaseManager::Close() {
+  // The listeners hear of the last changes while they are all still there
+  if (changes_) {
+    changes_->Flush();
+  }
+  
+  // Cached statements, cursors and watched queries must be finalized before
+  // the connection can close
+  query_watcher_.reset();
+  cursors_.reset();
+  key_values_.reset();
+  statement_cache_.reset();
+  full_text_indexes_.reset();
+  query_cache_.reset();
+  memory_cache_.reset();
+  
+  if (vector_indexes_) {
+    vector_indexes_->Save();
+    vector_indexes_.reset();
+  }
+  changes_.reset();
+  
   if (database_) {
     sqlite3_close(database_);
     database_ = nullptr;
   }
 }
 
-int64_t DatabaseManager::Insert(const std::string& table_name,
-                                 FlValue* data,
-                                 const std::string& space) {
-  if (!database_ || fl_value_get_type(data) != FL_VALUE_TYPE_MAP) {
+int64_t DatabaseManager::Insert(const std::string& table_name, FlValue* data) {
+  if (!database_ || fl_value_get_type(data) != FL_VALUE_TYPE_MAP ||
+      fl_value_get_length(data) == 0) {
     return -1;
   }
   
-  std::string prefixed_table = GetPrefixedTableName(table_name, space);
-  
-  // Build INSERT statement (simplified)
-  std::string sql = "INSERT INTO " + prefixed_table + " DEFAULT VALUES";
-  
-  sqlite3_stmt* statement;
-  if (sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+  std::string signature;
+  if (!GetInsertSignature(table_name, data, &signature)) {
     return -1;
   }
   
-  int result = sqlite3_step(statement);
-  sqlite3_finalize(statement);
+  ScopedStatement statement = AcquireInsertStatement(table_name, data, signature);
+  if (!statement || !BindInsertValues(statement.get(), data)) {
+    return -1;
+  }
   
-  if (result != SQLITE_DONE) {
+  if (sqlite3_step(statement.get()) != SQLITE_DONE) {
     return -1;
   }
   
   return sqlite3_last_insert_rowid(database_);
 }
 
-FlValue* DatabaseManager::Query(const std::string& sql) {
-  g_autoptr(FlValue) results = fl_value_new_list();
-  
+FlValue* DatabaseManager::Query(const std::string& sql,
+                                FlValue* arguments,
+                                ResultFormat format) {
   if (!database_) {
-    return fl_value_ref(results);
+    return EncodeEmptyResult(format);
   }
   
-  sqlite3_stmt* statement;
-  if (sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
-    return fl_value_ref(results);
+  // Inside a transaction this connection sees its own uncommitted writes
+  QueryCache::Miss miss;
+  bool cacheable = query_cache_ && sqlite3_get_autocommit(database_);
+  if (cacheable) {
+    FlValue* cached = query_cache_->Lookup(database_, sql, arguments, format, &miss);
+    if (cached != nullptr) {
+      return cached;
+    }
   }
   
-  while (sqlite3_step(statement) == SQLITE_ROW) {
-    g_autoptr(FlValue) row = fl_value_new_map();
-    int column_count = sqlite3_column_count(statement);
-    
-    for (int i = 0; i < column_count; i++) {
-      const char* column_name = sqlite3_column_name(statement, i);
-      int column_type = sqlite3_column_type(statement, i);
-      
-      g_autoptr(FlValue) key = fl_value_new_string(column_name);
-      g_autoptr(FlValue) value = nullptr;
-      
-      switch (column_type) {
-        case SQLITE_INTEGER:
-          value = fl_value_new_int(sqlite3_column_int64(statement, i));
-          break;
-        case SQLITE_FLOAT:
-          value = fl_value_new_float(sqlite3_column_double(statement, i));
-          break;
-        case SQLITE_TEXT: {
-          const char* text = reinterpret_cast<const char*>(
-              sqlite3_column_text(statement, i));
-          value = fl_value_new_string(text);
-          break;
-        }
-        case SQLITE_NULL:
-        default:
-          value = fl_value_new_null();
-          break;
-      }
-      
-      fl_value_set_take(row, key, value);
-    }
-    
-    fl_value_append_take(results, row);
+  ScopedStatement statement = statement_cache_->Acquire(sql);
+  if (!statement || !BindArguments(statement.get(), arguments)) {
+    return EncodeEmptyResult(format);
+  }
+  
+  FlValue* result = EncodeResult(statement.get(), format);
+  
+  // Only results read to the end are cached
+  if (cacheable && sqlite3_errcode(database_) == SQLITE_DONE) {
+    query_cache_->Store(miss, result);
   }
   
-  sqlite3_finalize(statement);
-  return fl_value_ref(results);
+  // Dropped or altered tables are not reported as row changes
+  if (!sqlite3_stmt_readonly(statement.get()) && IsSchemaChange(sql)) {
+    key_values_->Reset();
+    if (query_cache_) {
+      query_cache_->InvalidateAll();
+    }
+  }
+  return result;
 }
 
 int DatabaseManager::Update(const std::string& sql, FlValue* arguments) {
   if (!database_) return 0;
   
-  sqlite3_stmt* statement;
-  if (sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+  ScopedStatement statement = statement_cache_->Acquire(sql);
+  if (!statement || !BindArguments(statement.get(), arguments)) {
     return 0;
   }
   
-  sqlite3_step(statement);
-  int changes = sqlite3_changes(database_);
-  sqlite3_finalize(statement);
-  
-  return changes;
+  sqlite3_step(statement.get());
+  return sqlite3_changes(database_);
 }
 
 int DatabaseManager::Delete(const std::string& sql, FlValue* arguments) {
   return Update(sql, arguments);
 }
 
-std::string DatabaseManager::GetPrefixedTableName(const std::string& table_name,
-                                                   const std::string& space) {
-  return space + "_" + table_name;
+FlValue* DatabaseManager::ExecuteBatch(FlValue* operations) {
+  if (!database_ || fl_value_get_type(operations) != FL_VALUE_TYPE_LIST) {
+    last_error_ = "operations must be a list";
+    return nullptr;
+  }
+  
+  size_t count = fl_value_get_length(operations);
+  std::vector<int64_t> row_ids(count, -1);
+  std::vector<int64_t> changes(count, 0);
+  
+  // Nest inside an already open transaction instead of failing on BEGIN
+  bool nested = !sqlite3_get_autocommit(database_);
+  if (!Execute(nested ? "SAVEPOINT batch" : "BEGIN IMMEDIATE")) {
+    last_error_ = sqlite3_errmsg(database_);
+    return nullptr;
+  }
+  if (nested) {
+    changes_->BeginSavepoint();
+  }
+  
+  bool success = true;
+  {
+    std::unordered_map<std::string, ScopedStatement> statements;
+    for (size_t i = 0; i < count && success; i++) {
+      success = ExecuteBatchOperation(fl_value_get_list_value(operations, i), &statements,
+                                      &row_ids[i], &changes[i]);
+    }
+  }
+  
+  if (success) {
+    success = Execute(nested ? "RELEASE batch" : "COMMIT");
+  }
+  
+  if (!success) {
+    if (last_error_.empty()) {
+      last_error_ = sqlite3_errmsg(database_);
+    }
+    Execute(nested ? "ROLLBACK TO batch" : "ROLLBACK");
+    if (nested) {
+      changes_->RollbackToSavepoint();
+      Execute("RELEASE batch");
+    }
+  }
+  if (nested) {
+    changes_->ReleaseSavepoint();
+  }
+  if (!success) {
+    return nullptr;
+  }
+  
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "rowIds",
+                           fl_value_new_int64_list(row_ids.data(), count));
+  fl_value_set_string_take(result, "changes",
+                           fl_value_new_int64_list(changes.data(), count));
+  return fl_value_ref(result);
+}
+
+void DatabaseManager::FlushChanges() {
+  if (changes_) {
+    changes_->Flush();
+  }
+}
+
+StatementCache::Stats DatabaseManager::GetStatementCacheStats() const {
+  if (!statement_cache_) return StatementCache::Stats();
+  return statement_cache_->GetStats();
+}
+
+bool DatabaseManager::Execute(const char* sql) {
+  return sqlite3_exec(database_, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+bool DatabaseManager::ExecuteBatchOperation(
+    FlValue* operation,
+    std::unordered_map<std::string, ScopedStatement>* statements,
+    int64_t* row_id,
+    int64_t* changes) {
+  last_error_.clear();
+  
+  FlValue* type_value = fl_value_lookup_string(operation, "type");
+  FlValue* table_name_value = fl_value_lookup_string(operation, "tableName");
+  if (type_value == nullptr || table_name_value == nullptr ||
+      fl_value_get_type(type_value) != FL_VALUE_TYPE_STRING) {
+    last_error_ = "type and tableName are required";
+    return false;
+  }
+  
+  const gchar* type = fl_value_get_string(type_value);
+  bool is_insert = strcmp(type, "insert") == 0;
+  
+  // Group key: the column signature for inserts; the SQL text already
+  // carries the type, table and columns for updates and deletes
+  std::string key;
+  std::string table_name;
+  FlValue* data = nullptr;
+  FlValue* arguments = nullptr;
+  
+  if (is_insert) {
+    data = fl_value_lookup_string(operation, "data");
+    if (data == nullptr || fl_value_get_type(data) != FL_VALUE_TYPE_MAP ||
+        fl_value_get_length(data) == 0) {
+      last_error_ = "insert requires a non-empty data map";
+      return false;
+    }
+    
+    table_name = fl_value_get_string(table_name_value);
+    if (!GetInsertSignature(table_name, data, &key)) {
+      last_error_ = "data keys must be column names";
+      return false;
+    }
+  } else if (strcmp(type, "update") == 0 || strcmp(type, "delete") == 0) {
+    FlValue* sql_value = fl_value_lookup_string(operation, "sql");
+    if (sql_value == nullptr || fl_value_get_type(sql_value) != FL_VALUE_TYPE_STRING) {
+      last_error_ = std::string(type) + " requires sql";
+      return false;
+    }
+    
+    key = type;
+    key += '\x1f';
+    key += fl_value_get_string(sql_value);
+    arguments = fl_value_lookup_string(operation, "arguments");
+  } else {
+    last_error_ = std::string("Unknown batch operation type: ") + type;
+    return false;
+  }
+  
+  auto it = statements->find(key);
+  if (it == statements->end()) {
+    ScopedStatement statement = is_insert
+        ? AcquireInsertStatement(table_name, data, key)
+        : statement_cache_->Acquire(
+              fl_value_get_string(fl_value_lookup_string(operation, "sql")));
+    if (!statement) {
+      return false;
+    }
+    it = statements->emplace(key, std::move(statement)).first;
+  }
+  
+  sqlite3_stmt* statement = it->second.get();
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+  
+  bool bound = is_insert ? BindInsertValues(statement, data)
+                         : BindArguments(statement, arguments);
+  
+  if (!bound) {
+    last_error_ = "Unsupported argument type";
+    return false;
+  }
+  
+  if (sqlite3_step(statement) != SQLITE_DONE) {
+    return false;
+  }
+  
+  if (is_insert) {
+    *row_id = sqlite3_last_insert_rowid(database_);
+  }
+  *changes = sqlite3_changes(database_);
+  
+  return true;
+}
+
+bool DatabaseManager::GetInsertSignature(const std::string& table_name,
+                                         FlValue* data,
+                                         std::string* signature) {
+  // Leading separator keeps signatures apart from plain SQL cache keys
+  signature->assign("\x1finsert\x1f");
+  signature->append(table_name);
+  
+  size_t column_count = fl_value_get_length(data);
+  for (size_t i = 0; i < column_count; i++) {
+    FlValue* column = fl_value_get_map_key(data, i);
+    if (fl_value_get_type(column) != FL_VALUE_TYPE_STRING) {
+      return false;
+    }
+    signature->push_back('\x1f');
+    signature->append(fl_value_get_string(column));
+  }
+  
+  return true;
+}
+
+ScopedStatement DatabaseManager::AcquireInsertStatement(
+    const std::string& table_name,
+    FlValue* data,
+    const std::string& signature) {
+  // The SQL text is only built the first time a signature is seen
+  return statement_cache_->Acquire(signature, [&]() {
+    std::string sql = "INSERT INTO " + QuoteIdentifier(table_name) + " (";
+    std::string placeholders;
+    
+    size_t column_count = fl_value_get_length(data);
+    for (size_t i = 0; i < column_count; i++) {
+      if (i > 0) {
+        sql += ", ";
+        placeholders += ", ";
+      }
+      sql += QuoteIdentifier(fl_value_get_string(fl_value_get_map_key(data, i)));
+      placeholders += "?";
+    }
+    
+    return sql + ") VALUES (" + placeholders + ")";
+  });
+}
+
+bool DatabaseManager::BindInsertValues(sqlite3_stmt* statement, FlValue* data) {
+  size_t column_count = fl_value_get_length(data);
+  for (size_t i = 0; i < column_count; i++) {
+    if (!BindValue(statement, static_cast<int>(i + 1),
+                   fl_value_get_map_value(data, i))) {
+      return false;
+    }
+  }
+  return true;
 }
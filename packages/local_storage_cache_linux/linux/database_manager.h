@@ -3,31 +3,117 @@
 
 #include <flutter_linux/flutter_linux.h>
 #include <sqlite3.h>
+#include <memory>
 #include <string>
+#include <unordered_map>
+
+#include "change_tracker.h"
+#include "cursor_manager.h"
+#include "database_config.h"
+#include "full_text_index.h"
+#include "key_value_store.h"
+#include "memory_cache.h"
+#include "query_cache.h"
+#include "query_watcher.h"
+#include "result_encoder.h"
+#include "statement_cache.h"
+#include "vector_index_manager.h"
 
 class DatabaseManager {
  public:
   explicit DatabaseManager(const std::string& database_path);
   ~DatabaseManager();
 
-  bool Initialize();
+  bool Initialize(const DatabaseConfig& config = DatabaseConfig());
   void Close();
   
-  int64_t Insert(const std::string& table_name, 
-                 FlValue* data,
-                 const std::string& space);
+  // Inserts `data` into `table_name`, which carries its space prefix
+  // already. Returns the rowid, or -1 on failure.
+  int64_t Insert(const std::string& table_name, FlValue* data);
   
-  FlValue* Query(const std::string& sql);
+  FlValue* Query(const std::string& sql,
+                 FlValue* arguments,
+                 ResultFormat format = ResultFormat::kMaps);
   
   int Update(const std::string& sql, FlValue* arguments);
   int Delete(const std::string& sql, FlValue* arguments);
 
+  // Runs every operation in `operations` inside one transaction, reusing one
+  // statement per (type, table, column signature) group. Returns a map with
+  // parallel "rowIds" and "changes" lists, or nullptr after rolling back if
+  // any operation fails.
+  FlValue* ExecuteBatch(FlValue* operations);
+
+  const std::string& GetLastError() const { return last_error_; }
+
+  StatementCache::Stats GetStatementCacheStats() const;
+
+  // Cursors opened on the writer connection; null until initialized
+  CursorManager* cursors() const { return cursors_.get(); }
+
+  sqlite3* database() const { return database_; }
+
+  // Whether a transaction is open on the writer connection
+  bool InTransaction() const { return database_ && !sqlite3_get_autocommit(database_); }
+
+  // Row changes of committed writes; null until initialized
+  ChangeTracker* changes() const { return changes_.get(); }
+
+  // Shared with the readers, which search the indexes without the writer
+  std::shared_ptr<VectorIndexManager> vector_indexes() const { return vector_indexes_; }
+
+  // Values cached across calls, shared with the readers; null until
+  // initialized
+  std::shared_ptr<MemoryCache> memory_cache() const { return memory_cache_; }
+
+  // Results of read-only queries, shared with the readers; null until
+  // initialized or if disabled
+  std::shared_ptr<QueryCache> query_cache() const { return query_cache_; }
+
+  // Queries Dart watches, re-run after writes to their tables; null until
+  // initialized
+  QueryWatcher* query_watcher() const { return query_watcher_.get(); }
+
+  // setValue and getValue storage; null until initialized
+  KeyValueStore* key_values() const { return key_values_.get(); }
+
+  // Builds full-text indexes on the writer; null until initialized
+  FullTextIndexManager* full_text_indexes() const { return full_text_indexes_.get(); }
+
+  // Hands the rows changed by committed writes to the change listeners.
+  // Called once each call on the writer is done.
+  void FlushChanges();
+
  private:
   std::string database_path_;
   sqlite3* database_;
+  std::unique_ptr<StatementCache> statement_cache_;
+  std::unique_ptr<CursorManager> cursors_;
+  std::unique_ptr<ChangeTracker> changes_;
+  std::shared_ptr<VectorIndexManager> vector_indexes_;
+  std::unique_ptr<FullTextIndexManager> full_text_indexes_;
+  std::shared_ptr<MemoryCache> memory_cache_;
+  std::shared_ptr<QueryCache> query_cache_;
+  std::unique_ptr<KeyValueStore> key_values_;
+  std::unique_ptr<QueryWatcher> query_watcher_;
+  std::string last_error_;
+  
+  bool Execute(const char* sql);
   
-  std::string GetPrefixedTableName(const std::string& table_name, 
-                                   const std::string& space);
+  // Computes the column signature of an insert of `data` into
+  // `table_name`. Fails if any key of `data` is not a string.
+  bool GetInsertSignature(const std::string& table_name,
+                          FlValue* data,
+                          std::string* signature);
+  ScopedStatement AcquireInsertStatement(const std::string& table_name,
+                                         FlValue* data,
+                                         const std::string& signature);
+  bool BindInsertValues(sqlite3_stmt* statement, FlValue* data);
+  bool ExecuteBatchOperation(
+      FlValue* operation,
+      std::unordered_map<std::string, ScopedStatement>* statements,
+      int64_t* row_id,
+      int64_t* changes);
 };
 
 #endif  // DATABASE_MANAGER_H_
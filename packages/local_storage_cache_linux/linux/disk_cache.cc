@@ -0,0 +1,678 @@
+#include "disk_cache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+enum RecordType : uint32_t { kPut = 1, kRemoval = 2 };
+
+struct RecordHeader {
+  uint32_t checksum;  // CRC-32 of everything after it, key and value included
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t type;
+  int64_t expires_at;
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader must not be padded");
+
+const uint32_t* Crc32Table() {
+  static uint32_t table[256];
+  static bool initialized = [] {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+      }
+      table[i] = crc;
+    }
+    return true;
+  }();
+  (void)initialized;
+  return table;
+}
+
+uint32_t Crc32(uint32_t crc, const char* data, size_t size) {
+  const uint32_t* table = Crc32Table();
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+uint32_t RecordChecksum(const RecordHeader& header, const char* key, const char* value) {
+  uint32_t crc = Crc32(0, reinterpret_cast<const char*>(&header) + sizeof(header.checksum),
+                       sizeof(header) - sizeof(header.checksum));
+  crc = Crc32(crc, key, header.key_size);
+  return Crc32(crc, value, header.value_size);
+}
+
+int64_t NowMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+bool IsExpired(int64_t expires_at, int64_t now) {
+  return expires_at != 0 && expires_at <= now;
+}
+
+std::string ErrnoMessage(const char* action) {
+  return std::string(action) + ": " + strerror(errno);
+}
+
+}  // namespace
+
+std::unique_ptr<DiskCache> DiskCache::Open(const std::string& directory,
+                                           EvictionPolicy policy,
+                                           size_t max_entries,
+                                           ExpirationListener listener,
+                                           std::string* error) {
+  if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+    *error = ErrnoMessage("Cannot create disk cache directory");
+    return nullptr;
+  }
+
+  std::unique_ptr<DiskCache> cache(new DiskCache(directory, policy, max_entries));
+  cache->expiration_listener_ = std::move(listener);
+  if (!cache->Load(error)) {
+    return nullptr;
+  }
+  cache->worker_ = std::thread(&DiskCache::RunWorker, cache.get());
+  return cache;
+}
+
+DiskCache::DiskCache(const std::string& directory, EvictionPolicy policy, size_t max_entries)
+    : directory_(directory),
+      policy_(policy == EvictionPolicy::kTinyLfu ? EvictionPolicy::kLru : policy),
+      max_entries_(std::max<size_t>(max_entries, 1)),
+      wheel_(NowMillis()) {}
+
+DiskCache::~DiskCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_wanted_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+
+  while (!segments_.empty()) {
+    CloseSegment(segments_.begin()->first, false);
+  }
+}
+
+std::string DiskCache::SegmentPath(uint32_t id) const {
+  char name[32];
+  snprintf(name, sizeof(name), "segment-%08u.log", id);
+  return directory_ + "/" + name;
+}
+
+bool DiskCache::Load(std::string* error) {
+  DIR* dir = opendir(directory_.c_str());
+  if (dir == nullptr) {
+    *error = ErrnoMessage("Cannot read disk cache directory");
+    return false;
+  }
+  std::vector<uint32_t> ids;
+  while (dirent* entry = readdir(dir)) {
+    unsigned id = 0;
+    char suffix[8] = {0};
+    if (sscanf(entry->d_name, "segment-%8u.%4s", &id, suffix) == 2 && strcmp(suffix, "log") == 0 &&
+        id > 0) {
+      ids.push_back(id);
+    }
+  }
+  closedir(dir);
+  std::sort(ids.begin(), ids.end());
+  if (!ids.empty()) {
+    next_segment_ = ids.back() + 1;
+  }
+
+  for (uint32_t id : ids) {
+    int fd = open(SegmentPath(id).c_str(), O_RDWR | O_CLOEXEC);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) != 0) {
+      *error = ErrnoMessage("Cannot open disk cache segment");
+      if (fd >= 0) {
+        close(fd);
+      }
+      return false;
+    }
+
+    Segment& segment = segments_[id];
+    segment.fd = fd;
+    segment.size = static_cast<uint64_t>(status.st_size);
+    if (segment.size > 0) {
+      void* data = mmap(nullptr, segment.size, PROT_READ, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED) {
+        *error = ErrnoMessage("Cannot map disk cache segment");
+        return false;
+      }
+      segment.data = static_cast<char*>(data);
+      segment.mapped = segment.size;
+    }
+
+    // Whatever follows the first bad record was never fully written
+    uint64_t valid = Replay(id, &segment);
+    if (valid < segment.size) {
+      if (ftruncate(fd, static_cast<off_t>(valid)) != 0) {
+        *error = ErrnoMessage("Cannot truncate disk cache segment");
+        return false;
+      }
+      segment.size = valid;
+    }
+  }
+
+  // Keep appending to the last segment while it has room
+  if (!segments_.empty() && segments_.rbegin()->second.size < kSegmentBytes) {
+    uint32_t id = segments_.rbegin()->first;
+    Segment& segment = segments_.rbegin()->second;
+    void* data = mmap(nullptr, kSegmentBytes, PROT_READ, MAP_SHARED, segment.fd, 0);
+    if (data == MAP_FAILED) {
+      *error = ErrnoMessage("Cannot map disk cache segment");
+      return false;
+    }
+    if (segment.data != nullptr) {
+      munmap(segment.data, segment.mapped);
+    }
+    segment.data = static_cast<char*>(data);
+    segment.mapped = kSegmentBytes;
+    active_ = id;
+    return true;
+  }
+  return OpenSegment(kSegmentBytes, error);
+}
+
+uint64_t DiskCache::Replay(uint32_t id, Segment* segment) {
+  uint64_t offset = 0;
+  while (offset + sizeof(RecordHeader) <= segment->size) {
+    RecordHeader header;
+    memcpy(&header, segment->data + offset, sizeof(header));
+    uint64_t record_size =
+        sizeof(header) + static_cast<uint64_t>(header.key_size) + header.value_size;
+    if (record_size > segment->size - offset || (header.type != kPut && header.type != kRemoval)) {
+      break;
+    }
+    const char* key = segment->data + offset + sizeof(header);
+    if (RecordChecksum(header, key, key + header.key_size) != header.checksum) {
+      break;
+    }
+
+    std::string key_string(key, header.key_size);
+    if (header.type == kPut) {
+      Index(key_string, id, offset, static_cast<uint32_t>(record_size), header.expires_at);
+    } else {
+      auto it = entries_.find(key_string);
+      if (it != entries_.end()) {
+        Unindex(it);
+      }
+    }
+    offset += record_size;
+  }
+  return offset;
+}
+
+bool DiskCache::OpenSegment(uint64_t capacity, std::string* error) {
+  uint32_t id = next_segment_++;
+  int fd = open(SegmentPath(id).c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    *error = ErrnoMessage("Cannot create disk cache segment");
+    return false;
+  }
+
+  // Mapped past the end of the file, which only grows by appends; only the
+  // written part is ever read
+  void* data = mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    *error = ErrnoMessage("Cannot map disk cache segment");
+    close(fd);
+    unlink(SegmentPath(id).c_str());
+    return false;
+  }
+
+  Segment& segment = segments_[id];
+  segment.fd = fd;
+  segment.data = static_cast<char*>(data);
+  segment.mapped = capacity;
+  active_ = id;
+  return true;
+}
+
+void DiskCache::CloseSegment(uint32_t id, bool unlink_file) {
+  auto it = segments_.find(id);
+  if (it == segments_.end()) {
+    return;
+  }
+  if (it->second.data != nullptr) {
+    munmap(it->second.data, it->second.mapped);
+  }
+  close(it->second.fd);
+  if (unlink_file) {
+    unlink(SegmentPath(id).c_str());
+  }
+  segments_.erase(it);
+}
+
+bool DiskCache::Append(bool removal,
+                       const std::string& key,
+                       const char* value,
+                       size_t value_size,
+                       int64_t expires_at,
+                       uint32_t* segment_id,
+                       uint64_t* offset,
+                       std::string* error) {
+  RecordHeader header;
+  header.key_size = static_cast<uint32_t>(key.size());
+  header.value_size = static_cast<uint32_t>(value_size);
+  header.type = removal ? kRemoval : kPut;
+  header.expires_at = expires_at;
+  header.checksum = RecordChecksum(header, key.data(), value);
+
+  std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+  record.append(key);
+  record.append(value, value_size);
+
+  Segment* segment = &segments_[active_];
+  if (segment->size + record.size() > segment->mapped) {
+    uint64_t capacity = record.size() > kSegmentBytes ? record.size() : kSegmentBytes;
+    if (!OpenSegment(capacity, error)) {
+      return false;
+    }
+    segment = &segments_[active_];
+  }
+
+  size_t written_total = 0;
+  while (written_total < record.size()) {
+    ssize_t written = pwrite(segment->fd, record.data() + written_total,
+                             record.size() - written_total,
+                             static_cast<off_t>(segment->size + written_total));
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      *error = ErrnoMessage("Cannot write disk cache segment");
+      // A torn record left behind fails its checksum when replayed
+      int truncated = ftruncate(segment->fd, static_cast<off_t>(segment->size));
+      (void)truncated;
+      return false;
+    }
+    written_total += static_cast<size_t>(written);
+  }
+
+  *segment_id = active_;
+  *offset = segment->size;
+  segment->size += record.size();
+  return true;
+}
+
+void DiskCache::Index(const std::string& key,
+                      uint32_t segment_id,
+                      uint64_t offset,
+                      uint32_t size,
+                      int64_t expires_at) {
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    Release(it->second.segment, it->second.size);
+    Unlink(&it->second);
+    wheel_.Cancel(&it->second);
+  } else {
+    it = entries_.emplace(key, Entry()).first;
+    it->second.key = &it->first;
+  }
+
+  Entry& entry = it->second;
+  entry.segment = segment_id;
+  entry.offset = offset;
+  entry.size = size;
+  entry.deadline = expires_at;
+  Link(&entry);
+  segments_[segment_id].live += size;
+
+  if (expires_at != 0) {
+    wheel_.Schedule(&entry);
+    if (expires_at < wake_at_) {
+      work_wanted_.notify_one();
+    }
+  }
+}
+
+void DiskCache::Unindex(std::unordered_map<std::string, Entry>::iterator it) {
+  Release(it->second.segment, it->second.size);
+  Unlink(&it->second);
+  wheel_.Cancel(&it->second);
+  entries_.erase(it);
+}
+
+void DiskCache::Release(uint32_t id, uint64_t size) {
+  Segment& segment = segments_[id];
+  segment.live -= size;
+  if (id != active_ && segment.live * 2 < segment.size) {
+    work_wanted_.notify_one();
+  }
+}
+
+bool DiskCache::Erase(std::unordered_map<std::string, Entry>::iterator it, std::string* error) {
+  uint32_t segment_id = 0;
+  uint64_t offset = 0;
+  // A key dropped without its removal record would come back on the next
+  // open, so it stays until one is written
+  if (!Append(true, it->first, nullptr, 0, 0, &segment_id, &offset, error)) {
+    return false;
+  }
+  Unindex(it);
+  return true;
+}
+
+void DiskCache::Link(Entry* entry) {
+  if (policy_ != EvictionPolicy::kLfu) {
+    order_.push_front(entry);
+    entry->position = order_.begin();
+    return;
+  }
+
+  auto lowest = buckets_.begin();
+  if (lowest == buckets_.end() || lowest->frequency != 1) {
+    lowest = buckets_.emplace(lowest);
+    lowest->frequency = 1;
+  }
+  lowest->entries.push_front(entry);
+  entry->position = lowest->entries.begin();
+  entry->bucket = lowest;
+}
+
+void DiskCache::Unlink(Entry* entry) {
+  if (policy_ != EvictionPolicy::kLfu) {
+    order_.erase(entry->position);
+    return;
+  }
+
+  entry->bucket->entries.erase(entry->position);
+  if (entry->bucket->entries.empty()) {
+    buckets_.erase(entry->bucket);
+  }
+}
+
+void DiskCache::Touch(Entry* entry) {
+  if (policy_ == EvictionPolicy::kLru) {
+    order_.splice(order_.begin(), order_, entry->position);
+  } else if (policy_ == EvictionPolicy::kLfu) {
+    auto current = entry->bucket;
+    auto next = std::next(current);
+    if (next == buckets_.end() || next->frequency != current->frequency + 1) {
+      next = buckets_.emplace(next);
+      next->frequency = current->frequency + 1;
+    }
+    next->entries.splice(next->entries.begin(), current->entries, entry->position);
+    entry->bucket = next;
+    if (current->entries.empty()) {
+      buckets_.erase(current);
+    }
+  }
+}
+
+DiskCache::Entry* DiskCache::Victim() {
+  if (policy_ == EvictionPolicy::kLfu) {
+    return buckets_.empty() ? nullptr : buckets_.front().entries.back();
+  }
+  return order_.empty() ? nullptr : order_.back();
+}
+
+std::string DiskCache::ValueOf(const Entry& entry) {
+  const Segment& segment = segments_[entry.segment];
+  const char* record = segment.data + entry.offset;
+  size_t value_offset = sizeof(RecordHeader) + entry.key->size();
+  return std::string(record + value_offset, entry.size - value_offset);
+}
+
+bool DiskCache::Get(const std::string& key, std::string* value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  // An expired entry is left for the background thread, which reports it
+  if (it == entries_.end() || IsExpired(it->second.deadline, NowMillis())) {
+    return false;
+  }
+  *value = ValueOf(it->second);
+  Touch(&it->second);
+  return true;
+}
+
+bool DiskCache::Put(const std::string& key,
+                    const std::string& value,
+                    int64_t expires_at,
+                    std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Make room first, so that a new LFU entry is not its own victim
+  bool replacing = entries_.count(key) > 0;
+  while (!entries_.empty() && entries_.size() + (replacing ? 0 : 1) > max_entries_) {
+    Entry* victim = Victim();
+    replacing = replacing && *victim->key != key;
+    if (!Erase(entries_.find(*victim->key), error)) {
+      return false;
+    }
+  }
+
+  uint32_t segment_id = 0;
+  uint64_t offset = 0;
+  if (!Append(false, key, value.data(), value.size(), expires_at, &segment_id, &offset, error)) {
+    return false;
+  }
+  Index(key, segment_id, offset,
+        static_cast<uint32_t>(sizeof(RecordHeader) + key.size() + value.size()), expires_at);
+  return true;
+}
+
+bool DiskCache::Remove(const std::string& key, bool* removed, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  *removed = it != entries_.end() && !IsExpired(it->second.deadline, NowMillis());
+  return it == entries_.end() || Erase(it, error);
+}
+
+bool DiskCache::Clear(std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  wheel_.Clear();
+  entries_.clear();
+  order_.clear();
+  buckets_.clear();
+  while (!segments_.empty()) {
+    CloseSegment(segments_.begin()->first, true);
+  }
+  return OpenSegment(kSegmentBytes, error);
+}
+
+bool DiskCache::RemoveExpired(size_t* removed, std::string* error) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<Expiration> expired;
+  bool succeeded = ExpireDue(&expired, error);
+  *removed = expired.size();
+  NotifyExpired(expired, &lock);
+  return succeeded;
+}
+
+std::vector<std::string> DiskCache::Keys() {
+  std::vector<std::string> keys;
+  ForEachLive([&keys](const Entry& entry) { keys.push_back(*entry.key); });
+  return keys;
+}
+
+std::vector<std::string> DiskCache::Values() {
+  std::vector<std::string> values;
+  ForEachLive([this, &values](const Entry& entry) { values.push_back(ValueOf(entry)); });
+  return values;
+}
+
+void DiskCache::ForEachLive(const std::function<void(const Entry&)>& visit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t now = NowMillis();
+  auto visit_all = [&visit, now](const std::list<Entry*>& entries) {
+    for (const Entry* entry : entries) {
+      if (!IsExpired(entry->deadline, now)) {
+        visit(*entry);
+      }
+    }
+  };
+  if (policy_ == EvictionPolicy::kLfu) {
+    for (auto bucket = buckets_.rbegin(); bucket != buckets_.rend(); ++bucket) {
+      visit_all(bucket->entries);
+    }
+  } else {
+    visit_all(order_);
+  }
+}
+
+void DiskCache::SetMaxEntries(size_t max_entries) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_entries_ = std::max<size_t>(max_entries, 1);
+}
+
+size_t DiskCache::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+DiskCache::Stats DiskCache::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.entries = entries_.size();
+  stats.segments = segments_.size();
+  stats.compactions = compactions_;
+  for (const auto& segment : segments_) {
+    stats.live_bytes += segment.second.live;
+    stats.file_bytes += segment.second.size;
+  }
+  return stats;
+}
+
+bool DiskCache::CompactOne() {
+  uint32_t target = 0;
+  double sparsest = 0.5;
+  for (const auto& segment : segments_) {
+    if (segment.first == active_) {
+      continue;
+    }
+    double live = segment.second.size == 0
+                      ? 0.0
+                      : static_cast<double>(segment.second.live) / segment.second.size;
+    if (live < sparsest || (target == 0 && segment.second.live == 0)) {
+      sparsest = live;
+      target = segment.first;
+    }
+  }
+  if (target == 0) {
+    return false;
+  }
+
+  // Removal records only matter while an older segment may still hold a
+  // value for their key
+  bool oldest = target == segments_.begin()->first;
+  const Segment& segment = segments_[target];
+  uint64_t offset = 0;
+  std::string error;
+  while (offset < segment.size) {
+    RecordHeader header;
+    memcpy(&header, segment.data + offset, sizeof(header));
+    uint64_t record_size =
+        sizeof(header) + static_cast<uint64_t>(header.key_size) + header.value_size;
+    std::string key(segment.data + offset + sizeof(header), header.key_size);
+    const char* value = segment.data + offset + sizeof(header) + header.key_size;
+
+    auto it = entries_.find(key);
+    uint32_t segment_id = 0;
+    uint64_t new_offset = 0;
+    if (header.type == kPut && it != entries_.end() && it->second.segment == target &&
+        it->second.offset == offset) {
+      if (!Append(false, key, value, header.value_size, header.expires_at, &segment_id,
+                  &new_offset, &error)) {
+        return false;
+      }
+      Entry& entry = it->second;
+      segments_[target].live -= entry.size;
+      segments_[segment_id].live += entry.size;
+      entry.segment = segment_id;
+      entry.offset = new_offset;
+    } else if (header.type == kRemoval && !oldest && it == entries_.end()) {
+      if (!Append(true, key, nullptr, 0, 0, &segment_id, &new_offset, &error)) {
+        return false;
+      }
+    }
+    offset += record_size;
+  }
+
+  CloseSegment(target, true);
+  compactions_++;
+  return true;
+}
+
+bool DiskCache::ExpireDue(std::vector<Expiration>* expired, std::string* error) {
+  std::vector<TimingWheel::Timer*> due;
+  wheel_.Advance(NowMillis(), &due);
+  for (size_t i = 0; i < due.size(); i++) {
+    Entry* entry = static_cast<Entry*>(due[i]);
+    Expiration expiration{*entry->key, entry->deadline};
+    if (!Erase(entries_.find(expiration.key), error)) {
+      // This one and the rest stay due for the next attempt
+      for (size_t j = i; j < due.size(); j++) {
+        wheel_.Schedule(due[j]);
+      }
+      return false;
+    }
+    expired->push_back(std::move(expiration));
+  }
+  return true;
+}
+
+void DiskCache::NotifyExpired(const std::vector<Expiration>& expired,
+                              std::unique_lock<std::mutex>* lock) {
+  if (expired.empty() || !expiration_listener_) {
+    return;
+  }
+  ExpirationListener listener = expiration_listener_;
+  lock->unlock();
+  listener(expired);
+  lock->lock();
+}
+
+void DiskCache::RunWorker() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    std::vector<Expiration> expired;
+    std::string error;
+    bool expired_all = ExpireDue(&expired, &error);
+    NotifyExpired(expired, &lock);
+
+    if (CompactOne()) {
+      // Lets waiting calls in between segments
+      lock.unlock();
+      std::this_thread::yield();
+      lock.lock();
+      continue;
+    }
+
+    // Sleeps until the next entry is due, or for good while none is
+    wake_at_ = wheel_.NextDeadline();
+    if (!expired_all) {
+      // Entries left due wait a while rather than being retried at once
+      wake_at_ = std::max(wake_at_, NowMillis() + kExpiryRetryMillis);
+    }
+    if (wake_at_ == INT64_MAX) {
+      work_wanted_.wait(lock);
+    } else {
+      auto deadline = std::chrono::system_clock::time_point(std::chrono::milliseconds(wake_at_));
+      work_wanted_.wait_until(lock, deadline);
+    }
+    wake_at_ = INT64_MAX;
+  }
+}
@@ -0,0 +1,232 @@
+#ifndef DISK_CACHE_H_
+#define DISK_CACHE_H_
+
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_cache.h"
+#include "timing_wheel.h"
+
+// Persistent cache of string values in a directory of append-only segment
+// files, `segment-<id>.log`, behind the Dart DiskCache.
+//
+// Every put, removal and eviction appends one checksummed record to the
+// newest segment; nothing is rewritten in place. An in-memory hash index
+// maps each key to its latest record, and values are read through a
+// read-only mapping of their segment. Opening the cache replays the
+// segments in order to rebuild the index, dropping a torn record at the end
+// of the last one.
+//
+// Eviction keeps entries in O(1) LRU or FIFO lists or LFU frequency buckets
+// (W-TinyLFU evicts like LRU here) and appends a removal record for the
+// victim. Access order and counts are only kept in memory, and start over
+// from write order when the cache is reopened.
+//
+// Entries with an expiry time are scheduled on a timing wheel. A background
+// thread sleeps until the next one is due, then removes every entry due by
+// then and reports them together to the expiration listener; nothing is
+// scanned, and the thread stays asleep while no entry is due. The same
+// thread compacts sealed segments once less than half of their bytes are
+// still referenced, copying the live records to the newest segment and
+// deleting the file.
+//
+// Safe to use from any thread.
+class DiskCache {
+ public:
+  struct Expiration {
+    std::string key;
+    int64_t expired_at;  // Milliseconds since the epoch
+  };
+
+  // Called without the cache locked, from the background thread or
+  // RemoveExpired(), with the entries expired since the last call
+  using ExpirationListener = std::function<void(const std::vector<Expiration>&)>;
+
+  struct Stats {
+    size_t entries = 0;
+    size_t segments = 0;
+    uint64_t live_bytes = 0;  // Bytes of the records the index points to
+    uint64_t file_bytes = 0;
+    uint64_t compactions = 0;
+  };
+
+  // Segments roll over past this size; a larger record gets a segment of
+  // its own
+  static constexpr uint64_t kSegmentBytes = 4 * 1024 * 1024;
+
+  // How long the worker waits before expiring entries again after the
+  // removal record of one could not be written
+  static constexpr int64_t kExpiryRetryMillis = 1000;
+
+  // Opens the cache in `directory`, creating the directory if needed.
+  // Entries found already expired are reported to `listener`, which may be
+  // empty, as soon as it opens. Returns null with `*error` set if the
+  // directory cannot be read or created.
+  static std::unique_ptr<DiskCache> Open(const std::string& directory,
+                                         EvictionPolicy policy,
+                                         size_t max_entries,
+                                         ExpirationListener listener,
+                                         std::string* error);
+
+  ~DiskCache();
+
+  // Disallow copy and assign.
+  DiskCache(const DiskCache&) = delete;
+  DiskCache& operator=(const DiskCache&) = delete;
+
+  // Copies the value of `key` into `*value` and counts the access. Returns
+  // false if there is none or it has expired.
+  bool Get(const std::string& key, std::string* value);
+
+  // `expires_at` is in milliseconds since the epoch, 0 for never
+  bool Put(const std::string& key,
+           const std::string& value,
+           int64_t expires_at,
+           std::string* error);
+
+  bool Remove(const std::string& key, bool* removed, std::string* error);
+
+  bool Clear(std::string* error);
+
+  // Removes the entries already due instead of waiting for the background
+  // thread, and sets `*removed` to how many there were
+  bool RemoveExpired(size_t* removed, std::string* error);
+
+  // Keys and values of the entries not yet expired, in eviction order,
+  // next victim last
+  std::vector<std::string> Keys();
+  std::vector<std::string> Values();
+
+  void SetMaxEntries(size_t max_entries);
+
+  // Unexpired and expired entries not yet removed
+  size_t Size();
+
+  Stats GetStats();
+
+ private:
+  struct Segment {
+    int fd = -1;
+    char* data = nullptr;  // Read-only mapping
+    uint64_t mapped = 0;   // Length of the mapping, at least `size`
+    uint64_t size = 0;     // Bytes written
+    uint64_t live = 0;     // Bytes of records the index points to
+  };
+
+  struct Bucket;
+
+  // Scheduled on `wheel_` while `deadline`, the expiry time, is not 0
+  struct Entry : TimingWheel::Timer {
+    uint32_t segment;
+    uint32_t size;  // Of the whole record
+    uint64_t offset;
+    const std::string* key;  // Owned by the index
+    std::list<Entry*>::iterator position;
+    std::list<Bucket>::iterator bucket;  // LFU only
+  };
+
+  struct Bucket {
+    uint64_t frequency;
+    std::list<Entry*> entries;  // Most recently used first
+  };
+
+  DiskCache(const std::string& directory, EvictionPolicy policy, size_t max_entries);
+
+  std::string SegmentPath(uint32_t id) const;
+
+  // Reads the value of `entry` from its segment
+  std::string ValueOf(const Entry& entry);
+
+  // Visits the unexpired entries in eviction order, next victim last
+  void ForEachLive(const std::function<void(const Entry&)>& visit);
+
+  // Replays every segment into the index
+  bool Load(std::string* error);
+
+  // Scans the records of segment `id`, applying them to the index. Returns
+  // the length of its valid prefix.
+  uint64_t Replay(uint32_t id, Segment* segment);
+
+  // Opens a new segment of at least `capacity` bytes to append to
+  bool OpenSegment(uint64_t capacity, std::string* error);
+  void CloseSegment(uint32_t id, bool unlink);
+
+  // Appends a record, setting `*segment_id` and `*offset` to where it went
+  bool Append(bool removal,
+              const std::string& key,
+              const char* value,
+              size_t value_size,
+              int64_t expires_at,
+              uint32_t* segment_id,
+              uint64_t* offset,
+              std::string* error);
+
+  // Appends a removal record for `key` and drops it from the index. The key
+  // is kept if the record cannot be written.
+  bool Erase(std::unordered_map<std::string, Entry>::iterator it, std::string* error);
+
+  // Points `key` at a record, replacing any previous one
+  void Index(const std::string& key,
+             uint32_t segment_id,
+             uint64_t offset,
+             uint32_t size,
+             int64_t expires_at);
+  void Unindex(std::unordered_map<std::string, Entry>::iterator it);
+
+  // Marks `size` bytes of segment `id` dead, waking the compactor when a
+  // sealed segment gets sparse enough
+  void Release(uint32_t id, uint64_t size);
+
+  void Link(Entry* entry);
+  void Unlink(Entry* entry);
+  void Touch(Entry* entry);
+  Entry* Victim();
+
+  // Removes the entries due by now, appending them to `*expired`. Called
+  // with `mutex_` held.
+  bool ExpireDue(std::vector<Expiration>* expired, std::string* error);
+
+  // Passes `expired` to the listener, unlocking `lock` meanwhile
+  void NotifyExpired(const std::vector<Expiration>& expired, std::unique_lock<std::mutex>* lock);
+
+  // Rewrites the live records of the sparsest sealed segment, if any is
+  // sparse enough, and deletes it. Called with `mutex_` held.
+  bool CompactOne();
+
+  // Body of the background thread
+  void RunWorker();
+
+  const std::string directory_;
+  const EvictionPolicy policy_;
+  size_t max_entries_;
+
+  std::mutex mutex_;
+  std::map<uint32_t, Segment> segments_;
+  uint32_t active_ = 0;
+  uint32_t next_segment_ = 1;  // Ids are never reused
+  std::unordered_map<std::string, Entry> entries_;
+  std::list<Entry*> order_;    // LRU and FIFO: most recent first
+  std::list<Bucket> buckets_;  // LFU: lowest frequency first
+  uint64_t compactions_ = 0;
+  TimingWheel wheel_;
+  ExpirationListener expiration_listener_;
+
+  // Signalled when a segment gets sparse enough to compact or an entry
+  // expires before `wake_at_`
+  std::condition_variable work_wanted_;
+  int64_t wake_at_ = INT64_MAX;
+  bool stopping_ = false;
+  std::thread worker_;
+};
+
+#endif  // DISK_CACHE_H_
@@ -0,0 +1,62 @@
+#include "frequency_sketch.h"
+
+#include <algorithm>
+
+namespace {
+
+// Odd multipliers giving each row its own spread of the hash
+constexpr uint64_t kSeeds[FrequencySketch::kDepth] = {
+    0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL,
+    0xcbf29ce484222325ULL};
+
+}  // namespace
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+  width_ = 16;
+  while (width_ < capacity) {
+    width_ *= 2;
+  }
+  counters_.assign(kDepth * width_, 0);
+  sample_size_ = 10 * std::max<size_t>(capacity, 1);
+}
+
+size_t FrequencySketch::IndexOf(uint64_t hash, int row) const {
+  uint64_t mixed = (hash + kSeeds[row]) * kSeeds[row];
+  mixed ^= mixed >> 32;
+  return row * width_ + (mixed & (width_ - 1));
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+  bool added = false;
+  for (int row = 0; row < kDepth; row++) {
+    uint8_t& counter = counters_[IndexOf(hash, row)];
+    if (counter < kMaxCount) {
+      counter++;
+      added = true;
+    }
+  }
+
+  if (added && ++additions_ >= sample_size_) {
+    Age();
+  }
+}
+
+uint8_t FrequencySketch::Estimate(uint64_t hash) const {
+  uint8_t estimate = kMaxCount;
+  for (int row = 0; row < kDepth; row++) {
+    estimate = std::min(estimate, counters_[IndexOf(hash, row)]);
+  }
+  return estimate;
+}
+
+void FrequencySketch::Age() {
+  for (uint8_t& counter : counters_) {
+    counter >>= 1;
+  }
+  additions_ /= 2;
+}
+
+void FrequencySketch::Clear() {
+  std::fill(counters_.begin(), counters_.end(), 0);
+  additions_ = 0;
+}
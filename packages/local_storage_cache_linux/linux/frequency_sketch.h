@@ -0,0 +1,46 @@
+#ifndef FREQUENCY_SKETCH_H_
+#define FREQUENCY_SKETCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Count-min sketch estimating how often each key hash was seen recently, as
+// used by W-TinyLFU admission.
+//
+// Each hash increments one 4-bit counter in each of four rows, and the
+// estimate is the smallest of the four. Once the increments reach ten times
+// the expected number of distinct keys every counter is halved, so that
+// keys stop counting as popular some time after they stop being used.
+//
+// Not thread-safe.
+class FrequencySketch {
+ public:
+  static constexpr int kDepth = 4;
+  static constexpr uint8_t kMaxCount = 15;
+
+  // `capacity` is the number of keys whose frequency matters, e.g. the
+  // number of entries of the cache
+  explicit FrequencySketch(size_t capacity);
+
+  void Increment(uint64_t hash);
+
+  // The number of increments of `hash`, at most kMaxCount, possibly
+  // overestimated by collisions and lowered by aging
+  uint8_t Estimate(uint64_t hash) const;
+
+  void Clear();
+
+ private:
+  size_t IndexOf(uint64_t hash, int row) const;
+
+  // Halves every counter
+  void Age();
+
+  std::vector<uint8_t> counters_;  // kDepth rows, one byte per counter
+  size_t width_;                   // Counters per row, a power of two
+  size_t sample_size_;
+  size_t additions_ = 0;
+};
+
+#endif  // FREQUENCY_SKETCH_H_
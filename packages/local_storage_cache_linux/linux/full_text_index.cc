@@ -0,0 +1,587 @@
+#include "full_text_index.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <utility>
+
+#include "result_encoder.h"
+#include "sql_util.h"
+#include "value_binding.h"
+#include "vector_search.h"
+
+namespace {
+
+// Rows queued for indexing have a rowid in (built_rowid, last_rowid]; both
+// are NULL once the index is complete
+constexpr char kCreateIndexesTable[] =
+    "CREATE TABLE IF NOT EXISTS _full_text_indexes ("
+    "table_name TEXT PRIMARY KEY, "
+    "columns TEXT NOT NULL, "
+    "tokenizer TEXT NOT NULL, "
+    "prefixes TEXT NOT NULL, "
+    "built_rowid INTEGER, "
+    "last_rowid INTEGER)";
+
+// FTS5 allows at most 64 tokens per snippet
+constexpr int kMaxSnippetTokens = 64;
+
+std::string FullTextTableName(const std::string& table_name) {
+  return table_name + "_fts";
+}
+
+// Quotes `value` as an SQL string literal
+std::string QuoteString(const std::string& value) {
+  std::string quoted = "'";
+  for (char c : value) {
+    quoted += c;
+    if (c == '\'') {
+      quoted += '\'';
+    }
+  }
+  return quoted + "'";
+}
+
+const char* LookupString(FlValue* args, const char* key) {
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+    return nullptr;
+  }
+  return fl_value_get_string(value);
+}
+
+std::string JoinColumns(const std::vector<std::string>& columns) {
+  std::string joined;
+  for (const std::string& column : columns) {
+    joined += (joined.empty() ? "" : ",") + column;
+  }
+  return joined;
+}
+
+std::string JoinPrefixes(const std::vector<int>& prefixes) {
+  std::string joined;
+  for (int prefix : prefixes) {
+    joined += (joined.empty() ? "" : " ") + std::to_string(prefix);
+  }
+  return joined;
+}
+
+// Reads the recorded definition of the index of `table_name`. Returns false
+// if there is none.
+bool ReadDefinition(sqlite3* database,
+                    const std::string& table_name,
+                    FullTextIndexDefinition* definition) {
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database,
+                         "SELECT columns, tokenizer, prefixes FROM _full_text_indexes "
+                         "WHERE table_name = ?",
+                         -1, &statement, nullptr) != SQLITE_OK) {
+    sqlite3_finalize(statement);
+    return false;
+  }
+
+  sqlite3_bind_text(statement, 1, table_name.c_str(), -1, SQLITE_TRANSIENT);
+  bool found = sqlite3_step(statement) == SQLITE_ROW;
+  if (found) {
+    definition->table_name = table_name;
+    definition->columns.clear();
+    std::stringstream columns(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+    std::string column;
+    while (std::getline(columns, column, ',')) {
+      definition->columns.push_back(column);
+    }
+    definition->tokenizer = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
+    definition->prefixes.clear();
+    std::stringstream prefixes(reinterpret_cast<const char*>(sqlite3_column_text(statement, 2)));
+    int prefix;
+    while (prefixes >> prefix) {
+      definition->prefixes.push_back(prefix);
+    }
+  }
+  sqlite3_finalize(statement);
+  return found;
+}
+
+// Checks that `columns` exist in `table_name`, and finds the INTEGER PRIMARY
+// KEY column aliasing its rowid, if it has one
+bool CheckColumns(sqlite3* database,
+                  const std::string& table_name,
+                  const std::vector<std::string>& columns,
+                  std::string* rowid_alias,
+                  std::string* error) {
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database, "SELECT name, type, pk FROM pragma_table_info(?)", -1,
+                         &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database);
+    sqlite3_finalize(statement);
+    return false;
+  }
+
+  sqlite3_bind_text(statement, 1, table_name.c_str(), -1, SQLITE_TRANSIENT);
+  std::vector<std::string> names;
+  std::string integer_key;
+  int key_columns = 0;
+  while (sqlite3_step(statement) == SQLITE_ROW) {
+    names.push_back(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0)));
+    if (sqlite3_column_int(statement, 2) > 0) {
+      key_columns++;
+      const char* type = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
+      if (type != nullptr && sqlite3_stricmp(type, "INTEGER") == 0) {
+        integer_key = names.back();
+      }
+    }
+  }
+  sqlite3_finalize(statement);
+
+  if (names.empty()) {
+    *error = "No such table: " + table_name;
+    return false;
+  }
+  for (const std::string& column : columns) {
+    if (std::find(names.begin(), names.end(), column) == names.end()) {
+      *error = "No such column: " + column;
+      return false;
+    }
+  }
+  *rowid_alias = key_columns == 1 ? integer_key : "";
+  return true;
+}
+
+// SQL condition that `rowid` is not queued for BuildStep(), so the triggers
+// should keep its index entry up to date
+std::string IndexedCondition(const std::string& table_name, const std::string& rowid) {
+  return "NOT EXISTS (SELECT 1 FROM _full_text_indexes WHERE table_name = " +
+         QuoteString(table_name) + " AND " + rowid + " > built_rowid AND " + rowid +
+         " <= last_rowid)";
+}
+
+}  // namespace
+
+bool ParseFullTextIndexDefinition(FlValue* args,
+                                  FullTextIndexDefinition* definition,
+                                  std::string* error) {
+  const char* table_name = LookupString(args, "tableName");
+  FlValue* columns = fl_value_lookup_string(args, "columns");
+  if (table_name == nullptr || columns == nullptr ||
+      fl_value_get_type(columns) != FL_VALUE_TYPE_LIST || fl_value_get_length(columns) == 0) {
+    *error = "tableName and columns are required";
+    return false;
+  }
+  definition->table_name = table_name;
+
+  for (size_t i = 0; i < fl_value_get_length(columns); i++) {
+    FlValue* column = fl_value_get_list_value(columns, i);
+    // Columns are recorded comma-separated
+    if (fl_value_get_type(column) != FL_VALUE_TYPE_STRING ||
+        strchr(fl_value_get_string(column), ',') != nullptr) {
+      *error = "columns must be a list of column names";
+      return false;
+    }
+    definition->columns.push_back(fl_value_get_string(column));
+  }
+
+  const char* tokenizer = LookupString(args, "tokenizer");
+  if (tokenizer != nullptr) {
+    definition->tokenizer = tokenizer;
+  }
+
+  FlValue* prefixes = fl_value_lookup_string(args, "prefixes");
+  if (prefixes != nullptr && fl_value_get_type(prefixes) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(prefixes); i++) {
+      FlValue* prefix = fl_value_get_list_value(prefixes, i);
+      if (fl_value_get_type(prefix) != FL_VALUE_TYPE_INT || fl_value_get_int(prefix) < 1 ||
+          fl_value_get_int(prefix) > 999) {
+        *error = "prefixes must be lengths between 1 and 999";
+        return false;
+      }
+      definition->prefixes.push_back(static_cast<int>(fl_value_get_int(prefix)));
+    }
+  }
+  return true;
+}
+
+bool ParseFullTextSearchRequest(FlValue* args,
+                                FullTextSearchRequest* request,
+                                std::string* error) {
+  const char* table_name = LookupString(args, "tableName");
+  const char* query = LookupString(args, "query");
+  if (table_name == nullptr || query == nullptr || query[0] == '\0') {
+    *error = "tableName and a non-empty query are required";
+    return false;
+  }
+  request->table_name = table_name;
+  request->query = query;
+
+  FlValue* limit = fl_value_lookup_string(args, "limit");
+  if (limit != nullptr) {
+    if (fl_value_get_type(limit) != FL_VALUE_TYPE_INT || fl_value_get_int(limit) <= 0) {
+      *error = "limit must be a positive integer";
+      return false;
+    }
+    request->limit = static_cast<size_t>(fl_value_get_int(limit));
+  }
+
+  const char* filter = LookupString(args, "filterSql");
+  request->filter = filter ? filter : "";
+  request->filter_arguments = fl_value_lookup_string(args, "filterArguments");
+
+  const char* highlight_start = LookupString(args, "highlightStart");
+  if (highlight_start != nullptr) {
+    request->highlight_start = highlight_start;
+  }
+  const char* highlight_end = LookupString(args, "highlightEnd");
+  if (highlight_end != nullptr) {
+    request->highlight_end = highlight_end;
+  }
+  FlValue* snippet_tokens = fl_value_lookup_string(args, "snippetTokens");
+  if (snippet_tokens != nullptr && fl_value_get_type(snippet_tokens) == FL_VALUE_TYPE_INT) {
+    request->snippet_tokens = static_cast<int>(
+        std::min<int64_t>(std::max<int64_t>(fl_value_get_int(snippet_tokens), 1),
+                          kMaxSnippetTokens));
+  }
+  return true;
+}
+
+FlValue* SearchFullText(sqlite3* database,
+                        const FullTextSearchRequest& request,
+                        std::string* error) {
+  FullTextIndexDefinition definition;
+  if (!ReadDefinition(database, request.table_name, &definition)) {
+    *error = "No full-text index on " + request.table_name;
+    return nullptr;
+  }
+  std::string table = QuoteIdentifier(request.table_name);
+  std::string fts = QuoteIdentifier(FullTextTableName(request.table_name));
+
+  // Ranking only reads the index. The filter comes first so its positional
+  // arguments bind from 1, and sees only the table's columns.
+  std::string sql = "SELECT rowid, rank FROM " + fts + " WHERE ";
+  if (!request.filter.empty()) {
+    sql += "rowid IN (SELECT rowid FROM " + table + " WHERE " + request.filter + ") AND ";
+  }
+  sql += fts + " MATCH ? ORDER BY rank LIMIT ?";
+
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database);
+    sqlite3_finalize(statement);
+    return nullptr;
+  }
+
+  int parameter_count = sqlite3_bind_parameter_count(statement);
+  if (!BindArguments(statement, request.filter_arguments) ||
+      sqlite3_bind_text(statement, parameter_count - 1, request.query.c_str(), -1,
+                        SQLITE_STATIC) != SQLITE_OK ||
+      sqlite3_bind_int64(statement, parameter_count,
+                         static_cast<sqlite3_int64>(request.limit)) != SQLITE_OK) {
+    *error = "Failed to bind filter arguments";
+    sqlite3_finalize(statement);
+    return nullptr;
+  }
+
+  std::vector<std::pair<int64_t, double>> ranked;
+  int result;
+  while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
+    ranked.emplace_back(sqlite3_column_int64(statement, 0), sqlite3_column_double(statement, 1));
+  }
+  if (result != SQLITE_DONE) {
+    *error = sqlite3_errmsg(database);
+  }
+  sqlite3_finalize(statement);
+  if (result != SQLITE_DONE) {
+    return nullptr;
+  }
+
+  // Snippets and highlights are only worth computing for the rows returned
+  std::string extract_sql = "SELECT snippet(" + fts + ", -1, ?1, ?2, '...', ?3)";
+  for (size_t i = 0; i < definition.columns.size(); i++) {
+    extract_sql += ", highlight(" + fts + ", " + std::to_string(i) + ", ?1, ?2)";
+  }
+  extract_sql += " FROM " + fts + " WHERE " + fts + " MATCH ?4 AND rowid = ?5";
+  std::string row_sql = "SELECT * FROM " + table + " WHERE rowid = ?";
+
+  sqlite3_stmt* extract = nullptr;
+  sqlite3_stmt* row = nullptr;
+  if (sqlite3_prepare_v2(database, extract_sql.c_str(), -1, &extract, nullptr) != SQLITE_OK ||
+      sqlite3_prepare_v2(database, row_sql.c_str(), -1, &row, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database);
+    sqlite3_finalize(extract);
+    sqlite3_finalize(row);
+    return nullptr;
+  }
+  sqlite3_bind_text(extract, 1, request.highlight_start.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(extract, 2, request.highlight_end.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_int(extract, 3, request.snippet_tokens);
+  sqlite3_bind_text(extract, 4, request.query.c_str(), -1, SQLITE_STATIC);
+
+  FlValue* results = fl_value_new_list();
+  for (const auto& match : ranked) {
+    sqlite3_bind_int64(row, 1, match.first);
+    bool done = false;
+    g_autoptr(FlValue) rows = EncodeRows(row, 1, &done);
+    sqlite3_reset(row);
+
+    sqlite3_bind_int64(extract, 5, match.first);
+    if (fl_value_get_length(rows) == 0 || sqlite3_step(extract) != SQLITE_ROW) {
+      sqlite3_reset(extract);
+      continue;
+    }
+
+    FlValue* highlights = fl_value_new_map();
+    for (size_t i = 0; i < definition.columns.size(); i++) {
+      const unsigned char* text = sqlite3_column_text(extract, static_cast<int>(i) + 1);
+      fl_value_set_string_take(highlights, definition.columns[i].c_str(),
+                               text ? fl_value_new_string(reinterpret_cast<const char*>(text))
+                                    : fl_value_new_null());
+    }
+    const unsigned char* snippet = sqlite3_column_text(extract, 0);
+
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(entry, "score", fl_value_new_float(-match.second));
+    fl_value_set_string_take(entry, "snippet",
+                             fl_value_new_string(snippet ? reinterpret_cast<const char*>(snippet)
+                                                         : ""));
+    fl_value_set_string_take(entry, "highlights", highlights);
+    fl_value_set_string(entry, "row", fl_value_get_list_value(rows, 0));
+    fl_value_append_take(results, entry);
+    sqlite3_reset(extract);
+  }
+
+  sqlite3_finalize(extract);
+  sqlite3_finalize(row);
+  return results;
+}
+
+bool FullTextIndexManager::Execute(const std::string& sql, std::string* error) {
+  char* message = nullptr;
+  if (sqlite3_exec(database_, sql.c_str(), nullptr, nullptr, &message) != SQLITE_OK) {
+    *error = message ? message : sqlite3_errmsg(database_);
+    sqlite3_free(message);
+    return false;
+  }
+  return true;
+}
+
+void FullTextIndexManager::RollBackSavepoint() {
+  std::string ignored;
+  Execute("ROLLBACK TO full_text_index", &ignored);
+  changes_->RollbackToSavepoint();
+  Execute("RELEASE full_text_index", &ignored);
+  changes_->ReleaseSavepoint();
+}
+
+bool FullTextIndexManager::Record(const FullTextIndexDefinition& definition,
+                                  std::string* error) {
+  int64_t first_rowid = 0;
+  int64_t last_rowid = 0;
+  if (!GetRowidRange(database_, definition.table_name, &first_rowid, &last_rowid, error)) {
+    return false;
+  }
+
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database_,
+                         "INSERT OR REPLACE INTO _full_text_indexes "
+                         "(table_name, columns, tokenizer, prefixes, built_rowid, last_rowid) "
+                         "VALUES (?, ?, ?, ?, ?, ?)",
+                         -1, &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database_);
+    sqlite3_finalize(statement);
+    return false;
+  }
+
+  sqlite3_bind_text(statement, 1, definition.table_name.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(statement, 2, JoinColumns(definition.columns).c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(statement, 3, definition.tokenizer.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(statement, 4, JoinPrefixes(definition.prefixes).c_str(), -1,
+                    SQLITE_TRANSIENT);
+  if (first_rowid <= last_rowid) {
+    sqlite3_bind_int64(statement, 5, first_rowid - 1);
+    sqlite3_bind_int64(statement, 6, last_rowid);
+  }
+
+  bool recorded = sqlite3_step(statement) == SQLITE_DONE;
+  if (!recorded) {
+    *error = sqlite3_errmsg(database_);
+  }
+  sqlite3_finalize(statement);
+  return recorded;
+}
+
+bool FullTextIndexManager::Create(const FullTextIndexDefinition& definition,
+                                  std::string* error) {
+  if (!Execute(kCreateIndexesTable, error)) {
+    return false;
+  }
+
+  std::string rowid_alias;
+  if (!CheckColumns(database_, definition.table_name, definition.columns, &rowid_alias, error)) {
+    return false;
+  }
+
+  FullTextIndexDefinition existing;
+  if (ReadDefinition(database_, definition.table_name, &existing)) {
+    if (existing == definition) {
+      return true;
+    }
+    if (!Drop(definition.table_name, error)) {
+      return false;
+    }
+  }
+
+  std::string name = FullTextTableName(definition.table_name);
+  std::string fts = QuoteIdentifier(name);
+  std::string table = QuoteIdentifier(definition.table_name);
+  std::string columns;
+  std::string new_values;
+  std::string old_values;
+  for (const std::string& column : definition.columns) {
+    std::string separator = columns.empty() ? "" : ", ";
+    columns += separator + QuoteIdentifier(column);
+    new_values += separator + "new." + QuoteIdentifier(column);
+    old_values += separator + "old." + QuoteIdentifier(column);
+  }
+
+  std::string create = "CREATE VIRTUAL TABLE " + fts + " USING fts5(" + columns +
+                       ", content=" + QuoteString(definition.table_name) +
+                       ", tokenize=" + QuoteString(definition.tokenizer);
+  if (!definition.prefixes.empty()) {
+    create += ", prefix=" + QuoteString(JoinPrefixes(definition.prefixes));
+  }
+  create += ")";
+
+  // External content must be deleted with the values it was indexed with,
+  // which the old row still has
+  std::string insert_new = "INSERT INTO " + fts + "(rowid, " + columns + ") SELECT new.rowid, " +
+                           new_values + " WHERE " +
+                           IndexedCondition(definition.table_name, "new.rowid") + ";";
+  std::string delete_old = "INSERT INTO " + fts + "(" + fts + ", rowid, " + columns +
+                           ") SELECT 'delete', old.rowid, " + old_values + " WHERE " +
+                           IndexedCondition(definition.table_name, "old.rowid") + ";";
+
+  // Updates that leave the indexed columns and rowid alone skip the index
+  std::string updated_columns = columns;
+  if (!rowid_alias.empty() &&
+      std::find(definition.columns.begin(), definition.columns.end(), rowid_alias) ==
+          definition.columns.end()) {
+    updated_columns += ", " + QuoteIdentifier(rowid_alias);
+  }
+
+  std::string sql = "SAVEPOINT full_text_index; " + create + "; " +
+      "CREATE TRIGGER " + QuoteIdentifier(name + "_insert") + " AFTER INSERT ON " + table +
+      " BEGIN " + insert_new + " END; " +
+      "CREATE TRIGGER " + QuoteIdentifier(name + "_delete") + " AFTER DELETE ON " + table +
+      " BEGIN " + delete_old + " END; " +
+      "CREATE TRIGGER " + QuoteIdentifier(name + "_update") + " AFTER UPDATE OF " +
+      updated_columns + " ON " + table + " BEGIN " + delete_old + " " + insert_new + " END;";
+  changes_->BeginSavepoint();
+  if (!Execute(sql, error) || !Record(definition, error) ||
+      !Execute("RELEASE full_text_index", error)) {
+    RollBackSavepoint();
+    return false;
+  }
+  changes_->ReleaseSavepoint();
+  return true;
+}
+
+bool FullTextIndexManager::Drop(const std::string& table_name, std::string* error) {
+  std::string name = FullTextTableName(table_name);
+  std::string sql = std::string("SAVEPOINT full_text_index; ") + kCreateIndexesTable + "; " +
+                    "DROP TRIGGER IF EXISTS " + QuoteIdentifier(name + "_insert") + "; " +
+                    "DROP TRIGGER IF EXISTS " + QuoteIdentifier(name + "_delete") + "; " +
+                    "DROP TRIGGER IF EXISTS " + QuoteIdentifier(name + "_update") + "; " +
+                    "DROP TABLE IF EXISTS " + QuoteIdentifier(name) + "; " +
+                    "DELETE FROM _full_text_indexes WHERE table_name = " +
+                    QuoteString(table_name) + "; " +
+                    "RELEASE full_text_index";
+  changes_->BeginSavepoint();
+  if (!Execute(sql, error)) {
+    RollBackSavepoint();
+    return false;
+  }
+  changes_->ReleaseSavepoint();
+  return true;
+}
+
+bool FullTextIndexManager::Rebuild(const std::string& table_name, std::string* error) {
+  FullTextIndexDefinition definition;
+  if (!ReadDefinition(database_, table_name, &definition)) {
+    *error = "No full-text index on " + table_name;
+    return false;
+  }
+
+  std::string fts = QuoteIdentifier(FullTextTableName(table_name));
+  changes_->BeginSavepoint();
+  if (!Execute("SAVEPOINT full_text_index; INSERT INTO " + fts + "(" + fts +
+                   ") VALUES ('delete-all')",
+               error) ||
+      !Record(definition, error) || !Execute("RELEASE full_text_index", error)) {
+    RollBackSavepoint();
+    return false;
+  }
+  changes_->ReleaseSavepoint();
+  return true;
+}
+
+bool FullTextIndexManager::BuildStep(size_t max_rows) {
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database_,
+                         "SELECT table_name, columns, built_rowid, last_rowid "
+                         "FROM _full_text_indexes WHERE built_rowid < last_rowid LIMIT 1",
+                         -1, &statement, nullptr) != SQLITE_OK) {
+    // No index was ever created
+    sqlite3_finalize(statement);
+    return false;
+  }
+  if (sqlite3_step(statement) != SQLITE_ROW) {
+    sqlite3_finalize(statement);
+    return false;
+  }
+  std::string table_name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+  std::string columns = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
+  int64_t built_rowid = sqlite3_column_int64(statement, 2);
+  int64_t last_rowid = sqlite3_column_int64(statement, 3);
+  sqlite3_finalize(statement);
+
+  std::string column_list;
+  std::stringstream names(columns);
+  std::string column;
+  while (std::getline(names, column, ',')) {
+    column_list += (column_list.empty() ? "" : ", ") + QuoteIdentifier(column);
+  }
+  std::string table = QuoteIdentifier(table_name);
+
+  // The chunk ends at the `max_rows`th queued row, or the end of the queue
+  std::string sql = "SELECT max(rowid) FROM (SELECT rowid FROM " + table +
+                    " WHERE rowid > ?1 AND rowid <= ?2 ORDER BY rowid LIMIT ?3)";
+  sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr);
+  sqlite3_bind_int64(statement, 1, built_rowid);
+  sqlite3_bind_int64(statement, 2, last_rowid);
+  sqlite3_bind_int64(statement, 3, static_cast<sqlite3_int64>(max_rows));
+  int64_t chunk_end = last_rowid;
+  if (sqlite3_step(statement) == SQLITE_ROW &&
+      sqlite3_column_type(statement, 0) != SQLITE_NULL) {
+    chunk_end = sqlite3_column_int64(statement, 0);
+  }
+  sqlite3_finalize(statement);
+
+  // Rows past the end are indexed by the triggers from now on
+  std::string error;
+  std::string fts = QuoteIdentifier(FullTextTableName(table_name));
+  std::string chunk_end_value = std::to_string(chunk_end);
+  std::string finished = chunk_end >= last_rowid ? "NULL" : chunk_end_value;
+  sql = "SAVEPOINT full_text_index; INSERT INTO " + fts + "(rowid, " + column_list +
+        ") SELECT rowid, " + column_list + " FROM " + table + " WHERE rowid > " +
+        std::to_string(built_rowid) + " AND rowid <= " + chunk_end_value + "; " +
+        "UPDATE _full_text_indexes SET built_rowid = " + finished + ", last_rowid = " +
+        (chunk_end >= last_rowid ? "NULL" : "last_rowid") + " WHERE table_name = " +
+        QuoteString(table_name) + "; RELEASE full_text_index";
+  changes_->BeginSavepoint();
+  if (!Execute(sql, &error)) {
+    RollBackSavepoint();
+    return false;
+  }
+  changes_->ReleaseSavepoint();
+  return true;
+}
@@ -0,0 +1,111 @@
+#ifndef FULL_TEXT_INDEX_H_
+#define FULL_TEXT_INDEX_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <string>
+#include <vector>
+
+#include "change_tracker.h"
+
+// A full-text index over text columns of a table, as recorded in the
+// _full_text_indexes table. A table has at most one; its FTS5 table is named
+// `<table>_fts`.
+struct FullTextIndexDefinition {
+  std::string table_name;
+  std::vector<std::string> columns;
+  std::string tokenizer = "unicode61";
+  std::vector<int> prefixes;  // Prefix lengths indexed for `term*` queries
+
+  bool operator==(const FullTextIndexDefinition& other) const {
+    return table_name == other.table_name && columns == other.columns &&
+           tokenizer == other.tokenizer && prefixes == other.prefixes;
+  }
+};
+
+// Parses the createFullTextIndex arguments. Returns false with `*error` set
+// if they are missing or malformed.
+bool ParseFullTextIndexDefinition(FlValue* args,
+                                  FullTextIndexDefinition* definition,
+                                  std::string* error);
+
+// Arguments of a fullTextSearch call. `filter_arguments` is borrowed from the
+// method call, which outlives the search.
+struct FullTextSearchRequest {
+  std::string table_name;
+  std::string query;  // FTS5 query syntax
+  size_t limit = 20;
+  std::string filter;  // SQL expression rows must satisfy, may be empty.
+  FlValue* filter_arguments = nullptr;
+  std::string highlight_start = "<b>";
+  std::string highlight_end = "</b>";
+  int snippet_tokens = 16;
+};
+
+// Parses the fullTextSearch arguments. Returns false with `*error` set if
+// they are missing or malformed.
+bool ParseFullTextSearchRequest(FlValue* args,
+                                FullTextSearchRequest* request,
+                                std::string* error);
+
+// Runs `request` against the full-text index of its table on `database`,
+// which may be any connection. Returns a list of {"score": double,
+// "snippet": String, "highlights": {column: String}, "row": {...}} maps,
+// best match first, where the score is the negated bm25 rank. Rows of an
+// index still being built are only found once indexed.
+FlValue* SearchFullText(sqlite3* database,
+                        const FullTextSearchRequest& request,
+                        std::string* error);
+
+// Creates and maintains the FTS5 tables of a database.
+//
+// Each index is an external-content FTS5 table that reads its text from the
+// indexed table, kept in sync by insert, update and delete triggers. The
+// rows already in a table when its index is created or rebuilt are indexed
+// by BuildStep() a chunk at a time; until then the triggers leave them
+// alone, and rows written meanwhile are indexed as usual. Progress is
+// recorded in _full_text_indexes, so an interrupted build resumes when the
+// database is next opened.
+//
+// Every method runs on the writer thread.
+class FullTextIndexManager {
+ public:
+  // `database` is the writer connection, whose rows `changes` tracks
+  FullTextIndexManager(sqlite3* database, ChangeTracker* changes)
+      : database_(database), changes_(changes) {}
+
+  // Disallow copy and assign.
+  FullTextIndexManager(const FullTextIndexManager&) = delete;
+  FullTextIndexManager& operator=(const FullTextIndexManager&) = delete;
+
+  // Creates the index and queues the table's rows for BuildStep(). Creating
+  // an index that already exists with the same definition does nothing; a
+  // different definition replaces it.
+  bool Create(const FullTextIndexDefinition& definition, std::string* error);
+
+  bool Drop(const std::string& table_name, std::string* error);
+
+  // Empties the index of `table_name` and queues every row to be indexed
+  // again, for instance after the table was written to with triggers off.
+  bool Rebuild(const std::string& table_name, std::string* error);
+
+  // Indexes up to `max_rows` queued rows in one transaction. Returns false
+  // once no rows are left, or if they cannot be indexed.
+  bool BuildStep(size_t max_rows);
+
+ private:
+  bool Execute(const std::string& sql, std::string* error);
+
+  // Rolls back and releases the full_text_index savepoint every change
+  // runs in
+  void RollBackSavepoint();
+
+  // Records `definition` with every row of its table queued
+  bool Record(const FullTextIndexDefinition& definition, std::string* error);
+
+  sqlite3* database_;
+  ChangeTracker* changes_;
+};
+
+#endif  // FULL_TEXT_INDEX_H_
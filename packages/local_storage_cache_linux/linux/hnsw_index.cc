@@ -0,0 +1,418 @@
+#include "hnsw_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <queue>
+
+namespace {
+
+constexpr char kMagic[4] = {'L', 'S', 'C', 'H'};
+constexpr uint32_t kFormatVersion = 1;
+
+// Levels above this are practically unreachable; a cap keeps Load() honest
+constexpr int kMaxLevel = 32;
+
+// Tombstones below this are never worth a rebuild
+constexpr size_t kMinDeletedForCompaction = 1024;
+
+// Per-thread "visited" marks, reset in O(1) by bumping the epoch so searches
+// on reader threads share nothing
+struct VisitedSet {
+  std::vector<uint32_t> marks;
+  uint32_t epoch = 0;
+
+  void Reset(size_t size) {
+    if (marks.size() < size) {
+      marks.resize(size, 0);
+    }
+    if (++epoch == 0) {
+      std::fill(marks.begin(), marks.end(), 0);
+      epoch = 1;
+    }
+  }
+
+  // Returns false if `node` was already visited
+  bool Visit(uint32_t node) {
+    if (marks[node] == epoch) {
+      return false;
+    }
+    marks[node] = epoch;
+    return true;
+  }
+};
+
+VisitedSet& ThreadVisitedSet() {
+  static thread_local VisitedSet visited;
+  return visited;
+}
+
+}  // namespace
+
+HnswIndex::HnswIndex(size_t dimensions, DistanceMetric metric, const HnswParams& params)
+    : VectorIndex(dimensions, metric), params_(ClampParams(params)), random_(100) {
+  level_multiplier_ = 1.0 / std::log(static_cast<double>(params_.m));
+}
+
+HnswParams HnswIndex::ClampParams(const HnswParams& params) {
+  HnswParams clamped = params;
+  clamped.m = std::max<size_t>(clamped.m, 2);
+  clamped.ef_construction = std::max(clamped.ef_construction, clamped.m);
+  clamped.ef_search = std::max<size_t>(clamped.ef_search, 1);
+  return clamped;
+}
+
+int HnswIndex::RandomLevel() {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double level = -std::log(1.0 - uniform(random_)) * level_multiplier_;
+  return std::min(static_cast<int>(level), kMaxLevel);
+}
+
+HnswIndex::NodeId HnswIndex::GreedyClosest(const float* query, NodeId entry, int level) const {
+  NodeId current = entry;
+  float current_distance = Distance(query, VectorOf(current));
+  bool improved = true;
+  while (improved) {
+    improved = false;
+    for (NodeId neighbor : links_[current][level]) {
+      float distance = Distance(query, VectorOf(neighbor));
+      if (distance < current_distance) {
+        current_distance = distance;
+        current = neighbor;
+        improved = true;
+      }
+    }
+  }
+  return current;
+}
+
+std::vector<HnswIndex::Candidate> HnswIndex::SearchLayer(const float* query,
+                                                         NodeId entry,
+                                                         size_t ef,
+                                                         int level,
+                                                         bool include_deleted) const {
+  auto closer = [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; };
+  auto farther = [](const Candidate& a, const Candidate& b) { return a.distance > b.distance; };
+
+  // Frontier ordered closest first, results farthest first so the cut-off is
+  // always at the top
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(farther)> frontier(farther);
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(closer)> results(closer);
+
+  VisitedSet& visited = ThreadVisitedSet();
+  visited.Reset(rowids_.size());
+  visited.Visit(entry);
+
+  float entry_distance = Distance(query, VectorOf(entry));
+  frontier.push(Candidate{entry_distance, entry});
+  if (include_deleted || !deleted_[entry]) {
+    results.push(Candidate{entry_distance, entry});
+  }
+
+  while (!frontier.empty()) {
+    Candidate current = frontier.top();
+    if (results.size() >= ef && current.distance > results.top().distance) {
+      break;
+    }
+    frontier.pop();
+
+    for (NodeId neighbor : links_[current.node][level]) {
+      if (!visited.Visit(neighbor)) {
+        continue;
+      }
+
+      float distance = Distance(query, VectorOf(neighbor));
+      if (results.size() < ef || distance < results.top().distance) {
+        frontier.push(Candidate{distance, neighbor});
+        if (include_deleted || !deleted_[neighbor]) {
+          results.push(Candidate{distance, neighbor});
+          if (results.size() > ef) {
+            results.pop();
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<Candidate> sorted(results.size());
+  for (size_t i = sorted.size(); i > 0; i--) {
+    sorted[i - 1] = results.top();
+    results.pop();
+  }
+  return sorted;
+}
+
+std::vector<HnswIndex::NodeId> HnswIndex::SelectNeighbors(std::vector<Candidate> candidates,
+                                                          size_t count) const {
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+
+  std::vector<NodeId> selected;
+  selected.reserve(count);
+  for (const Candidate& candidate : candidates) {
+    if (selected.size() >= count) {
+      break;
+    }
+
+    bool diverse = true;
+    for (NodeId kept : selected) {
+      if (Distance(VectorOf(candidate.node), VectorOf(kept)) < candidate.distance) {
+        diverse = false;
+        break;
+      }
+    }
+    if (diverse) {
+      selected.push_back(candidate.node);
+    }
+  }
+  return selected;
+}
+
+void HnswIndex::Link(NodeId node, NodeId neighbor, int level) {
+  std::vector<NodeId>& links = links_[node][level];
+  links.push_back(neighbor);
+  if (links.size() <= MaxLinks(level)) {
+    return;
+  }
+
+  // Over capacity: keep the most diverse subset of the old links plus the new
+  std::vector<Candidate> candidates;
+  candidates.reserve(links.size());
+  for (NodeId linked : links) {
+    candidates.push_back(Candidate{Distance(VectorOf(node), VectorOf(linked)), linked});
+  }
+  links = SelectNeighbors(std::move(candidates), MaxLinks(level));
+}
+
+void HnswIndex::Insert(int64_t rowid, const float* prepared) {
+  NodeId node = static_cast<NodeId>(rowids_.size());
+  int level = RandomLevel();
+
+  vectors_.insert(vectors_.end(), prepared, prepared + dimensions_);
+  rowids_.push_back(rowid);
+  deleted_.push_back(0);
+  links_.emplace_back(level + 1);
+  by_rowid_[rowid] = node;
+
+  if (max_level_ < 0) {
+    entry_point_ = node;
+    max_level_ = level;
+    return;
+  }
+
+  NodeId entry = entry_point_;
+  for (int l = max_level_; l > level; l--) {
+    entry = GreedyClosest(prepared, entry, l);
+  }
+
+  for (int l = std::min(level, max_level_); l >= 0; l--) {
+    std::vector<Candidate> candidates =
+        SearchLayer(prepared, entry, params_.ef_construction, l, true);
+    entry = candidates.front().node;
+
+    std::vector<NodeId> neighbors = SelectNeighbors(std::move(candidates), params_.m);
+    for (NodeId neighbor : neighbors) {
+      Link(neighbor, node, l);
+    }
+    links_[node][l] = std::move(neighbors);
+  }
+
+  if (level > max_level_) {
+    entry_point_ = node;
+    max_level_ = level;
+  }
+}
+
+void HnswIndex::Upsert(int64_t rowid, const float* vector) {
+  Remove(rowid);
+
+  std::vector<float> prepared;
+  Prepare(vector, &prepared);
+  Insert(rowid, prepared.data());
+}
+
+bool HnswIndex::Remove(int64_t rowid) {
+  auto it = by_rowid_.find(rowid);
+  if (it == by_rowid_.end()) {
+    return false;
+  }
+
+  deleted_[it->second] = 1;
+  by_rowid_.erase(it);
+
+  size_t deleted = rowids_.size() - by_rowid_.size();
+  if (deleted >= kMinDeletedForCompaction && deleted > by_rowid_.size()) {
+    Compact();
+  }
+  return true;
+}
+
+void HnswIndex::Compact() {
+  HnswIndex compacted(dimensions_, metric_, params_);
+  compacted.vectors_.reserve(by_rowid_.size() * dimensions_);
+  for (NodeId node = 0; node < rowids_.size(); node++) {
+    if (!deleted_[node]) {
+      // Stored vectors are already prepared
+      compacted.Insert(rowids_[node], VectorOf(node));
+    }
+  }
+
+  vectors_ = std::move(compacted.vectors_);
+  rowids_ = std::move(compacted.rowids_);
+  deleted_ = std::move(compacted.deleted_);
+  links_ = std::move(compacted.links_);
+  by_rowid_ = std::move(compacted.by_rowid_);
+  entry_point_ = compacted.entry_point_;
+  max_level_ = compacted.max_level_;
+}
+
+std::vector<VectorMatch> HnswIndex::Search(const float* query,
+                                           size_t k,
+                                           size_t ef_search) const {
+  std::vector<VectorMatch> matches;
+  if (by_rowid_.empty() || k == 0) {
+    return matches;
+  }
+
+  std::vector<float> prepared;
+  Prepare(query, &prepared);
+
+  NodeId entry = entry_point_;
+  for (int l = max_level_; l > 0; l--) {
+    entry = GreedyClosest(prepared.data(), entry, l);
+  }
+
+  size_t ef = std::max(ef_search == 0 ? params_.ef_search : ef_search, k);
+  std::vector<Candidate> candidates = SearchLayer(prepared.data(), entry, ef, 0, false);
+
+  size_t count = std::min(k, candidates.size());
+  matches.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    matches.push_back(VectorMatch{ToPublicDistance(candidates[i].distance),
+                                  rowids_[candidates[i].node]});
+  }
+  return matches;
+}
+
+void HnswIndex::ForEach(
+    const std::function<void(int64_t rowid, const float* vector)>& visit) const {
+  for (NodeId node = 0; node < rowids_.size(); node++) {
+    if (!deleted_[node]) {
+      visit(rowids_[node], VectorOf(node));
+    }
+  }
+}
+
+bool HnswIndex::Save(FILE* file) const {
+  uint32_t node_count = static_cast<uint32_t>(rowids_.size());
+  bool ok = fwrite(kMagic, sizeof(kMagic), 1, file) == 1 &&
+            WriteValue(file, kFormatVersion) &&
+            WriteValue(file, static_cast<uint32_t>(dimensions_)) &&
+            WriteValue(file, static_cast<uint32_t>(metric_)) &&
+            WriteValue(file, static_cast<uint32_t>(params_.m)) &&
+            WriteValue(file, static_cast<uint32_t>(params_.ef_construction)) &&
+            WriteValue(file, static_cast<uint32_t>(params_.ef_search)) &&
+            WriteValue(file, node_count) &&
+            WriteValue(file, entry_point_) &&
+            WriteValue(file, static_cast<int32_t>(max_level_));
+  if (!ok || node_count == 0) {
+    return ok;
+  }
+
+  ok = fwrite(rowids_.data(), sizeof(int64_t), node_count, file) == node_count &&
+       fwrite(deleted_.data(), sizeof(uint8_t), node_count, file) == node_count &&
+       fwrite(vectors_.data(), sizeof(float), vectors_.size(), file) == vectors_.size();
+  for (NodeId node = 0; ok && node < node_count; node++) {
+    ok = WriteValue(file, static_cast<uint32_t>(links_[node].size()));
+    for (const std::vector<NodeId>& links : links_[node]) {
+      ok = ok && WriteValue(file, static_cast<uint32_t>(links.size())) &&
+           (links.empty() ||
+            fwrite(links.data(), sizeof(NodeId), links.size(), file) == links.size());
+    }
+  }
+  return ok;
+}
+
+std::unique_ptr<HnswIndex> HnswIndex::Load(FILE* file) {
+  char magic[sizeof(kMagic)];
+  uint32_t version, dimensions, metric, m, ef_construction, ef_search, node_count, entry_point;
+  int32_t max_level;
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !ReadValue(file, &version) || version != kFormatVersion ||
+      !ReadValue(file, &dimensions) || !ReadValue(file, &metric) || !ReadValue(file, &m) ||
+      !ReadValue(file, &ef_construction) || !ReadValue(file, &ef_search) ||
+      !ReadValue(file, &node_count) || !ReadValue(file, &entry_point) || !ReadValue(file, &max_level)) {
+    return nullptr;
+  }
+  if (dimensions == 0 || metric > static_cast<uint32_t>(DistanceMetric::kDotProduct) ||
+      max_level > kMaxLevel || (node_count == 0) != (max_level < 0) ||
+      (node_count > 0 && entry_point >= node_count)) {
+    return nullptr;
+  }
+
+  HnswParams params;
+  params.m = m;
+  params.ef_construction = ef_construction;
+  params.ef_search = ef_search;
+  std::unique_ptr<HnswIndex> index(
+      new HnswIndex(dimensions, static_cast<DistanceMetric>(metric), params));
+  if (node_count == 0) {
+    return index;
+  }
+
+  index->rowids_.resize(node_count);
+  index->deleted_.resize(node_count);
+  index->vectors_.resize(static_cast<size_t>(node_count) * dimensions);
+  if (fread(index->rowids_.data(), sizeof(int64_t), node_count, file) != node_count ||
+      fread(index->deleted_.data(), sizeof(uint8_t), node_count, file) != node_count ||
+      fread(index->vectors_.data(), sizeof(float), index->vectors_.size(), file) !=
+          index->vectors_.size()) {
+    return nullptr;
+  }
+
+  index->links_.resize(node_count);
+  for (NodeId node = 0; node < node_count; node++) {
+    uint32_t levels;
+    if (!ReadValue(file, &levels) || levels == 0 || levels > static_cast<uint32_t>(max_level) + 1) {
+      return nullptr;
+    }
+
+    index->links_[node].resize(levels);
+    for (uint32_t level = 0; level < levels; level++) {
+      uint32_t count;
+      if (!ReadValue(file, &count) || count > index->MaxLinks(level)) {
+        return nullptr;
+      }
+      std::vector<NodeId>& links = index->links_[node][level];
+      links.resize(count);
+      if (count > 0 && fread(links.data(), sizeof(NodeId), count, file) != count) {
+        return nullptr;
+      }
+    }
+
+    if (!index->deleted_[node]) {
+      index->by_rowid_[index->rowids_[node]] = node;
+    }
+  }
+
+  // Every link has to land on a node that has the level too
+  for (NodeId node = 0; node < node_count; node++) {
+    for (size_t level = 0; level < index->links_[node].size(); level++) {
+      for (NodeId neighbor : index->links_[node][level]) {
+        if (neighbor >= node_count || index->links_[neighbor].size() <= level) {
+          return nullptr;
+        }
+      }
+    }
+  }
+  if (index->links_[entry_point].size() != static_cast<size_t>(max_level) + 1) {
+    return nullptr;
+  }
+
+  index->entry_point_ = entry_point;
+  index->max_level_ = max_level;
+  index->random_.seed(node_count);
+  return index;
+}
@@ -0,0 +1,104 @@
+#ifndef HNSW_INDEX_H_
+#define HNSW_INDEX_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "vector_index.h"
+
+// Tuning of an HNSW graph (VectorIndexConfig.parameters).
+struct HnswParams {
+  // Links per node on the upper layers; layer 0 keeps twice as many
+  size_t m = 16;
+  // Candidate list size while inserting; higher builds a better graph, slower
+  size_t ef_construction = 200;
+  // Default candidate list size while searching; trades latency for recall
+  size_t ef_search = 64;
+};
+
+// Hierarchical Navigable Small World graph (Malkov & Yashunin) over
+// single-precision vectors, for approximate nearest neighbour search in
+// roughly logarithmic time.
+//
+// Vectors are kept in memory next to the graph. Removed rows are tombstoned:
+// they keep routing searches but are never returned, and the graph is rebuilt
+// once they outnumber the live rows.
+class HnswIndex : public VectorIndex {
+ public:
+  HnswIndex(size_t dimensions, DistanceMetric metric, const HnswParams& params);
+
+  void Upsert(int64_t rowid, const float* vector) override;
+  bool Remove(int64_t rowid) override;
+
+  // `ef_search` is raised to at least `k`
+  std::vector<VectorMatch> Search(const float* query,
+                                  size_t k,
+                                  size_t ef_search) const override;
+
+  void ForEach(
+      const std::function<void(int64_t rowid, const float* vector)>& visit) const override;
+
+  size_t size() const override { return by_rowid_.size(); }
+  const HnswParams& params() const { return params_; }
+
+  // `params` raised to the smallest values the graph works with
+  static HnswParams ClampParams(const HnswParams& params);
+
+  bool Save(FILE* file) const override;
+
+  // Returns nullptr if `file` does not hold a valid index.
+  static std::unique_ptr<HnswIndex> Load(FILE* file);
+
+ private:
+  using NodeId = uint32_t;
+
+  struct Candidate {
+    float distance;
+    NodeId node;
+  };
+
+  const float* VectorOf(NodeId node) const {
+    return vectors_.data() + static_cast<size_t>(node) * dimensions_;
+  }
+
+  size_t MaxLinks(int level) const { return level == 0 ? 2 * params_.m : params_.m; }
+
+  int RandomLevel();
+  NodeId GreedyClosest(const float* query, NodeId entry, int level) const;
+
+  // Best-first search of one layer; returns up to `ef` candidates, closest
+  // first. Tombstones are traversed but only returned if `include_deleted`.
+  std::vector<Candidate> SearchLayer(const float* query,
+                                     NodeId entry,
+                                     size_t ef,
+                                     int level,
+                                     bool include_deleted) const;
+
+  // Keeps up to `count` candidates, each closer to the node being linked
+  // (their `distance`) than to any candidate already kept, so links spread out
+  // in different directions
+  std::vector<NodeId> SelectNeighbors(std::vector<Candidate> candidates, size_t count) const;
+
+  void Link(NodeId node, NodeId neighbor, int level);
+  void Insert(int64_t rowid, const float* prepared);
+  void Compact();
+
+  HnswParams params_;
+  double level_multiplier_;
+  std::mt19937_64 random_;
+
+  std::vector<float> vectors_;
+  std::vector<int64_t> rowids_;
+  std::vector<uint8_t> deleted_;
+  std::vector<std::vector<std::vector<NodeId>>> links_;  // [node][level]
+  std::unordered_map<int64_t, NodeId> by_rowid_;
+  NodeId entry_point_ = 0;
+  int max_level_ = -1;
+};
+
+#endif  // HNSW_INDEX_H_
@@ -0,0 +1,476 @@
+#include "ivf_flat_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <utility>
+
+namespace {
+
+constexpr char kMagic[4] = {'L', 'S', 'C', 'I'};
+constexpr uint32_t kFormatVersion = 2;
+
+// Below this many vectors a single exhaustively scanned list is as fast
+constexpr size_t kMinTrainingSize = 256;
+
+// k-means needs a few dozen points per centroid to place it well, and gains
+// little from more than a few hundred
+constexpr size_t kMinPointsPerList = 39;
+constexpr size_t kMaxPointsPerList = 256;
+
+constexpr size_t kTrainingIterations = 20;
+
+// New vectors this much further from their centroids than the training set
+// mean the centroids no longer fit the data
+constexpr double kDriftRatio = 1.5;
+constexpr size_t kMinDriftSample = 256;
+
+// Keeps Load() from allocating for a corrupt list count
+constexpr uint32_t kMaxLists = 1u << 20;
+
+// Assignments per thread worth the cost of starting it
+constexpr size_t kMinItemsPerThread = 256;
+
+}  // namespace
+
+IvfFlatIndex::IvfFlatIndex(size_t dimensions,
+                           DistanceMetric metric,
+                           const IvfFlatParams& params)
+    : VectorIndex(dimensions, metric),
+      params_(ClampParams(params)),
+      quantizer_(dimensions, metric, params_.quantization, params_.pq_subvectors),
+      code_words_(quantizer_.code_words()),
+      lists_(1) {
+  params_.pq_subvectors = quantizer_.subvectors();
+}
+
+IvfFlatParams IvfFlatIndex::ClampParams(const IvfFlatParams& params) {
+  IvfFlatParams clamped = params;
+  clamped.nlist = std::min<size_t>(clamped.nlist, kMaxLists);
+  clamped.nprobe = std::max<size_t>(clamped.nprobe, 1);
+  clamped.rerank = std::max<size_t>(clamped.rerank, 1);
+  return clamped;
+}
+
+uint32_t IvfFlatIndex::Nearest(const float* prepared,
+                               const float* centroids,
+                               size_t count) const {
+  uint32_t nearest = 0;
+  float nearest_distance = std::numeric_limits<float>::infinity();
+  for (size_t i = 0; i < count; i++) {
+    float distance = Distance(prepared, centroids + i * dimensions_);
+    if (distance < nearest_distance) {
+      nearest_distance = distance;
+      nearest = static_cast<uint32_t>(i);
+    }
+  }
+  return nearest;
+}
+
+void IvfFlatIndex::Append(uint32_t list, int64_t rowid, const float* code) {
+  InvertedList& inverted = lists_[list];
+  locations_[rowid] = Location{list, static_cast<uint32_t>(inverted.rowids.size())};
+  inverted.rowids.push_back(rowid);
+  inverted.codes.insert(inverted.codes.end(), code, code + code_words_);
+}
+
+void IvfFlatIndex::Upsert(int64_t rowid, const float* vector) {
+  Remove(rowid);
+
+  std::vector<float> prepared;
+  Prepare(vector, &prepared);
+  std::vector<float> code(code_words_);
+  quantizer_.Encode(prepared.data(), code.data());
+  if (!trained()) {
+    Append(0, rowid, code.data());
+    return;
+  }
+
+  uint32_t list = Nearest(prepared.data(), centroids_.data(), ListCount());
+  Append(list, rowid, code.data());
+  added_error_ += kernels_.squared_l2(prepared.data(), &centroids_[list * dimensions_],
+                                      dimensions_);
+  added_count_++;
+}
+
+bool IvfFlatIndex::Remove(int64_t rowid) {
+  auto it = locations_.find(rowid);
+  if (it == locations_.end()) {
+    return false;
+  }
+
+  // The last entry of the list moves into the hole
+  Location location = it->second;
+  locations_.erase(it);
+  InvertedList& inverted = lists_[location.list];
+  size_t last = inverted.rowids.size() - 1;
+  if (location.slot != last) {
+    int64_t moved = inverted.rowids[last];
+    inverted.rowids[location.slot] = moved;
+    std::copy(inverted.codes.begin() + last * code_words_, inverted.codes.end(),
+              inverted.codes.begin() + location.slot * code_words_);
+    locations_[moved].slot = location.slot;
+  }
+  inverted.rowids.pop_back();
+  inverted.codes.resize(last * code_words_);
+  return true;
+}
+
+std::vector<VectorMatch> IvfFlatIndex::Search(const float* query,
+                                              size_t k,
+                                              size_t nprobe) const {
+  std::vector<VectorMatch> matches;
+  if (locations_.empty() || k == 0) {
+    return matches;
+  }
+
+  std::vector<float> prepared;
+  Prepare(query, &prepared);
+
+  // Closest centroids first; an untrained index has just the one list
+  std::vector<std::pair<float, uint32_t>> probes;
+  probes.reserve(ListCount());
+  for (uint32_t list = 0; list < ListCount(); list++) {
+    float distance =
+        trained() ? Distance(prepared.data(), &centroids_[list * dimensions_]) : 0;
+    probes.emplace_back(distance, list);
+  }
+  size_t probe_count = std::min(nprobe == 0 ? params_.nprobe : nprobe, probes.size());
+  std::partial_sort(probes.begin(), probes.begin() + probe_count, probes.end());
+
+  VectorQuantizer::Scanner scanner(quantizer_, prepared.data());
+  TopK top(k);
+  for (size_t i = 0; i < probe_count; i++) {
+    const InvertedList& inverted = lists_[probes[i].second];
+    const float* code = inverted.codes.data();
+    for (size_t slot = 0; slot < inverted.rowids.size(); slot++, code += code_words_) {
+      float distance = scanner.Distance(code);
+      if (top.Accepts(distance)) {
+        top.Push(distance, inverted.rowids[slot]);
+      }
+    }
+  }
+
+  matches = top.Sorted();
+  for (VectorMatch& match : matches) {
+    match.distance = ToPublicDistance(match.distance);
+  }
+  return matches;
+}
+
+void IvfFlatIndex::ForEach(
+    const std::function<void(int64_t rowid, const float* vector)>& visit) const {
+  std::vector<float> vector(dimensions_);
+  for (const InvertedList& inverted : lists_) {
+    for (size_t slot = 0; slot < inverted.rowids.size(); slot++) {
+      const float* code = &inverted.codes[slot * code_words_];
+      if (!quantizer_.compressed()) {
+        visit(inverted.rowids[slot], code);
+        continue;
+      }
+      quantizer_.Decode(code, vector.data());
+      visit(inverted.rowids[slot], vector.data());
+    }
+  }
+}
+
+bool IvfFlatIndex::Find(int64_t rowid, std::vector<float>* vector) const {
+  auto it = locations_.find(rowid);
+  if (it == locations_.end()) {
+    return false;
+  }
+  vector->resize(dimensions_);
+  quantizer_.Decode(&lists_[it->second.list].codes[it->second.slot * code_words_],
+                    vector->data());
+  return true;
+}
+
+bool IvfFlatIndex::NeedsTraining() const {
+  if (!trained()) {
+    return size() >= kMinTrainingSize;
+  }
+  if (size() >= 2 * trained_size_) {
+    return true;
+  }
+  return added_count_ >= std::max(kMinDriftSample, trained_size_ / 10) &&
+         added_error_ / added_count_ > kDriftRatio * trained_error_;
+}
+
+void IvfFlatIndex::Train() {
+  size_t count = size();
+  if (count < kMinTrainingSize) {
+    return;
+  }
+
+  size_t lists = params_.nlist != 0
+      ? params_.nlist
+      : static_cast<size_t>(std::lround(std::sqrt(static_cast<double>(count))));
+  lists = std::max<size_t>(std::min(lists, count / kMinPointsPerList), 1);
+
+  // Random sample, reproducible for a given size. Codebooks need a few
+  // hundred points whatever the number of lists.
+  std::vector<const float*> codes;
+  codes.reserve(count);
+  for (const InvertedList& inverted : lists_) {
+    for (size_t slot = 0; slot < inverted.rowids.size(); slot++) {
+      codes.push_back(&inverted.codes[slot * code_words_]);
+    }
+  }
+  size_t sample_count = std::min(count, std::max(lists, kMinPointsPerList) * kMaxPointsPerList);
+  std::mt19937_64 random(count);
+  std::vector<float> sample(sample_count * dimensions_);
+  for (size_t i = 0; i < sample_count; i++) {
+    std::swap(codes[i], codes[i + random() % (count - i)]);
+    quantizer_.Decode(codes[i], &sample[i * dimensions_]);
+  }
+
+  VectorQuantizer quantizer = quantizer_;
+  quantizer.Train(sample.data(), sample_count);
+  size_t list_sample_count = std::min(sample_count, lists * kMaxPointsPerList);
+  Reassign(RunKMeans(sample, list_sample_count, lists), quantizer);
+}
+
+std::vector<float> IvfFlatIndex::RunKMeans(const std::vector<float>& sample,
+                                           size_t count,
+                                           size_t lists) const {
+  // The sample is in random order, so its head makes a random start
+  std::vector<float> centroids(sample.begin(), sample.begin() + lists * dimensions_);
+  std::vector<uint32_t> assignments(count, std::numeric_limits<uint32_t>::max());
+  std::mt19937_64 random(lists);
+
+  for (size_t iteration = 0; iteration < kTrainingIterations; iteration++) {
+    std::vector<uint8_t> changed(count, 0);
+    ParallelFor(count, kMinItemsPerThread, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        uint32_t list = Nearest(&sample[i * dimensions_], centroids.data(), lists);
+        changed[i] = list != assignments[i];
+        assignments[i] = list;
+      }
+    });
+    if (iteration > 0 && std::find(changed.begin(), changed.end(), 1) == changed.end()) {
+      break;
+    }
+
+    std::vector<double> sums(lists * dimensions_, 0.0);
+    std::vector<size_t> sizes(lists, 0);
+    for (size_t i = 0; i < count; i++) {
+      double* sum = &sums[assignments[i] * dimensions_];
+      const float* vector = &sample[i * dimensions_];
+      for (size_t d = 0; d < dimensions_; d++) {
+        sum[d] += vector[d];
+      }
+      sizes[assignments[i]]++;
+    }
+    for (size_t list = 0; list < lists; list++) {
+      if (sizes[list] == 0) {
+        continue;
+      }
+      for (size_t d = 0; d < dimensions_; d++) {
+        centroids[list * dimensions_ + d] =
+            static_cast<float>(sums[list * dimensions_ + d] / sizes[list]);
+      }
+    }
+
+    // An empty list splits a large one in two, nudging both halves apart
+    for (size_t empty = 0; empty < lists; empty++) {
+      if (sizes[empty] != 0) {
+        continue;
+      }
+      size_t split = 0;
+      do {
+        split = random() % lists;
+      } while (sizes[split] < 2 || random() % count >= sizes[split]);
+
+      float* from = &centroids[split * dimensions_];
+      float* to = &centroids[empty * dimensions_];
+      for (size_t d = 0; d < dimensions_; d++) {
+        float nudge = d % 2 == 0 ? 1.0f / 1024 : -1.0f / 1024;
+        to[d] = from[d] * (1 + nudge);
+        from[d] *= 1 - nudge;
+      }
+      sizes[empty] = sizes[split] / 2;
+      sizes[split] -= sizes[empty];
+    }
+
+    // Spherical k-means for cosine: centroids stay on the unit sphere
+    if (metric_ == DistanceMetric::kCosine) {
+      for (size_t list = 0; list < lists; list++) {
+        float* centroid = &centroids[list * dimensions_];
+        float norm = std::sqrt(kernels_.dot(centroid, centroid, dimensions_));
+        if (norm > 0) {
+          for (size_t d = 0; d < dimensions_; d++) {
+            centroid[d] /= norm;
+          }
+        }
+      }
+    }
+  }
+  return centroids;
+}
+
+void IvfFlatIndex::Reassign(std::vector<float> centroids, const VectorQuantizer& quantizer) {
+  size_t lists = centroids.size() / dimensions_;
+  std::vector<std::pair<int64_t, const float*>> entries;
+  entries.reserve(size());
+  for (const InvertedList& inverted : lists_) {
+    for (size_t slot = 0; slot < inverted.rowids.size(); slot++) {
+      entries.emplace_back(inverted.rowids[slot], &inverted.codes[slot * code_words_]);
+    }
+  }
+
+  // Vectors are decoded with the current quantizer and encoded with the new
+  size_t code_words = quantizer.code_words();
+  std::vector<float> codes(entries.size() * code_words);
+  std::vector<uint32_t> assignments(entries.size());
+  std::vector<float> errors(entries.size());
+  ParallelFor(entries.size(), kMinItemsPerThread, [&](size_t begin, size_t end) {
+    std::vector<float> vector(dimensions_);
+    for (size_t i = begin; i < end; i++) {
+      quantizer_.Decode(entries[i].second, vector.data());
+      assignments[i] = Nearest(vector.data(), centroids.data(), lists);
+      errors[i] = kernels_.squared_l2(vector.data(), &centroids[assignments[i] * dimensions_],
+                                      dimensions_);
+      quantizer.Encode(vector.data(), &codes[i * code_words]);
+    }
+  });
+
+  // Sized up front so every list is one allocation
+  std::vector<size_t> sizes(lists, 0);
+  for (uint32_t list : assignments) {
+    sizes[list]++;
+  }
+  quantizer_ = quantizer;
+  code_words_ = code_words;
+  std::vector<InvertedList> previous;
+  previous.swap(lists_);
+  lists_.resize(lists);
+  for (size_t list = 0; list < lists; list++) {
+    lists_[list].rowids.reserve(sizes[list]);
+    lists_[list].codes.reserve(sizes[list] * code_words_);
+  }
+
+  double error = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    Append(assignments[i], entries[i].first, &codes[i * code_words_]);
+    error += errors[i];
+  }
+
+  centroids_ = std::move(centroids);
+  trained_size_ = entries.size();
+  trained_error_ = entries.empty() ? 0 : error / entries.size();
+  added_error_ = 0;
+  added_count_ = 0;
+}
+
+std::unique_ptr<IvfFlatIndex> IvfFlatIndex::Clone() const {
+  std::unique_ptr<IvfFlatIndex> clone(new IvfFlatIndex(dimensions_, metric_, params_));
+  clone->quantizer_ = quantizer_;
+  clone->code_words_ = code_words_;
+  clone->centroids_ = centroids_;
+  clone->lists_ = lists_;
+  clone->locations_ = locations_;
+  clone->trained_size_ = trained_size_;
+  clone->trained_error_ = trained_error_;
+  clone->added_error_ = added_error_;
+  clone->added_count_ = added_count_;
+  return clone;
+}
+
+bool IvfFlatIndex::Save(FILE* file) const {
+  uint32_t list_count = static_cast<uint32_t>(ListCount());
+  bool ok = fwrite(kMagic, sizeof(kMagic), 1, file) == 1 &&
+            WriteValue(file, kFormatVersion) &&
+            WriteValue(file, static_cast<uint32_t>(dimensions_)) &&
+            WriteValue(file, static_cast<uint32_t>(metric_)) &&
+            WriteValue(file, static_cast<uint32_t>(params_.nlist)) &&
+            WriteValue(file, static_cast<uint32_t>(params_.nprobe)) &&
+            WriteValue(file, static_cast<uint32_t>(params_.rerank)) &&
+            quantizer_.Save(file) &&
+            WriteValue(file, list_count) &&
+            WriteValue(file, static_cast<uint8_t>(trained())) &&
+            WriteValue(file, static_cast<uint64_t>(trained_size_)) &&
+            WriteValue(file, trained_error_) &&
+            (centroids_.empty() ||
+             fwrite(centroids_.data(), sizeof(float), centroids_.size(), file) ==
+                 centroids_.size());
+  for (const InvertedList& inverted : lists_) {
+    uint32_t count = static_cast<uint32_t>(inverted.rowids.size());
+    ok = ok && WriteValue(file, count) &&
+         (count == 0 ||
+          (fwrite(inverted.rowids.data(), sizeof(int64_t), count, file) == count &&
+           fwrite(inverted.codes.data(), sizeof(float), inverted.codes.size(), file) ==
+               inverted.codes.size()));
+  }
+  return ok;
+}
+
+std::unique_ptr<IvfFlatIndex> IvfFlatIndex::Load(FILE* file) {
+  char magic[sizeof(kMagic)];
+  uint32_t version, dimensions, metric, nlist, nprobe, rerank, list_count;
+  uint8_t trained;
+  uint64_t trained_size;
+  double trained_error;
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !ReadValue(file, &version) || version != kFormatVersion ||
+      !ReadValue(file, &dimensions) || !ReadValue(file, &metric) ||
+      !ReadValue(file, &nlist) || !ReadValue(file, &nprobe) || !ReadValue(file, &rerank) ||
+      dimensions == 0 || metric > static_cast<uint32_t>(DistanceMetric::kDotProduct)) {
+    return nullptr;
+  }
+  std::unique_ptr<VectorQuantizer> quantizer =
+      VectorQuantizer::Load(file, dimensions, static_cast<DistanceMetric>(metric));
+  if (quantizer == nullptr || !ReadValue(file, &list_count) || !ReadValue(file, &trained) ||
+      !ReadValue(file, &trained_size) || !ReadValue(file, &trained_error)) {
+    return nullptr;
+  }
+  if (list_count == 0 || list_count > kMaxLists || (!trained && list_count != 1)) {
+    return nullptr;
+  }
+
+  IvfFlatParams params;
+  params.nlist = nlist;
+  params.nprobe = nprobe;
+  params.rerank = rerank;
+  params.quantization = quantizer->quantization();
+  params.pq_subvectors = quantizer->subvectors();
+  std::unique_ptr<IvfFlatIndex> index(
+      new IvfFlatIndex(dimensions, static_cast<DistanceMetric>(metric), params));
+  index->quantizer_ = *quantizer;
+  index->code_words_ = quantizer->code_words();
+  if (trained) {
+    index->centroids_.resize(static_cast<size_t>(list_count) * dimensions);
+    if (fread(index->centroids_.data(), sizeof(float), index->centroids_.size(), file) !=
+        index->centroids_.size()) {
+      return nullptr;
+    }
+  }
+
+  index->lists_.resize(list_count);
+  for (uint32_t list = 0; list < list_count; list++) {
+    uint32_t count;
+    if (!ReadValue(file, &count)) {
+      return nullptr;
+    }
+    InvertedList& inverted = index->lists_[list];
+    inverted.rowids.resize(count);
+    inverted.codes.resize(static_cast<size_t>(count) * index->code_words_);
+    if (count > 0 &&
+        (fread(inverted.rowids.data(), sizeof(int64_t), count, file) != count ||
+         fread(inverted.codes.data(), sizeof(float), inverted.codes.size(), file) !=
+             inverted.codes.size())) {
+      return nullptr;
+    }
+    for (uint32_t slot = 0; slot < count; slot++) {
+      if (!index->locations_.emplace(inverted.rowids[slot], Location{list, slot}).second) {
+        return nullptr;
+      }
+    }
+  }
+
+  index->trained_size_ = static_cast<size_t>(trained_size);
+  index->trained_error_ = trained_error;
+  return index;
+}
@@ -0,0 +1,139 @@
+#ifndef IVF_FLAT_INDEX_H_
+#define IVF_FLAT_INDEX_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "vector_index.h"
+#include "vector_quantizer.h"
+
+// Tuning of an IVF-Flat index (VectorIndexConfig.parameters).
+struct IvfFlatParams {
+  // Inverted lists to partition the vectors into; 0 picks about sqrt(size)
+  // each time the index is trained
+  size_t nlist = 0;
+  // Default number of lists scanned per search; trades latency for recall
+  size_t nprobe = 8;
+  // Compression of the stored vectors
+  VectorQuantization quantization = VectorQuantization::kNone;
+  // Subvectors of product quantization; 0 picks one per two dimensions
+  size_t pq_subvectors = 0;
+  // Candidates per requested neighbour whose exact distance is recomputed
+  // from the table when vectors are compressed
+  size_t rerank = 4;
+};
+
+// Inverted file index with uncompressed ("flat") vectors: k-means centroids
+// partition the space, each vector is stored in the list of its closest
+// centroid, and a search scans only the `nprobe` lists whose centroids are
+// closest to the query.
+//
+// Each list keeps its vectors in one contiguous block, so a probe is a
+// linear scan. Writes only append to or swap-remove from one list, which
+// makes the index much cheaper to maintain than a graph.
+//
+// Vectors may be stored compressed by a VectorQuantizer, in which case
+// searches rank the lists by distances to the codes and return approximate
+// distances; callers re-rank the candidates against the original vectors.
+// Product quantization learns its codebooks the first time the index is
+// trained and keeps them through later retraining.
+//
+// An index starts untrained, with a single list scanned exhaustively, and is
+// trained by Train() once it holds enough vectors. NeedsTraining() reports
+// when the data has outgrown or drifted away from the centroids.
+class IvfFlatIndex : public VectorIndex {
+ public:
+  IvfFlatIndex(size_t dimensions, DistanceMetric metric, const IvfFlatParams& params);
+
+  void Upsert(int64_t rowid, const float* vector) override;
+  bool Remove(int64_t rowid) override;
+
+  // `nprobe` of 0 uses the index default. Distances are approximate if
+  // compressed().
+  std::vector<VectorMatch> Search(const float* query,
+                                  size_t k,
+                                  size_t nprobe) const override;
+
+  void ForEach(
+      const std::function<void(int64_t rowid, const float* vector)>& visit) const override;
+
+  size_t size() const override { return locations_.size(); }
+  const IvfFlatParams& params() const { return params_; }
+  bool compressed() const { return quantizer_.compressed(); }
+
+  // Copies the stored vector of `rowid`, decoded, into `vector`. Returns
+  // false if it is not indexed.
+  bool Find(int64_t rowid, std::vector<float>* vector) const;
+
+  // Whether the index is untrained but large enough to train, has doubled
+  // in size since it was trained, or new vectors sit noticeably further from
+  // their centroids than the training set did.
+  bool NeedsTraining() const;
+
+  // Trains centroids with k-means on a sample of the stored vectors, and the
+  // product quantization codebooks if they are not trained yet, on several
+  // threads, then reassigns every vector to its closest centroid.
+  // Does nothing while the index is too small to train.
+  void Train();
+
+  // A deep copy, for training away from the live index
+  std::unique_ptr<IvfFlatIndex> Clone() const;
+
+  // `params` raised to the smallest values the index works with
+  static IvfFlatParams ClampParams(const IvfFlatParams& params);
+
+  bool Save(FILE* file) const override;
+
+  // Returns nullptr if `file` does not hold a valid index.
+  static std::unique_ptr<IvfFlatIndex> Load(FILE* file);
+
+ private:
+  struct InvertedList {
+    std::vector<int64_t> rowids;
+    std::vector<float> codes;  // rowids.size() * code_words_, in order
+  };
+
+  struct Location {
+    uint32_t list;
+    uint32_t slot;
+  };
+
+  size_t ListCount() const { return lists_.size(); }
+  bool trained() const { return !centroids_.empty(); }
+
+  // The closest of the `count` centroids in `centroids` to `prepared`
+  uint32_t Nearest(const float* prepared, const float* centroids, size_t count) const;
+
+  // Runs k-means over the `count` vectors of `sample`
+  std::vector<float> RunKMeans(const std::vector<float>& sample,
+                               size_t count,
+                               size_t lists) const;
+
+  // Appends the code of a vector to `list`
+  void Append(uint32_t list, int64_t rowid, const float* code);
+
+  // Rebuilds the lists around `centroids`, assigning and re-encoding every
+  // stored vector with `quantizer` on several threads
+  void Reassign(std::vector<float> centroids, const VectorQuantizer& quantizer);
+
+  IvfFlatParams params_;
+  VectorQuantizer quantizer_;
+  size_t code_words_;  // quantizer_.code_words()
+
+  std::vector<float> centroids_;  // ListCount() * dimensions_ once trained
+  std::vector<InvertedList> lists_;
+  std::unordered_map<int64_t, Location> locations_;
+
+  // Drift tracking: squared distance of vectors to their centroid, averaged
+  // over the training set and over vectors added since
+  size_t trained_size_ = 0;
+  double trained_error_ = 0;
+  double added_error_ = 0;
+  size_t added_count_ = 0;
+};
+
+#endif  // IVF_FLAT_INDEX_H_
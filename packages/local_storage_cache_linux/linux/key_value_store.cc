@@ -0,0 +1,280 @@
+#include "key_value_store.h"
+
+#include <chrono>
+
+#include "sql_util.h"
+
+namespace {
+
+int64_t NowMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Cache keys of a table start with this, and its keys follow
+std::string CachePrefix(const std::string& table_name) {
+  std::string prefix = "kv:" + table_name;
+  prefix.push_back('\0');
+  return prefix;
+}
+
+}  // namespace
+
+KeyValueStore::KeyValueStore(sqlite3* database,
+                             StatementCache* statements,
+                             MemoryCache* cache,
+                             ChangeTracker* changes)
+    : database_(database), statements_(statements), cache_(cache), changes_(changes) {}
+
+KeyValueStore::Table* KeyValueStore::EnsureTable(const std::string& table_name,
+                                                 std::string* error) {
+  auto it = tables_.find(table_name);
+  if (it != tables_.end()) {
+    return &it->second;
+  }
+
+  std::string sql = "CREATE TABLE IF NOT EXISTS " + QuoteIdentifier(table_name) +
+                    " (key TEXT PRIMARY KEY, value TEXT NOT NULL, updated_at INTEGER NOT NULL)";
+  char* message = nullptr;
+  if (sqlite3_exec(database_, sql.c_str(), nullptr, nullptr, &message) != SQLITE_OK) {
+    *error = message ? message : sqlite3_errmsg(database_);
+    sqlite3_free(message);
+    return nullptr;
+  }
+  return &tables_[table_name];
+}
+
+void KeyValueStore::Cache(const std::string& table_name,
+                          const std::string& key,
+                          bool found,
+                          const std::string& value) {
+  // The first byte tells found values from keys known to be missing
+  std::string cached(1, found ? '1' : '0');
+  if (found) {
+    cached += value;
+  }
+  cache_->Put(CachePrefix(table_name) + key, std::move(cached));
+}
+
+void KeyValueStore::Evict(const std::string& table_name, const std::string& key) {
+  cache_->Erase(CachePrefix(table_name) + key);
+}
+
+void KeyValueStore::RollBackSavepoint() {
+  sqlite3_exec(database_, "ROLLBACK TO key_values", nullptr, nullptr, nullptr);
+  changes_->RollbackToSavepoint();
+  sqlite3_exec(database_, "RELEASE key_values", nullptr, nullptr, nullptr);
+  changes_->ReleaseSavepoint();
+}
+
+bool KeyValueStore::Get(const std::string& table_name,
+                        const std::string& key,
+                        std::string* value,
+                        bool* found,
+                        std::string* error) {
+  Table* table = EnsureTable(table_name, error);
+  if (table == nullptr) {
+    return false;
+  }
+
+  bool cacheable = sqlite3_get_autocommit(database_) != 0;
+  std::string cached;
+  if (cacheable && cache_->Get(CachePrefix(table_name) + key, &cached)) {
+    *found = cached[0] == '1';
+    value->assign(cached, 1, std::string::npos);
+    return true;
+  }
+
+  ScopedStatement statement = statements_->Acquire("kv_get:" + table_name, [&table_name]() {
+    return "SELECT value FROM " + QuoteIdentifier(table_name) + " WHERE key = ?";
+  });
+  if (!statement) {
+    // The table went away, e.g. with a rolled back transaction
+    *error = sqlite3_errmsg(database_);
+    ForgetTable(table_name);
+    return false;
+  }
+
+  sqlite3_bind_text(statement.get(), 1, key.c_str(), static_cast<int>(key.size()),
+                    SQLITE_STATIC);
+  int result = sqlite3_step(statement.get());
+  if (result != SQLITE_ROW && result != SQLITE_DONE) {
+    *error = sqlite3_errmsg(database_);
+    return false;
+  }
+
+  *found = result == SQLITE_ROW;
+  value->clear();
+  if (*found) {
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(statement.get(), 0));
+    value->assign(text ? text : "", sqlite3_column_bytes(statement.get(), 0));
+  }
+  if (cacheable) {
+    Cache(table_name, key, *found, *value);
+  }
+  return true;
+}
+
+bool KeyValueStore::Write(const std::string& table_name,
+                          const std::string& key,
+                          const std::string& value,
+                          std::string* error) {
+  // An upsert keeps the row's rowid, so it is reported as one change
+  ScopedStatement statement = statements_->Acquire("kv_set:" + table_name, [&table_name]() {
+    return "INSERT INTO " + QuoteIdentifier(table_name) +
+           " (key, value, updated_at) VALUES (?, ?, ?) ON CONFLICT(key) DO UPDATE SET "
+           "value = excluded.value, updated_at = excluded.updated_at";
+  });
+  if (!statement) {
+    *error = sqlite3_errmsg(database_);
+    ForgetTable(table_name);
+    return false;
+  }
+
+  sqlite3_bind_text(statement.get(), 1, key.c_str(), static_cast<int>(key.size()),
+                    SQLITE_STATIC);
+  sqlite3_bind_text(statement.get(), 2, value.c_str(), static_cast<int>(value.size()),
+                    SQLITE_STATIC);
+  sqlite3_bind_int64(statement.get(), 3, NowMillis());
+  if (sqlite3_step(statement.get()) != SQLITE_DONE) {
+    *error = sqlite3_errmsg(database_);
+    return false;
+  }
+  return true;
+}
+
+bool KeyValueStore::Set(const std::string& table_name,
+                        const std::string& key,
+                        const std::string& value,
+                        std::string* error) {
+  Table* table = EnsureTable(table_name, error);
+  if (table == nullptr) {
+    return false;
+  }
+
+  bool cacheable = sqlite3_get_autocommit(database_) != 0;
+  if (!Write(table_name, key, value, error)) {
+    return false;
+  }
+
+  if (cacheable) {
+    table->own_changes += sqlite3_changes(database_);
+    Cache(table_name, key, true, value);
+  } else {
+    Evict(table_name, key);
+  }
+  return true;
+}
+
+bool KeyValueStore::Delete(const std::string& table_name,
+                           const std::string& key,
+                           bool* deleted,
+                           std::string* error) {
+  Table* table = EnsureTable(table_name, error);
+  if (table == nullptr) {
+    return false;
+  }
+
+  ScopedStatement statement = statements_->Acquire("kv_delete:" + table_name, [&table_name]() {
+    return "DELETE FROM " + QuoteIdentifier(table_name) + " WHERE key = ?";
+  });
+  if (!statement) {
+    *error = sqlite3_errmsg(database_);
+    ForgetTable(table_name);
+    return false;
+  }
+
+  sqlite3_bind_text(statement.get(), 1, key.c_str(), static_cast<int>(key.size()),
+                    SQLITE_STATIC);
+  if (sqlite3_step(statement.get()) != SQLITE_DONE) {
+    *error = sqlite3_errmsg(database_);
+    return false;
+  }
+
+  *deleted = sqlite3_changes(database_) > 0;
+  if (sqlite3_get_autocommit(database_)) {
+    table->own_changes += sqlite3_changes(database_);
+    Cache(table_name, key, false, std::string());
+  } else {
+    Evict(table_name, key);
+  }
+  return true;
+}
+
+bool KeyValueStore::SetMany(const std::string& table_name,
+                            const std::vector<std::pair<std::string, std::string>>& entries,
+                            std::string* error) {
+  Table* table = EnsureTable(table_name, error);
+  if (table == nullptr) {
+    return false;
+  }
+
+  bool cacheable = sqlite3_get_autocommit(database_) != 0;
+  if (sqlite3_exec(database_, "SAVEPOINT key_values", nullptr, nullptr, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database_);
+    return false;
+  }
+  changes_->BeginSavepoint();
+
+  int64_t changes = 0;
+  for (const auto& entry : entries) {
+    if (!Write(table_name, entry.first, entry.second, error)) {
+      RollBackSavepoint();
+      return false;
+    }
+    changes += sqlite3_changes(database_);
+  }
+  if (sqlite3_exec(database_, "RELEASE key_values", nullptr, nullptr, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database_);
+    RollBackSavepoint();
+    return false;
+  }
+  changes_->ReleaseSavepoint();
+
+  for (const auto& entry : entries) {
+    if (cacheable) {
+      Cache(table_name, entry.first, true, entry.second);
+    } else {
+      Evict(table_name, entry.first);
+    }
+  }
+  if (cacheable) {
+    table->own_changes += changes;
+  }
+  return true;
+}
+
+void KeyValueStore::ApplyChanges(const std::vector<RowChange>& changes) {
+  std::unordered_map<std::string, int64_t> reported;
+  bool unknown = false;  // Rows of any table may have changed
+  for (const RowChange& change : changes) {
+    if (change.table_name.empty()) {
+      unknown = true;
+    } else if (tables_.count(change.table_name) > 0) {
+      reported[change.table_name]++;
+    }
+  }
+
+  for (auto& entry : tables_) {
+    Table& table = entry.second;
+    auto count = reported.find(entry.first);
+    if (unknown || (count != reported.end() && count->second > table.own_changes)) {
+      cache_->ErasePrefix(CachePrefix(entry.first));
+    }
+    table.own_changes = 0;
+  }
+}
+
+void KeyValueStore::ForgetTable(const std::string& table_name) {
+  if (tables_.erase(table_name) > 0) {
+    cache_->ErasePrefix(CachePrefix(table_name));
+  }
+}
+
+void KeyValueStore::Reset() {
+  for (const auto& entry : tables_) {
+    cache_->ErasePrefix(CachePrefix(entry.first));
+  }
+  tables_.clear();
+}
@@ -0,0 +1,108 @@
+#ifndef KEY_VALUE_STORE_H_
+#define KEY_VALUE_STORE_H_
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "change_tracker.h"
+#include "memory_cache.h"
+#include "statement_cache.h"
+
+// The key-value tables behind setValue and getValue, each a
+// (key TEXT PRIMARY KEY, value TEXT, updated_at INTEGER) table holding
+// JSON-encoded values, fronted by the plugin's MemoryCache.
+//
+// Tables are created the first time they are used. Cached values, including
+// keys known to be missing, are served without touching SQLite, and stay
+// valid until something other than this store writes to their table: the
+// store counts its own row changes and drops a table's cache when the
+// committed changes reported for it are more than that, or when rows of
+// unknown tables changed. Inside an open transaction lookups bypass the
+// cache, and writes evict rather than fill it, since the transaction may
+// still roll back.
+//
+// Every method runs on the writer thread.
+class KeyValueStore {
+ public:
+  // `database` is the writer connection, whose statements `statements`
+  // caches and whose rows `changes` tracks. Values are cached in `cache`
+  // under keys starting with "kv:".
+  KeyValueStore(sqlite3* database,
+                StatementCache* statements,
+                MemoryCache* cache,
+                ChangeTracker* changes);
+
+  // Disallow copy and assign.
+  KeyValueStore(const KeyValueStore&) = delete;
+  KeyValueStore& operator=(const KeyValueStore&) = delete;
+
+  // Looks up `key`, setting `*found` and, if found, `*value`.
+  bool Get(const std::string& table_name,
+           const std::string& key,
+           std::string* value,
+           bool* found,
+           std::string* error);
+
+  bool Set(const std::string& table_name,
+           const std::string& key,
+           const std::string& value,
+           std::string* error);
+
+  // Sets `*deleted` to whether `key` was there to delete.
+  bool Delete(const std::string& table_name,
+              const std::string& key,
+              bool* deleted,
+              std::string* error);
+
+  // Sets every entry in one transaction, or none of them on error.
+  bool SetMany(const std::string& table_name,
+               const std::vector<std::pair<std::string, std::string>>& entries,
+               std::string* error);
+
+  // ChangeTracker listener: drops the cache of tables written to by others
+  void ApplyChanges(const std::vector<RowChange>& changes);
+
+  // Forgets every table and cached value, after tables may have been dropped
+  // or altered
+  void Reset();
+
+ private:
+  struct Table {
+    int64_t own_changes = 0;  // Row changes by this store not yet reported
+  };
+
+  // Creates `table_name` unless it was already used
+  Table* EnsureTable(const std::string& table_name, std::string* error);
+
+  // Forgets `table_name`, so that it is created again on next use
+  void ForgetTable(const std::string& table_name);
+
+  bool Write(const std::string& table_name,
+             const std::string& key,
+             const std::string& value,
+             std::string* error);
+
+  // Caches a lookup; keys known to be missing are cached too
+  void Cache(const std::string& table_name,
+             const std::string& key,
+             bool found,
+             const std::string& value);
+
+  void Evict(const std::string& table_name, const std::string& key);
+
+  // Rolls back and releases the savepoint SetMany() opened
+  void RollBackSavepoint();
+
+  sqlite3* database_;
+  StatementCache* statements_;
+  MemoryCache* cache_;
+  ChangeTracker* changes_;
+  std::unordered_map<std::string, Table> tables_;
+};
+
+#endif  // KEY_VALUE_STORE_H_
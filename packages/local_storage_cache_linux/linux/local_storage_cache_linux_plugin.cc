@@ -4,10 +4,27 @@
 #include <gtk/gtk.h>
 #include <sys/utsname.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
+#include "change_feed.h"
+#include "cursor_manager.h"
+#include "database_executor.h"
 #include "database_manager.h"
+#include "disk_cache.h"
+#include "full_text_index.h"
+#include "key_value_store.h"
+#include "query_cache.h"
+#include "query_watcher.h"
+#include "reader_pool.h"
+#include "vector_index_manager.h"
+#include "vector_search.h"
 
 #define LOCAL_STORAGE_CACHE_LINUX_PLUGIN(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST((obj), local_storage_cache_linux_plugin_get_type(), \
@@ -15,11 +32,459 @@
 
 struct _LocalStorageCacheLinuxPlugin {
   GObject parent_instance;
+  
+  // Writer connection; only touched from the executor thread
   std::unique_ptr<DatabaseManager> database_manager;
+  
+  std::unique_ptr<DatabaseExecutor> executor;
+  
+  // Read-only connections, opened and closed from the executor thread
+  std::unique_ptr<ReaderPool> reader_pool;
+  
+  // Main loop only
+  int64_t next_cursor_serial;
+  guint cursor_sweep_source;
+  
+  // Executor thread only
+  bool full_text_build_queued;
+  
+  // Open disk caches by directory; executor thread only
+  std::unique_ptr<std::unordered_map<std::string, std::unique_ptr<DiskCache>>> disk_caches;
+  
+  // Carries disk cache expirations to Dart; set once registered
+  FlEventChannel* expiration_channel;
+  
+  // Carries batches of committed row changes to Dart; set once registered
+  FlEventChannel* data_change_channel;
+  
+  // Whether Dart asked for the batches, which are not built otherwise
+  std::atomic<bool> data_changes_enabled;
+  
+  // Carries the diffs of watched queries to Dart; set once registered
+  FlEventChannel* query_diff_channel;
+  
+  // Whether the writer had a transaction open when its last call finished
+  std::atomic<bool> writer_in_transaction;
+  
+  // Stops background work from queueing more while the executor drains
+  std::atomic<bool> disposing;
 };
 
 G_DEFINE_TYPE(LocalStorageCacheLinuxPlugin, local_storage_cache_linux_plugin, g_object_get_type())
 
+// How often idle cursors are looked for
+static const guint kCursorSweepIntervalSeconds = 10;
+
+// Rows indexed per full-text build step. Calls queued on the writer run
+// between steps.
+static const size_t kFullTextBuildChunkRows = 2000;
+
+static void build_full_text_indexes(LocalStorageCacheLinuxPlugin* self);
+
+// Parses the `config` map sent by initialize
+static DatabaseConfig get_database_config(FlValue* args, const gchar* database_path) {
+  DatabaseConfig config = DatabaseConfig::FromValue(fl_value_lookup_string(args, "config"));
+  
+  // In-memory databases are private to the writer connection, and readers
+  // can only run alongside the writer in WAL mode
+  if (database_path[0] == '\0' || strcmp(database_path, ":memory:") == 0 ||
+      !config.IsWal()) {
+    config.reader_pool_size = 0;
+  }
+  config.reader_pool_size = std::min(config.reader_pool_size, kMaxCursorReaders);
+  
+  return config;
+}
+
+static bool get_cursor_id(FlValue* args, int64_t* cursor_id) {
+  FlValue* cursor_id_value = fl_value_lookup_string(args, "cursorId");
+  if (cursor_id_value == nullptr || fl_value_get_type(cursor_id_value) != FL_VALUE_TYPE_INT) {
+    return false;
+  }
+  *cursor_id = fl_value_get_int(cursor_id_value);
+  return true;
+}
+
+static FlMethodResponse* cursor_not_found_response() {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "CURSOR_NOT_FOUND", "Cursor is closed or has expired", nullptr));
+}
+
+// Opens cursor `cursor_id` on the writer connection
+static FlMethodResponse* open_cursor(CursorManager* cursors,
+                                     int64_t cursor_id,
+                                     FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  const gchar* sql = fl_value_get_string(fl_value_lookup_string(args, "sql"));
+  FlValue* arguments = fl_value_lookup_string(args, "arguments");
+  
+  std::string error;
+  if (!cursors->Open(cursor_id, sql, arguments, false, &error)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "CURSOR_ERROR", error.c_str(), nullptr));
+  }
+  
+  g_autoptr(FlValue) result = fl_value_new_int(cursor_id);
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Handles fetch and closeCursor on the connection owning the cursor
+static FlMethodResponse* handle_cursor_call(CursorManager* cursors,
+                                            FlMethodCall* method_call) {
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  
+  int64_t cursor_id = 0;
+  get_cursor_id(args, &cursor_id);
+  
+  if (strcmp(method, "closeCursor") == 0) {
+    // Closing a cursor that already finished or expired is not an error
+    cursors->Close(cursor_id);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  FlValue* page_size_value = fl_value_lookup_string(args, "pageSize");
+  int64_t page_size = page_size_value != nullptr &&
+      fl_value_get_type(page_size_value) == FL_VALUE_TYPE_INT
+      ? fl_value_get_int(page_size_value)
+      : 100;
+  
+  g_autoptr(FlValue) result = cursors->Fetch(cursor_id, page_size);
+  if (result == nullptr) {
+    return cursor_not_found_response();
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Query methods and the result format each of them responds with
+static bool get_query_format(const gchar* method, ResultFormat* format) {
+  if (strcmp(method, "query") == 0) {
+    *format = ResultFormat::kMaps;
+    return true;
+  }
+  if (strcmp(method, "queryColumnar") == 0) {
+    *format = ResultFormat::kColumnar;
+    return true;
+  }
+  if (strcmp(method, "queryPacked") == 0) {
+    *format = ResultFormat::kPacked;
+    return true;
+  }
+  return false;
+}
+
+static FlMethodResponse* key_value_error_response(const std::string& error) {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "KEY_VALUE_ERROR", error.c_str(), nullptr));
+}
+
+// kvGet, kvSet, kvDelete, kvMultiGet and kvMultiSet on the key-value table
+// `tableName`. Values are JSON strings, encoded and decoded in Dart.
+static FlMethodResponse* handle_key_value_call(KeyValueStore* key_values,
+                                               const gchar* method,
+                                               FlValue* args) {
+  FlValue* table_name_value = fl_value_lookup_string(args, "tableName");
+  if (table_name_value == nullptr ||
+      fl_value_get_type(table_name_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", "tableName is required", nullptr));
+  }
+  std::string table_name = fl_value_get_string(table_name_value);
+  FlValue* key_value = fl_value_lookup_string(args, "key");
+  bool has_key = key_value != nullptr && fl_value_get_type(key_value) == FL_VALUE_TYPE_STRING;
+  std::string key = has_key ? fl_value_get_string(key_value) : "";
+  std::string error;
+  
+  if (strcmp(method, "kvGet") == 0 && has_key) {
+    std::string value;
+    bool found = false;
+    if (!key_values->Get(table_name, key, &value, &found, &error)) {
+      return key_value_error_response(error);
+    }
+    g_autoptr(FlValue) result = found ? fl_value_new_string(value.c_str()) : fl_value_new_null();
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "kvSet") == 0 && has_key) {
+    FlValue* value = fl_value_lookup_string(args, "value");
+    if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "value must be a string", nullptr));
+    }
+    if (!key_values->Set(table_name, key, fl_value_get_string(value), &error)) {
+      return key_value_error_response(error);
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  if (strcmp(method, "kvDelete") == 0 && has_key) {
+    bool deleted = false;
+    if (!key_values->Delete(table_name, key, &deleted, &error)) {
+      return key_value_error_response(error);
+    }
+    g_autoptr(FlValue) result = fl_value_new_bool(deleted);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "kvMultiGet") == 0) {
+    FlValue* keys = fl_value_lookup_string(args, "keys");
+    if (keys == nullptr || fl_value_get_type(keys) != FL_VALUE_TYPE_LIST) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "keys is required", nullptr));
+    }
+    
+    // Missing keys are left out
+    g_autoptr(FlValue) result = fl_value_new_map();
+    std::string value;
+    for (size_t i = 0; i < fl_value_get_length(keys); i++) {
+      FlValue* key_item = fl_value_get_list_value(keys, i);
+      bool found = false;
+      if (fl_value_get_type(key_item) != FL_VALUE_TYPE_STRING) {
+        continue;
+      }
+      if (!key_values->Get(table_name, fl_value_get_string(key_item), &value, &found, &error)) {
+        return key_value_error_response(error);
+      }
+      if (found) {
+        fl_value_set_take(result, fl_value_ref(key_item), fl_value_new_string(value.c_str()));
+      }
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "kvMultiSet") == 0) {
+    FlValue* entries = fl_value_lookup_string(args, "entries");
+    if (entries == nullptr || fl_value_get_type(entries) != FL_VALUE_TYPE_MAP) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "entries is required", nullptr));
+    }
+    
+    std::vector<std::pair<std::string, std::string>> values;
+    for (size_t i = 0; i < fl_value_get_length(entries); i++) {
+      FlValue* entry_key = fl_value_get_map_key(entries, i);
+      FlValue* entry_value = fl_value_get_map_value(entries, i);
+      if (fl_value_get_type(entry_key) != FL_VALUE_TYPE_STRING ||
+          fl_value_get_type(entry_value) != FL_VALUE_TYPE_STRING) {
+        return FL_METHOD_RESPONSE(fl_method_error_response_new(
+            "INVALID_ARGS", "entries must map strings to strings", nullptr));
+      }
+      values.emplace_back(fl_value_get_string(entry_key), fl_value_get_string(entry_value));
+    }
+    if (!key_values->SetMany(table_name, values, &error)) {
+      return key_value_error_response(error);
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  if (strcmp(method, "kvGet") == 0 || strcmp(method, "kvSet") == 0 ||
+      strcmp(method, "kvDelete") == 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", "key is required", nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+}
+
+// An event produced off the main loop, waiting to be sent from it
+struct PendingEvent {
+  FlEventChannel* channel;
+  FlValue* event;
+};
+
+static gboolean send_on_main_thread(gpointer user_data) {
+  PendingEvent* pending = static_cast<PendingEvent*>(user_data);
+  fl_event_channel_send(pending->channel, pending->event, nullptr, nullptr);
+  g_object_unref(pending->channel);
+  fl_value_unref(pending->event);
+  delete pending;
+  return G_SOURCE_REMOVE;
+}
+
+static void post_event(FlEventChannel* channel, FlValue* event) {
+  PendingEvent* pending =
+      new PendingEvent{static_cast<FlEventChannel*>(g_object_ref(channel)), event};
+  g_main_context_invoke(nullptr, send_on_main_thread, pending);
+}
+
+// Sends each batch of expirations of the disk cache in `directory` as one
+// {directory, keys, expiredAt} event
+static DiskCache::ExpirationListener expiration_listener(FlEventChannel* channel,
+                                                         const std::string& directory) {
+  if (channel == nullptr) {
+    return nullptr;
+  }
+  return [channel, directory](const std::vector<DiskCache::Expiration>& expirations) {
+    FlValue* keys = fl_value_new_list();
+    FlValue* expired_at = fl_value_new_list();
+    for (const DiskCache::Expiration& expiration : expirations) {
+      fl_value_append_take(keys, fl_value_new_string(expiration.key.c_str()));
+      fl_value_append_take(expired_at, fl_value_new_int(expiration.expired_at));
+    }
+    FlValue* event = fl_value_new_map();
+    fl_value_set_string_take(event, "directory", fl_value_new_string(directory.c_str()));
+    fl_value_set_string_take(event, "keys", keys);
+    fl_value_set_string_take(event, "expiredAt", expired_at);
+    post_event(channel, event);
+  };
+}
+
+// Sends the rows each flush of the writer's changes committed as one batch,
+// while Dart asks for them
+static ChangeTracker::Listener data_change_listener(LocalStorageCacheLinuxPlugin* self) {
+  return [self](const std::vector<RowChange>& changes) {
+    if (!self->data_changes_enabled || self->data_change_channel == nullptr) {
+      return;
+    }
+    FlValue* batch = EncodeChangeBatch(changes);
+    if (batch != nullptr) {
+      post_event(self->data_change_channel, batch);
+    }
+  };
+}
+
+// Sends each diff of a watched query as one event
+static QueryWatcher::Listener query_diff_listener(FlEventChannel* channel) {
+  if (channel == nullptr) {
+    return [](FlValue* diff) {};
+  }
+  return [channel](FlValue* diff) {
+    post_event(channel, fl_value_ref(diff));
+  };
+}
+
+static FlMethodResponse* disk_cache_error_response(const std::string& error) {
+  return FL_METHOD_RESPONSE(fl_method_error_response_new(
+      "DISK_CACHE_ERROR", error.c_str(), nullptr));
+}
+
+// diskCache* calls on the cache in `directory`, opened by diskCacheOpen.
+// Values are JSON strings, encoded and decoded in Dart.
+static FlMethodResponse* handle_disk_cache_call(
+    std::unordered_map<std::string, std::unique_ptr<DiskCache>>* caches,
+    FlEventChannel* expiration_channel,
+    const gchar* method,
+    FlValue* args) {
+  FlValue* directory_value = fl_value_lookup_string(args, "directory");
+  if (directory_value == nullptr ||
+      fl_value_get_type(directory_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", "directory is required", nullptr));
+  }
+  std::string directory = fl_value_get_string(directory_value);
+  std::string error;
+  
+  if (strcmp(method, "diskCacheOpen") == 0) {
+    FlValue* max_entries_value = fl_value_lookup_string(args, "maxEntries");
+    FlValue* policy_value = fl_value_lookup_string(args, "evictionPolicy");
+    EvictionPolicy policy = EvictionPolicy::kLru;
+    if (max_entries_value == nullptr || fl_value_get_type(max_entries_value) != FL_VALUE_TYPE_INT ||
+        fl_value_get_int(max_entries_value) <= 0) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "maxEntries must be a positive int", nullptr));
+    }
+    if (policy_value != nullptr && fl_value_get_type(policy_value) == FL_VALUE_TYPE_STRING &&
+        !ParseEvictionPolicy(fl_value_get_string(policy_value), &policy)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "Unknown evictionPolicy", nullptr));
+    }
+    size_t max_entries = static_cast<size_t>(fl_value_get_int(max_entries_value));
+    
+    // Opening the same directory again keeps the cache and its order
+    auto it = caches->find(directory);
+    if (it != caches->end()) {
+      it->second->SetMaxEntries(max_entries);
+      return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+    std::unique_ptr<DiskCache> cache =
+        DiskCache::Open(directory, policy, max_entries,
+                        expiration_listener(expiration_channel, directory), &error);
+    if (!cache) {
+      return disk_cache_error_response(error);
+    }
+    caches->emplace(directory, std::move(cache));
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  auto it = caches->find(directory);
+  if (it == caches->end()) {
+    return disk_cache_error_response("Disk cache not open: " + directory);
+  }
+  DiskCache* cache = it->second.get();
+  FlValue* key_value = fl_value_lookup_string(args, "key");
+  bool has_key = key_value != nullptr && fl_value_get_type(key_value) == FL_VALUE_TYPE_STRING;
+  std::string key = has_key ? fl_value_get_string(key_value) : "";
+  
+  if (strcmp(method, "diskCacheGet") == 0 && has_key) {
+    std::string value;
+    bool found = cache->Get(key, &value);
+    g_autoptr(FlValue) result = found ? fl_value_new_string(value.c_str()) : fl_value_new_null();
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "diskCachePut") == 0 && has_key) {
+    FlValue* value = fl_value_lookup_string(args, "value");
+    if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "value must be a string", nullptr));
+    }
+    FlValue* expires_at_value = fl_value_lookup_string(args, "expiresAt");
+    int64_t expires_at =
+        expires_at_value != nullptr && fl_value_get_type(expires_at_value) == FL_VALUE_TYPE_INT
+            ? fl_value_get_int(expires_at_value)
+            : 0;
+    if (!cache->Put(key, fl_value_get_string(value), expires_at, &error)) {
+      return disk_cache_error_response(error);
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  if (strcmp(method, "diskCacheRemove") == 0 && has_key) {
+    bool removed = false;
+    if (!cache->Remove(key, &removed, &error)) {
+      return disk_cache_error_response(error);
+    }
+    g_autoptr(FlValue) result = fl_value_new_bool(removed);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "diskCacheClear") == 0) {
+    if (!cache->Clear(&error)) {
+      return disk_cache_error_response(error);
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  
+  if (strcmp(method, "diskCacheRemoveExpired") == 0) {
+    size_t removed = 0;
+    if (!cache->RemoveExpired(&removed, &error)) {
+      return disk_cache_error_response(error);
+    }
+    g_autoptr(FlValue) result = fl_value_new_int(static_cast<int64_t>(removed));
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "diskCacheKeys") == 0 || strcmp(method, "diskCacheValues") == 0) {
+    std::vector<std::string> items =
+        strcmp(method, "diskCacheKeys") == 0 ? cache->Keys() : cache->Values();
+    g_autoptr(FlValue) result = fl_value_new_list();
+    for (const std::string& item : items) {
+      fl_value_append_take(result, fl_value_new_string(item.c_str()));
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "diskCacheSize") == 0) {
+    g_autoptr(FlValue) result = fl_value_new_int(static_cast<int64_t>(cache->Size()));
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  
+  if (strcmp(method, "diskCacheGet") == 0 || strcmp(method, "diskCachePut") == 0 ||
+      strcmp(method, "diskCacheRemove") == 0) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", "key is required", nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+}
+
 // Method call handler
 static FlMethodResponse* handle_method_call(
     LocalStorageCacheLinuxPlugin* self,
@@ -27,6 +492,7 @@ static FlMethodResponse* handle_method_call(
   
   const gchar* method = fl_method_call_get_name(method_call);
   FlValue* args = fl_method_call_get_args(method_call);
+  ResultFormat format = ResultFormat::kMaps;
 
   if (strcmp(method, "initialize") == 0) {
     FlValue* database_path_value = fl_value_lookup_string(args, "databasePath");
@@ -36,9 +502,20 @@ static FlMethodResponse* handle_method_call(
     }
     
     const gchar* database_path = fl_value_get_string(database_path_value);
+    DatabaseConfig config = get_database_config(args, database_path);
     self->database_manager = std::make_unique<DatabaseManager>(database_path);
     
-    if (self->database_manager->Initialize()) {
+    if (self->database_manager->Initialize(config)) {
+      self->database_manager->changes()->AddListener(data_change_listener(self));
+      
+      // Reads fall back to the writer if the readers cannot be opened
+      if (!self->reader_pool->Open(database_path, config,
+                                   self->database_manager->vector_indexes(),
+                                   self->database_manager->query_cache())) {
+        self->reader_pool->Close();
+      }
+      // Resumes builds interrupted when the database was last open
+      build_full_text_indexes(self);
       return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
     } else {
       return FL_METHOD_RESPONSE(fl_method_error_response_new(
@@ -46,6 +523,7 @@ static FlMethodResponse* handle_method_call(
     }
   }
   else if (strcmp(method, "close") == 0) {
+    self->reader_pool->Close();
     if (self->database_manager) {
       self->database_manager->Close();
       self->database_manager.reset();
@@ -60,17 +538,15 @@ static FlMethodResponse* handle_method_call(
     
     FlValue* table_name_value = fl_value_lookup_string(args, "tableName");
     FlValue* data_value = fl_value_lookup_string(args, "data");
-    FlValue* space_value = fl_value_lookup_string(args, "space");
     
     if (table_name_value == nullptr || data_value == nullptr) {
       return FL_METHOD_RESPONSE(fl_method_error_response_new(
           "INVALID_ARGS", "tableName and data are required", nullptr));
     }
     
+    // Dart passes the table name with its space already applied
     const gchar* table_name = fl_value_get_string(table_name_value);
-    const gchar* space = space_value ? fl_value_get_string(space_value) : "default";
-    
-    int64_t id = self->database_manager->Insert(table_name, data_value, space);
+    int64_t id = self->database_manager->Insert(table_name, data_value);
     
     if (id >= 0) {
       g_autoptr(FlValue) result = fl_value_new_int(id);
@@ -80,7 +556,7 @@ static FlMethodResponse* handle_method_call(
           "INSERT_ERROR", "Failed to insert data", nullptr));
     }
   }
-  else if (strcmp(method, "query") == 0) {
+  else if (get_query_format(method, &format)) {
     if (!self->database_manager) {
       return FL_METHOD_RESPONSE(fl_method_error_response_new(
           "NOT_INITIALIZED", "Database not initialized", nullptr));
@@ -93,10 +569,312 @@ static FlMethodResponse* handle_method_call(
     }
     
     const gchar* sql = fl_value_get_string(sql_value);
-    FlValue* results = self->database_manager->Query(sql);
+    FlValue* arguments = fl_value_lookup_string(args, "arguments");
+    g_autoptr(FlValue) results = self->database_manager->Query(sql, arguments, format);
     
     return FL_METHOD_RESPONSE(fl_method_success_response_new(results));
   }
+  else if (strcmp(method, "update") == 0 || strcmp(method, "delete") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    FlValue* sql_value = fl_value_lookup_string(args, "sql");
+    if (sql_value == nullptr) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "sql is required", nullptr));
+    }
+    
+    const gchar* sql = fl_value_get_string(sql_value);
+    FlValue* arguments = fl_value_lookup_string(args, "arguments");
+    int changes = strcmp(method, "update") == 0
+        ? self->database_manager->Update(sql, arguments)
+        : self->database_manager->Delete(sql, arguments);
+    
+    g_autoptr(FlValue) result = fl_value_new_int(changes);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  else if (strcmp(method, "executeBatch") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    FlValue* operations_value = fl_value_lookup_string(args, "operations");
+    if (operations_value == nullptr) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "operations is required", nullptr));
+    }
+    
+    g_autoptr(FlValue) result = self->database_manager->ExecuteBatch(operations_value);
+    
+    if (result == nullptr) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "BATCH_ERROR", self->database_manager->GetLastError().c_str(), nullptr));
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  else if (strcmp(method, "getStatementCacheStats") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    StatementCache::Stats stats = self->database_manager->GetStatementCacheStats();
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "hits", fl_value_new_int(stats.hits));
+    fl_value_set_string_take(result, "misses", fl_value_new_int(stats.misses));
+    fl_value_set_string_take(result, "evictions", fl_value_new_int(stats.evictions));
+    fl_value_set_string_take(result, "size", fl_value_new_int(stats.size));
+    fl_value_set_string_take(result, "capacity", fl_value_new_int(stats.capacity));
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  else if (strcmp(method, "getMemoryCacheStats") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+
+    MemoryCache::Stats stats = self->database_manager->memory_cache()->GetStats();
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "hits", fl_value_new_int(stats.hits));
+    fl_value_set_string_take(result, "misses", fl_value_new_int(stats.misses));
+    fl_value_set_string_take(result, "evictions", fl_value_new_int(stats.evictions));
+    fl_value_set_string_take(result, "size", fl_value_new_int(stats.entries));
+    fl_value_set_string_take(result, "bytes", fl_value_new_int(stats.bytes));
+    fl_value_set_string_take(result, "capacity", fl_value_new_int(stats.max_entries));
+    fl_value_set_string_take(result, "maxBytes", fl_value_new_int(stats.max_bytes));
+    fl_value_set_string_take(
+        result, "evictionPolicy",
+        fl_value_new_string(EvictionPolicyName(self->database_manager->memory_cache()->policy())));
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  else if (strcmp(method, "compareEvictionPolicies") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+
+    // Replays the given keys, or else the lookups the cache recorded
+    std::shared_ptr<MemoryCache> cache = self->database_manager->memory_cache();
+    FlValue* trace_value =
+        args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP ? fl_value_lookup_string(args, "trace")
+                                                             : nullptr;
+    MemoryCache::PolicyHitRates rates;
+    if (trace_value != nullptr && fl_value_get_type(trace_value) == FL_VALUE_TYPE_LIST) {
+      std::vector<std::string> trace;
+      for (size_t i = 0; i < fl_value_get_length(trace_value); i++) {
+        FlValue* key = fl_value_get_list_value(trace_value, i);
+        if (fl_value_get_type(key) != FL_VALUE_TYPE_STRING) {
+          return FL_METHOD_RESPONSE(fl_method_error_response_new(
+              "INVALID_ARGS", "trace must be a list of strings", nullptr));
+        }
+        trace.push_back(fl_value_get_string(key));
+      }
+      rates = MemoryCache::CompareEvictionPolicies(trace, cache->GetStats().max_entries);
+    } else {
+      rates = cache->CompareEvictionPolicies();
+    }
+
+    g_autoptr(FlValue) result = fl_value_new_map();
+    for (const auto& rate : rates) {
+      fl_value_set_string_take(result, EvictionPolicyName(rate.first),
+                               fl_value_new_float(rate.second));
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  else if (strcmp(method, "invalidateQueryCache") == 0) {
+    // Results reading any of the given tables, or else every result. Nothing
+    // is cached before the database is initialized.
+    std::shared_ptr<QueryCache> query_cache =
+        self->database_manager ? self->database_manager->query_cache() : nullptr;
+    FlValue* tables_value =
+        args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP ? fl_value_lookup_string(args, "tables")
+                                                             : nullptr;
+    if (tables_value != nullptr && fl_value_get_type(tables_value) == FL_VALUE_TYPE_LIST) {
+      std::vector<std::string> table_names;
+      for (size_t i = 0; i < fl_value_get_length(tables_value); i++) {
+        FlValue* table_name = fl_value_get_list_value(tables_value, i);
+        if (fl_value_get_type(table_name) != FL_VALUE_TYPE_STRING) {
+          return FL_METHOD_RESPONSE(fl_method_error_response_new(
+              "INVALID_ARGS", "tables must be a list of strings", nullptr));
+        }
+        table_names.push_back(fl_value_get_string(table_name));
+      }
+      if (query_cache) {
+        query_cache->Invalidate(table_names);
+      }
+    } else if (query_cache) {
+      query_cache->InvalidateAll();
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  else if (strcmp(method, "watchQuery") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    FlValue* sql_value = fl_value_lookup_string(args, "sql");
+    FlValue* arguments = fl_value_lookup_string(args, "arguments");
+    FlValue* key_column_value = fl_value_lookup_string(args, "keyColumn");
+    if (sql_value == nullptr || fl_value_get_type(sql_value) != FL_VALUE_TYPE_STRING) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "sql is required", nullptr));
+    }
+    std::string key_column =
+        key_column_value != nullptr && fl_value_get_type(key_column_value) == FL_VALUE_TYPE_STRING
+            ? fl_value_get_string(key_column_value)
+            : "id";
+    
+    FlValue* rows = nullptr;
+    std::string error;
+    int64_t watch_id = self->database_manager->query_watcher()->Watch(
+        fl_value_get_string(sql_value), arguments, key_column,
+        query_diff_listener(self->query_diff_channel), &rows, &error);
+    if (watch_id == 0) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "WATCH_ERROR", error.c_str(), nullptr));
+    }
+    
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "watchId", fl_value_new_int(watch_id));
+    fl_value_set_string_take(result, "rows", rows);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+  else if (strcmp(method, "unwatchQuery") == 0) {
+    FlValue* watch_id_value = fl_value_lookup_string(args, "watchId");
+    if (watch_id_value == nullptr || fl_value_get_type(watch_id_value) != FL_VALUE_TYPE_INT) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "watchId is required", nullptr));
+    }
+    
+    // Watches end with the database, so there may be nothing left to stop
+    if (self->database_manager) {
+      self->database_manager->query_watcher()->Unwatch(fl_value_get_int(watch_id_value));
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  else if (strcmp(method, "setDataChangesEnabled") == 0) {
+    FlValue* enabled_value =
+        args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP ? fl_value_lookup_string(args, "enabled")
+                                                             : nullptr;
+    if (enabled_value == nullptr || fl_value_get_type(enabled_value) != FL_VALUE_TYPE_BOOL) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "enabled is required", nullptr));
+    }
+    
+    // Runs on the writer, so no write queued before it is reported
+    self->data_changes_enabled = fl_value_get_bool(enabled_value);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  else if (strcmp(method, "fetch") == 0 || strcmp(method, "closeCursor") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    return handle_cursor_call(self->database_manager->cursors(), method_call);
+  }
+  else if (strcmp(method, "createVectorIndex") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    VectorIndexDefinition definition;
+    std::string error;
+    if (!ParseVectorIndexDefinition(args, &definition, &error)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", error.c_str(), nullptr));
+    }
+    
+    if (!self->database_manager->vector_indexes()->Create(definition, &error)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "VECTOR_INDEX_ERROR", error.c_str(), nullptr));
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  else if (strcmp(method, "dropVectorIndex") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    FlValue* name_value = fl_value_lookup_string(args, "indexName");
+    if (name_value == nullptr || fl_value_get_type(name_value) != FL_VALUE_TYPE_STRING) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "indexName is required", nullptr));
+    }
+    
+    std::string error;
+    if (!self->database_manager->vector_indexes()->Drop(fl_value_get_string(name_value),
+                                                        &error)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "VECTOR_INDEX_ERROR", error.c_str(), nullptr));
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  else if (strcmp(method, "createFullTextIndex") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    FullTextIndexDefinition definition;
+    std::string error;
+    if (!ParseFullTextIndexDefinition(args, &definition, &error)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", error.c_str(), nullptr));
+    }
+    
+    if (!self->database_manager->full_text_indexes()->Create(definition, &error)) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "FULL_TEXT_INDEX_ERROR", error.c_str(), nullptr));
+    }
+    build_full_text_indexes(self);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  else if (strcmp(method, "dropFullTextIndex") == 0 ||
+           strcmp(method, "rebuildFullTextIndex") == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    
+    FlValue* table_name_value = fl_value_lookup_string(args, "tableName");
+    if (table_name_value == nullptr ||
+        fl_value_get_type(table_name_value) != FL_VALUE_TYPE_STRING) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_ARGS", "tableName is required", nullptr));
+    }
+    
+    FullTextIndexManager* full_text_indexes = self->database_manager->full_text_indexes();
+    const gchar* table_name = fl_value_get_string(table_name_value);
+    std::string error;
+    bool dropping = strcmp(method, "dropFullTextIndex") == 0;
+    if (!(dropping ? full_text_indexes->Drop(table_name, &error)
+                   : full_text_indexes->Rebuild(table_name, &error))) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "FULL_TEXT_INDEX_ERROR", error.c_str(), nullptr));
+    }
+    if (!dropping) {
+      build_full_text_indexes(self);
+    }
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  }
+  else if (strncmp(method, "kv", 2) == 0) {
+    if (!self->database_manager) {
+      return FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr));
+    }
+    return handle_key_value_call(self->database_manager->key_values(), method, args);
+  }
+  else if (strncmp(method, "diskCache", strlen("diskCache")) == 0) {
+    // Disk caches live in their own directories, database or not
+    return handle_disk_cache_call(self->disk_caches.get(), self->expiration_channel, method,
+                                  args);
+  }
   else if (strcmp(method, "isBiometricAvailable") == 0) {
     // Linux doesn't have standard biometric API
     g_autoptr(FlValue) result = fl_value_new_bool(FALSE);
@@ -106,14 +884,500 @@ static FlMethodResponse* handle_method_call(
   return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
 }
 
+// A response computed on the executor thread, waiting to be sent from the
+// main loop
+struct PendingResponse {
+  FlMethodCall* method_call;
+  FlMethodResponse* response;
+};
+
+static gboolean respond_on_main_thread(gpointer user_data) {
+  PendingResponse* pending = static_cast<PendingResponse*>(user_data);
+  fl_method_call_respond(pending->method_call, pending->response, nullptr);
+  g_object_unref(pending->method_call);
+  g_object_unref(pending->response);
+  delete pending;
+  return G_SOURCE_REMOVE;
+}
+
+static void post_response(FlMethodCall* method_call, FlMethodResponse* response) {
+  PendingResponse* pending = new PendingResponse{method_call, response};
+  g_main_context_invoke(nullptr, respond_on_main_thread, pending);
+}
+
+// Lets change listeners such as the vector indexes catch up with a call's
+// writes before its caller hears back
+static void flush_changes(LocalStorageCacheLinuxPlugin* self) {
+  if (self->database_manager) {
+    self->database_manager->FlushChanges();
+  }
+  self->writer_in_transaction =
+      self->database_manager && self->database_manager->InTransaction();
+}
+
+// Readers cannot see rows the writer has not committed, so while it has a
+// transaction open, reads stay on the writer. Returns false if the task
+// was not posted.
+static bool post_read(LocalStorageCacheLinuxPlugin* self, ReaderPool::Task task) {
+  return !self->writer_in_transaction && self->reader_pool->Post(std::move(task));
+}
+
+static void run_on_writer(LocalStorageCacheLinuxPlugin* self,
+                          FlMethodCall* method_call) {
+  self->executor->Post([self, method_call]() {
+    FlMethodResponse* response = handle_method_call(self, method_call);
+    flush_changes(self);
+    post_response(method_call, response);
+  });
+}
+
+// Runs a read-only query on one of the reader connections. Anything the
+// reader cannot serve is handed on to the writer.
+static void run_on_reader(LocalStorageCacheLinuxPlugin* self,
+                          FlMethodCall* method_call) {
+  bool posted = post_read(self, [self, method_call](ReaderConnection* reader) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const gchar* sql = fl_value_get_string(fl_value_lookup_string(args, "sql"));
+    FlValue* arguments = fl_value_lookup_string(args, "arguments");
+    ResultFormat format = ResultFormat::kMaps;
+    get_query_format(fl_method_call_get_name(method_call), &format);
+    
+    bool requires_writer = false;
+    g_autoptr(FlValue) results = reader->Query(sql, arguments, format, &requires_writer);
+    if (requires_writer) {
+      run_on_writer(self, method_call);
+      return;
+    }
+    
+    post_response(method_call, FL_METHOD_RESPONSE(fl_method_success_response_new(results)));
+  });
+  
+  if (!posted) {
+    run_on_writer(self, method_call);
+  }
+}
+
+static void open_cursor_on_writer(LocalStorageCacheLinuxPlugin* self,
+                                  FlMethodCall* method_call,
+                                  int64_t serial) {
+  self->executor->Post([self, method_call, serial]() {
+    if (!self->database_manager) {
+      post_response(method_call, FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr)));
+      return;
+    }
+    
+    CursorManager* cursors = self->database_manager->cursors();
+    FlMethodResponse* response = open_cursor(cursors, MakeCursorId(serial, 0), method_call);
+    flush_changes(self);
+    post_response(method_call, response);
+  });
+}
+
+// Read-only cursors are held by a reader, so paging through a large table
+// never holds up the writer
+static void open_cursor(LocalStorageCacheLinuxPlugin* self,
+                        FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* sql_value = fl_value_lookup_string(args, "sql");
+  if (sql_value == nullptr || fl_value_get_type(sql_value) != FL_VALUE_TYPE_STRING) {
+    post_response(method_call, FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", "sql is required", nullptr)));
+    return;
+  }
+  
+  int64_t serial = ++self->next_cursor_serial;
+  if (!IsReadQuery(fl_value_get_string(sql_value))) {
+    open_cursor_on_writer(self, method_call, serial);
+    return;
+  }
+  
+  bool posted = post_read(self, [self, method_call, serial](ReaderConnection* reader) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const gchar* sql = fl_value_get_string(fl_value_lookup_string(args, "sql"));
+    FlValue* arguments = fl_value_lookup_string(args, "arguments");
+    
+    int64_t cursor_id = MakeCursorId(serial, reader->index() + 1);
+    if (!reader->OpenCursor(cursor_id, sql, arguments)) {
+      open_cursor_on_writer(self, method_call, serial);
+      return;
+    }
+    
+    g_autoptr(FlValue) result = fl_value_new_int(cursor_id);
+    post_response(method_call, FL_METHOD_RESPONSE(fl_method_success_response_new(result)));
+  });
+  
+  if (!posted) {
+    open_cursor_on_writer(self, method_call, serial);
+  }
+}
+
+// Routes fetch and closeCursor to the connection encoded in the cursor id
+static void run_on_cursor_owner(LocalStorageCacheLinuxPlugin* self,
+                                FlMethodCall* method_call) {
+  int64_t cursor_id = 0;
+  if (!get_cursor_id(fl_method_call_get_args(method_call), &cursor_id)) {
+    post_response(method_call, FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", "cursorId is required", nullptr)));
+    return;
+  }
+  
+  size_t slot = GetCursorSlot(cursor_id);
+  if (slot == 0) {
+    run_on_writer(self, method_call);
+    return;
+  }
+  
+  bool posted = self->reader_pool->PostTo(slot - 1, [method_call](ReaderConnection* reader) {
+    post_response(method_call, handle_cursor_call(reader->cursors(), method_call));
+  });
+  
+  // The reader went away with the pool, and its cursors with it
+  if (!posted) {
+    post_response(method_call, strcmp(fl_method_call_get_name(method_call), "closeCursor") == 0
+        ? FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr))
+        : cursor_not_found_response());
+  }
+}
+
+// Loads the matches on the connection that finished the search and responds
+static void finish_vector_search(FlMethodCall* method_call,
+                                 sqlite3* database,
+                                 const VectorSearchRequest& request,
+                                 const std::vector<VectorMatch>& matches,
+                                 std::string error) {
+  g_autoptr(FlValue) results =
+      error.empty() ? LoadVectorMatches(database, request, matches, &error) : nullptr;
+  if (results == nullptr) {
+    post_response(method_call, FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "VECTOR_SEARCH_ERROR", error.c_str(), nullptr)));
+    return;
+  }
+  post_response(method_call, FL_METHOD_RESPONSE(fl_method_success_response_new(results)));
+}
+
+// Answers the search from a vector index over the column, if there is one
+static bool search_vector_index(FlMethodCall* method_call,
+                                sqlite3* database,
+                                VectorIndexManager* vector_indexes,
+                                const VectorSearchRequest& request) {
+  std::vector<VectorMatch> matches;
+  std::string error;
+  if (vector_indexes == nullptr || !vector_indexes->Search(database, request, &matches, &error)) {
+    return false;
+  }
+  finish_vector_search(method_call, database, request, matches, error);
+  return true;
+}
+
+// Scans the whole table on a single connection
+static void scan_vectors(FlMethodCall* method_call,
+                         sqlite3* database,
+                         const VectorSearchRequest& request) {
+  TopK top(request.k);
+  std::string error;
+  ScanVectors(database, request, INT64_MIN, INT64_MAX, &top, &error);
+  finish_vector_search(method_call, database, request, top.Sorted(), error);
+}
+
+static void vector_search_on_writer(LocalStorageCacheLinuxPlugin* self,
+                                    FlMethodCall* method_call,
+                                    std::shared_ptr<const VectorSearchRequest> request) {
+  self->executor->Post([self, method_call, request]() {
+    if (!self->database_manager) {
+      post_response(method_call, FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_INITIALIZED", "Database not initialized", nullptr)));
+      return;
+    }
+    sqlite3* database = self->database_manager->database();
+    if (!search_vector_index(method_call, database,
+                             self->database_manager->vector_indexes().get(), *request)) {
+      scan_vectors(method_call, database, *request);
+    }
+  });
+}
+
+static void scan_vector_slice(FlMethodCall* method_call,
+                              ReaderConnection* reader,
+                              const std::shared_ptr<VectorSearchJob>& job,
+                              std::pair<int64_t, int64_t> slice) {
+  TopK top(job->request().k);
+  std::string error;
+  ScanVectors(reader->database(), job->request(), slice.first, slice.second, &top, &error);
+  if (job->Complete(top, error)) {
+    finish_vector_search(method_call, reader->database(), job->request(), job->top().Sorted(),
+                         job->error());
+  }
+}
+
+// Nearest neighbours over a vector column. A vector index over the column
+// answers unfiltered searches; otherwise the table is split into rowid ranges
+// scanned in parallel by the readers, each keeping its own top k, and the
+// last one to finish merges them and loads the rows.
+static void vector_search(LocalStorageCacheLinuxPlugin* self,
+                          FlMethodCall* method_call) {
+  auto request = std::make_shared<VectorSearchRequest>();
+  std::string error;
+  if (!ParseVectorSearchRequest(fl_method_call_get_args(method_call), request.get(), &error)) {
+    post_response(method_call, FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", error.c_str(), nullptr)));
+    return;
+  }
+  
+  std::shared_ptr<const VectorSearchRequest> shared_request = request;
+  bool posted = post_read(self, [self, method_call, shared_request](ReaderConnection* reader) {
+    if (search_vector_index(method_call, reader->database(), reader->vector_indexes(),
+                            *shared_request)) {
+      return;
+    }
+    
+    int64_t first_rowid = 0;
+    int64_t last_rowid = 0;
+    std::string error;
+    if (!GetRowidRange(reader->database(), shared_request->table_name, &first_rowid,
+                       &last_rowid, &error)) {
+      // Let the writer report the real error, as for queries
+      vector_search_on_writer(self, method_call, shared_request);
+      return;
+    }
+    
+    size_t reader_count = self->reader_pool->size();
+    std::vector<std::pair<int64_t, int64_t>> slices =
+        SplitRowidRange(first_rowid, last_rowid, reader_count);
+    if (slices.size() <= 1) {
+      scan_vectors(method_call, reader->database(), *shared_request);
+      return;
+    }
+    
+    // Every other reader takes a slice; this one scans whatever is left
+    auto job = std::make_shared<VectorSearchJob>(shared_request, slices.size());
+    size_t next_slice = 1;
+    for (size_t i = 0; i < reader_count && next_slice < slices.size(); i++) {
+      if (i == reader->index()) {
+        continue;
+      }
+      std::pair<int64_t, int64_t> slice = slices[next_slice];
+      if (self->reader_pool->PostTo(i, [method_call, job, slice](ReaderConnection* other) {
+            scan_vector_slice(method_call, other, job, slice);
+          })) {
+        next_slice++;
+      }
+    }
+    
+    scan_vector_slice(method_call, reader, job, slices[0]);
+    for (; next_slice < slices.size(); next_slice++) {
+      scan_vector_slice(method_call, reader, job, slices[next_slice]);
+    }
+  });
+  
+  if (!posted) {
+    vector_search_on_writer(self, method_call, shared_request);
+  }
+}
+
+static FlMethodResponse* benchmark_vector_index(sqlite3* database,
+                                                VectorIndexManager* vector_indexes,
+                                                FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* name_value = fl_value_lookup_string(args, "indexName");
+  FlValue* queries_value = fl_value_lookup_string(args, "queries");
+  FlValue* k_value = fl_value_lookup_string(args, "k");
+  if (name_value == nullptr || fl_value_get_type(name_value) != FL_VALUE_TYPE_STRING) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", "indexName is required", nullptr));
+  }
+  
+  size_t queries = 100;
+  if (queries_value != nullptr && fl_value_get_type(queries_value) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(queries_value) > 0) {
+    queries = static_cast<size_t>(fl_value_get_int(queries_value));
+  }
+  size_t k = 10;
+  if (k_value != nullptr && fl_value_get_type(k_value) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(k_value) > 0) {
+    k = static_cast<size_t>(fl_value_get_int(k_value));
+  }
+  // Search widths to try: efSearch for HNSW, nprobe for IVF-Flat
+  std::vector<size_t> ef_values;
+  std::vector<size_t> nprobe_values;
+  for (auto& widths : {std::make_pair("efSearch", &ef_values),
+                       std::make_pair("nprobe", &nprobe_values)}) {
+    FlValue* list = fl_value_lookup_string(args, widths.first);
+    if (list == nullptr || fl_value_get_type(list) != FL_VALUE_TYPE_LIST) {
+      continue;
+    }
+    for (size_t i = 0; i < fl_value_get_length(list); i++) {
+      FlValue* width = fl_value_get_list_value(list, i);
+      if (fl_value_get_type(width) == FL_VALUE_TYPE_INT && fl_value_get_int(width) > 0) {
+        widths.second->push_back(static_cast<size_t>(fl_value_get_int(width)));
+      }
+    }
+  }
+  
+  std::string error;
+  g_autoptr(FlValue) result = vector_indexes == nullptr
+      ? nullptr
+      : vector_indexes->Benchmark(database, fl_value_get_string(name_value), queries, k,
+                                  ef_values, nprobe_values, &error);
+  if (result == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "VECTOR_INDEX_ERROR", error.empty() ? "Database not initialized" : error.c_str(),
+        nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+}
+
+// Benchmarks only read the index and its table, so they run on a reader and
+// leave the writer free
+static void run_vector_index_benchmark(LocalStorageCacheLinuxPlugin* self,
+                                       FlMethodCall* method_call) {
+  bool posted = post_read(self, [method_call](ReaderConnection* reader) {
+    post_response(method_call, benchmark_vector_index(reader->database(),
+                                                      reader->vector_indexes(), method_call));
+  });
+  
+  if (!posted) {
+    self->executor->Post([self, method_call]() {
+      if (!self->database_manager) {
+        post_response(method_call, benchmark_vector_index(nullptr, nullptr, method_call));
+        return;
+      }
+      post_response(method_call,
+                    benchmark_vector_index(self->database_manager->database(),
+                                           self->database_manager->vector_indexes().get(),
+                                           method_call));
+    });
+  }
+}
+
+// Indexes the rows queued for full-text indexes one chunk per task, so a
+// large table never holds up the writer for long
+static void build_full_text_indexes(LocalStorageCacheLinuxPlugin* self) {
+  if (self->full_text_build_queued || self->disposing) {
+    return;
+  }
+  
+  self->full_text_build_queued = true;
+  self->executor->Post([self]() {
+    self->full_text_build_queued = false;
+    if (self->disposing || !self->database_manager) {
+      return;
+    }
+    if (self->database_manager->full_text_indexes()->BuildStep(kFullTextBuildChunkRows)) {
+      flush_changes(self);
+      build_full_text_indexes(self);
+    }
+  });
+}
+
+static FlMethodResponse* search_full_text(sqlite3* database, FlMethodCall* method_call) {
+  if (database == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "NOT_INITIALIZED", "Database not initialized", nullptr));
+  }
+  
+  FullTextSearchRequest request;
+  std::string error;
+  if (!ParseFullTextSearchRequest(fl_method_call_get_args(method_call), &request, &error)) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "INVALID_ARGS", error.c_str(), nullptr));
+  }
+  
+  g_autoptr(FlValue) results = SearchFullText(database, request, &error);
+  if (results == nullptr) {
+    return FL_METHOD_RESPONSE(fl_method_error_response_new(
+        "FULL_TEXT_SEARCH_ERROR", error.c_str(), nullptr));
+  }
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(results));
+}
+
+// Searches only read, so they run on a reader like any other query
+static void full_text_search(LocalStorageCacheLinuxPlugin* self, FlMethodCall* method_call) {
+  bool posted = post_read(self, [method_call](ReaderConnection* reader) {
+    post_response(method_call, search_full_text(reader->database(), method_call));
+  });
+  
+  if (!posted) {
+    self->executor->Post([self, method_call]() {
+      post_response(method_call,
+                    search_full_text(self->database_manager
+                                         ? self->database_manager->database()
+                                         : nullptr,
+                                     method_call));
+    });
+  }
+}
+
+static gboolean sweep_idle_cursors(gpointer user_data) {
+  LocalStorageCacheLinuxPlugin* self = LOCAL_STORAGE_CACHE_LINUX_PLUGIN(user_data);
+  
+  self->executor->Post([self]() {
+    if (self->database_manager) {
+      self->database_manager->cursors()->ExpireIdle();
+    }
+  });
+  self->reader_pool->PostToAll([](ReaderConnection* reader) {
+    reader->cursors()->ExpireIdle();
+  });
+  
+  return G_SOURCE_CONTINUE;
+}
+
 static void local_storage_cache_linux_plugin_handle_method_call(
     LocalStorageCacheLinuxPlugin* self,
     FlMethodCall* method_call) {
-  g_autoptr(FlMethodResponse) response = handle_method_call(self, method_call);
-  fl_method_call_respond(method_call, response, nullptr);
+  // SQLite work runs off the main loop; responses are posted back to it,
+  // since it owns the method channel
+  g_object_ref(method_call);
+  
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  ResultFormat format = ResultFormat::kMaps;
+  FlValue* sql_value = get_query_format(method, &format)
+      ? fl_value_lookup_string(args, "sql")
+      : nullptr;
+  
+  if (strcmp(method, "openCursor") == 0) {
+    open_cursor(self, method_call);
+  } else if (strcmp(method, "fetch") == 0 || strcmp(method, "closeCursor") == 0) {
+    run_on_cursor_owner(self, method_call);
+  } else if (strcmp(method, "vectorSearch") == 0) {
+    vector_search(self, method_call);
+  } else if (strcmp(method, "benchmarkVectorIndex") == 0) {
+    run_vector_index_benchmark(self, method_call);
+  } else if (strcmp(method, "fullTextSearch") == 0) {
+    full_text_search(self, method_call);
+  } else if (sql_value != nullptr && fl_value_get_type(sql_value) == FL_VALUE_TYPE_STRING &&
+      IsReadQuery(fl_value_get_string(sql_value))) {
+    run_on_reader(self, method_call);
+  } else {
+    run_on_writer(self, method_call);
+  }
 }
 
 static void local_storage_cache_linux_plugin_dispose(GObject* object) {
+  LocalStorageCacheLinuxPlugin* self = LOCAL_STORAGE_CACHE_LINUX_PLUGIN(object);
+  
+  if (self->cursor_sweep_source != 0) {
+    g_source_remove(self->cursor_sweep_source);
+    self->cursor_sweep_source = 0;
+  }
+  
+  // Finishes queued calls and joins the threads before the database goes
+  // away. Readers go first since they may hand work on to the writer, and
+  // must not be reopened by an initialize still queued on it.
+  self->disposing = true;
+  if (self->reader_pool) {
+    self->reader_pool->Shutdown();
+  }
+  self->executor.reset();
+  self->reader_pool.reset();
+  self->database_manager.reset();
+  self->disk_caches.reset();
+  g_clear_object(&self->expiration_channel);
+  g_clear_object(&self->data_change_channel);
+  g_clear_object(&self->query_diff_channel);
+  
   G_OBJECT_CLASS(local_storage_cache_linux_plugin_parent_class)->dispose(object);
 }
 
@@ -122,7 +1386,22 @@ static void local_storage_cache_linux_plugin_class_init(
   G_OBJECT_CLASS(klass)->dispose = local_storage_cache_linux_plugin_dispose;
 }
 
-static void local_storage_cache_linux_plugin_init(LocalStorageCacheLinuxPlugin* self) {}
+static void local_storage_cache_linux_plugin_init(LocalStorageCacheLinuxPlugin* self) {
+  self->executor = std::make_unique<DatabaseExecutor>();
+  self->reader_pool = std::make_unique<ReaderPool>();
+  self->disk_caches =
+      std::make_unique<std::unordered_map<std::string, std::unique_ptr<DiskCache>>>();
+  self->next_cursor_serial = 0;
+  self->full_text_build_queued = false;
+  self->expiration_channel = nullptr;
+  self->data_change_channel = nullptr;
+  self->data_changes_enabled = false;
+  self->writer_in_transaction = false;
+  self->query_diff_channel = nullptr;
+  self->disposing = false;
+  self->cursor_sweep_source =
+      g_timeout_add_seconds(kCursorSweepIntervalSeconds, sweep_idle_cursors, self);
+}
 
 static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
                            gpointer user_data) {
@@ -142,6 +1421,19 @@ void local_storage_cache_linux_plugin_register_with_registrar(FlPluginRegistrar*
   fl_method_channel_set_method_call_handler(channel, method_call_cb,
                                             g_object_ref(plugin),
                                             g_object_unref);
+  
+  plugin->expiration_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "local_storage_cache/cache_expirations",
+                           FL_METHOD_CODEC(codec));
+  plugin->data_change_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "local_storage_cache/data_changes",
+                           FL_METHOD_CODEC(codec));
+  plugin->query_diff_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "local_storage_cache/query_diffs",
+                           FL_METHOD_CODEC(codec));
 
   g_object_unref(plugin);
 }
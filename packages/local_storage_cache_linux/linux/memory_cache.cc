@@ -0,0 +1,421 @@
+#include "memory_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+template <typename Node>
+void InitList(Node* head) {
+  head->prev = head;
+  head->next = head;
+}
+
+template <typename Node>
+void PushFront(Node* head, Node* node) {
+  node->prev = head;
+  node->next = head->next;
+  head->next->prev = node;
+  head->next = node;
+}
+
+template <typename Node>
+void Detach(Node* node) {
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+}
+
+template <typename Node>
+Node* Back(Node* head) {
+  return head->prev == head ? nullptr : head->prev;
+}
+
+}  // namespace
+
+bool ParseEvictionPolicy(const std::string& name, EvictionPolicy* policy) {
+  for (EvictionPolicy candidate : kEvictionPolicies) {
+    if (name == EvictionPolicyName(candidate)) {
+      *policy = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* EvictionPolicyName(EvictionPolicy policy) {
+  switch (policy) {
+    case EvictionPolicy::kLru:
+      return "lru";
+    case EvictionPolicy::kLfu:
+      return "lfu";
+    case EvictionPolicy::kFifo:
+      return "fifo";
+    case EvictionPolicy::kTinyLfu:
+      return "wTinyLfu";
+  }
+  return "lru";
+}
+
+MemoryCache::MemoryCache(EvictionPolicy policy,
+                         size_t max_entries,
+                         size_t max_bytes,
+                         size_t max_shards)
+    : policy_(policy), max_entries_(std::max<size_t>(max_entries, 1)), max_bytes_(max_bytes) {
+  size_t shard_limit = max_shards < kMaxShards ? max_shards : kMaxShards;
+  size_t shard_count = 1;
+  while (shard_count * 2 <= shard_limit &&
+         max_entries_ / (shard_count * 2) >= kMinShardEntries) {
+    shard_count *= 2;
+  }
+  shard_entries_ = (max_entries_ + shard_count - 1) / shard_count;
+  shard_bytes_ = max_bytes_ == 0 ? 0 : (max_bytes_ + shard_count - 1) / shard_count;
+  window_capacity_ = std::max<size_t>(shard_entries_ / 100, 1);
+  protected_capacity_ =
+      shard_entries_ > window_capacity_ ? (shard_entries_ - window_capacity_) * 8 / 10 : 0;
+
+  for (size_t i = 0; i < shard_count; i++) {
+    std::unique_ptr<Shard> shard(new Shard());
+    InitList(&shard->order);
+    InitList(&shard->probation);
+    InitList(&shard->protected_entries);
+    if (policy_ == EvictionPolicy::kTinyLfu) {
+      shard->sketch.reset(new FrequencySketch(shard_entries_));
+    }
+    shard->trace.reserve(kTraceLength / shard_count);
+    shards_.push_back(std::move(shard));
+  }
+}
+
+MemoryCache::~MemoryCache() = default;
+
+MemoryCache::Shard* MemoryCache::ShardFor(uint64_t hash) const {
+  // The low bits pick the bucket inside the shard's map, so use high ones
+  return shards_[(hash >> 16) & (shards_.size() - 1)].get();
+}
+
+void MemoryCache::Link(Shard* shard, Entry* entry) {
+  switch (policy_) {
+    case EvictionPolicy::kLfu: {
+      auto lowest = shard->buckets.begin();
+      if (lowest == shard->buckets.end() || lowest->frequency != 1) {
+        lowest = shard->buckets.emplace(lowest);
+        lowest->frequency = 1;
+        InitList(&lowest->entries);
+      }
+      entry->bucket = lowest;
+      PushFront<Node>(&lowest->entries, entry);
+      break;
+    }
+    case EvictionPolicy::kTinyLfu:
+      entry->segment = Segment::kWindow;
+      shard->window_count++;
+      PushFront<Node>(&shard->order, entry);
+      break;
+    default:
+      PushFront<Node>(&shard->order, entry);
+      break;
+  }
+}
+
+void MemoryCache::Unlink(Shard* shard, Entry* entry) {
+  Detach<Node>(entry);
+  if (policy_ == EvictionPolicy::kLfu) {
+    Node* head = &entry->bucket->entries;
+    if (head->next == head) {
+      shard->buckets.erase(entry->bucket);
+    }
+  } else if (policy_ == EvictionPolicy::kTinyLfu) {
+    if (entry->segment == Segment::kWindow) {
+      shard->window_count--;
+    } else if (entry->segment == Segment::kProtected) {
+      shard->protected_count--;
+    }
+  }
+}
+
+void MemoryCache::Touch(Shard* shard, Entry* entry) {
+  switch (policy_) {
+    case EvictionPolicy::kFifo:
+      break;
+    case EvictionPolicy::kLfu: {
+      auto current = entry->bucket;
+      auto next = std::next(current);
+      uint64_t frequency = current->frequency + 1;
+      if (next == shard->buckets.end() || next->frequency != frequency) {
+        next = shard->buckets.emplace(next);
+        next->frequency = frequency;
+        InitList(&next->entries);
+      }
+      Detach<Node>(entry);
+      if (current->entries.next == &current->entries) {
+        shard->buckets.erase(current);
+      }
+      entry->bucket = next;
+      PushFront<Node>(&next->entries, entry);
+      break;
+    }
+    case EvictionPolicy::kTinyLfu:
+      Detach<Node>(entry);
+      if (entry->segment == Segment::kWindow) {
+        PushFront<Node>(&shard->order, entry);
+        break;
+      }
+
+      // A second use promotes a probation entry, demoting the protected
+      // entry used longest ago if there is no room
+      if (entry->segment == Segment::kProbation) {
+        entry->segment = Segment::kProtected;
+        shard->protected_count++;
+      }
+      PushFront<Node>(&shard->protected_entries, entry);
+      while (shard->protected_count > protected_capacity_) {
+        Entry* demoted = static_cast<Entry*>(Back(&shard->protected_entries));
+        Detach<Node>(demoted);
+        demoted->segment = Segment::kProbation;
+        shard->protected_count--;
+        PushFront<Node>(&shard->probation, demoted);
+      }
+      break;
+    case EvictionPolicy::kLru:
+      Detach<Node>(entry);
+      PushFront<Node>(&shard->order, entry);
+      break;
+  }
+}
+
+void MemoryCache::Admit(Shard* shard) {
+  while (shard->window_count > window_capacity_) {
+    Entry* candidate = static_cast<Entry*>(Back(&shard->order));
+    Detach<Node>(candidate);
+    shard->window_count--;
+    candidate->segment = Segment::kProbation;
+    PushFront<Node>(&shard->probation, candidate);
+    if (shard->entries.size() <= shard_entries_) {
+      continue;
+    }
+
+    Entry* victim = static_cast<Entry*>(Back(&shard->probation));
+    if (victim == candidate) {
+      Node* protected_back = Back(&shard->protected_entries);
+      victim = protected_back ? static_cast<Entry*>(protected_back) : candidate;
+    }
+    if (victim != candidate &&
+        shard->sketch->Estimate(candidate->hash) > shard->sketch->Estimate(victim->hash)) {
+      Evict(shard, victim);
+    } else {
+      Evict(shard, candidate);
+    }
+  }
+}
+
+MemoryCache::Entry* MemoryCache::Victim(Shard* shard) const {
+  Node* back = nullptr;
+  switch (policy_) {
+    case EvictionPolicy::kLfu:
+      if (!shard->buckets.empty()) {
+        back = Back(&shard->buckets.front().entries);
+      }
+      break;
+    case EvictionPolicy::kTinyLfu:
+      back = Back(&shard->probation);
+      if (back == nullptr) {
+        back = Back(&shard->protected_entries);
+      }
+      if (back == nullptr) {
+        back = Back(&shard->order);
+      }
+      break;
+    default:
+      back = Back(&shard->order);
+      break;
+  }
+  return static_cast<Entry*>(back);
+}
+
+void MemoryCache::Remove(Shard* shard, std::unordered_map<std::string, Entry>::iterator it) {
+  Unlink(shard, &it->second);
+  shard->bytes -= it->second.charge;
+  shard->entries.erase(it);
+}
+
+void MemoryCache::Evict(Shard* shard, Entry* entry) {
+  Remove(shard, shard->entries.find(*entry->key));
+  shard->evictions++;
+}
+
+bool MemoryCache::Get(const std::string& key, std::string* value) {
+  uint64_t hash = std::hash<std::string>()(key);
+  Shard* shard = ShardFor(hash);
+  std::lock_guard<std::mutex> lock(shard->mutex);
+
+  if (shard->trace.size() < shard->trace.capacity()) {
+    shard->trace.push_back(hash);
+  } else if (!shard->trace.empty()) {
+    shard->trace[shard->trace_next] = hash;
+    shard->trace_next = (shard->trace_next + 1) % shard->trace.size();
+  }
+  if (shard->sketch) {
+    shard->sketch->Increment(hash);
+  }
+
+  auto it = shard->entries.find(key);
+  if (it == shard->entries.end()) {
+    shard->misses++;
+    return false;
+  }
+
+  shard->hits++;
+  Touch(shard, &it->second);
+  *value = it->second.value;
+  return true;
+}
+
+void MemoryCache::Put(const std::string& key, std::string value) {
+  uint64_t hash = std::hash<std::string>()(key);
+  size_t charge = key.size() + value.size() + kEntryOverhead;
+  Shard* shard = ShardFor(hash);
+  std::lock_guard<std::mutex> lock(shard->mutex);
+
+  auto it = shard->entries.find(key);
+  if (it != shard->entries.end()) {
+    Remove(shard, it);
+  }
+  if (shard_bytes_ != 0 && charge > shard_bytes_) {
+    return;
+  }
+
+  // W-TinyLFU always takes new entries into the window and evicts after
+  if (policy_ != EvictionPolicy::kTinyLfu) {
+    while (shard->entries.size() >= shard_entries_) {
+      Evict(shard, Victim(shard));
+    }
+  }
+
+  auto inserted = shard->entries.emplace(key, Entry());
+  Entry* entry = &inserted.first->second;
+  entry->key = &inserted.first->first;
+  entry->value = std::move(value);
+  entry->charge = charge;
+  entry->hash = hash;
+  Link(shard, entry);
+  shard->bytes += charge;
+
+  if (policy_ == EvictionPolicy::kTinyLfu) {
+    shard->sketch->Increment(hash);
+    Admit(shard);
+  }
+  while (shard_bytes_ != 0 && shard->bytes > shard_bytes_) {
+    Evict(shard, Victim(shard));
+  }
+}
+
+bool MemoryCache::Erase(const std::string& key) {
+  Shard* shard = ShardFor(std::hash<std::string>()(key));
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  auto it = shard->entries.find(key);
+  if (it == shard->entries.end()) {
+    return false;
+  }
+  Remove(shard, it);
+  return true;
+}
+
+void MemoryCache::ErasePrefix(const std::string& prefix) {
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (auto it = shard->entries.begin(); it != shard->entries.end();) {
+      auto current = it++;
+      if (current->first.compare(0, prefix.size(), prefix) == 0) {
+        Remove(shard.get(), current);
+      }
+    }
+  }
+}
+
+void MemoryCache::Clear() {
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->entries.clear();
+    shard->buckets.clear();
+    InitList(&shard->order);
+    InitList(&shard->probation);
+    InitList(&shard->protected_entries);
+    shard->window_count = 0;
+    shard->protected_count = 0;
+    if (shard->sketch) {
+      shard->sketch->Clear();
+    }
+    shard->bytes = 0;
+  }
+}
+
+MemoryCache::Stats MemoryCache::GetStats() const {
+  Stats stats;
+  stats.max_entries = max_entries_;
+  stats.max_bytes = max_bytes_;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.hits += shard->hits;
+    stats.misses += shard->misses;
+    stats.evictions += shard->evictions;
+    stats.entries += shard->entries.size();
+    stats.bytes += shard->bytes;
+  }
+  return stats;
+}
+
+void MemoryCache::Replay(EvictionPolicy policy,
+                         size_t max_entries,
+                         const std::vector<std::string>& trace,
+                         uint64_t* hits,
+                         uint64_t* lookups) {
+  MemoryCache cache(policy, max_entries, 0, 1);
+  std::string value;
+  for (const std::string& key : trace) {
+    if (cache.Get(key, &value)) {
+      (*hits)++;
+    } else {
+      cache.Put(key, std::string());
+    }
+  }
+  *lookups += trace.size();
+}
+
+MemoryCache::PolicyHitRates MemoryCache::CompareEvictionPolicies() const {
+  // Each shard replays its own lookups, oldest first, as if it were alone
+  std::vector<std::vector<std::string>> traces;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    std::vector<std::string> trace;
+    trace.reserve(shard->trace.size());
+    for (size_t i = 0; i < shard->trace.size(); i++) {
+      uint64_t hash = shard->trace[(shard->trace_next + i) % shard->trace.size()];
+      trace.emplace_back(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    }
+    traces.push_back(std::move(trace));
+  }
+
+  PolicyHitRates rates;
+  for (EvictionPolicy policy : kEvictionPolicies) {
+    uint64_t hits = 0;
+    uint64_t lookups = 0;
+    for (const auto& trace : traces) {
+      Replay(policy, shard_entries_, trace, &hits, &lookups);
+    }
+    rates.emplace_back(policy, lookups > 0 ? static_cast<double>(hits) / lookups : 0.0);
+  }
+  return rates;
+}
+
+MemoryCache::PolicyHitRates MemoryCache::CompareEvictionPolicies(
+    const std::vector<std::string>& trace,
+    size_t max_entries) {
+  PolicyHitRates rates;
+  for (EvictionPolicy policy : kEvictionPolicies) {
+    uint64_t hits = 0;
+    uint64_t lookups = 0;
+    Replay(policy, max_entries, trace, &hits, &lookups);
+    rates.emplace_back(policy, lookups > 0 ? static_cast<double>(hits) / lookups : 0.0);
+  }
+  return rates;
+}
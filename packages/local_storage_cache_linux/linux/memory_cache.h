@@ -0,0 +1,197 @@
+#ifndef MEMORY_CACHE_H_
+#define MEMORY_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "frequency_sketch.h"
+
+// Mirrors the Dart EvictionPolicy enum
+enum class EvictionPolicy { kLru, kLfu, kFifo, kTinyLfu };
+
+constexpr EvictionPolicy kEvictionPolicies[] = {EvictionPolicy::kLru, EvictionPolicy::kLfu,
+                                                EvictionPolicy::kFifo, EvictionPolicy::kTinyLfu};
+
+// Parses an EvictionPolicy name ("lru", "lfu", "fifo" or "wTinyLfu").
+// Returns false and leaves `*policy` alone for anything else.
+bool ParseEvictionPolicy(const std::string& name, EvictionPolicy* policy);
+
+// The Dart name of `policy`
+const char* EvictionPolicyName(EvictionPolicy policy);
+
+// Bounded in-memory cache of string values, shared by every lookup that goes
+// through the plugin and safe to use from any thread.
+//
+// Keys are spread over shards by hash, each with its own lock and its own
+// share of the entry and byte limits, so that threads touching different
+// keys rarely wait for one another. Within a shard every operation is O(1):
+// LRU and FIFO keep an intrusive doubly linked list of entries, moved to the
+// front on access for LRU only, and LFU keeps a list of frequency buckets in
+// increasing order, each holding the entries used that many times, most
+// recently used first. The entry evicted is the back of the list or of the
+// lowest bucket.
+//
+// W-TinyLFU puts new entries in a small LRU window, 1% of the shard. Entries
+// leaving the window only enter the main segmented LRU if a count-min sketch
+// of recent lookups, hits and misses alike, rates them more popular than the
+// entry they would evict. A scan over many keys used once therefore cycles
+// through the window and leaves the main cache alone. The main cache is
+// split into probation, for entries not used since they were admitted, and
+// protected (80%), for the rest.
+//
+// Each shard also records the hashes of its last lookups, which
+// CompareEvictionPolicies() replays to compare the policies on the actual
+// workload.
+class MemoryCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t max_entries = 0;
+    size_t max_bytes = 0;
+  };
+
+  // Hit rate of each policy over the same lookups
+  using PolicyHitRates = std::vector<std::pair<EvictionPolicy, double>>;
+
+  static constexpr size_t kMaxShards = 16;
+
+  // Entries per shard below which fewer shards are used, since a small
+  // shard evicts by its own limit well before the cache is full
+  static constexpr size_t kMinShardEntries = 64;
+
+  // Bookkeeping charged to every entry on top of its key and value
+  static constexpr size_t kEntryOverhead = 96;
+
+  // Lookups recorded across all shards
+  static constexpr size_t kTraceLength = 16384;
+
+  // `max_bytes` of 0 leaves the size in bytes unbounded
+  MemoryCache(EvictionPolicy policy,
+              size_t max_entries,
+              size_t max_bytes,
+              size_t max_shards = kMaxShards);
+  ~MemoryCache();
+
+  // Disallow copy and assign.
+  MemoryCache(const MemoryCache&) = delete;
+  MemoryCache& operator=(const MemoryCache&) = delete;
+
+  EvictionPolicy policy() const { return policy_; }
+
+  // Copies the value of `key` into `*value` and counts the access
+  bool Get(const std::string& key, std::string* value);
+
+  // Inserts or replaces `key`, evicting other entries of its shard as
+  // needed. A value too large for its shard is not cached at all.
+  void Put(const std::string& key, std::string value);
+
+  bool Erase(const std::string& key);
+
+  // Erases every key starting with `prefix`, visiting the whole cache
+  void ErasePrefix(const std::string& prefix);
+
+  void Clear();
+
+  Stats GetStats() const;
+
+  // Replays the recorded lookups of each shard through an empty shard of the
+  // same entry limit under every policy, filling it on each miss. Sizes in
+  // bytes are not simulated.
+  PolicyHitRates CompareEvictionPolicies() const;
+
+  // Same as above for lookups of `trace`, in order, against a cache of
+  // `max_entries` entries
+  static PolicyHitRates CompareEvictionPolicies(const std::vector<std::string>& trace,
+                                                size_t max_entries);
+
+ private:
+  struct Node {
+    Node* prev;
+    Node* next;
+  };
+
+  struct Bucket;
+
+  // Where a W-TinyLFU entry lives
+  enum class Segment { kWindow, kProbation, kProtected };
+
+  struct Entry : Node {
+    const std::string* key;  // Owned by the shard's map
+    std::string value;
+    size_t charge;
+    uint64_t hash;
+    std::list<Bucket>::iterator bucket;  // LFU only
+    Segment segment;                     // W-TinyLFU only
+  };
+
+  struct Bucket {
+    uint64_t frequency;
+    Node entries;  // Sentinel of a circular list
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    Node order;                 // LRU, FIFO and the W-TinyLFU window: sentinel,
+                                // front is newest
+    std::list<Bucket> buckets;  // LFU: lowest frequency first
+    Node probation;             // W-TinyLFU main segments
+    Node protected_entries;
+    size_t window_count = 0;
+    size_t protected_count = 0;
+    std::unique_ptr<FrequencySketch> sketch;  // W-TinyLFU only
+    std::vector<uint64_t> trace;              // Ring of lookup hashes
+    size_t trace_next = 0;
+    size_t bytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  // Replays `trace` with demand fill, adding to the hit and lookup counts
+  static void Replay(EvictionPolicy policy,
+                     size_t max_entries,
+                     const std::vector<std::string>& trace,
+                     uint64_t* hits,
+                     uint64_t* lookups);
+
+  Shard* ShardFor(uint64_t hash) const;
+
+  // Links a new entry into the eviction order of `shard`
+  void Link(Shard* shard, Entry* entry);
+  void Unlink(Shard* shard, Entry* entry);
+
+  // Records a hit on `entry`
+  void Touch(Shard* shard, Entry* entry);
+
+  // Moves entries out of a full W-TinyLFU window, admitting each to the main
+  // cache or evicting it
+  void Admit(Shard* shard);
+
+  void Remove(Shard* shard, std::unordered_map<std::string, Entry>::iterator it);
+  void Evict(Shard* shard, Entry* entry);
+
+  // The entry to evict next, or null if `shard` is empty
+  Entry* Victim(Shard* shard) const;
+
+  const EvictionPolicy policy_;
+  const size_t max_entries_;
+  const size_t max_bytes_;
+  size_t shard_entries_;
+  size_t shard_bytes_;
+  size_t window_capacity_;     // W-TinyLFU entries per shard window
+  size_t protected_capacity_;  // W-TinyLFU entries per shard protected segment
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif  // MEMORY_CACHE_H_
@@ -0,0 +1,62 @@
+#ifndef MPSC_QUEUE_H_
+#define MPSC_QUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+// Unbounded lock-free multi-producer single-consumer queue (Vyukov).
+//
+// Push() may be called from any thread; TryPop() only from the single
+// consumer thread.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : stub_(new Node()), head_(stub_), tail_(stub_) {}
+
+  ~MpscQueue() {
+    T value;
+    while (TryPop(&value)) {
+    }
+    delete tail_;
+  }
+
+  // Disallow copy and assign.
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void Push(T value) {
+    Node* node = new Node(std::move(value));
+    Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  // Returns false if the queue is empty, or if a producer is midway through
+  // linking its node; callers should simply retry later.
+  bool TryPop(T* value) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+
+    *value = std::move(next->value);
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Node {
+    Node() : next(nullptr) {}
+    explicit Node(T node_value) : value(std::move(node_value)), next(nullptr) {}
+
+    T value;
+    std::atomic<Node*> next;
+  };
+
+  Node* stub_;
+  std::atomic<Node*> head_;  // Producers push here.
+  Node* tail_;               // Consumer pops here; always a consumed node.
+};
+
+#endif  // MPSC_QUEUE_H_
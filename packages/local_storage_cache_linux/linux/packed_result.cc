@@ -0,0 +1,234 @@
+#include "packed_result.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t kPackedVersion = 1;
+constexpr size_t kHeaderSize = 16;
+constexpr size_t kDescriptorSize = 24;
+
+// Storage classes seen in a column, as a bit mask
+constexpr int kSeenInteger = 1 << SQLITE_INTEGER;
+constexpr int kSeenFloat = 1 << SQLITE_FLOAT;
+constexpr int kSeenText = 1 << SQLITE_TEXT;
+constexpr int kSeenBlob = 1 << SQLITE_BLOB;
+
+// Cells of one column, captured while stepping the statement
+struct ColumnData {
+  std::string name;
+  int seen = 0;
+  bool has_nulls = false;
+  std::vector<uint8_t> kinds;     // SQLite storage class per row
+  std::vector<int64_t> integers;  // Integer value per row
+  std::vector<double> floats;     // Float value per row
+  std::vector<uint32_t> ends;     // End of each row's bytes in `heap`
+  std::string heap;               // Text and blob bytes
+};
+
+size_t Align8(size_t offset) {
+  return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+// The single type a column is packed as. Integer and float columns widen to
+// float64; any other mix falls back to blob if it holds blobs, which need not
+// be valid UTF-8, and to text otherwise.
+uint8_t GetPackedType(int seen) {
+  if (seen == 0) return kPackedNull;
+  if (seen == kSeenInteger) return kPackedInt64;
+  if ((seen & ~(kSeenInteger | kSeenFloat)) == 0) return kPackedFloat64;
+  if (seen & kSeenBlob) return kPackedBlob;
+  return kPackedText;
+}
+
+// Bytes of a cell in a column of mixed storage classes, numbers in text form
+std::string CellText(const ColumnData& column, size_t row) {
+  switch (column.kinds[row]) {
+    case SQLITE_INTEGER:
+      return std::to_string(column.integers[row]);
+    case SQLITE_FLOAT: {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%.17g", column.floats[row]);
+      return buffer;
+    }
+    case SQLITE_TEXT:
+    case SQLITE_BLOB: {
+      uint32_t start = row == 0 ? 0 : column.ends[row - 1];
+      return column.heap.substr(start, column.ends[row] - start);
+    }
+    default:
+      return std::string();
+  }
+}
+
+class Writer {
+ public:
+  explicit Writer(size_t size) : buffer_(size, 0) {}
+  
+  template <typename T>
+  void Put(size_t offset, T value) {
+    memcpy(buffer_.data() + offset, &value, sizeof(T));
+  }
+  
+  void PutBytes(size_t offset, const void* data, size_t length) {
+    if (length > 0) {
+      memcpy(buffer_.data() + offset, data, length);
+    }
+  }
+  
+  const std::vector<uint8_t>& buffer() const { return buffer_; }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+}  // namespace
+
+FlValue* EncodePacked(sqlite3_stmt* statement) {
+  int column_count = sqlite3_column_count(statement);
+  std::vector<ColumnData> columns(column_count);
+  for (int i = 0; i < column_count; i++) {
+    columns[i].name = sqlite3_column_name(statement, i);
+  }
+  
+  size_t row_count = 0;
+  while (sqlite3_step(statement) == SQLITE_ROW) {
+    for (int i = 0; i < column_count; i++) {
+      ColumnData& column = columns[i];
+      int kind = sqlite3_column_type(statement, i);
+      int64_t integer = 0;
+      double real = 0;
+  
+      switch (kind) {
+        case SQLITE_INTEGER:
+          integer = sqlite3_column_int64(statement, i);
+          break;
+        case SQLITE_FLOAT:
+          real = sqlite3_column_double(statement, i);
+          break;
+        case SQLITE_TEXT:
+          column.heap.append(reinterpret_cast<const char*>(sqlite3_column_text(statement, i)),
+                             sqlite3_column_bytes(statement, i));
+          break;
+        case SQLITE_BLOB: {
+          const void* blob = sqlite3_column_blob(statement, i);
+          int length = sqlite3_column_bytes(statement, i);
+          if (length > 0) {
+            column.heap.append(static_cast<const char*>(blob), length);
+          }
+          break;
+        }
+        default:
+          column.has_nulls = true;
+          break;
+      }
+  
+      if (kind != SQLITE_NULL) {
+        column.seen |= 1 << kind;
+      }
+      column.kinds.push_back(static_cast<uint8_t>(kind));
+      column.integers.push_back(integer);
+      column.floats.push_back(kind == SQLITE_INTEGER ? static_cast<double>(integer) : real);
+      column.ends.push_back(static_cast<uint32_t>(column.heap.size()));
+    }
+    row_count++;
+  }
+  
+  // Columns of mixed storage classes are re-encoded as text or blob
+  for (ColumnData& column : columns) {
+    uint8_t type = GetPackedType(column.seen);
+    if ((type != kPackedText && type != kPackedBlob) || column.seen == kSeenText ||
+        column.seen == kSeenBlob) {
+      continue;
+    }
+    std::string heap;
+    for (size_t row = 0; row < row_count; row++) {
+      heap += CellText(column, row);
+      column.ends[row] = static_cast<uint32_t>(heap.size());
+    }
+    column.heap.swap(heap);
+  }
+  
+  // Lay out the sections
+  size_t offset = kHeaderSize + kDescriptorSize * column_count;
+  std::vector<size_t> name_offsets(column_count);
+  for (int i = 0; i < column_count; i++) {
+    name_offsets[i] = offset;
+    offset += columns[i].name.size();
+  }
+  
+  size_t bitmap_size = (row_count + 7) / 8;
+  std::vector<size_t> null_offsets(column_count, 0);
+  std::vector<size_t> data_offsets(column_count, 0);
+  std::vector<size_t> heap_offsets(column_count, 0);
+  for (int i = 0; i < column_count; i++) {
+    uint8_t type = GetPackedType(columns[i].seen);
+    if (columns[i].has_nulls && type != kPackedNull) {
+      offset = Align8(offset);
+      null_offsets[i] = offset;
+      offset += bitmap_size;
+    }
+  
+    offset = Align8(offset);
+    data_offsets[i] = offset;
+    if (type == kPackedInt64 || type == kPackedFloat64) {
+      offset += sizeof(int64_t) * row_count;
+    } else if (type == kPackedText || type == kPackedBlob) {
+      offset += sizeof(uint32_t) * (row_count + 1);
+      heap_offsets[i] = offset;
+      offset += columns[i].heap.size();
+    }
+  }
+  
+  Writer writer(Align8(offset));
+  writer.PutBytes(0, "LSCP", 4);
+  writer.Put<uint16_t>(4, kPackedVersion);
+  writer.Put<uint16_t>(6, static_cast<uint16_t>(column_count));
+  writer.Put<uint32_t>(8, static_cast<uint32_t>(row_count));
+  
+  for (int i = 0; i < column_count; i++) {
+    const ColumnData& column = columns[i];
+    uint8_t type = GetPackedType(column.seen);
+    size_t descriptor = kHeaderSize + kDescriptorSize * i;
+    writer.Put<uint8_t>(descriptor, type);
+    writer.Put<uint32_t>(descriptor + 4, static_cast<uint32_t>(name_offsets[i]));
+    writer.Put<uint32_t>(descriptor + 8, static_cast<uint32_t>(column.name.size()));
+    writer.Put<uint32_t>(descriptor + 12, static_cast<uint32_t>(null_offsets[i]));
+    writer.Put<uint32_t>(descriptor + 16, static_cast<uint32_t>(data_offsets[i]));
+    writer.Put<uint32_t>(descriptor + 20, static_cast<uint32_t>(heap_offsets[i]));
+    writer.PutBytes(name_offsets[i], column.name.data(), column.name.size());
+  
+    if (null_offsets[i] != 0) {
+      for (size_t row = 0; row < row_count; row++) {
+        if (column.kinds[row] == SQLITE_NULL) {
+          size_t byte = null_offsets[i] + row / 8;
+          writer.Put<uint8_t>(byte, writer.buffer()[byte] | (1 << (row % 8)));
+        }
+      }
+    }
+  
+    if (type == kPackedInt64) {
+      writer.PutBytes(data_offsets[i], column.integers.data(), sizeof(int64_t) * row_count);
+    } else if (type == kPackedFloat64) {
+      writer.PutBytes(data_offsets[i], column.floats.data(), sizeof(double) * row_count);
+    } else if (type == kPackedText || type == kPackedBlob) {
+      writer.Put<uint32_t>(data_offsets[i], 0);
+      writer.PutBytes(data_offsets[i] + sizeof(uint32_t), column.ends.data(),
+                      sizeof(uint32_t) * row_count);
+      writer.PutBytes(heap_offsets[i], column.heap.data(), column.heap.size());
+    }
+  }
+  
+  return fl_value_new_uint8_list(writer.buffer().data(), writer.buffer().size());
+}
+
+FlValue* EncodeEmptyPacked() {
+  Writer writer(kHeaderSize);
+  writer.PutBytes(0, "LSCP", 4);
+  writer.Put<uint16_t>(4, kPackedVersion);
+  return fl_value_new_uint8_list(writer.buffer().data(), writer.buffer().size());
+}
@@ -0,0 +1,45 @@
+#ifndef PACKED_RESULT_H_
+#define PACKED_RESULT_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+// Serializes a whole result set into one Uint8List, so the method channel
+// carries a single buffer instead of a boxed value per cell. Decoded by
+// PackedResult on the Dart side.
+//
+// All integers are little-endian and every offset is from the start of the
+// buffer. Sections start on 8-byte boundaries so numeric columns can be
+// viewed in place as Int64List / Float64List.
+//
+//   Header (16 bytes)
+//     char[4] magic "LSCP"
+//     u16     version (1)
+//     u16     column count
+//     u32     row count
+//     u32     reserved
+//   Column descriptors (24 bytes each)
+//     u8      type (PackedColumnType)
+//     u8[3]   reserved
+//     u32     name offset, u32 name length (UTF-8)
+//     u32     null bitmap offset, 0 if the column has no nulls (bit set = null)
+//     u32     data offset
+//     u32     heap offset (text and blob columns)
+//   Data
+//     int64 / float64 columns: one 8-byte value per row
+//     text / blob columns: u32[row count + 1] offsets into the column's heap
+enum PackedColumnType {
+  kPackedNull = 0,
+  kPackedInt64 = 1,
+  kPackedFloat64 = 2,
+  kPackedText = 3,
+  kPackedBlob = 4,
+};
+
+// Steps `statement` to completion and returns the packed result.
+FlValue* EncodePacked(sqlite3_stmt* statement);
+
+// A packed result with no columns and no rows.
+FlValue* EncodeEmptyPacked();
+
+#endif  // PACKED_RESULT_H_
@@ -0,0 +1,367 @@
+#include "query_cache.h"
+
+#include <strings.h>
+
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// Cached results start with the generation they were read at and the
+// length of their table list, followed by the list and the encoded result
+constexpr size_t kResultHeaderBytes = sizeof(uint64_t) + sizeof(uint32_t);
+
+// Table lists start with the generation they were found at and whether the
+// query can be cached
+constexpr size_t kTablesHeaderBytes = sizeof(uint64_t) + 1;
+
+// What the authorizer learns about a query while it is being prepared
+struct Analysis {
+  std::set<std::string> tables;
+  bool cacheable = true;
+};
+
+// Set while Lookup() prepares a query on this thread
+thread_local Analysis* current_analysis = nullptr;
+
+// The table a DROP prepared on this thread is about to delete, as
+// "<database>.<table>", taken from the DROP action's own arguments
+thread_local std::string dropping_table;
+
+bool IsDrop(int action) {
+  return action == SQLITE_DROP_TABLE || action == SQLITE_DROP_TEMP_TABLE ||
+         action == SQLITE_DROP_VIEW || action == SQLITE_DROP_TEMP_VIEW ||
+         action == SQLITE_DROP_VTABLE;
+}
+
+// Functions that may return something else on the next call with the same
+// arguments. Date and time functions read the clock for 'now' and when
+// called without arguments.
+bool IsVolatileFunction(const char* name) {
+  static const char* const kVolatileFunctions[] = {
+      "random", "randomblob", "changes", "total_changes", "last_insert_rowid", "date", "time",
+      "datetime", "julianday", "unixepoch", "strftime", "current_date", "current_time",
+      "current_timestamp",
+  };
+  for (const char* function : kVolatileFunctions) {
+    if (strcasecmp(name, function) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int Authorize(void* user_data,
+              int action,
+              const char* argument1,
+              const char* argument2,
+              const char* database_name,
+              const char* trigger_or_view) {
+  Analysis* analysis = current_analysis;
+  if (analysis == nullptr) {
+    // Makes a DELETE without WHERE remove rows one by one, which SQLite then
+    // reports, rather than truncate the table. DROP statements ask about
+    // deleting from the schema table and, right after the DROP action
+    // itself, from the dropped table too, and would be skipped if those
+    // were ignored.
+    if (IsDrop(action) && argument1 != nullptr && database_name != nullptr) {
+      dropping_table = std::string(database_name) + "." + argument1;
+    } else if (action == SQLITE_DELETE && argument1 != nullptr &&
+               strncmp(argument1, "sqlite_", 7) != 0) {
+      std::string table = std::string(database_name != nullptr ? database_name : "") + "." +
+                          argument1;
+      bool dropped = table == dropping_table;
+      dropping_table.clear();
+      return dropped ? SQLITE_OK : SQLITE_IGNORE;
+    }
+    return SQLITE_OK;
+  }
+
+  switch (action) {
+    case SQLITE_SELECT:
+    case SQLITE_RECURSIVE:
+      break;
+    case SQLITE_READ:
+      if (argument1 != nullptr) {
+        analysis->tables.insert(argument1);
+      }
+      break;
+    case SQLITE_FUNCTION:
+      if (argument2 == nullptr || IsVolatileFunction(argument2)) {
+        analysis->cacheable = false;
+      }
+      break;
+    default:
+      // Writes, pragmas, transactions and the like
+      analysis->cacheable = false;
+      break;
+  }
+  return SQLITE_OK;
+}
+
+// Collapses whitespace and comments outside quotes into single spaces and
+// drops trailing semicolons
+std::string NormalizeSql(const std::string& sql) {
+  std::string normalized;
+  normalized.reserve(sql.size());
+  bool space = false;
+  size_t i = 0;
+  while (i < sql.size()) {
+    char c = sql[i];
+    if (isspace(static_cast<unsigned char>(c))) {
+      space = true;
+      i++;
+      continue;
+    }
+    if (c == '-' && sql[i + 1] == '-') {
+      size_t end = sql.find('\n', i);
+      i = end == std::string::npos ? sql.size() : end;
+      space = true;
+      continue;
+    }
+    if (c == '/' && sql[i + 1] == '*') {
+      size_t end = sql.find("*/", i + 2);
+      i = end == std::string::npos ? sql.size() : end + 2;
+      space = true;
+      continue;
+    }
+
+    if (space && !normalized.empty()) {
+      normalized.push_back(' ');
+    }
+    space = false;
+
+    // Quoted strings and identifiers are kept as they are; a doubled quote
+    // just starts the next quoted run
+    if (c == '\'' || c == '"' || c == '`' || c == '[') {
+      size_t end = sql.find(c == '[' ? ']' : c, i + 1);
+      end = end == std::string::npos ? sql.size() : end + 1;
+      normalized.append(sql, i, end - i);
+      i = end;
+      continue;
+    }
+    normalized.push_back(c);
+    i++;
+  }
+
+  while (!normalized.empty() && (normalized.back() == ';' || normalized.back() == ' ')) {
+    normalized.pop_back();
+  }
+  return normalized;
+}
+
+}  // namespace
+
+QueryCache::QueryCache(std::shared_ptr<MemoryCache> cache)
+    : cache_(std::move(cache)), codec_(fl_standard_message_codec_new()) {}
+
+QueryCache::~QueryCache() {
+  g_object_unref(codec_);
+}
+
+void QueryCache::Install(sqlite3* database) {
+  sqlite3_set_authorizer(database, &Authorize, nullptr);
+}
+
+sqlite3_stmt* QueryCache::Prepare(sqlite3* database,
+                                  const std::string& sql,
+                                  std::set<std::string>* tables,
+                                  bool* cacheable) {
+  Analysis analysis;
+  sqlite3_stmt* statement = nullptr;
+  current_analysis = &analysis;
+  int result = sqlite3_prepare_v2(database, sql.c_str(), static_cast<int>(sql.size()),
+                                  &statement, nullptr);
+  current_analysis = nullptr;
+  if (result != SQLITE_OK || statement == nullptr) {
+    sqlite3_finalize(statement);
+    return nullptr;
+  }
+
+  *cacheable = analysis.cacheable && sqlite3_stmt_readonly(statement);
+  tables->insert(analysis.tables.begin(), analysis.tables.end());
+  return statement;
+}
+
+FlValue* QueryCache::Lookup(sqlite3* database,
+                            const std::string& sql,
+                            FlValue* arguments,
+                            ResultFormat format,
+                            Miss* miss) {
+  miss->key.clear();
+
+  std::string normalized_sql = NormalizeSql(sql);
+  std::string key = "q:";
+  key.push_back(static_cast<char>('0' + static_cast<int>(format)));
+  key += normalized_sql;
+  key.push_back('\0');
+  if (arguments != nullptr && fl_value_get_type(arguments) != FL_VALUE_TYPE_NULL) {
+    g_autoptr(GError) error = nullptr;
+    g_autoptr(GBytes) encoded =
+        fl_message_codec_encode_message(FL_MESSAGE_CODEC(codec_), arguments, &error);
+    if (encoded == nullptr) {
+      return nullptr;
+    }
+    gsize size = 0;
+    const char* data = static_cast<const char*>(g_bytes_get_data(encoded, &size));
+    key.append(data, size);
+  }
+
+  uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation = generation_;
+  }
+
+  std::string cached;
+  if (cache_->Get(key, &cached)) {
+    uint64_t cached_generation = 0;
+    uint32_t tables_length = 0;
+    bool current = false;
+    if (cached.size() >= kResultHeaderBytes) {
+      memcpy(&cached_generation, cached.data(), sizeof(cached_generation));
+      memcpy(&tables_length, cached.data() + sizeof(cached_generation), sizeof(tables_length));
+      std::lock_guard<std::mutex> lock(mutex_);
+      current = cached.size() - kResultHeaderBytes >= tables_length &&
+                IsCurrent(cached.data() + kResultHeaderBytes, tables_length, cached_generation);
+    }
+
+    if (current) {
+      size_t offset = kResultHeaderBytes + tables_length;
+      g_autoptr(GBytes) encoded = g_bytes_new(cached.data() + offset, cached.size() - offset);
+      g_autoptr(GError) error = nullptr;
+      FlValue* result =
+          fl_message_codec_decode_message(FL_MESSAGE_CODEC(codec_), encoded, &error);
+      if (result != nullptr) {
+        return result;
+      }
+    }
+    cache_->Erase(key);
+  }
+
+  std::string tables;
+  if (!GetTables(database, normalized_sql, generation, &tables)) {
+    return nullptr;
+  }
+  miss->key = std::move(key);
+  miss->tables = std::move(tables);
+  miss->generation = generation;
+  return nullptr;
+}
+
+bool QueryCache::GetTables(sqlite3* database,
+                           const std::string& normalized_sql,
+                           uint64_t generation,
+                           std::string* tables) {
+  std::string key = "qt:" + normalized_sql;
+  std::string cached;
+  if (cache_->Get(key, &cached) && cached.size() >= kTablesHeaderBytes) {
+    uint64_t cached_generation = 0;
+    memcpy(&cached_generation, cached.data(), sizeof(cached_generation));
+    bool current = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      current = cached_generation >= reset_generation_;
+    }
+    if (current) {
+      tables->assign(cached, kTablesHeaderBytes, std::string::npos);
+      return cached[sizeof(cached_generation)] == '1';
+    }
+  }
+
+  // Only the authorizer calls matter; the statement itself is thrown away
+  std::set<std::string> table_names;
+  bool cacheable = false;
+  sqlite3_stmt* statement = Prepare(database, normalized_sql, &table_names, &cacheable);
+  if (statement == nullptr) {
+    return false;
+  }
+  sqlite3_finalize(statement);
+
+  tables->clear();
+  for (const std::string& table : table_names) {
+    tables->append(table);
+    tables->push_back('\0');
+  }
+
+  std::string value(kTablesHeaderBytes, '\0');
+  memcpy(&value[0], &generation, sizeof(generation));
+  value[sizeof(generation)] = cacheable ? '1' : '0';
+  value += *tables;
+  cache_->Put(key, std::move(value));
+  return cacheable;
+}
+
+void QueryCache::Store(const Miss& miss, FlValue* result) {
+  if (miss.key.empty() || result == nullptr) {
+    return;
+  }
+
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GBytes) encoded =
+      fl_message_codec_encode_message(FL_MESSAGE_CODEC(codec_), result, &error);
+  if (encoded == nullptr) {
+    return;
+  }
+  gsize size = 0;
+  const char* data = static_cast<const char*>(g_bytes_get_data(encoded, &size));
+
+  uint32_t tables_length = static_cast<uint32_t>(miss.tables.size());
+  std::string value(kResultHeaderBytes, '\0');
+  memcpy(&value[0], &miss.generation, sizeof(miss.generation));
+  memcpy(&value[sizeof(miss.generation)], &tables_length, sizeof(tables_length));
+  value += miss.tables;
+  value.append(data, size);
+
+  // A result a write has already overtaken would only be dropped on lookup
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!IsCurrent(miss.tables.data(), miss.tables.size(), miss.generation)) {
+      return;
+    }
+  }
+  cache_->Put(miss.key, std::move(value));
+}
+
+bool QueryCache::IsCurrent(const char* tables, size_t length, uint64_t generation) const {
+  if (generation < reset_generation_) {
+    return false;
+  }
+
+  const char* end = tables + length;
+  while (tables < end) {
+    size_t name_length = strnlen(tables, end - tables);
+    auto it = table_generations_.find(std::string(tables, name_length));
+    if (it != table_generations_.end() && it->second > generation) {
+      return false;
+    }
+    tables += name_length + 1;
+  }
+  return true;
+}
+
+void QueryCache::Invalidate(const std::vector<std::string>& table_names) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  generation_++;
+  for (const std::string& table_name : table_names) {
+    table_generations_[table_name] = generation_;
+  }
+}
+
+void QueryCache::InvalidateAll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  reset_generation_ = ++generation_;
+}
+
+void QueryCache::ApplyChanges(const std::vector<RowChange>& changes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  generation_++;
+  for (const RowChange& change : changes) {
+    if (change.table_name.empty()) {
+      reset_generation_ = generation_;
+    } else {
+      table_generations_[change.table_name] = generation_;
+    }
+  }
+}
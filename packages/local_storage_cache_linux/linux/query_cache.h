@@ -0,0 +1,117 @@
+#ifndef QUERY_CACHE_H_
+#define QUERY_CACHE_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "change_tracker.h"
+#include "memory_cache.h"
+#include "result_encoder.h"
+
+// Results of read-only queries, kept in the plugin's MemoryCache under keys
+// starting with "q:" and served on the next identical query without
+// touching SQLite.
+//
+// A result is keyed by its SQL, with whitespace and comments outside quotes
+// collapsed, its bound arguments and its format, and is tagged with the
+// tables the query reads. The tables are those an authorizer is asked about
+// while the SQL is prepared once on its own, so views, joins and subqueries
+// count with every table beneath them. Statements other than plain SELECTs,
+// and queries calling functions that do not always return the same result,
+// such as random() or date('now'), are never cached.
+//
+// The writer's ChangeTracker invalidates the tables its committed
+// transactions touch, and every table at once when SQLite changed rows
+// without reporting them, e.g. when a full-text index, which keeps part of
+// its data in a WITHOUT ROWID table, is updated. Invalidation is lazy: each
+// table remembers the generation of its last change, and a result is only
+// served if none of its tables changed since the generation taken before it
+// was read. A result read while the writer commits is therefore never served
+// as current, and stale results are dropped once found or evicted by the
+// cache. Writes made by other processes are not seen.
+//
+// Safe to use from any thread.
+class QueryCache {
+ public:
+  // What Store() needs to cache the result of a lookup that missed
+  struct Miss {
+    std::string key;  // Empty if the query cannot be cached
+    std::string tables;
+    uint64_t generation = 0;
+  };
+
+  explicit QueryCache(std::shared_ptr<MemoryCache> cache);
+  ~QueryCache();
+
+  // Disallow copy and assign.
+  QueryCache(const QueryCache&) = delete;
+  QueryCache& operator=(const QueryCache&) = delete;
+
+  // Lets Lookup() learn which tables the queries it prepares on `database`
+  // read, and has DELETEs without WHERE remove and report rows one by one
+  // rather than truncate their table. Called once per connection, before
+  // anything is prepared on it, since installing an authorizer expires the
+  // connection's statements.
+  static void Install(sqlite3* database);
+
+  // Prepares `sql` on `database`, which Install() was called on, and adds
+  // the tables it reads to `tables`. Sets `*cacheable` to whether its
+  // results may be cached. Returns null if `sql` does not prepare.
+  static sqlite3_stmt* Prepare(sqlite3* database,
+                               const std::string& sql,
+                               std::set<std::string>* tables,
+                               bool* cacheable);
+
+  // Returns a new reference to the cached result of `sql` run with
+  // `arguments`, in `format`, or null with `*miss` set. Prepares `sql` on
+  // `database`, which must not be in an open transaction, to learn which
+  // tables it reads the first time it is seen.
+  FlValue* Lookup(sqlite3* database,
+                  const std::string& sql,
+                  FlValue* arguments,
+                  ResultFormat format,
+                  Miss* miss);
+
+  // Caches `result` for the query that missed, unless it cannot be cached
+  void Store(const Miss& miss, FlValue* result);
+
+  // Invalidates the results reading any of `table_names`
+  void Invalidate(const std::vector<std::string>& table_names);
+
+  // Invalidates every result, e.g. once tables may have been dropped or
+  // altered
+  void InvalidateAll();
+
+  // ChangeTracker listener
+  void ApplyChanges(const std::vector<RowChange>& changes);
+
+ private:
+  // Finds the tables `sql`, normalized, reads, as '\0'-terminated names.
+  // Returns false if its results cannot be cached.
+  bool GetTables(sqlite3* database,
+                 const std::string& normalized_sql,
+                 uint64_t generation,
+                 std::string* tables);
+
+  // Whether none of `tables` changed after `generation`. Called with
+  // `mutex_` held.
+  bool IsCurrent(const char* tables, size_t length, uint64_t generation) const;
+
+  std::shared_ptr<MemoryCache> cache_;
+  FlStandardMessageCodec* codec_;
+
+  mutable std::mutex mutex_;
+  uint64_t generation_ = 0;        // Advanced by every invalidation
+  uint64_t reset_generation_ = 0;  // Of the last InvalidateAll()
+  std::unordered_map<std::string, uint64_t> table_generations_;
+};
+
+#endif  // QUERY_CACHE_H_
@@ -0,0 +1,242 @@
+#include "query_watcher.h"
+
+#include <utility>
+
+#include "query_cache.h"
+#include "result_encoder.h"
+#include "value_binding.h"
+
+QueryWatcher::QueryWatcher(sqlite3* database)
+    : database_(database), codec_(fl_standard_message_codec_new()) {}
+
+QueryWatcher::~QueryWatcher() {
+  for (auto& query : queries_) {
+    Finalize(query.second);
+  }
+  g_object_unref(codec_);
+}
+
+int64_t QueryWatcher::Watch(const std::string& sql,
+                            FlValue* arguments,
+                            const std::string& key_column,
+                            Listener listener,
+                            FlValue** rows,
+                            std::string* error) {
+  WatchedQuery query;
+  bool cacheable = false;
+  query.statement = QueryCache::Prepare(database_, sql, &query.tables, &cacheable);
+  if (query.statement == nullptr) {
+    *error = sqlite3_errmsg(database_);
+    return 0;
+  }
+  if (!sqlite3_stmt_readonly(query.statement)) {
+    sqlite3_finalize(query.statement);
+    *error = "only queries that do not write can be watched";
+    return 0;
+  }
+  if (!BindArguments(query.statement, arguments)) {
+    sqlite3_finalize(query.statement);
+    *error = "arguments could not be bound";
+    return 0;
+  }
+  query.arguments = arguments ? fl_value_ref(arguments) : nullptr;
+
+  FlValue* result = Run(&query);
+  if (result == nullptr) {
+    *error = sqlite3_errmsg(database_);
+    Finalize(query);
+    return 0;
+  }
+
+  query.id = next_id_++;
+  query.key_column = key_column;
+  query.listener = std::move(listener);
+  Update(&query, result, true);
+  *rows = result;
+
+  int64_t id = query.id;
+  queries_.emplace(id, std::move(query));
+  return id;
+}
+
+bool QueryWatcher::Unwatch(int64_t id) {
+  auto it = queries_.find(id);
+  if (it == queries_.end()) {
+    return false;
+  }
+  Finalize(it->second);
+  queries_.erase(it);
+  return true;
+}
+
+void QueryWatcher::ApplyChanges(const std::vector<RowChange>& changes) {
+  if (queries_.empty()) {
+    return;
+  }
+
+  // Rows SQLite did not report could be in any table
+  std::set<std::string> tables;
+  bool unknown = false;
+  for (const RowChange& change : changes) {
+    if (change.table_name.empty()) {
+      unknown = true;
+    } else {
+      tables.insert(change.table_name);
+    }
+  }
+
+  for (auto& entry : queries_) {
+    WatchedQuery& query = entry.second;
+    bool affected = unknown;
+    for (auto it = query.tables.begin(); !affected && it != query.tables.end(); ++it) {
+      affected = tables.count(*it) > 0;
+    }
+    if (!affected) {
+      continue;
+    }
+
+    // A query that fails, e.g. since its table was dropped, keeps its last
+    // result until it runs again
+    g_autoptr(FlValue) rows = Run(&query);
+    if (rows == nullptr) {
+      continue;
+    }
+    g_autoptr(FlValue) diff = Update(&query, rows, false);
+    if (diff != nullptr) {
+      query.listener(diff);
+    }
+  }
+}
+
+void QueryWatcher::Finalize(const WatchedQuery& query) {
+  sqlite3_finalize(query.statement);
+  if (query.arguments) {
+    fl_value_unref(query.arguments);
+  }
+}
+
+FlValue* QueryWatcher::Run(WatchedQuery* query) {
+  sqlite3_reset(query->statement);
+  FlValue* rows = EncodeRows(query->statement);
+  bool done = sqlite3_errcode(database_) == SQLITE_DONE;
+  sqlite3_reset(query->statement);
+  if (!done) {
+    fl_value_unref(rows);
+    return nullptr;
+  }
+  return rows;
+}
+
+FlValue* QueryWatcher::Update(WatchedQuery* query, FlValue* rows, bool initial) {
+  size_t count = fl_value_get_length(rows);
+  std::vector<std::string> keys;
+  std::unordered_map<std::string, std::string> encoded_rows;
+  keys.reserve(count);
+  bool keyed = true;
+  for (size_t i = 0; i < count && keyed; i++) {
+    FlValue* row = fl_value_get_list_value(rows, i);
+    FlValue* key = fl_value_lookup_string(row, query->key_column.c_str());
+    std::string encoded_key;
+    std::string encoded_row;
+    keyed = key != nullptr && Encode(key, &encoded_key) && Encode(row, &encoded_row) &&
+            encoded_rows.emplace(encoded_key, std::move(encoded_row)).second;
+    keys.push_back(std::move(encoded_key));
+  }
+
+  // A result that cannot be keyed, or follows one that could not, goes
+  // whole whenever it changed
+  if (initial || !keyed || !query->keyed) {
+    std::string unkeyed_rows;
+    bool changed = !initial;
+    if (!keyed) {
+      Encode(rows, &unkeyed_rows);
+      changed = changed && (query->keyed || unkeyed_rows.empty() ||
+                            unkeyed_rows != query->unkeyed_rows);
+    }
+    query->keyed = keyed;
+    query->keys = keyed ? std::move(keys) : std::vector<std::string>();
+    query->rows = keyed ? std::move(encoded_rows) : std::unordered_map<std::string, std::string>();
+    query->unkeyed_rows = std::move(unkeyed_rows);
+    if (!changed) {
+      return nullptr;
+    }
+
+    FlValue* diff = fl_value_new_map();
+    fl_value_set_string_take(diff, "watchId", fl_value_new_int(query->id));
+    fl_value_set_string(diff, "rows", rows);
+    return diff;
+  }
+
+  // The previous keys still there, in their order, then the new ones: the
+  // order applying the diff leaves the rows in
+  FlValue* removed = fl_value_new_list();
+  std::vector<std::string> implied_keys;
+  implied_keys.reserve(count);
+  for (const std::string& key : query->keys) {
+    if (encoded_rows.count(key) > 0) {
+      implied_keys.push_back(key);
+    } else {
+      FlValue* decoded = Decode(key);
+      fl_value_append_take(removed, decoded != nullptr ? decoded : fl_value_new_null());
+    }
+  }
+
+  FlValue* inserted = fl_value_new_list();
+  FlValue* changed = fl_value_new_list();
+  for (size_t i = 0; i < count; i++) {
+    FlValue* row = fl_value_get_list_value(rows, i);
+    auto previous = query->rows.find(keys[i]);
+    if (previous == query->rows.end()) {
+      fl_value_append(inserted, row);
+      implied_keys.push_back(keys[i]);
+    } else if (previous->second != encoded_rows[keys[i]]) {
+      fl_value_append(changed, row);
+    }
+  }
+
+  bool reordered = implied_keys != keys;
+  bool changes = reordered || fl_value_get_length(removed) > 0 ||
+                 fl_value_get_length(inserted) > 0 || fl_value_get_length(changed) > 0;
+  query->keys = std::move(keys);
+  query->rows = std::move(encoded_rows);
+  if (!changes) {
+    fl_value_unref(removed);
+    fl_value_unref(inserted);
+    fl_value_unref(changed);
+    return nullptr;
+  }
+
+  FlValue* diff = fl_value_new_map();
+  fl_value_set_string_take(diff, "watchId", fl_value_new_int(query->id));
+  fl_value_set_string_take(diff, "inserted", inserted);
+  fl_value_set_string_take(diff, "changed", changed);
+  fl_value_set_string_take(diff, "removed", removed);
+  if (reordered) {
+    FlValue* order = fl_value_new_list();
+    for (size_t i = 0; i < count; i++) {
+      fl_value_append(order, fl_value_lookup_string(fl_value_get_list_value(rows, i),
+                                                    query->key_column.c_str()));
+    }
+    fl_value_set_string_take(diff, "order", order);
+  }
+  return diff;
+}
+
+bool QueryWatcher::Encode(FlValue* value, std::string* encoded) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GBytes) bytes =
+      fl_message_codec_encode_message(FL_MESSAGE_CODEC(codec_), value, &error);
+  if (bytes == nullptr) {
+    return false;
+  }
+  gsize size = 0;
+  const char* data = static_cast<const char*>(g_bytes_get_data(bytes, &size));
+  encoded->assign(data, size);
+  return true;
+}
+
+FlValue* QueryWatcher::Decode(const std::string& encoded) {
+  g_autoptr(GBytes) bytes = g_bytes_new(encoded.data(), encoded.size());
+  g_autoptr(GError) error = nullptr;
+  return fl_message_codec_decode_message(FL_MESSAGE_CODEC(codec_), bytes, &error);
+}
@@ -0,0 +1,101 @@
+#ifndef QUERY_WATCHER_H_
+#define QUERY_WATCHER_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "change_tracker.h"
+
+// Queries Dart watches on the writer connection. Each is re-run only once a
+// committed write touches a table it reads, and only what changed in its
+// result is handed on.
+//
+// The tables a query reads are those the authorizer QueryCache::Install()
+// sets up is asked about when the query is prepared, so views, joins and
+// subqueries count with every table beneath them. Rows are matched across
+// runs by the value of a key column, typically the rowid or primary key; a
+// result missing that column, or holding a key twice, is handed on whole
+// instead.
+//
+// Only used from the writer's thread.
+class QueryWatcher {
+ public:
+  // Called with each diff, a map holding the `watchId`, the `inserted` and
+  // `changed` rows and the keys of the `removed` rows. Applying it means
+  // dropping the removed rows, replacing the changed ones in place and
+  // appending the inserted ones; if that leaves the rows in another order
+  // than the query's, the diff also holds the `order` of every key. A
+  // result that cannot be diffed comes as its `rows` instead. `diff` is
+  // borrowed.
+  using Listener = std::function<void(FlValue* diff)>;
+
+  explicit QueryWatcher(sqlite3* database);
+  ~QueryWatcher();
+
+  // Disallow copy and assign.
+  QueryWatcher(const QueryWatcher&) = delete;
+  QueryWatcher& operator=(const QueryWatcher&) = delete;
+
+  // Runs `sql` with `arguments` and watches it from then on, matching rows
+  // by `key_column`. Returns the id of the watch and sets `*rows` to a new
+  // reference to the first result, or returns 0 with `*error` set.
+  int64_t Watch(const std::string& sql,
+                FlValue* arguments,
+                const std::string& key_column,
+                Listener listener,
+                FlValue** rows,
+                std::string* error);
+
+  // Returns false if nothing is watched under `id`.
+  bool Unwatch(int64_t id);
+
+  // ChangeTracker listener
+  void ApplyChanges(const std::vector<RowChange>& changes);
+
+ private:
+  struct WatchedQuery {
+    int64_t id;
+    sqlite3_stmt* statement;  // Arguments stay bound across runs
+    FlValue* arguments;       // Kept alive for the statically bound strings
+    std::string key_column;
+    std::set<std::string> tables;
+    Listener listener;
+
+    // The last result: encoded keys in result order and encoded rows by
+    // key, or, if it could not be keyed, the whole result encoded
+    bool keyed = false;
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, std::string> rows;
+    std::string unkeyed_rows;
+  };
+
+  // Releases the statement and arguments of `query`
+  void Finalize(const WatchedQuery& query);
+
+  // Runs `query` and returns a new reference to its rows, or null if it
+  // failed
+  FlValue* Run(WatchedQuery* query);
+
+  // Keeps `rows` as the last result of `query`. Returns the diff from the
+  // previous result, or null if nothing changed; with `initial`, nothing is
+  // compared.
+  FlValue* Update(WatchedQuery* query, FlValue* rows, bool initial);
+
+  bool Encode(FlValue* value, std::string* encoded);
+  FlValue* Decode(const std::string& encoded);
+
+  sqlite3* database_;
+  FlStandardMessageCodec* codec_;
+  std::map<int64_t, WatchedQuery> queries_;
+  int64_t next_id_ = 1;
+};
+
+#endif  // QUERY_WATCHER_H_
@@ -0,0 +1,220 @@
+#include "reader_pool.h"
+
+#include <strings.h>
+
+#include <cctype>
+#include <utility>
+
+#include "result_encoder.h"
+#include "value_binding.h"
+#include "vector_functions.h"
+
+namespace {
+
+// Opens a read-only connection to `database_path` set up like the writer's.
+// Returns null on failure.
+sqlite3* OpenReadOnly(const std::string& database_path, const DatabaseConfig& config) {
+  sqlite3* database = nullptr;
+  int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+  if (sqlite3_open_v2(database_path.c_str(), &database, flags, nullptr) != SQLITE_OK ||
+      !RegisterVectorFunctions(database)) {
+    sqlite3_close(database);
+    return nullptr;
+  }
+  config.ApplyToReader(database);
+  return database;
+}
+
+}  // namespace
+
+ReaderConnection::~ReaderConnection() {
+  Close();
+}
+
+bool ReaderConnection::Open(const std::string& database_path,
+                            const DatabaseConfig& config,
+                            std::shared_ptr<VectorIndexManager> vector_indexes,
+                            std::shared_ptr<QueryCache> query_cache) {
+  database_ = OpenReadOnly(database_path, config);
+  cursor_database_ = OpenReadOnly(database_path, config);
+  if (database_ == nullptr || cursor_database_ == nullptr) {
+    Close();
+    return false;
+  }
+  
+  if (query_cache) {
+    QueryCache::Install(database_);
+  }
+  statement_cache_ =
+      std::make_unique<StatementCache>(database_, config.statement_cache_size);
+  cursors_ = std::make_unique<CursorManager>(cursor_database_, config.cursor_idle_timeout_ms);
+  vector_indexes_ = std::move(vector_indexes);
+  query_cache_ = std::move(query_cache);
+  return true;
+}
+
+void ReaderConnection::Close() {
+  cursors_.reset();
+  statement_cache_.reset();
+  vector_indexes_.reset();
+  query_cache_.reset();
+  
+  if (database_) {
+    sqlite3_close(database_);
+    database_ = nullptr;
+  }
+  if (cursor_database_) {
+    sqlite3_close(cursor_database_);
+    cursor_database_ = nullptr;
+  }
+}
+
+FlValue* ReaderConnection::Query(const std::string& sql,
+                                 FlValue* arguments,
+                                 ResultFormat format,
+                                 bool* requires_writer) {
+  *requires_writer = false;
+  
+  QueryCache::Miss miss;
+  if (query_cache_) {
+    FlValue* cached = query_cache_->Lookup(database_, sql, arguments, format, &miss);
+    if (cached != nullptr) {
+      return cached;
+    }
+  }
+  
+  ScopedStatement statement = statement_cache_->Acquire(sql);
+  if (!statement) {
+    // Read-only connections cannot compile statements against tables the
+    // writer has not created yet, so let the writer report the real error
+    *requires_writer = true;
+    return nullptr;
+  }
+  
+  if (!sqlite3_stmt_readonly(statement.get())) {
+    *requires_writer = true;
+    return nullptr;
+  }
+  
+  if (!BindArguments(statement.get(), arguments)) {
+    return EncodeEmptyResult(format);
+  }
+  
+  FlValue* result = EncodeResult(statement.get(), format);
+  if (query_cache_ && sqlite3_errcode(database_) == SQLITE_DONE) {
+    query_cache_->Store(miss, result);
+  }
+  return result;
+}
+
+bool ReaderConnection::OpenCursor(int64_t cursor_id,
+                                  const std::string& sql,
+                                  FlValue* arguments) {
+  std::string error;
+  return cursors_->Open(cursor_id, sql, arguments, true, &error);
+}
+
+ReaderPool::~ReaderPool() {
+  Close();
+}
+
+bool ReaderPool::Open(const std::string& database_path,
+                      const DatabaseConfig& config,
+                      std::shared_ptr<VectorIndexManager> vector_indexes,
+                      std::shared_ptr<QueryCache> query_cache) {
+  Close();
+  
+  std::vector<std::unique_ptr<Reader>> readers;
+  for (size_t i = 0; i < config.reader_pool_size; i++) {
+    auto reader = std::make_unique<Reader>(i);
+    if (!reader->connection.Open(database_path, config, vector_indexes, query_cache)) {
+      return false;
+    }
+    reader->executor = std::make_unique<DatabaseExecutor>();
+    readers.push_back(std::move(reader));
+  }
+  
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shut_down_) {
+    return false;
+  }
+  readers_ = std::move(readers);
+  return true;
+}
+
+void ReaderPool::Close() {
+  std::vector<std::unique_ptr<Reader>> readers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    readers.swap(readers_);
+  }
+  
+  // Outside the lock: joining lets queued reads finish, and they may post
+  // follow-up work back through the plugin
+  for (auto& reader : readers) {
+    reader->executor.reset();
+    reader->connection.Close();
+  }
+}
+
+void ReaderPool::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shut_down_ = true;
+  }
+  Close();
+}
+
+bool ReaderPool::Post(Task task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (readers_.empty()) {
+    return false;
+  }
+  
+  Reader* target = readers_.front().get();
+  for (auto& reader : readers_) {
+    if (reader->in_flight.load() < target->in_flight.load()) {
+      target = reader.get();
+    }
+  }
+  
+  PostLocked(target, std::move(task));
+  return true;
+}
+
+bool ReaderPool::PostTo(size_t index, Task task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index >= readers_.size()) {
+    return false;
+  }
+  
+  PostLocked(readers_[index].get(), std::move(task));
+  return true;
+}
+
+void ReaderPool::PostToAll(const Task& task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& reader : readers_) {
+    PostLocked(reader.get(), task);
+  }
+}
+
+void ReaderPool::PostLocked(Reader* reader, Task task) {
+  reader->in_flight.fetch_add(1);
+  reader->executor->Post([reader, task = std::move(task)]() {
+    task(&reader->connection);
+    reader->in_flight.fetch_sub(1);
+  });
+}
+
+size_t ReaderPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return readers_.size();
+}
+
+bool IsReadQuery(const char* sql) {
+  while (isspace(static_cast<unsigned char>(*sql))) {
+    sql++;
+  }
+  return strncasecmp(sql, "SELECT", 6) == 0 || strncasecmp(sql, "WITH", 4) == 0;
+}
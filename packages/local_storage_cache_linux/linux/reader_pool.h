@@ -0,0 +1,136 @@
+#ifndef READER_POOL_H_
+#define READER_POOL_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cursor_manager.h"
+#include "database_config.h"
+#include "database_executor.h"
+#include "query_cache.h"
+#include "result_encoder.h"
+#include "statement_cache.h"
+#include "vector_index_manager.h"
+
+// A read-only connection, used exclusively by its reader thread.
+//
+// Cursors run on a second connection of their own: an open cursor keeps its
+// connection's read transaction, and with it a WAL snapshot, alive until it
+// is done or expires, and queries sharing that connection would read the
+// same stale snapshot.
+class ReaderConnection {
+ public:
+  explicit ReaderConnection(size_t index) : index_(index) {}
+  ~ReaderConnection();
+
+  // Disallow copy and assign.
+  ReaderConnection(const ReaderConnection&) = delete;
+  ReaderConnection& operator=(const ReaderConnection&) = delete;
+
+  bool Open(const std::string& database_path,
+            const DatabaseConfig& config,
+            std::shared_ptr<VectorIndexManager> vector_indexes,
+            std::shared_ptr<QueryCache> query_cache);
+  void Close();
+
+  // Runs a read-only query, or serves it from the query cache. Sets
+  // `*requires_writer` and returns nullptr if the SQL turns out to modify the
+  // database.
+  FlValue* Query(const std::string& sql,
+                 FlValue* arguments,
+                 ResultFormat format,
+                 bool* requires_writer);
+
+  // Opens a cursor over a read-only query. Returns false if the SQL does not
+  // compile here or modifies the database; the writer should open it instead.
+  bool OpenCursor(int64_t cursor_id, const std::string& sql, FlValue* arguments);
+
+  // Position of this reader in its pool
+  size_t index() const { return index_; }
+
+  sqlite3* database() const { return database_; }
+  sqlite3* cursor_database() const { return cursor_database_; }
+  StatementCache* statement_cache() const { return statement_cache_.get(); }
+  CursorManager* cursors() const { return cursors_.get(); }
+
+  // The writer's vector indexes, which readers search directly
+  VectorIndexManager* vector_indexes() const { return vector_indexes_.get(); }
+
+ private:
+  size_t index_;
+  sqlite3* database_ = nullptr;
+  sqlite3* cursor_database_ = nullptr;
+  std::unique_ptr<StatementCache> statement_cache_;
+  std::unique_ptr<CursorManager> cursors_;
+  std::shared_ptr<VectorIndexManager> vector_indexes_;
+  std::shared_ptr<QueryCache> query_cache_;  // Null if disabled
+};
+
+// Pool of read-only WAL connections, each served by its own thread, so reads
+// run concurrently with each other and with the single writer.
+class ReaderPool {
+ public:
+  using Task = std::function<void(ReaderConnection*)>;
+
+  ReaderPool() = default;
+  ~ReaderPool();
+
+  // Disallow copy and assign.
+  ReaderPool(const ReaderPool&) = delete;
+  ReaderPool& operator=(const ReaderPool&) = delete;
+
+  // Opens `config.reader_pool_size` reader connections. The writer must
+  // already have switched the database to WAL mode.
+  bool Open(const std::string& database_path,
+            const DatabaseConfig& config,
+            std::shared_ptr<VectorIndexManager> vector_indexes,
+            std::shared_ptr<QueryCache> query_cache);
+
+  // Runs queued reads to completion, then closes every reader.
+  void Close();
+
+  // Closes the pool for good; later Open() calls fail.
+  void Shutdown();
+
+  // Queues `task` on the least busy reader. Returns false if the pool is
+  // closed, in which case the caller should run the read on the writer.
+  bool Post(Task task);
+
+  // Queues `task` on the reader at `index`, e.g. the one holding a cursor.
+  // Returns false if there is no such reader.
+  bool PostTo(size_t index, Task task);
+
+  // Queues a copy of `task` on every reader.
+  void PostToAll(const Task& task);
+
+  size_t size() const;
+
+ private:
+  struct Reader {
+    explicit Reader(size_t index) : connection(index) {}
+
+    ReaderConnection connection;
+    std::unique_ptr<DatabaseExecutor> executor;
+    std::atomic<int> in_flight{0};
+  };
+
+  // Must be called with `mutex_` held
+  void PostLocked(Reader* reader, Task task);
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Reader>> readers_;
+  bool shut_down_ = false;
+};
+
+// Whether `sql` looks like a read (SELECT or WITH). Readers double-check with
+// sqlite3_stmt_readonly() before running it.
+bool IsReadQuery(const char* sql);
+
+#endif  // READER_POOL_H_
@@ -0,0 +1,143 @@
+#include "result_encoder.h"
+
+#include <vector>
+
+#include "packed_result.h"
+#include "vector_codec.h"
+
+namespace {
+
+// BLOBs come back as Uint8List, except in vector columns, which decode to
+// Float32List (F16_BLOB, F32_BLOB, I8_BLOB) or Float64List (F64_BLOB)
+FlValue* EncodeBlob(sqlite3_stmt* statement, int index) {
+  const void* blob = sqlite3_column_blob(statement, index);
+  size_t length = static_cast<size_t>(sqlite3_column_bytes(statement, index));
+  if (blob == nullptr || length == 0) {
+    return fl_value_new_uint8_list(nullptr, 0);
+  }
+  
+  VectorElementType type;
+  size_t count = 0;
+  if (!ParseVectorType(sqlite3_column_decltype(statement, index), &type) ||
+      !VectorBlobDimensions(type, length, &count)) {
+    return fl_value_new_uint8_list(static_cast<const uint8_t*>(blob), length);
+  }
+  
+  switch (type) {
+    case VectorElementType::kFloat16:
+    case VectorElementType::kInt8: {
+      std::vector<float> values(count);
+      DecodeVector(blob, type, &values);
+      return fl_value_new_float32_list(values.data(), count);
+    }
+    case VectorElementType::kFloat64:
+      // The list copies the bytes straight out of SQLite's buffer
+      return fl_value_new_float_list(static_cast<const double*>(blob), count);
+    case VectorElementType::kFloat32:
+    default:
+      return fl_value_new_float32_list(static_cast<const float*>(blob), count);
+  }
+}
+
+FlValue* EncodeColumn(sqlite3_stmt* statement, int index) {
+  switch (sqlite3_column_type(statement, index)) {
+    case SQLITE_INTEGER:
+      return fl_value_new_int(sqlite3_column_int64(statement, index));
+    case SQLITE_FLOAT:
+      return fl_value_new_float(sqlite3_column_double(statement, index));
+    case SQLITE_TEXT: {
+      const char* text = reinterpret_cast<const char*>(
+          sqlite3_column_text(statement, index));
+      return fl_value_new_string(text);
+    }
+    case SQLITE_BLOB:
+      return EncodeBlob(statement, index);
+    case SQLITE_NULL:
+    default:
+      return fl_value_new_null();
+  }
+}
+
+FlValue* EncodeColumnar(sqlite3_stmt* statement) {
+  int column_count = sqlite3_column_count(statement);
+  
+  FlValue* columns = fl_value_new_list();
+  for (int i = 0; i < column_count; i++) {
+    fl_value_append_take(columns, fl_value_new_string(sqlite3_column_name(statement, i)));
+  }
+  
+  FlValue* rows = fl_value_new_list();
+  while (sqlite3_step(statement) == SQLITE_ROW) {
+    FlValue* row = fl_value_new_list();
+    for (int i = 0; i < column_count; i++) {
+      fl_value_append_take(row, EncodeColumn(statement, i));
+    }
+    fl_value_append_take(rows, row);
+  }
+  
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "columns", columns);
+  fl_value_set_string_take(result, "rows", rows);
+  return result;
+}
+
+}  // namespace
+
+FlValue* EncodeRows(sqlite3_stmt* statement) {
+  bool done = false;
+  return EncodeRows(statement, INT64_MAX, &done);
+}
+
+FlValue* EncodeRows(sqlite3_stmt* statement, int64_t max_rows, bool* done) {
+  g_autoptr(FlValue) results = fl_value_new_list();
+  *done = false;
+  
+  for (int64_t count = 0; count < max_rows; count++) {
+    if (sqlite3_step(statement) != SQLITE_ROW) {
+      *done = true;
+      break;
+    }
+    
+    FlValue* row = fl_value_new_map();
+    int column_count = sqlite3_column_count(statement);
+    
+    for (int i = 0; i < column_count; i++) {
+      const char* column_name = sqlite3_column_name(statement, i);
+      
+      // The row takes ownership of both key and value
+      fl_value_set_take(row, fl_value_new_string(column_name), EncodeColumn(statement, i));
+    }
+    
+    fl_value_append_take(results, row);
+  }
+  
+  return fl_value_ref(results);
+}
+
+FlValue* EncodeResult(sqlite3_stmt* statement, ResultFormat format) {
+  switch (format) {
+    case ResultFormat::kColumnar:
+      return EncodeColumnar(statement);
+    case ResultFormat::kPacked:
+      return EncodePacked(statement);
+    case ResultFormat::kMaps:
+    default:
+      return EncodeRows(statement);
+  }
+}
+
+FlValue* EncodeEmptyResult(ResultFormat format) {
+  switch (format) {
+    case ResultFormat::kColumnar: {
+      FlValue* result = fl_value_new_map();
+      fl_value_set_string_take(result, "columns", fl_value_new_list());
+      fl_value_set_string_take(result, "rows", fl_value_new_list());
+      return result;
+    }
+    case ResultFormat::kPacked:
+      return EncodeEmptyPacked();
+    case ResultFormat::kMaps:
+    default:
+      return fl_value_new_list();
+  }
+}
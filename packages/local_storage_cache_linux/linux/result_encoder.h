@@ -0,0 +1,34 @@
+#ifndef RESULT_ENCODER_H_
+#define RESULT_ENCODER_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+
+// Shape of a query response sent back over the method channel.
+enum class ResultFormat {
+  // A list of column-name -> value maps, one per row
+  kMaps,
+  // {"columns": [names], "rows": [[values], ...]}; column names are sent
+  // once instead of once per row
+  kColumnar,
+  // A single Uint8List, see packed_result.h
+  kPacked,
+};
+
+// Steps `statement` to completion and returns its rows as a list of
+// column-name -> value maps.
+FlValue* EncodeRows(sqlite3_stmt* statement);
+
+// Steps `statement` at most `max_rows` times. Sets `*done` once the statement
+// has no more rows.
+FlValue* EncodeRows(sqlite3_stmt* statement, int64_t max_rows, bool* done);
+
+// Steps `statement` to completion and returns its rows in `format`.
+FlValue* EncodeResult(sqlite3_stmt* statement, ResultFormat format);
+
+// The response for a query that produced no rows, or could not run.
+FlValue* EncodeEmptyResult(ResultFormat format);
+
+#endif  // RESULT_ENCODER_H_
@@ -0,0 +1,9 @@
+#ifndef SQL_UTIL_H_
+#define SQL_UTIL_H_
+
+#include <string>
+
+// Quotes `name` as an SQL identifier.
+std::string QuoteIdentifier(const std::string& name);
+
+#endif  // SQL_UTIL_H_
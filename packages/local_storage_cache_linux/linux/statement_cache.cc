@@ -0,0 +1,142 @@
+#include "statement_cache.h"
+
+#include <utility>
+
+ScopedStatement::ScopedStatement(StatementCache* cache,
+                                 sqlite3_stmt* statement,
+                                 bool cached)
+    : cache_(cache), statement_(statement), cached_(cached) {}
+
+ScopedStatement::~ScopedStatement() {
+  Reset();
+}
+
+ScopedStatement::ScopedStatement(ScopedStatement&& other) noexcept
+    : cache_(other.cache_),
+      statement_(other.statement_),
+      cached_(other.cached_) {
+  other.cache_ = nullptr;
+  other.statement_ = nullptr;
+}
+
+ScopedStatement& ScopedStatement::operator=(ScopedStatement&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    cache_ = other.cache_;
+    statement_ = other.statement_;
+    cached_ = other.cached_;
+    other.cache_ = nullptr;
+    other.statement_ = nullptr;
+  }
+  return *this;
+}
+
+void ScopedStatement::Reset() {
+  if (statement_) {
+    cache_->Release(statement_, cached_);
+    statement_ = nullptr;
+  }
+}
+
+StatementCache::StatementCache(sqlite3* database, size_t capacity)
+    : database_(database), capacity_(capacity) {
+  stats_.capacity = capacity;
+}
+
+StatementCache::~StatementCache() {
+  Clear();
+}
+
+ScopedStatement StatementCache::Acquire(const std::string& sql) {
+  return Acquire(sql, nullptr);
+}
+
+ScopedStatement StatementCache::Acquire(
+    const std::string& key,
+    const std::function<std::string()>& build_sql) {
+  auto it = index_.find(key);
+  if (it != index_.end() && !it->second->in_use) {
+    stats_.hits++;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    it->second->in_use = true;
+    return ScopedStatement(this, it->second->statement, true);
+  }
+
+  stats_.misses++;
+
+  std::string built_sql = build_sql ? build_sql() : std::string();
+  const std::string& sql = build_sql ? built_sql : key;
+  
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    sqlite3_finalize(statement);
+    return ScopedStatement();
+  }
+
+  // The same SQL is already borrowed further up the stack (e.g. a nested
+  // query); hand out a one-off statement rather than sharing it.
+  if (it != index_.end() || capacity_ == 0) {
+    return ScopedStatement(this, statement, false);
+  }
+
+  entries_.push_front(Entry{key, statement, true});
+  index_[key] = entries_.begin();
+  by_statement_[statement] = entries_.begin();
+  EvictIfNecessary();
+
+  return ScopedStatement(this, statement, true);
+}
+
+void StatementCache::Clear() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    // Borrowed statements are finalized by Release() once handed back.
+    if (!it->in_use) {
+      sqlite3_finalize(it->statement);
+    }
+    it = entries_.erase(it);
+  }
+  index_.clear();
+  by_statement_.clear();
+}
+
+void StatementCache::SetCapacity(size_t capacity) {
+  capacity_ = capacity;
+  stats_.capacity = capacity;
+  EvictIfNecessary();
+}
+
+StatementCache::Stats StatementCache::GetStats() const {
+  Stats stats = stats_;
+  stats.size = entries_.size();
+  return stats;
+}
+
+void StatementCache::Release(sqlite3_stmt* statement, bool cached) {
+  auto it = cached ? by_statement_.find(statement) : by_statement_.end();
+  if (it == by_statement_.end()) {
+    sqlite3_finalize(statement);
+    return;
+  }
+
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+  it->second->in_use = false;
+
+  // Borrowed entries are skipped during eviction, so the cache may have
+  // grown past capacity while this one was out.
+  EvictIfNecessary();
+}
+
+void StatementCache::EvictIfNecessary() {
+  auto it = entries_.end();
+  while (entries_.size() > capacity_ && it != entries_.begin()) {
+    --it;
+    if (it->in_use) continue;
+
+    sqlite3_finalize(it->statement);
+    index_.erase(it->key);
+    by_statement_.erase(it->statement);
+    it = entries_.erase(it);
+    stats_.evictions++;
+  }
+}
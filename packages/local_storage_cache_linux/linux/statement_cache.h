@@ -0,0 +1,99 @@
+#ifndef STATEMENT_CACHE_H_
+#define STATEMENT_CACHE_H_
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+class StatementCache;
+
+// Borrowed handle to a prepared statement. Hands the statement back to its
+// cache (reset and unbound) when it goes out of scope.
+class ScopedStatement {
+ public:
+  ScopedStatement() = default;
+  ScopedStatement(StatementCache* cache, sqlite3_stmt* statement, bool cached);
+  ~ScopedStatement();
+
+  ScopedStatement(ScopedStatement&& other) noexcept;
+  ScopedStatement& operator=(ScopedStatement&& other) noexcept;
+
+  // Disallow copy and assign.
+  ScopedStatement(const ScopedStatement&) = delete;
+  ScopedStatement& operator=(const ScopedStatement&) = delete;
+
+  sqlite3_stmt* get() const { return statement_; }
+  explicit operator bool() const { return statement_ != nullptr; }
+
+ private:
+  void Reset();
+
+  StatementCache* cache_ = nullptr;
+  sqlite3_stmt* statement_ = nullptr;
+  bool cached_ = false;
+};
+
+// Bounded LRU cache of prepared statements for a single connection, keyed by
+// SQL text or a caller-supplied signature.
+class StatementCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+  };
+
+  static constexpr size_t kDefaultCapacity = 100;
+
+  StatementCache(sqlite3* database, size_t capacity = kDefaultCapacity);
+  ~StatementCache();
+
+  // Disallow copy and assign.
+  StatementCache(const StatementCache&) = delete;
+  StatementCache& operator=(const StatementCache&) = delete;
+
+  // Returns a ready-to-bind statement for `sql`, preparing it on a miss.
+  // The handle is empty if the SQL fails to compile.
+  ScopedStatement Acquire(const std::string& sql);
+
+  // Same as above, but caches under `key` and only calls `build_sql` on a
+  // miss. Lets callers with a cheap signature (e.g. an insert's column list)
+  // skip building the SQL text on every call.
+  ScopedStatement Acquire(const std::string& key,
+                          const std::function<std::string()>& build_sql);
+
+  // Finalizes every cached statement. Statements that are currently borrowed
+  // are finalized when they are handed back.
+  void Clear();
+
+  void SetCapacity(size_t capacity);
+
+  Stats GetStats() const;
+
+ private:
+  friend class ScopedStatement;
+
+  struct Entry {
+    std::string key;
+    sqlite3_stmt* statement;
+    bool in_use;
+  };
+
+  void Release(sqlite3_stmt* statement, bool cached);
+  void EvictIfNecessary();
+
+  sqlite3* database_;
+  size_t capacity_;
+  std::list<Entry> entries_;  // Most recently used first.
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  std::unordered_map<sqlite3_stmt*, std::list<Entry>::iterator> by_statement_;
+  Stats stats_;
+};
+
+#endif  // STATEMENT_CACHE_H_
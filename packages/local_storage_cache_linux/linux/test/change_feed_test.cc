@@ -0,0 +1,52 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <vector>
+
+#include "change_feed.h"
+#include "change_tracker.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+TEST(ChangeFeed, ReportsRowsOfUnknownTables) {
+  sqlite3* database = nullptr;
+  ASSERT_EQ(sqlite3_open(":memory:", &database), SQLITE_OK);
+  ASSERT_EQ(sqlite3_exec(database,
+                         "CREATE TABLE items (name TEXT);"
+                         "CREATE TABLE tags (name TEXT PRIMARY KEY) WITHOUT ROWID",
+                         nullptr, nullptr, nullptr),
+            SQLITE_OK);
+
+  std::vector<FlValue*> batches;
+  {
+    ChangeTracker changes(database);
+    changes.AddListener([&batches](const std::vector<RowChange>& rows) {
+      FlValue* batch = EncodeChangeBatch(rows);
+      if (batch != nullptr) {
+        batches.push_back(batch);
+      }
+    });
+
+    ASSERT_EQ(sqlite3_exec(database, "INSERT INTO tags VALUES ('red')", nullptr, nullptr, nullptr),
+              SQLITE_OK);
+    changes.Flush();
+    ASSERT_EQ(sqlite3_exec(database, "INSERT INTO items VALUES ('box')", nullptr, nullptr, nullptr),
+              SQLITE_OK);
+    changes.Flush();
+  }
+  sqlite3_close(database);
+
+  ASSERT_EQ(batches.size(), 2u);
+  EXPECT_EQ(fl_value_get_length(fl_value_lookup_string(batches[0], "tables")), 0u);
+  EXPECT_TRUE(fl_value_get_bool(fl_value_lookup_string(batches[0], "unknownTables")));
+  EXPECT_EQ(fl_value_get_length(fl_value_lookup_string(batches[1], "tables")), 1u);
+  EXPECT_FALSE(fl_value_get_bool(fl_value_lookup_string(batches[1], "unknownTables")));
+  for (FlValue* batch : batches) {
+    fl_value_unref(batch);
+  }
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
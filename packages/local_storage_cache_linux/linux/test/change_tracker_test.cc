@@ -0,0 +1,142 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "change_tracker.h"
+#include "database_manager.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// A database in a fresh file whose committed row changes are collected
+class ChangeTrackerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "change_tracker_test_" + std::to_string(getpid()) + ".db";
+    unlink(path_.c_str());
+    manager_ = std::make_unique<DatabaseManager>(path_);
+    ASSERT_TRUE(manager_->Initialize());
+    manager_->changes()->AddListener([this](const std::vector<RowChange>& changes) {
+      for (const RowChange& change : changes) {
+        reported_.push_back(change.table_name);
+      }
+    });
+  }
+
+  void TearDown() override {
+    manager_.reset();
+    unlink(path_.c_str());
+    unlink((path_ + "-wal").c_str());
+    unlink((path_ + "-shm").c_str());
+  }
+
+  void Execute(const char* sql) {
+    ASSERT_EQ(sqlite3_exec(manager_->database(), sql, nullptr, nullptr, nullptr), SQLITE_OK)
+        << sqlite3_errmsg(manager_->database());
+  }
+
+  std::string path_;
+  std::unique_ptr<DatabaseManager> manager_;
+  std::vector<std::string> reported_;  // Table of each row reported
+};
+
+FlValue* InsertOperation(const char* table_name, const char* name) {
+  FlValue* operation = fl_value_new_map();
+  fl_value_set_string_take(operation, "type", fl_value_new_string("insert"));
+  fl_value_set_string_take(operation, "tableName", fl_value_new_string(table_name));
+  FlValue* data = fl_value_new_map();
+  fl_value_set_string_take(data, "name", fl_value_new_string(name));
+  fl_value_set_string_take(operation, "data", data);
+  return operation;
+}
+
+}  // namespace
+
+TEST_F(ChangeTrackerTest, ReportsRowsOfReleasedSavepoints) {
+  Execute("CREATE TABLE items (name TEXT)");
+  manager_->FlushChanges();
+
+  ChangeTracker* changes = manager_->changes();
+  Execute("SAVEPOINT outer_savepoint");
+  changes->BeginSavepoint();
+  Execute("INSERT INTO items VALUES ('kept')");
+  Execute("SAVEPOINT inner_savepoint");
+  changes->BeginSavepoint();
+  Execute("INSERT INTO items VALUES ('dropped')");
+  Execute("ROLLBACK TO inner_savepoint");
+  changes->RollbackToSavepoint();
+  Execute("RELEASE inner_savepoint");
+  changes->ReleaseSavepoint();
+  Execute("RELEASE outer_savepoint");
+  changes->ReleaseSavepoint();
+  manager_->FlushChanges();
+
+  EXPECT_THAT(reported_, ::testing::ElementsAre("items"));
+}
+
+TEST_F(ChangeTrackerTest, FailedSetManyReportsNoRows) {
+  KeyValueStore* key_values = manager_->key_values();
+  std::string error;
+  ASSERT_TRUE(key_values->Set("settings", "theme", "\"dark\"", &error)) << error;
+  Execute(
+      "CREATE TRIGGER reject_bad BEFORE INSERT ON settings WHEN new.key = 'bad' "
+      "BEGIN SELECT RAISE(ABORT, 'rejected'); END");
+  manager_->FlushChanges();
+  reported_.clear();
+
+  std::vector<std::pair<std::string, std::string>> entries = {{"language", "\"en\""},
+                                                              {"bad", "\"value\""}};
+  EXPECT_FALSE(key_values->SetMany("settings", entries, &error));
+  manager_->FlushChanges();
+
+  EXPECT_THAT(reported_, ::testing::IsEmpty());
+}
+
+TEST_F(ChangeTrackerTest, FailedNestedBatchReportsNoRows) {
+  Execute("CREATE TABLE main_items (name TEXT)");
+  manager_->FlushChanges();
+
+  Execute("BEGIN");
+  Execute("INSERT INTO main_items VALUES ('before')");
+  g_autoptr(FlValue) operations = fl_value_new_list();
+  fl_value_append_take(operations, InsertOperation("main_items", "batched"));
+  fl_value_append_take(operations, InsertOperation("main_missing", "batched"));
+  g_autoptr(FlValue) result = manager_->ExecuteBatch(operations);
+  EXPECT_EQ(result, nullptr);
+  Execute("COMMIT");
+  manager_->FlushChanges();
+
+  // Only the row written before the batch
+  EXPECT_THAT(reported_, ::testing::ElementsAre("main_items"));
+}
+
+TEST_F(ChangeTrackerTest, DeleteWithoutWhereReportsEveryRow) {
+  Execute("CREATE TABLE items (name TEXT); CREATE TABLE temporary_items (name TEXT)");
+  Execute("CREATE VIEW item_names AS SELECT name FROM items");
+  Execute("INSERT INTO items VALUES ('a'), ('b')");
+  manager_->FlushChanges();
+  reported_.clear();
+
+  // Dropping deletes from the dropped table, which must not be ignored
+  Execute("DROP VIEW item_names; DROP TABLE temporary_items; DELETE FROM items");
+  manager_->FlushChanges();
+
+  EXPECT_THAT(reported_, ::testing::ElementsAre("items", "items"));
+  g_autoptr(FlValue) arguments = fl_value_new_list();
+  g_autoptr(FlValue) rows = manager_->Query(
+      "SELECT name FROM sqlite_master WHERE name IN ('item_names', 'temporary_items')",
+      arguments);
+  EXPECT_EQ(fl_value_get_length(rows), 0u);
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,123 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cursor_manager.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// An in-memory database with an `items` table of ten rows, ids 1 to 10
+class CursorManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(sqlite3_open(":memory:", &database_), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(database_,
+                           "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT);"
+                           "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n "
+                           "WHERE i < 10) INSERT INTO items SELECT i, 'item' || i FROM n",
+                           nullptr, nullptr, nullptr),
+              SQLITE_OK);
+  }
+
+  void TearDown() override { EXPECT_EQ(sqlite3_close(database_), SQLITE_OK); }
+
+  // The ids of a fetched page, and whether it was the last
+  static std::vector<int64_t> Ids(FlValue* page, bool* done) {
+    *done = fl_value_get_bool(fl_value_lookup_string(page, "done"));
+    FlValue* rows = fl_value_lookup_string(page, "rows");
+    std::vector<int64_t> ids;
+    for (size_t i = 0; i < fl_value_get_length(rows); i++) {
+      ids.push_back(
+          fl_value_get_int(fl_value_lookup_string(fl_value_get_list_value(rows, i), "id")));
+    }
+    return ids;
+  }
+
+  sqlite3* database_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(CursorManagerTest, PagesThroughResultAndClosesWhenDone) {
+  CursorManager cursors(database_);
+  std::string error;
+  ASSERT_TRUE(cursors.Open(1, "SELECT id FROM items ORDER BY id", nullptr, true, &error))
+      << error;
+
+  bool done = false;
+  g_autoptr(FlValue) first = cursors.Fetch(1, 4);
+  EXPECT_EQ(Ids(first, &done), std::vector<int64_t>({1, 2, 3, 4}));
+  EXPECT_FALSE(done);
+  g_autoptr(FlValue) second = cursors.Fetch(1, 4);
+  EXPECT_EQ(Ids(second, &done), std::vector<int64_t>({5, 6, 7, 8}));
+  EXPECT_FALSE(done);
+  g_autoptr(FlValue) last = cursors.Fetch(1, 4);
+  EXPECT_EQ(Ids(last, &done), std::vector<int64_t>({9, 10}));
+  EXPECT_TRUE(done);
+
+  EXPECT_EQ(cursors.size(), 0u);
+  EXPECT_EQ(cursors.Fetch(1, 4), nullptr);
+  EXPECT_EQ(sqlite3_next_stmt(database_, nullptr), nullptr);
+}
+
+TEST_F(CursorManagerTest, KeepsArgumentsAliveBetweenFetches) {
+  CursorManager cursors(database_);
+  std::string error;
+  FlValue* arguments = fl_value_new_list();
+  fl_value_append_take(arguments, fl_value_new_string("item1%"));
+  ASSERT_TRUE(cursors.Open(1, "SELECT id FROM items WHERE name LIKE ? ORDER BY id", arguments,
+                           true, &error))
+      << error;
+  fl_value_unref(arguments);
+
+  bool done = false;
+  g_autoptr(FlValue) first = cursors.Fetch(1, 1);
+  EXPECT_EQ(Ids(first, &done), std::vector<int64_t>({1}));
+  g_autoptr(FlValue) second = cursors.Fetch(1, 1);
+  EXPECT_EQ(Ids(second, &done), std::vector<int64_t>({10}));
+}
+
+TEST_F(CursorManagerTest, ClosesIdleCursors) {
+  CursorManager cursors(database_, 200);
+  std::string error;
+  ASSERT_TRUE(cursors.Open(1, "SELECT id FROM items", nullptr, true, &error)) << error;
+  ASSERT_TRUE(cursors.Open(2, "SELECT id FROM items", nullptr, true, &error)) << error;
+  EXPECT_EQ(cursors.ExpireIdle(), 0u);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  g_autoptr(FlValue) page = cursors.Fetch(2, 1);
+  ASSERT_NE(page, nullptr);
+
+  // Only the cursor not fetched from within the timeout is closed
+  EXPECT_EQ(cursors.ExpireIdle(), 1u);
+  EXPECT_EQ(cursors.Fetch(1, 1), nullptr);
+  EXPECT_EQ(cursors.size(), 1u);
+}
+
+TEST_F(CursorManagerTest, ReadOnlyCursorRefusesWrites) {
+  CursorManager cursors(database_);
+  std::string error;
+  EXPECT_FALSE(cursors.Open(1, "DELETE FROM items RETURNING id", nullptr, true, &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_EQ(cursors.size(), 0u);
+  EXPECT_FALSE(cursors.Close(1));
+}
+
+TEST(CursorIdTest, CarriesItsSlot) {
+  int64_t id = MakeCursorId(12345, 3);
+  EXPECT_EQ(GetCursorSlot(id), 3u);
+  EXPECT_NE(MakeCursorId(12346, 3), id);
+  EXPECT_EQ(GetCursorSlot(MakeCursorId(1, 0)), 0u);
+  EXPECT_EQ(GetCursorSlot(MakeCursorId(1, kMaxCursorReaders)), kMaxCursorReaders);
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
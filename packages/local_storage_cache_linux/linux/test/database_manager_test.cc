@@ -0,0 +1,109 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "database_manager.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// A database in a fresh file
+class DatabaseManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "database_manager_test_" + std::to_string(getpid()) + ".db";
+    unlink(path_.c_str());
+    manager_ = std::make_unique<DatabaseManager>(path_);
+    ASSERT_TRUE(manager_->Initialize());
+  }
+
+  void TearDown() override {
+    manager_.reset();
+    unlink(path_.c_str());
+    unlink((path_ + "-wal").c_str());
+    unlink((path_ + "-shm").c_str());
+  }
+
+  void Execute(const char* sql) {
+    ASSERT_EQ(sqlite3_exec(manager_->database(), sql, nullptr, nullptr, nullptr), SQLITE_OK)
+        << sqlite3_errmsg(manager_->database());
+  }
+
+  // The first column of the first row `sql` returns, as text
+  std::string QueryText(const char* sql) {
+    g_autoptr(FlValue) arguments = fl_value_new_list();
+    g_autoptr(FlValue) rows = manager_->Query(sql, arguments);
+    if (fl_value_get_length(rows) == 0) {
+      return "";
+    }
+    FlValue* value = fl_value_get_map_value(fl_value_get_list_value(rows, 0), 0);
+    return fl_value_get_type(value) == FL_VALUE_TYPE_STRING ? fl_value_get_string(value)
+                                                            : "";
+  }
+
+  std::string path_;
+  std::unique_ptr<DatabaseManager> manager_;
+};
+
+FlValue* UpdateOperation(const char* table_name,
+                         const char* sql,
+                         const char* value,
+                         int64_t id) {
+  FlValue* operation = fl_value_new_map();
+  fl_value_set_string_take(operation, "type", fl_value_new_string("update"));
+  fl_value_set_string_take(operation, "tableName", fl_value_new_string(table_name));
+  fl_value_set_string_take(operation, "sql", fl_value_new_string(sql));
+  FlValue* arguments = fl_value_new_list();
+  fl_value_append_take(arguments, fl_value_new_string(value));
+  fl_value_append_take(arguments, fl_value_new_int(id));
+  fl_value_set_string_take(operation, "arguments", arguments);
+  return operation;
+}
+
+}  // namespace
+
+TEST_F(DatabaseManagerTest, InsertQuotesColumnNames) {
+  Execute("CREATE TABLE main_items (id INTEGER PRIMARY KEY, \"order\" TEXT, \"group\" TEXT)");
+
+  g_autoptr(FlValue) data = fl_value_new_map();
+  fl_value_set_string_take(data, "order", fl_value_new_string("first"));
+  fl_value_set_string_take(data, "group", fl_value_new_string("a"));
+  EXPECT_EQ(manager_->Insert("main_items", data), 1);
+  EXPECT_EQ(QueryText("SELECT \"order\" FROM main_items"), "first");
+}
+
+TEST_F(DatabaseManagerTest, InsertRejectsColumnNamesCarryingSql) {
+  Execute("CREATE TABLE main_items (id INTEGER PRIMARY KEY, name TEXT)");
+
+  // Unquoted, this key would complete the statement on its own
+  g_autoptr(FlValue) data = fl_value_new_map();
+  fl_value_set_string_take(data, "name) VALUES (?) --", fl_value_new_string("y"));
+  EXPECT_EQ(manager_->Insert("main_items", data), -1);
+  EXPECT_EQ(QueryText("SELECT group_concat(name) FROM main_items"), "");
+}
+
+TEST_F(DatabaseManagerTest, ExecuteBatchRunsUpdates) {
+  Execute("CREATE TABLE main_users (id INTEGER PRIMARY KEY, email TEXT);"
+          "INSERT INTO main_users (email) VALUES ('old1@example.com'), ('old2@example.com')");
+
+  const char* sql = "UPDATE main_users SET email = ? WHERE id = ?";
+  g_autoptr(FlValue) operations = fl_value_new_list();
+  fl_value_append_take(operations, UpdateOperation("main_users", sql, "new1@example.com", 1));
+  fl_value_append_take(operations, UpdateOperation("main_users", sql, "new2@example.com", 2));
+  g_autoptr(FlValue) result = manager_->ExecuteBatch(operations);
+  ASSERT_NE(result, nullptr) << manager_->GetLastError();
+
+  FlValue* changes = fl_value_lookup_string(result, "changes");
+  EXPECT_EQ(fl_value_get_int64_list(changes)[0], 1);
+  EXPECT_EQ(fl_value_get_int64_list(changes)[1], 1);
+  EXPECT_EQ(QueryText("SELECT email FROM main_users WHERE id = 2"), "new2@example.com");
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
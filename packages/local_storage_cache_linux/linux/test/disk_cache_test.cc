@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "disk_cache.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+class DiskCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = ::testing::TempDir() + "disk_cache_" + std::to_string(getpid());
+    ASSERT_EQ(mkdir(directory_.c_str(), 0700), 0);
+    Reopen();
+  }
+
+  void TearDown() override {
+    cache_.reset();
+    std::string command = "rm -rf '" + directory_ + "'";
+    ASSERT_EQ(system(command.c_str()), 0);
+  }
+
+  // Closes the cache, if open, and opens it again from its segments
+  void Reopen() {
+    cache_.reset();
+    std::string error;
+    cache_ = DiskCache::Open(directory_, EvictionPolicy::kLru, 1000, nullptr, &error);
+    ASSERT_NE(cache_, nullptr) << error;
+  }
+
+  void Put(const std::string& key, const std::string& value) {
+    std::string error;
+    ASSERT_TRUE(cache_->Put(key, value, 0, &error)) << error;
+  }
+
+  void Remove(const std::string& key) {
+    bool removed = false;
+    std::string error;
+    ASSERT_TRUE(cache_->Remove(key, &removed, &error)) << error;
+    EXPECT_TRUE(removed) << key;
+  }
+
+  std::string Get(const std::string& key) {
+    std::string value;
+    return cache_->Get(key, &value) ? value : "<missing>";
+  }
+
+  std::string SegmentPath(uint32_t id) const {
+    char name[32];
+    snprintf(name, sizeof(name), "segment-%08u.log", id);
+    return directory_ + "/" + name;
+  }
+
+  static off_t FileSize(const std::string& path) {
+    struct stat status;
+    return stat(path.c_str(), &status) == 0 ? status.st_size : -1;
+  }
+
+  std::string directory_;
+  std::unique_ptr<DiskCache> cache_;
+};
+
+}  // namespace
+
+TEST_F(DiskCacheTest, ReplaysSegmentsOnReopen) {
+  Put("a", "1");
+  Put("b", "2");
+  Put("c", "3");
+  Put("a", "4");
+  Remove("b");
+
+  Reopen();
+  // Replay keeps the write order, so the least recently written goes first
+  std::vector<std::string> keys = cache_->Keys();
+  ASSERT_EQ(keys.size(), 2u);
+  EXPECT_EQ(keys.back(), "c");
+
+  EXPECT_EQ(Get("a"), "4");
+  EXPECT_EQ(Get("b"), "<missing>");
+  EXPECT_EQ(Get("c"), "3");
+}
+
+TEST_F(DiskCacheTest, DropsTornRecordAtTheTail) {
+  Put("a", "kept");
+  Put("b", "also kept");
+  cache_.reset();
+  off_t intact = FileSize(SegmentPath(1));
+  ASSERT_GT(intact, 0);
+
+  Reopen();
+  Put("c", std::string(100, 'x'));
+  cache_.reset();
+  // The last record only made it halfway to disk
+  off_t full = FileSize(SegmentPath(1));
+  ASSERT_GT(full, intact);
+  ASSERT_EQ(truncate(SegmentPath(1).c_str(), intact + (full - intact) / 2), 0);
+
+  Reopen();
+  EXPECT_EQ(cache_->Size(), 2u);
+  EXPECT_EQ(Get("a"), "kept");
+  EXPECT_EQ(Get("b"), "also kept");
+  EXPECT_EQ(Get("c"), "<missing>");
+
+  // Writes after the truncated tail replay too
+  Put("d", "after");
+  Reopen();
+  EXPECT_EQ(Get("d"), "after");
+  EXPECT_EQ(Get("c"), "<missing>");
+  EXPECT_EQ(cache_->Size(), 3u);
+}
+
+TEST_F(DiskCacheTest, DropsGarbageAtTheTail) {
+  Put("a", "kept");
+  cache_.reset();
+  off_t intact = FileSize(SegmentPath(1));
+  FILE* file = fopen(SegmentPath(1).c_str(), "ab");
+  ASSERT_NE(file, nullptr);
+  fputs("not a record at all, just some trailing bytes", file);
+  fclose(file);
+
+  Reopen();
+  EXPECT_EQ(Get("a"), "kept");
+  Put("b", "next");
+  cache_.reset();
+  EXPECT_GT(FileSize(SegmentPath(1)), intact);
+
+  Reopen();
+  EXPECT_EQ(Get("a"), "kept");
+  EXPECT_EQ(Get("b"), "next");
+}
+
+TEST_F(DiskCacheTest, CompactsSparseSealedSegments) {
+  // 96 values of 64 KiB fill the first segment and roll into a second
+  const std::string value(64 * 1024, 'v');
+  for (int i = 0; i < 96; i++) {
+    Put("key" + std::to_string(i), value + std::to_string(i));
+  }
+  DiskCache::Stats before = cache_->GetStats();
+  ASSERT_GE(before.segments, 2u);
+
+  // Leaves the first segment mostly dead
+  for (int i = 0; i < 48; i++) {
+    Remove("key" + std::to_string(i));
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (cache_->GetStats().compactions == 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  DiskCache::Stats after = cache_->GetStats();
+  EXPECT_GE(after.compactions, 1u);
+  EXPECT_LT(after.file_bytes, before.file_bytes);
+  EXPECT_EQ(after.entries, 48u);
+  EXPECT_EQ(FileSize(SegmentPath(1)), -1);
+
+  for (int i = 0; i < 96; i++) {
+    std::string key = "key" + std::to_string(i);
+    EXPECT_EQ(Get(key), i < 48 ? "<missing>" : value + std::to_string(i)) << key;
+  }
+
+  // Moved entries and the removals they outlived replay the same
+  Reopen();
+  EXPECT_EQ(cache_->Size(), 48u);
+  for (int i = 0; i < 96; i++) {
+    std::string key = "key" + std::to_string(i);
+    EXPECT_EQ(Get(key), i < 48 ? "<missing>" : value + std::to_string(i)) << key;
+  }
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "hnsw_index.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+constexpr size_t kDimensions = 16;
+
+std::vector<float> RandomVector(std::mt19937* random) {
+  std::normal_distribution<float> normal;
+  std::vector<float> vector(kDimensions);
+  for (float& value : vector) {
+    value = normal(*random);
+  }
+  return vector;
+}
+
+// Fraction of the exact `k` nearest neighbours of `queries` the index finds
+double Recall(const VectorIndex& index, const std::vector<std::vector<float>>& queries, size_t k) {
+  size_t found = 0;
+  for (const auto& query : queries) {
+    std::unordered_set<int64_t> exact;
+    for (const VectorMatch& match : index.ExactSearch(query.data(), k)) {
+      exact.insert(match.rowid);
+    }
+    for (const VectorMatch& match : index.Search(query.data(), k, 0)) {
+      found += exact.count(match.rowid);
+    }
+  }
+  return static_cast<double>(found) / (queries.size() * k);
+}
+
+// Size of the index once saved
+long SavedSize(const HnswIndex& index) {
+  FILE* file = tmpfile();
+  EXPECT_TRUE(index.Save(file));
+  long size = ftell(file);
+  fclose(file);
+  return size;
+}
+
+class HnswIndexTest : public ::testing::TestWithParam<DistanceMetric> {
+ protected:
+  void SetUp() override {
+    // A sparser graph than the default, which builds faster
+    HnswParams params;
+    params.m = 8;
+    params.ef_construction = 64;
+    index_ = std::make_unique<HnswIndex>(kDimensions, GetParam(), params);
+    for (int64_t rowid = 1; rowid <= 2500; rowid++) {
+      index_->Upsert(rowid, RandomVector(&random_).data());
+    }
+    for (int i = 0; i < 50; i++) {
+      queries_.push_back(RandomVector(&random_));
+    }
+  }
+
+  std::mt19937 random_{11};
+  std::unique_ptr<HnswIndex> index_;
+  std::vector<std::vector<float>> queries_;
+};
+
+}  // namespace
+
+TEST_P(HnswIndexTest, FindsMostNearestNeighbours) {
+  EXPECT_GE(Recall(*index_, queries_, 10), 0.9);
+}
+
+TEST_P(HnswIndexTest, NeverReturnsRemovedRows) {
+  for (int64_t rowid = 1; rowid <= 2500; rowid += 3) {
+    EXPECT_TRUE(index_->Remove(rowid));
+  }
+  EXPECT_FALSE(index_->Remove(1));
+  EXPECT_EQ(index_->size(), 1666u);
+
+  for (const auto& query : queries_) {
+    for (const VectorMatch& match : index_->Search(query.data(), 10, 0)) {
+      EXPECT_NE(match.rowid % 3, 1) << match.rowid;
+    }
+  }
+  EXPECT_GE(Recall(*index_, queries_, 10), 0.9);
+}
+
+TEST_P(HnswIndexTest, CompactsOnceTombstonesOutnumberLiveRows) {
+  for (int64_t rowid = 1; rowid <= 1250; rowid++) {
+    index_->Remove(rowid);
+  }
+  long with_tombstones = SavedSize(*index_);
+
+  // One more removal tips the tombstones over the live rows
+  index_->Remove(1251);
+  EXPECT_EQ(index_->size(), 1249u);
+  EXPECT_LT(SavedSize(*index_), with_tombstones * 6 / 10);
+
+  size_t visited = 0;
+  index_->ForEach([&visited](int64_t rowid, const float*) {
+    EXPECT_GT(rowid, 1251);
+    visited++;
+  });
+  EXPECT_EQ(visited, 1249u);
+  EXPECT_GE(Recall(*index_, queries_, 10), 0.9);
+}
+
+TEST_P(HnswIndexTest, LoadsWhatItSaved) {
+  index_->Remove(7);
+  FILE* file = tmpfile();
+  ASSERT_TRUE(index_->Save(file));
+  rewind(file);
+  std::unique_ptr<HnswIndex> loaded = HnswIndex::Load(file);
+  fclose(file);
+  ASSERT_NE(loaded, nullptr);
+
+  EXPECT_EQ(loaded->size(), index_->size());
+  for (const auto& query : queries_) {
+    std::vector<VectorMatch> expected = index_->Search(query.data(), 5, 0);
+    std::vector<VectorMatch> actual = loaded->Search(query.data(), 5, 0);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); i++) {
+      EXPECT_EQ(actual[i].rowid, expected[i].rowid);
+      EXPECT_FLOAT_EQ(actual[i].distance, expected[i].distance);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Metrics,
+                         HnswIndexTest,
+                         ::testing::Values(DistanceMetric::kCosine,
+                                           DistanceMetric::kEuclidean,
+                                           DistanceMetric::kDotProduct));
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "ivf_flat_index.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+constexpr size_t kDimensions = 16;
+constexpr size_t kClusters = 30;
+
+// Fraction of the exact `k` nearest neighbours of `queries` the index finds
+// scanning `nprobe` lists
+double Recall(const VectorIndex& index,
+              const std::vector<std::vector<float>>& queries,
+              size_t k,
+              size_t nprobe) {
+  size_t found = 0;
+  for (const auto& query : queries) {
+    std::unordered_set<int64_t> exact;
+    for (const VectorMatch& match : index.ExactSearch(query.data(), k)) {
+      exact.insert(match.rowid);
+    }
+    for (const VectorMatch& match : index.Search(query.data(), k, nprobe)) {
+      found += exact.count(match.rowid);
+    }
+  }
+  return static_cast<double>(found) / (queries.size() * k);
+}
+
+// 3000 vectors around 30 random centres, and queries drawn the same way
+class IvfFlatIndexTest : public ::testing::TestWithParam<DistanceMetric> {
+ protected:
+  void SetUp() override {
+    std::normal_distribution<float> normal;
+    for (size_t i = 0; i < kClusters * kDimensions; i++) {
+      centres_.push_back(4 * normal(random_));
+    }
+    index_ = std::make_unique<IvfFlatIndex>(kDimensions, GetParam(), IvfFlatParams());
+    for (int64_t rowid = 1; rowid <= 3000; rowid++) {
+      index_->Upsert(rowid, NearCentre().data());
+    }
+    for (int i = 0; i < 50; i++) {
+      queries_.push_back(NearCentre());
+    }
+  }
+
+  std::vector<float> NearCentre() {
+    std::normal_distribution<float> normal;
+    const float* centre = &centres_[random_() % kClusters * kDimensions];
+    std::vector<float> vector(kDimensions);
+    for (size_t i = 0; i < kDimensions; i++) {
+      vector[i] = centre[i] + normal(random_);
+    }
+    return vector;
+  }
+
+  std::mt19937 random_{5};
+  std::vector<float> centres_;
+  std::unique_ptr<IvfFlatIndex> index_;
+  std::vector<std::vector<float>> queries_;
+};
+
+}  // namespace
+
+TEST_P(IvfFlatIndexTest, UntrainedIndexIsExact) {
+  EXPECT_TRUE(index_->NeedsTraining());
+  EXPECT_EQ(Recall(*index_, queries_, 10, 1), 1.0);
+}
+
+TEST_P(IvfFlatIndexTest, TrainedIndexFindsMostNearestNeighbours) {
+  index_->Train();
+  EXPECT_FALSE(index_->NeedsTraining());
+  EXPECT_EQ(index_->size(), 3000u);
+
+  EXPECT_GE(Recall(*index_, queries_, 10, 0), 0.9);
+  // Probing every list is a full scan
+  EXPECT_EQ(Recall(*index_, queries_, 10, 1000), 1.0);
+}
+
+TEST_P(IvfFlatIndexTest, NeverReturnsRemovedRows) {
+  index_->Train();
+  for (int64_t rowid = 1; rowid <= 3000; rowid += 2) {
+    EXPECT_TRUE(index_->Remove(rowid));
+  }
+  EXPECT_FALSE(index_->Remove(1));
+  EXPECT_EQ(index_->size(), 1500u);
+
+  std::vector<float> vector;
+  EXPECT_FALSE(index_->Find(1, &vector));
+  EXPECT_TRUE(index_->Find(2, &vector));
+  for (const auto& query : queries_) {
+    for (const VectorMatch& match : index_->Search(query.data(), 10, 1000)) {
+      EXPECT_EQ(match.rowid % 2, 0) << match.rowid;
+    }
+  }
+  EXPECT_EQ(Recall(*index_, queries_, 10, 1000), 1.0);
+}
+
+TEST_P(IvfFlatIndexTest, LoadsWhatItSaved) {
+  index_->Train();
+  FILE* file = tmpfile();
+  ASSERT_TRUE(index_->Save(file));
+  rewind(file);
+  std::unique_ptr<IvfFlatIndex> loaded = IvfFlatIndex::Load(file);
+  fclose(file);
+  ASSERT_NE(loaded, nullptr);
+
+  EXPECT_EQ(loaded->size(), index_->size());
+  for (const auto& query : queries_) {
+    std::vector<VectorMatch> expected = index_->Search(query.data(), 5, 0);
+    std::vector<VectorMatch> actual = loaded->Search(query.data(), 5, 0);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); i++) {
+      EXPECT_EQ(actual[i].rowid, expected[i].rowid);
+      EXPECT_FLOAT_EQ(actual[i].distance, expected[i].distance);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Metrics,
+                         IvfFlatIndexTest,
+                         ::testing::Values(DistanceMetric::kCosine, DistanceMetric::kEuclidean));
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
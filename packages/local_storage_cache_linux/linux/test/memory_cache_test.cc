@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "memory_cache.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// Lookups of `keys` keys drawn from a Zipf distribution of exponent 1, with
+// a scan of `scan_length` keys never looked up again after every
+// `scan_every` of them
+std::vector<std::string> ZipfTraceWithScans(size_t lookups,
+                                            size_t keys,
+                                            size_t scan_every,
+                                            size_t scan_length) {
+  std::vector<double> cumulative(keys);
+  double total = 0;
+  for (size_t i = 0; i < keys; i++) {
+    total += 1.0 / (i + 1);
+    cumulative[i] = total;
+  }
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<double> uniform(0, total);
+  std::vector<std::string> trace;
+  size_t scanned = 0;
+  for (size_t i = 0; i < lookups; i++) {
+    size_t rank = std::lower_bound(cumulative.begin(), cumulative.end(), uniform(random)) -
+                  cumulative.begin();
+    trace.push_back("key" + std::to_string(std::min(rank, keys - 1)));
+    if ((i + 1) % scan_every == 0) {
+      for (size_t j = 0; j < scan_length; j++) {
+        trace.push_back("scan" + std::to_string(scanned++));
+      }
+    }
+  }
+  return trace;
+}
+
+double HitRate(const MemoryCache::PolicyHitRates& rates, EvictionPolicy policy) {
+  for (const auto& rate : rates) {
+    if (rate.first == policy) {
+      return rate.second;
+    }
+  }
+  ADD_FAILURE() << "No hit rate for " << EvictionPolicyName(policy);
+  return 0;
+}
+
+}  // namespace
+
+TEST(MemoryCacheTest, TinyLfuBeatsLruOnZipfTraceWithScans) {
+  std::vector<std::string> trace = ZipfTraceWithScans(100000, 10000, 2000, 1000);
+  MemoryCache::PolicyHitRates rates = MemoryCache::CompareEvictionPolicies(trace, 500);
+
+  double lru = HitRate(rates, EvictionPolicy::kLru);
+  double tiny_lfu = HitRate(rates, EvictionPolicy::kTinyLfu);
+  EXPECT_GT(tiny_lfu, lru + 0.05) << "W-TinyLFU " << tiny_lfu << ", LRU " << lru;
+}
+
+TEST(MemoryCacheTest, ComparesPoliciesOnRecordedLookups) {
+  MemoryCache cache(EvictionPolicy::kLru, 64, 0, 1);
+  std::string value;
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < 32; i++) {
+      std::string key = "key" + std::to_string(i);
+      if (!cache.Get(key, &value)) {
+        cache.Put(key, "value");
+      }
+    }
+  }
+
+  // The 32 keys fit, so only their first lookups miss under any policy
+  MemoryCache::PolicyHitRates rates = cache.CompareEvictionPolicies();
+  ASSERT_EQ(rates.size(), 4u);
+  for (const auto& rate : rates) {
+    EXPECT_DOUBLE_EQ(rate.second, 0.75) << EvictionPolicyName(rate.first);
+  }
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
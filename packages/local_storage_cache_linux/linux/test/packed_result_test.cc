@@ -0,0 +1,181 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "packed_result.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// Reads the cells of a packed result the way PackedResult does in Dart
+class PackedReader {
+ public:
+  explicit PackedReader(FlValue* packed)
+      : data_(fl_value_get_uint8_list(packed)), size_(fl_value_get_length(packed)) {}
+
+  uint16_t column_count() const { return Get<uint16_t>(6); }
+  uint32_t row_count() const { return Get<uint32_t>(8); }
+
+  uint8_t type(int column) const { return Get<uint8_t>(Descriptor(column)); }
+
+  std::string name(int column) const {
+    return std::string(reinterpret_cast<const char*>(data_) + Get<uint32_t>(Descriptor(column) + 4),
+                       Get<uint32_t>(Descriptor(column) + 8));
+  }
+
+  bool is_null(int column, size_t row) const {
+    uint32_t bitmap = Get<uint32_t>(Descriptor(column) + 12);
+    return bitmap != 0 && (data_[bitmap + row / 8] & (1 << (row % 8))) != 0;
+  }
+
+  int64_t int64(int column, size_t row) const {
+    return Get<int64_t>(Get<uint32_t>(Descriptor(column) + 16) + 8 * row);
+  }
+
+  double float64(int column, size_t row) const {
+    return Get<double>(Get<uint32_t>(Descriptor(column) + 16) + 8 * row);
+  }
+
+  uint32_t data_offset(int column) const { return Get<uint32_t>(Descriptor(column) + 16); }
+
+  // The bytes of a text or blob cell
+  std::string bytes(int column, size_t row) const {
+    uint32_t offsets = Get<uint32_t>(Descriptor(column) + 16);
+    uint32_t heap = Get<uint32_t>(Descriptor(column) + 20);
+    uint32_t start = Get<uint32_t>(offsets + 4 * row);
+    uint32_t end = Get<uint32_t>(offsets + 4 * (row + 1));
+    return std::string(reinterpret_cast<const char*>(data_) + heap + start, end - start);
+  }
+
+ private:
+  static size_t Descriptor(int column) { return 16 + 24 * column; }
+
+  template <typename T>
+  T Get(size_t offset) const {
+    EXPECT_LE(offset + sizeof(T), size_);
+    T value;
+    memcpy(&value, data_ + offset, sizeof(T));
+    return value;
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+};
+
+class PackedResultTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ASSERT_EQ(sqlite3_open(":memory:", &database_), SQLITE_OK); }
+
+  void TearDown() override { sqlite3_close(database_); }
+
+  FlValue* Pack(const char* sql) {
+    sqlite3_stmt* statement = nullptr;
+    EXPECT_EQ(sqlite3_prepare_v2(database_, sql, -1, &statement, nullptr), SQLITE_OK)
+        << sqlite3_errmsg(database_);
+    FlValue* packed = EncodePacked(statement);
+    sqlite3_finalize(statement);
+    return packed;
+  }
+
+  sqlite3* database_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(PackedResultTest, RoundTripsTypedColumns) {
+  g_autoptr(FlValue) packed = Pack(
+      "SELECT column1 AS id, column2 AS score, column3 AS name, column4 AS data, "
+      "column5 AS unset FROM (VALUES (1, 0.5, 'a', x'00ff', NULL), "
+      "(-9007199254740993, 2, NULL, x'', NULL), (3, NULL, 'h\xc3\xa9', NULL, NULL))");
+  PackedReader reader(packed);
+
+  ASSERT_EQ(reader.column_count(), 5u);
+  ASSERT_EQ(reader.row_count(), 3u);
+  EXPECT_EQ(reader.name(0), "id");
+  EXPECT_EQ(reader.name(4), "unset");
+
+  EXPECT_EQ(reader.type(0), kPackedInt64);
+  EXPECT_EQ(reader.int64(0, 0), 1);
+  EXPECT_EQ(reader.int64(0, 1), -9007199254740993);
+  EXPECT_FALSE(reader.is_null(0, 2));
+
+  // Integers in a float column are widened
+  EXPECT_EQ(reader.type(1), kPackedFloat64);
+  EXPECT_EQ(reader.float64(1, 0), 0.5);
+  EXPECT_EQ(reader.float64(1, 1), 2.0);
+  EXPECT_TRUE(reader.is_null(1, 2));
+
+  EXPECT_EQ(reader.type(2), kPackedText);
+  EXPECT_EQ(reader.bytes(2, 0), "a");
+  EXPECT_TRUE(reader.is_null(2, 1));
+  EXPECT_EQ(reader.bytes(2, 2), "h\xc3\xa9");
+
+  EXPECT_EQ(reader.type(3), kPackedBlob);
+  EXPECT_EQ(reader.bytes(3, 0), std::string("\x00\xff", 2));
+  EXPECT_EQ(reader.bytes(3, 1), "");
+  EXPECT_FALSE(reader.is_null(3, 1));
+  EXPECT_TRUE(reader.is_null(3, 2));
+
+  EXPECT_EQ(reader.type(4), kPackedNull);
+}
+
+TEST_F(PackedResultTest, AlignsSectionsForInPlaceViews) {
+  g_autoptr(FlValue) packed =
+      Pack("SELECT 'abc' AS a_long_name, 1 AS n, 2.5 AS x UNION ALL SELECT NULL, 2, 3.5");
+  PackedReader reader(packed);
+
+  EXPECT_EQ(fl_value_get_length(packed) % 8, 0u);
+  for (int column = 0; column < reader.column_count(); column++) {
+    EXPECT_EQ(reader.data_offset(column) % 8, 0u) << reader.name(column);
+  }
+}
+
+TEST_F(PackedResultTest, EmptyResultKeepsItsColumns) {
+  g_autoptr(FlValue) packed = Pack("SELECT 1 AS id, 'a' AS name WHERE 0");
+  PackedReader reader(packed);
+
+  ASSERT_EQ(reader.column_count(), 2u);
+  EXPECT_EQ(reader.row_count(), 0u);
+  EXPECT_EQ(reader.name(1), "name");
+  EXPECT_EQ(reader.type(0), kPackedNull);
+
+  g_autoptr(FlValue) empty = EncodeEmptyPacked();
+  PackedReader empty_reader(empty);
+  EXPECT_EQ(fl_value_get_length(empty), 16u);
+  EXPECT_EQ(memcmp(fl_value_get_uint8_list(empty), "LSCP", 4), 0);
+  EXPECT_EQ(empty_reader.column_count(), 0u);
+  EXPECT_EQ(empty_reader.row_count(), 0u);
+}
+
+TEST_F(PackedResultTest, MixedBlobColumnIsPackedAsBlob) {
+  g_autoptr(FlValue) packed =
+      Pack("SELECT column1 AS value FROM (VALUES ('a'), (x'ff00'), (3), (NULL))");
+  PackedReader reader(packed);
+
+  ASSERT_EQ(reader.row_count(), 4u);
+  EXPECT_EQ(reader.type(0), kPackedBlob);
+  EXPECT_EQ(reader.bytes(0, 0), "a");
+  EXPECT_EQ(reader.bytes(0, 1), std::string("\xff\x00", 2));
+  EXPECT_EQ(reader.bytes(0, 2), "3");
+  EXPECT_TRUE(reader.is_null(0, 3));
+}
+
+TEST_F(PackedResultTest, MixedTextColumnIsPackedAsText) {
+  g_autoptr(FlValue) packed = Pack("SELECT column1 AS value FROM (VALUES ('a'), (3), (0.5))");
+  PackedReader reader(packed);
+
+  ASSERT_EQ(reader.row_count(), 3u);
+  EXPECT_EQ(reader.type(0), kPackedText);
+  EXPECT_EQ(reader.bytes(0, 0), "a");
+  EXPECT_EQ(reader.bytes(0, 1), "3");
+  EXPECT_EQ(reader.bytes(0, 2), "0.5");
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,65 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <string>
+#include <vector>
+
+#include "change_tracker.h"
+#include "query_cache.h"
+#include "query_watcher.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+TEST(QueryWatcher, KeepsStringArgumentsAcrossRuns) {
+  sqlite3* database = nullptr;
+  ASSERT_EQ(sqlite3_open(":memory:", &database), SQLITE_OK);
+  QueryCache::Install(database);
+  ASSERT_EQ(sqlite3_exec(database, "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)",
+                         nullptr, nullptr, nullptr),
+            SQLITE_OK);
+
+  {
+    ChangeTracker changes(database);
+    QueryWatcher watcher(database);
+    changes.AddListener(
+        [&watcher](const std::vector<RowChange>& rows) { watcher.ApplyChanges(rows); });
+
+    std::vector<std::string> inserted_names;
+    FlValue* rows = nullptr;
+    std::string error;
+    {
+      // The arguments of a method call are released once it returns
+      g_autoptr(FlValue) arguments = fl_value_new_list();
+      fl_value_append_take(arguments, fl_value_new_string("watched name"));
+      ASSERT_NE(watcher.Watch(
+                    "SELECT id, name FROM items WHERE name = ?", arguments, "id",
+                    [&inserted_names](FlValue* diff) {
+                      FlValue* inserted = fl_value_lookup_string(diff, "inserted");
+                      for (size_t i = 0; inserted && i < fl_value_get_length(inserted); i++) {
+                        FlValue* row = fl_value_get_list_value(inserted, i);
+                        inserted_names.push_back(
+                            fl_value_get_string(fl_value_lookup_string(row, "name")));
+                      }
+                    },
+                    &rows, &error),
+                0)
+          << error;
+    }
+    EXPECT_EQ(fl_value_get_length(rows), 0u);
+    fl_value_unref(rows);
+
+    ASSERT_EQ(sqlite3_exec(database,
+                           "INSERT INTO items (name) VALUES ('other name'), ('watched name')",
+                           nullptr, nullptr, nullptr),
+              SQLITE_OK);
+    changes.Flush();
+
+    EXPECT_EQ(inserted_names, std::vector<std::string>{"watched name"});
+  }
+  sqlite3_close(database);
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,132 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+
+#include <future>
+#include <memory>
+#include <string>
+
+#include "database_manager.h"
+#include "reader_pool.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// A WAL database in a fresh file holding an `items` table of three rows
+class ReaderPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "reader_pool_test_" + std::to_string(getpid()) + ".db";
+    unlink(path_.c_str());
+    manager_ = std::make_unique<DatabaseManager>(path_);
+    ASSERT_TRUE(manager_->Initialize(config_));
+    Write("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT);"
+          "INSERT INTO items (name) VALUES ('a'), ('b'), ('c')");
+  }
+
+  void TearDown() override {
+    manager_.reset();
+    unlink(path_.c_str());
+    unlink((path_ + "-wal").c_str());
+    unlink((path_ + "-shm").c_str());
+  }
+
+  void Write(const char* sql) {
+    ASSERT_EQ(sqlite3_exec(manager_->database(), sql, nullptr, nullptr, nullptr), SQLITE_OK)
+        << sqlite3_errmsg(manager_->database());
+  }
+
+  // The number of rows of `items` `reader` sees
+  int64_t CountItems(ReaderConnection* reader) {
+    bool requires_writer = false;
+    g_autoptr(FlValue) rows = reader->Query("SELECT count(*) AS n FROM items", nullptr,
+                                            ResultFormat::kMaps, &requires_writer);
+    EXPECT_FALSE(requires_writer);
+    return fl_value_get_int(fl_value_lookup_string(fl_value_get_list_value(rows, 0), "n"));
+  }
+
+  DatabaseConfig config_;
+  std::string path_;
+  std::unique_ptr<DatabaseManager> manager_;
+};
+
+}  // namespace
+
+TEST_F(ReaderPoolTest, OpenCursorDoesNotHoldBackQueries) {
+  ReaderConnection reader(0);
+  ASSERT_TRUE(reader.Open(path_, config_, nullptr, nullptr));
+
+  // A cursor that is paged through keeps its read transaction open
+  ASSERT_TRUE(reader.OpenCursor(1, "SELECT * FROM items", nullptr));
+  g_autoptr(FlValue) page = reader.cursors()->Fetch(1, 1);
+  ASSERT_NE(page, nullptr);
+  EXPECT_FALSE(fl_value_get_bool(fl_value_lookup_string(page, "done")));
+
+  Write("INSERT INTO items (name) VALUES ('d')");
+
+  EXPECT_EQ(CountItems(&reader), 4);
+}
+
+TEST_F(ReaderPoolTest, WritesAreHandedBackToTheWriter) {
+  ReaderConnection reader(0);
+  ASSERT_TRUE(reader.Open(path_, config_, nullptr, nullptr));
+
+  // Looks like a read, but writes through a CTE
+  bool requires_writer = false;
+  FlValue* rows = reader.Query("WITH x AS (SELECT 1) DELETE FROM items", nullptr,
+                               ResultFormat::kMaps, &requires_writer);
+  EXPECT_EQ(rows, nullptr);
+  EXPECT_TRUE(requires_writer);
+  EXPECT_FALSE(reader.OpenCursor(1, "WITH x AS (SELECT 1) DELETE FROM items", nullptr));
+  EXPECT_EQ(CountItems(&reader), 3);
+}
+
+TEST_F(ReaderPoolTest, RecognizesReadQueries) {
+  EXPECT_TRUE(IsReadQuery("SELECT 1"));
+  EXPECT_TRUE(IsReadQuery("  \n\tselect 1"));
+  EXPECT_TRUE(IsReadQuery("WITH x AS (SELECT 1) SELECT * FROM x"));
+  EXPECT_FALSE(IsReadQuery("INSERT INTO items (name) VALUES ('d')"));
+  EXPECT_FALSE(IsReadQuery("PRAGMA user_version"));
+  EXPECT_FALSE(IsReadQuery(""));
+}
+
+TEST_F(ReaderPoolTest, PostsToTheLeastBusyReader) {
+  DatabaseConfig config = config_;
+  config.reader_pool_size = 2;
+  ReaderPool pool;
+  ASSERT_TRUE(pool.Open(path_, config, nullptr, nullptr));
+  ASSERT_EQ(pool.size(), 2u);
+
+  // Reader 0 stays busy until released
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  ASSERT_TRUE(pool.PostTo(0, [released](ReaderConnection*) { released.wait(); }));
+
+  std::promise<size_t> ran_on;
+  ASSERT_TRUE(
+      pool.Post([&ran_on](ReaderConnection* reader) { ran_on.set_value(reader->index()); }));
+  EXPECT_EQ(ran_on.get_future().get(), 1u);
+
+  release.set_value();
+  EXPECT_FALSE(pool.PostTo(2, [](ReaderConnection*) {}));
+}
+
+TEST_F(ReaderPoolTest, ClosedPoolRefusesReads) {
+  DatabaseConfig config = config_;
+  config.reader_pool_size = 1;
+  ReaderPool pool;
+  ASSERT_TRUE(pool.Open(path_, config, nullptr, nullptr));
+  pool.Close();
+  EXPECT_FALSE(pool.Post([](ReaderConnection*) {}));
+
+  ASSERT_TRUE(pool.Open(path_, config, nullptr, nullptr));
+  pool.Shutdown();
+  EXPECT_FALSE(pool.Open(path_, config, nullptr, nullptr));
+  EXPECT_FALSE(pool.Post([](ReaderConnection*) {}));
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <string>
+
+#include "statement_cache.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+class StatementCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ASSERT_EQ(sqlite3_open(":memory:", &database_), SQLITE_OK); }
+
+  void TearDown() override { EXPECT_EQ(sqlite3_close(database_), SQLITE_OK); }
+
+  // Statements prepared on the connection and not yet finalized
+  int LiveStatements() {
+    int count = 0;
+    for (sqlite3_stmt* statement = sqlite3_next_stmt(database_, nullptr); statement != nullptr;
+         statement = sqlite3_next_stmt(database_, statement)) {
+      count++;
+    }
+    return count;
+  }
+
+  // Acquires and hands back the statement of `sql`
+  sqlite3_stmt* Use(StatementCache* cache, const std::string& sql) {
+    ScopedStatement statement = cache->Acquire(sql);
+    EXPECT_TRUE(statement);
+    return statement.get();
+  }
+
+  sqlite3* database_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(StatementCacheTest, EvictsLeastRecentlyUsed) {
+  StatementCache cache(database_, 2);
+  sqlite3_stmt* first = Use(&cache, "SELECT 1");
+  Use(&cache, "SELECT 2");
+  EXPECT_EQ(Use(&cache, "SELECT 1"), first);
+  Use(&cache, "SELECT 3");
+
+  StatementCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 3u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.size, 2u);
+
+  // "SELECT 2" was the least recently used
+  EXPECT_EQ(Use(&cache, "SELECT 1"), first);
+  Use(&cache, "SELECT 2");
+  EXPECT_EQ(cache.GetStats().misses, 4u);
+}
+
+TEST_F(StatementCacheTest, FinalizesEvictedStatements) {
+  StatementCache cache(database_, 2);
+  for (int i = 0; i < 5; i++) {
+    Use(&cache, "SELECT " + std::to_string(i));
+  }
+  EXPECT_EQ(LiveStatements(), 2);
+
+  cache.SetCapacity(1);
+  EXPECT_EQ(LiveStatements(), 1);
+  EXPECT_EQ(cache.GetStats().evictions, 4u);
+
+  cache.Clear();
+  EXPECT_EQ(LiveStatements(), 0);
+}
+
+TEST_F(StatementCacheTest, KeepsBorrowedStatementsUntilHandedBack) {
+  StatementCache cache(database_, 1);
+  {
+    ScopedStatement borrowed = cache.Acquire("SELECT 1");
+    Use(&cache, "SELECT 2");
+
+    // Only the statement handed back may be evicted
+    EXPECT_EQ(LiveStatements(), 1);
+    EXPECT_EQ(cache.GetStats().size, 1u);
+
+    cache.Clear();
+    EXPECT_EQ(LiveStatements(), 1);
+  }
+  EXPECT_EQ(LiveStatements(), 0);
+}
+
+TEST_F(StatementCacheTest, NestedAcquireOfBorrowedSqlGetsItsOwnStatement) {
+  StatementCache cache(database_, 4);
+  ScopedStatement outer = cache.Acquire("SELECT 1");
+  {
+    ScopedStatement inner = cache.Acquire("SELECT 1");
+    ASSERT_TRUE(inner);
+    EXPECT_NE(inner.get(), outer.get());
+    EXPECT_EQ(LiveStatements(), 2);
+  }
+
+  // The one-off statement is finalized once handed back
+  EXPECT_EQ(LiveStatements(), 1);
+  EXPECT_EQ(cache.GetStats().size, 1u);
+}
+
+TEST_F(StatementCacheTest, KeyedAcquireBuildsSqlOnlyOnMiss) {
+  StatementCache cache(database_, 4);
+  int built = 0;
+  auto build_sql = [&built]() {
+    built++;
+    return std::string("SELECT ?");
+  };
+  for (int i = 0; i < 3; i++) {
+    ScopedStatement statement = cache.Acquire("signature", build_sql);
+    ASSERT_TRUE(statement);
+    EXPECT_EQ(sqlite3_bind_parameter_count(statement.get()), 1);
+  }
+  EXPECT_EQ(built, 1);
+}
+
+TEST_F(StatementCacheTest, InvalidSqlYieldsEmptyHandle) {
+  StatementCache cache(database_, 4);
+  EXPECT_FALSE(cache.Acquire("SELEC 1"));
+  EXPECT_EQ(cache.GetStats().size, 0u);
+  EXPECT_EQ(LiveStatements(), 0);
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "timing_wheel.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+constexpr int64_t kStart = 1700000000000;
+
+// Width of one slot at `level`, in milliseconds
+int64_t SlotWidth(int level) {
+  return int64_t{1} << (TimingWheel::kSlotBits * level);
+}
+
+// Advances `wheel` to `now`, returning the deadlines that fired
+std::vector<int64_t> Advance(TimingWheel* wheel, int64_t now) {
+  std::vector<TimingWheel::Timer*> expired;
+  wheel->Advance(now, &expired);
+  std::vector<int64_t> deadlines;
+  for (const TimingWheel::Timer* timer : expired) {
+    EXPECT_FALSE(TimingWheel::IsScheduled(timer));
+    deadlines.push_back(timer->deadline);
+  }
+  std::sort(deadlines.begin(), deadlines.end());
+  return deadlines;
+}
+
+}  // namespace
+
+TEST(TimingWheelTest, FiresEachTimerAtItsDeadline) {
+  TimingWheel wheel(kStart);
+  TimingWheel::Timer soon;
+  soon.deadline = kStart + 10;
+  TimingWheel::Timer later;
+  later.deadline = kStart + 11;
+  wheel.Schedule(&soon);
+  wheel.Schedule(&later);
+  EXPECT_LE(wheel.NextDeadline(), kStart + 10);
+
+  EXPECT_TRUE(Advance(&wheel, kStart + 9).empty());
+  EXPECT_EQ(Advance(&wheel, kStart + 10), std::vector<int64_t>{kStart + 10});
+  EXPECT_TRUE(TimingWheel::IsScheduled(&later));
+  EXPECT_EQ(Advance(&wheel, kStart + 11), std::vector<int64_t>{kStart + 11});
+  EXPECT_EQ(wheel.NextDeadline(), INT64_MAX);
+}
+
+TEST(TimingWheelTest, PastDeadlineFiresOnNextAdvance) {
+  TimingWheel wheel(kStart);
+  TimingWheel::Timer past;
+  past.deadline = kStart - 5000;
+  wheel.Schedule(&past);
+  EXPECT_LE(wheel.NextDeadline(), kStart);
+  EXPECT_EQ(Advance(&wheel, kStart), std::vector<int64_t>{kStart - 5000});
+}
+
+TEST(TimingWheelTest, CascadesThroughEveryLevel) {
+  TimingWheel wheel(kStart);
+  // One timer just past the edge of each level, and one in the overflow list
+  std::vector<TimingWheel::Timer> timers(TimingWheel::kLevels + 1);
+  for (int level = 0; level <= TimingWheel::kLevels; level++) {
+    timers[level].deadline = kStart + SlotWidth(level) * TimingWheel::kSlots + level + 1;
+    wheel.Schedule(&timers[level]);
+  }
+
+  for (int level = 0; level <= TimingWheel::kLevels; level++) {
+    int64_t deadline = timers[level].deadline;
+    // Jumps straight to just before the deadline, which cascades the timer
+    // down from wherever it waited without firing it
+    EXPECT_TRUE(Advance(&wheel, deadline - 1).empty()) << level;
+    EXPECT_LE(wheel.NextDeadline(), deadline) << level;
+    EXPECT_TRUE(TimingWheel::IsScheduled(&timers[level])) << level;
+    EXPECT_EQ(Advance(&wheel, deadline), std::vector<int64_t>{deadline}) << level;
+  }
+  EXPECT_EQ(wheel.NextDeadline(), INT64_MAX);
+}
+
+TEST(TimingWheelTest, MatchesSortedDeadlinesUnderRandomSteps) {
+  std::mt19937_64 random(13);
+  TimingWheel wheel(kStart);
+  // Deadlines spread over levels 0 to 4
+  std::vector<TimingWheel::Timer> timers(2000);
+  std::vector<int64_t> pending;
+  for (TimingWheel::Timer& timer : timers) {
+    int level = static_cast<int>(random() % 5);
+    timer.deadline = kStart + static_cast<int64_t>(random() % (SlotWidth(level + 1) * 2));
+    wheel.Schedule(&timer);
+    pending.push_back(timer.deadline);
+  }
+  // Every third timer is cancelled
+  for (size_t i = 0; i < timers.size(); i += 3) {
+    wheel.Cancel(&timers[i]);
+    EXPECT_FALSE(TimingWheel::IsScheduled(&timers[i]));
+    pending.erase(std::find(pending.begin(), pending.end(), timers[i].deadline));
+  }
+  std::sort(pending.begin(), pending.end());
+
+  int64_t now = kStart;
+  size_t fired = 0;
+  while (fired < pending.size()) {
+    // NextDeadline() never skips past a timer
+    int64_t next = wheel.NextDeadline();
+    ASSERT_LE(next, pending[fired]);
+
+    // Steps to the next deadline or some random way short of or past it
+    int64_t step = static_cast<int64_t>(random() % (2 * SlotWidth(random() % 4) + 1));
+    now = std::max(now + 1, random() % 2 == 0 ? next : now + step);
+    size_t due = std::upper_bound(pending.begin(), pending.end(), now) - pending.begin();
+    std::vector<int64_t> expected(pending.begin() + fired, pending.begin() + due);
+    ASSERT_EQ(Advance(&wheel, now), expected) << "at " << now - kStart;
+    fired = due;
+  }
+  EXPECT_EQ(wheel.NextDeadline(), INT64_MAX);
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
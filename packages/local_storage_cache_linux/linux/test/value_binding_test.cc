@@ -0,0 +1,83 @@
+#include <flutter_linux/flutter_linux.h>
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <string>
+
+#include "value_binding.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+class ValueBindingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(sqlite3_open(":memory:", &database_), SQLITE_OK);
+    ASSERT_EQ(sqlite3_prepare_v2(database_, "SELECT typeof(?1), length(?1), hex(?1)", -1,
+                                 &statement_, nullptr),
+              SQLITE_OK);
+  }
+
+  void TearDown() override {
+    sqlite3_finalize(statement_);
+    sqlite3_close(database_);
+  }
+
+  // The type, length and hex bytes SQLite sees once `value` is bound
+  std::string Bind(FlValue* value) {
+    sqlite3_reset(statement_);
+    EXPECT_TRUE(BindValue(statement_, 1, value));
+    EXPECT_EQ(sqlite3_step(statement_), SQLITE_ROW);
+    std::string bound = reinterpret_cast<const char*>(sqlite3_column_text(statement_, 0));
+    if (sqlite3_column_type(statement_, 1) != SQLITE_NULL) {
+      bound += " " + std::to_string(sqlite3_column_int64(statement_, 1)) + " " +
+               reinterpret_cast<const char*>(sqlite3_column_text(statement_, 2));
+    }
+    return bound;
+  }
+
+  sqlite3* database_ = nullptr;
+  sqlite3_stmt* statement_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(ValueBindingTest, BindsScalars) {
+  g_autoptr(FlValue) null_value = fl_value_new_null();
+  g_autoptr(FlValue) boolean = fl_value_new_bool(true);
+  g_autoptr(FlValue) integer = fl_value_new_int(-42);
+  g_autoptr(FlValue) text = fl_value_new_string("h\xc3\xa9");
+  EXPECT_EQ(Bind(nullptr), "null");
+  EXPECT_EQ(Bind(null_value), "null");
+  EXPECT_EQ(Bind(boolean), "integer 1 31");
+  EXPECT_EQ(Bind(integer), "integer 3 2D3432");
+  EXPECT_EQ(Bind(text), "text 2 68C3A9");
+}
+
+TEST_F(ValueBindingTest, BindsTypedListsAsTheirBytes) {
+  const uint8_t bytes[] = {0x00, 0xff, 0x10};
+  g_autoptr(FlValue) uint8_list = fl_value_new_uint8_list(bytes, 3);
+  const int32_t words[] = {1};
+  g_autoptr(FlValue) int32_list = fl_value_new_int32_list(words, 1);
+  EXPECT_EQ(Bind(uint8_list), "blob 3 00FF10");
+  EXPECT_EQ(Bind(int32_list), "blob 4 01000000");
+}
+
+TEST_F(ValueBindingTest, EmptyListIsAnEmptyBlobNotNull) {
+  g_autoptr(FlValue) uint8_list = fl_value_new_uint8_list(nullptr, 0);
+  g_autoptr(FlValue) float_list = fl_value_new_float_list(nullptr, 0);
+  EXPECT_EQ(Bind(uint8_list), "blob 0 ");
+  EXPECT_EQ(Bind(float_list), "blob 0 ");
+}
+
+TEST_F(ValueBindingTest, RejectsCollections) {
+  g_autoptr(FlValue) list = fl_value_new_list();
+  sqlite3_reset(statement_);
+  EXPECT_FALSE(BindValue(statement_, 1, list));
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vector_index_manager.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// A database in a fresh file with two tables of 2-dimensional vectors,
+// `near` holding rowids 1 to 3 and `far` rowids 10 and 11
+class VectorIndexManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "vector_index_manager_test_" + std::to_string(getpid()) +
+            ".db";
+    Cleanup();
+    ASSERT_EQ(sqlite3_open(path_.c_str(), &database_), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(database_,
+                           "CREATE TABLE near (id INTEGER PRIMARY KEY, embedding BLOB);"
+                           "CREATE TABLE far (id INTEGER PRIMARY KEY, embedding BLOB)",
+                           nullptr, nullptr, nullptr),
+              SQLITE_OK);
+    InsertVector("near", 1, {1, 0});
+    InsertVector("near", 2, {0, 1});
+    InsertVector("near", 3, {1, 1});
+    InsertVector("far", 10, {100, 0});
+    InsertVector("far", 11, {0, 100});
+  }
+
+  void TearDown() override {
+    sqlite3_close(database_);
+    Cleanup();
+  }
+
+  void Cleanup() {
+    unlink(path_.c_str());
+    unlink((path_ + "-embeddings.hnsw").c_str());
+    unlink((path_ + "-embeddings.ivf").c_str());
+  }
+
+  void InsertVector(const std::string& table, int64_t id, const std::vector<float>& vector) {
+    sqlite3_stmt* statement = nullptr;
+    std::string sql = "INSERT INTO " + table + " (id, embedding) VALUES (?, ?)";
+    ASSERT_EQ(sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr), SQLITE_OK);
+    sqlite3_bind_int64(statement, 1, id);
+    sqlite3_bind_blob(statement, 2, vector.data(), static_cast<int>(vector.size() * sizeof(float)),
+                      SQLITE_TRANSIENT);
+    EXPECT_EQ(sqlite3_step(statement), SQLITE_DONE);
+    sqlite3_finalize(statement);
+  }
+
+  static VectorIndexDefinition Definition(const std::string& table_name) {
+    VectorIndexDefinition definition;
+    definition.name = "embeddings";
+    definition.table_name = table_name;
+    definition.column = "embedding";
+    definition.metric = DistanceMetric::kEuclidean;
+    return definition;
+  }
+
+  // The rowid of the closest match to `query` in `table_name`, or -1 if no
+  // index answers the search
+  int64_t Nearest(const VectorIndexManager& manager,
+                  const std::string& table_name,
+                  const std::vector<float>& query) {
+    VectorSearchRequest request;
+    request.table_name = table_name;
+    request.column = "embedding";
+    request.query = query;
+    request.k = 1;
+    request.metric = DistanceMetric::kEuclidean;
+    std::vector<VectorMatch> matches;
+    std::string error;
+    if (!manager.Search(database_, request, &matches, &error) || matches.empty()) {
+      return -1;
+    }
+    return matches[0].rowid;
+  }
+
+  std::string path_;
+  sqlite3* database_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(VectorIndexManagerTest, ReplacedIndexIsNotLoadedFromItsSideFile) {
+  {
+    VectorIndexManager manager(database_, path_);
+    std::string error;
+    ASSERT_TRUE(manager.Create(Definition("near"), &error)) << error;
+    manager.Save();
+
+    // Replaced with an index of the same kind, then closed without saving
+    ASSERT_TRUE(manager.Create(Definition("far"), &error)) << error;
+    EXPECT_EQ(Nearest(manager, "far", {0, 90}), 11);
+  }
+
+  VectorIndexManager reopened(database_, path_);
+  reopened.Load();
+  EXPECT_EQ(Nearest(reopened, "far", {0, 90}), 11);
+  EXPECT_EQ(Nearest(reopened, "near", {0, 1}), -1);
+}
+
+TEST_F(VectorIndexManagerTest, SavedIndexIsLoadedFromItsSideFile) {
+  {
+    VectorIndexManager manager(database_, path_);
+    std::string error;
+    ASSERT_TRUE(manager.Create(Definition("near"), &error)) << error;
+    manager.Save();
+  }
+
+  // Rows written while closed are only seen by an index rebuilt from the table
+  InsertVector("near", 4, {0, 5});
+
+  VectorIndexManager reopened(database_, path_);
+  reopened.Load();
+  EXPECT_EQ(Nearest(reopened, "near", {0, 5}), 2);
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
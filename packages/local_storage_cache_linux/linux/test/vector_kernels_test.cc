@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "vector_codec.h"
+#include "vector_kernels.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+// Lengths around every SIMD width, so both the vector loops and their tails
+// are covered
+constexpr size_t kCounts[] = {1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 64, 100, 257};
+
+class VectorKernelsTest : public ::testing::Test {
+ protected:
+  std::vector<float> RandomVector(size_t count) {
+    std::uniform_real_distribution<float> uniform(-1, 1);
+    std::vector<float> values(count);
+    for (float& value : values) {
+      value = uniform(random_);
+    }
+    return values;
+  }
+
+  // Tolerance for a float sum of `count` products of magnitude at most 1
+  static double Tolerance(size_t count) { return 1e-5 * count + 1e-5; }
+
+  const VectorKernels& kernels_ = GetVectorKernels();
+  std::mt19937 random_{7};
+};
+
+double ReferenceDot(const std::vector<float>& a, const std::vector<float>& b) {
+  double sum = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    sum += static_cast<double>(a[i]) * b[i];
+  }
+  return sum;
+}
+
+double ReferenceSquaredL2(const std::vector<float>& a, const std::vector<float>& b) {
+  double sum = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    double d = static_cast<double>(a[i]) - b[i];
+    sum += d * d;
+  }
+  return sum;
+}
+
+}  // namespace
+
+TEST_F(VectorKernelsTest, Float32MatchesScalarReference) {
+  for (size_t count : kCounts) {
+    std::vector<float> a = RandomVector(count);
+    // One element in, so the kernels see an unaligned row
+    std::vector<float> padded = RandomVector(count + 1);
+    std::vector<float> b(padded.begin() + 1, padded.end());
+
+    EXPECT_NEAR(kernels_.dot(a.data(), padded.data() + 1, count), ReferenceDot(a, b),
+                Tolerance(count))
+        << kernels_.name << " count " << count;
+    EXPECT_NEAR(kernels_.squared_l2(a.data(), padded.data() + 1, count),
+                ReferenceSquaredL2(a, b), Tolerance(count))
+        << kernels_.name << " count " << count;
+
+    float dot = 0;
+    float norm = 0;
+    kernels_.dot_and_norm(a.data(), padded.data() + 1, count, &dot, &norm);
+    EXPECT_NEAR(dot, ReferenceDot(a, b), Tolerance(count)) << count;
+    EXPECT_NEAR(norm, ReferenceDot(b, b), Tolerance(count)) << count;
+  }
+}
+
+TEST_F(VectorKernelsTest, HalfMatchesScalarReference) {
+  for (size_t count : kCounts) {
+    std::vector<float> a = RandomVector(count);
+    std::vector<float> values = RandomVector(count);
+
+    // Stored after one byte, so the halves are not even 2-byte aligned
+    std::vector<uint8_t> blob(1 + 2 * count);
+    std::vector<float> b(count);
+    for (size_t i = 0; i < count; i++) {
+      uint16_t half = FloatToHalf(values[i]);
+      blob[1 + 2 * i] = static_cast<uint8_t>(half & 0xff);
+      blob[2 + 2 * i] = static_cast<uint8_t>(half >> 8);
+      b[i] = HalfToFloat(half);
+    }
+
+    float dot = 0;
+    float norm = 0;
+    kernels_.half_dot_and_norm(a.data(), blob.data() + 1, count, &dot, &norm);
+    EXPECT_NEAR(dot, ReferenceDot(a, b), Tolerance(count)) << kernels_.name << " " << count;
+    EXPECT_NEAR(norm, ReferenceDot(b, b), Tolerance(count)) << kernels_.name << " " << count;
+    EXPECT_NEAR(kernels_.half_squared_l2(a.data(), blob.data() + 1, count),
+                ReferenceSquaredL2(a, b), Tolerance(count))
+        << kernels_.name << " " << count;
+  }
+}
+
+TEST_F(VectorKernelsTest, Int8MatchesScalarReference) {
+  std::uniform_int_distribution<int> code(-127, 127);
+  const float scale = 0.0125f;
+  for (size_t count : kCounts) {
+    std::vector<float> a = RandomVector(count);
+    std::vector<int8_t> codes(count);
+    std::vector<float> codes_as_floats(count);
+    std::vector<float> b(count);
+    for (size_t i = 0; i < count; i++) {
+      codes[i] = static_cast<int8_t>(code(random_));
+      codes_as_floats[i] = codes[i];
+      b[i] = scale * codes[i];
+    }
+
+    // The dot product and norm are of the codes themselves
+    float dot = 0;
+    float norm = 0;
+    kernels_.int8_dot_and_norm(a.data(), codes.data(), count, &dot, &norm);
+    EXPECT_NEAR(dot, ReferenceDot(a, codes_as_floats), 127 * Tolerance(count))
+        << kernels_.name << " " << count;
+    EXPECT_NEAR(norm, ReferenceDot(codes_as_floats, codes_as_floats), 0.5)
+        << kernels_.name << " " << count;
+    EXPECT_NEAR(kernels_.int8_squared_l2(a.data(), codes.data(), scale, count),
+                ReferenceSquaredL2(a, b), Tolerance(count))
+        << kernels_.name << " " << count;
+  }
+}
+
+TEST_F(VectorKernelsTest, DistancesFollowTheirMetric) {
+  std::vector<float> query = {3, 4};
+  std::vector<float> row = {4, 3};
+  float query_norm = 5;
+
+  EXPECT_NEAR(VectorDistance(kernels_, DistanceMetric::kEuclidean, query.data(), query_norm,
+                             row.data(), 2),
+              std::sqrt(2.0f), 1e-6);
+  EXPECT_NEAR(VectorDistance(kernels_, DistanceMetric::kDotProduct, query.data(), query_norm,
+                             row.data(), 2),
+              -24, 1e-6);
+  EXPECT_NEAR(VectorDistance(kernels_, DistanceMetric::kCosine, query.data(), query_norm,
+                             row.data(), 2),
+              1 - 24.0 / 25, 1e-6);
+
+  // A zero vector is equally far from everything
+  std::vector<float> zero = {0, 0};
+  EXPECT_EQ(VectorDistance(kernels_, DistanceMetric::kCosine, query.data(), query_norm,
+                           zero.data(), 2),
+            1);
+}
+
+TEST_F(VectorKernelsTest, CompressedDistancesMatchFloat32) {
+  const size_t count = 48;
+  std::vector<float> query = RandomVector(count);
+  float query_norm = std::sqrt(static_cast<float>(ReferenceDot(query, query)));
+  std::vector<float> row = RandomVector(count);
+
+  std::vector<uint16_t> halves(count);
+  std::vector<float> decoded_halves(count);
+  for (size_t i = 0; i < count; i++) {
+    halves[i] = FloatToHalf(row[i]);
+    decoded_halves[i] = HalfToFloat(halves[i]);
+  }
+  float scale = 0;
+  std::vector<int8_t> codes(count);
+  QuantizeInt8(row.data(), count, &scale, codes.data());
+  std::vector<float> decoded_codes(count);
+  for (size_t i = 0; i < count; i++) {
+    decoded_codes[i] = scale * codes[i];
+  }
+
+  for (DistanceMetric metric :
+       {DistanceMetric::kCosine, DistanceMetric::kEuclidean, DistanceMetric::kDotProduct}) {
+    EXPECT_NEAR(HalfVectorDistance(kernels_, metric, query.data(), query_norm, halves.data(),
+                                   count),
+                VectorDistance(kernels_, metric, query.data(), query_norm,
+                               decoded_halves.data(), count),
+                1e-4)
+        << DistanceMetricName(metric);
+    EXPECT_NEAR(Int8VectorDistance(kernels_, metric, query.data(), query_norm, codes.data(),
+                                   scale, count),
+                VectorDistance(kernels_, metric, query.data(), query_norm,
+                               decoded_codes.data(), count),
+                1e-4)
+        << DistanceMetricName(metric);
+  }
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
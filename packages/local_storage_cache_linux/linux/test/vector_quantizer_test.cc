@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "vector_codec.h"
+#include "vector_quantizer.h"
+
+namespace local_storage_cache_linux {
+namespace test {
+
+namespace {
+
+constexpr size_t kDimensions = 18;  // Not a multiple of a float word of int8
+
+class VectorQuantizerTest : public ::testing::Test {
+ protected:
+  std::vector<float> RandomVector() {
+    std::normal_distribution<float> normal;
+    std::vector<float> vector(kDimensions);
+    for (float& value : vector) {
+      value = normal(random_);
+    }
+    return vector;
+  }
+
+  // Encodes then decodes `vector`
+  static std::vector<float> RoundTrip(const VectorQuantizer& quantizer,
+                                      const std::vector<float>& vector) {
+    std::vector<float> code(quantizer.code_words());
+    quantizer.Encode(vector.data(), code.data());
+    std::vector<float> decoded(kDimensions);
+    quantizer.Decode(code.data(), decoded.data());
+    return decoded;
+  }
+
+  static double SquaredL2(const std::vector<float>& a, const std::vector<float>& b) {
+    double sum = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+      sum += (static_cast<double>(a[i]) - b[i]) * (a[i] - b[i]);
+    }
+    return sum;
+  }
+
+  std::mt19937 random_{3};
+};
+
+}  // namespace
+
+TEST_F(VectorQuantizerTest, NoneStoresVectorsAsIs) {
+  VectorQuantizer quantizer(kDimensions, DistanceMetric::kEuclidean, VectorQuantization::kNone, 0);
+  EXPECT_FALSE(quantizer.compressed());
+  EXPECT_EQ(quantizer.code_words(), kDimensions);
+
+  std::vector<float> vector = RandomVector();
+  EXPECT_EQ(RoundTrip(quantizer, vector), vector);
+}
+
+TEST_F(VectorQuantizerTest, Int8RoundTripsWithinHalfAStep) {
+  VectorQuantizer quantizer(kDimensions, DistanceMetric::kEuclidean, VectorQuantization::kInt8, 0);
+  EXPECT_TRUE(quantizer.compressed());
+  EXPECT_EQ(quantizer.code_words(), 1 + (kDimensions + 3) / 4);
+
+  for (int i = 0; i < 20; i++) {
+    std::vector<float> vector = RandomVector();
+    float max = 0;
+    for (float value : vector) {
+      max = std::max(max, std::abs(value));
+    }
+    std::vector<float> decoded = RoundTrip(quantizer, vector);
+    for (size_t j = 0; j < kDimensions; j++) {
+      EXPECT_NEAR(decoded[j], vector[j], max / 127 / 2 * 1.001f) << j;
+    }
+  }
+
+  // A zero vector stays zero
+  std::vector<float> zero(kDimensions, 0);
+  EXPECT_EQ(RoundTrip(quantizer, zero), zero);
+}
+
+TEST_F(VectorQuantizerTest, ProductQuantizationLearnsItsCodebooks) {
+  VectorQuantizer quantizer(kDimensions, DistanceMetric::kEuclidean,
+                            VectorQuantization::kProduct, 6);
+  EXPECT_TRUE(quantizer.NeedsTraining());
+
+  // Untrained, vectors are stored uncompressed
+  std::vector<float> vector = RandomVector();
+  EXPECT_FALSE(quantizer.compressed());
+  EXPECT_EQ(RoundTrip(quantizer, vector), vector);
+
+  std::vector<float> sample;
+  for (int i = 0; i < 4000; i++) {
+    std::vector<float> row = RandomVector();
+    sample.insert(sample.end(), row.begin(), row.end());
+  }
+  quantizer.Train(sample.data(), 4000);
+  EXPECT_FALSE(quantizer.NeedsTraining());
+  EXPECT_TRUE(quantizer.compressed());
+  EXPECT_EQ(quantizer.code_words(), 2u);
+
+  // Three dimensions per subvector of 256 codewords keep most of the signal
+  double error = 0;
+  double energy = 0;
+  for (int i = 0; i < 100; i++) {
+    std::vector<float> row = RandomVector();
+    error += SquaredL2(RoundTrip(quantizer, row), row);
+    energy += SquaredL2(row, std::vector<float>(kDimensions, 0));
+  }
+  EXPECT_LT(error / energy, 0.25);
+}
+
+TEST_F(VectorQuantizerTest, ScannerMatchesDistanceToDecodedVector) {
+  for (VectorQuantization quantization :
+       {VectorQuantization::kNone, VectorQuantization::kInt8, VectorQuantization::kProduct}) {
+    VectorQuantizer quantizer(kDimensions, DistanceMetric::kEuclidean, quantization, 6);
+    std::vector<float> sample;
+    for (int i = 0; i < 1000; i++) {
+      std::vector<float> row = RandomVector();
+      sample.insert(sample.end(), row.begin(), row.end());
+    }
+    quantizer.Train(sample.data(), 1000);
+
+    std::vector<float> query = RandomVector();
+    VectorQuantizer::Scanner scanner(quantizer, query.data());
+    for (int i = 0; i < 20; i++) {
+      std::vector<float> row = RandomVector();
+      std::vector<float> code(quantizer.code_words());
+      quantizer.Encode(row.data(), code.data());
+      std::vector<float> decoded(kDimensions);
+      quantizer.Decode(code.data(), decoded.data());
+
+      // Euclidean distances are kept squared
+      EXPECT_NEAR(scanner.Distance(code.data()), SquaredL2(query, decoded), 1e-3)
+          << VectorQuantizationName(quantization);
+    }
+  }
+}
+
+TEST_F(VectorQuantizerTest, LoadsWhatItSaved) {
+  VectorQuantizer quantizer(kDimensions, DistanceMetric::kEuclidean,
+                            VectorQuantization::kProduct, 6);
+  std::vector<float> sample;
+  for (int i = 0; i < 1000; i++) {
+    std::vector<float> row = RandomVector();
+    sample.insert(sample.end(), row.begin(), row.end());
+  }
+  quantizer.Train(sample.data(), 1000);
+
+  FILE* file = tmpfile();
+  ASSERT_TRUE(quantizer.Save(file));
+  rewind(file);
+  std::unique_ptr<VectorQuantizer> loaded =
+      VectorQuantizer::Load(file, kDimensions, DistanceMetric::kEuclidean);
+  fclose(file);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->subvectors(), 6u);
+  EXPECT_TRUE(loaded->compressed());
+
+  std::vector<float> vector = RandomVector();
+  EXPECT_EQ(RoundTrip(*loaded, vector), RoundTrip(quantizer, vector));
+}
+
+TEST(VectorCodecTest, HalfRoundTripsRepresentableValues) {
+  for (float value : {0.0f, -0.0f, 1.0f, -2.5f, 0.333251953125f, 65504.0f, 6.103515625e-05f}) {
+    EXPECT_EQ(HalfToFloat(FloatToHalf(value)), value);
+  }
+  EXPECT_TRUE(std::isinf(HalfToFloat(FloatToHalf(1e6f))));
+  EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(NAN))));
+  // Rounded to the nearest of 1 and 1 + 2^-10
+  EXPECT_EQ(HalfToFloat(FloatToHalf(1.0004f)), 1.0f);
+  EXPECT_EQ(HalfToFloat(FloatToHalf(1.0006f)), 1.0009765625f);
+}
+
+}  // namespace test
+}  // namespace local_storage_cache_linux
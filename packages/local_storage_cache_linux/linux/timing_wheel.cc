@@ -0,0 +1,163 @@
+#include "timing_wheel.h"
+
+#include <climits>
+
+TimingWheel::TimingWheel(int64_t now) : now_(now) {
+  Clear();
+}
+
+void TimingWheel::Clear() {
+  for (int level = 0; level < kLevels; level++) {
+    for (int slot = 0; slot < kSlots; slot++) {
+      InitList(&slots_[level][slot]);
+    }
+    occupied_[level] = 0;
+  }
+  InitList(&due_);
+  InitList(&overflow_);
+}
+
+void TimingWheel::InitList(Timer* list) {
+  list->prev = list;
+  list->next = list;
+}
+
+void TimingWheel::Push(Timer* list, Timer* timer) {
+  timer->prev = list->prev;
+  timer->next = list;
+  list->prev->next = timer;
+  list->prev = timer;
+}
+
+void TimingWheel::Unlink(Timer* timer) {
+  timer->prev->next = timer->next;
+  timer->next->prev = timer->prev;
+  timer->prev = nullptr;
+  timer->next = nullptr;
+}
+
+TimingWheel::Timer* TimingWheel::ListFor(const Timer* timer, int* level, int* slot) {
+  *level = -1;
+  if (timer->deadline <= now_) {
+    return &due_;
+  }
+
+  // The highest bit telling the deadline apart from now picks the level
+  uint64_t difference = static_cast<uint64_t>(timer->deadline) ^ static_cast<uint64_t>(now_);
+  if ((difference >> (kSlotBits * kLevels)) != 0) {
+    return &overflow_;
+  }
+  *level = (63 - __builtin_clzll(difference)) / kSlotBits;
+  *slot = static_cast<int>((timer->deadline >> (kSlotBits * *level)) & (kSlots - 1));
+  return &slots_[*level][*slot];
+}
+
+void TimingWheel::Schedule(Timer* timer) {
+  int level = 0;
+  int slot = 0;
+  Push(ListFor(timer, &level, &slot), timer);
+  if (level >= 0) {
+    occupied_[level] |= 1ULL << slot;
+  }
+}
+
+void TimingWheel::Cancel(Timer* timer) {
+  if (!IsScheduled(timer)) {
+    return;
+  }
+  int level = 0;
+  int slot = 0;
+  Timer* list = ListFor(timer, &level, &slot);
+  Unlink(timer);
+  if (level >= 0 && list->next == list) {
+    occupied_[level] &= ~(1ULL << slot);
+  }
+}
+
+int64_t TimingWheel::EarliestSlot(int* level, int* slot) const {
+  int64_t earliest = INT64_MAX;
+  for (int l = 0; l < kLevels; l++) {
+    // Every timer of a level lies ahead of now within the current slot of
+    // the level above
+    int shift = kSlotBits * l;
+    int digit = static_cast<int>((now_ >> shift) & (kSlots - 1));
+    uint64_t ahead = occupied_[l] & (~0ULL << digit);
+    if (ahead == 0) {
+      continue;
+    }
+    int first = __builtin_ctzll(ahead);
+    int64_t start = ((now_ >> (shift + kSlotBits)) << (shift + kSlotBits)) |
+                    (static_cast<int64_t>(first) << shift);
+    if (start < earliest) {
+      earliest = start;
+      *level = l;
+      *slot = first;
+    }
+  }
+
+  // Overflowing timers are placed again once the top level wraps around
+  if (overflow_.next != &overflow_) {
+    int bits = kSlotBits * kLevels;
+    int64_t start = ((now_ >> bits) + 1) << bits;
+    if (start < earliest) {
+      earliest = start;
+      *level = -1;
+    }
+  }
+  return earliest;
+}
+
+void TimingWheel::Advance(int64_t now, std::vector<Timer*>* expired) {
+  while (due_.next != &due_) {
+    Timer* timer = due_.next;
+    Unlink(timer);
+    expired->push_back(timer);
+  }
+
+  for (;;) {
+    int level = -1;
+    int slot = 0;
+    int64_t start = EarliestSlot(&level, &slot);
+    if (start > now) {
+      break;
+    }
+    if (start > now_) {
+      now_ = start;
+    }
+
+    // Detaches the slot before its timers are placed again lower down
+    Timer* source = level < 0 ? &overflow_ : &slots_[level][slot];
+    if (level >= 0) {
+      occupied_[level] &= ~(1ULL << slot);
+    }
+    Timer pending;
+    pending.next = source->next;
+    pending.prev = source->prev;
+    pending.next->prev = &pending;
+    pending.prev->next = &pending;
+    InitList(source);
+
+    while (pending.next != &pending) {
+      Timer* timer = pending.next;
+      Unlink(timer);
+      if (timer->deadline <= now) {
+        expired->push_back(timer);
+      } else {
+        Schedule(timer);
+      }
+    }
+  }
+
+  if (now > now_) {
+    now_ = now;
+  }
+}
+
+int64_t TimingWheel::NextDeadline() const {
+  if (due_.next != &due_) {
+    return now_;
+  }
+  int level = -1;
+  int slot = 0;
+  return EarliestSlot(&level, &slot);
+}
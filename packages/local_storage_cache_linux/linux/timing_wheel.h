@@ -0,0 +1,79 @@
+#ifndef TIMING_WHEEL_H_
+#define TIMING_WHEEL_H_
+
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel of millisecond deadlines, used to expire cache
+// entries without scanning them.
+//
+// Level 0 has 64 slots of one millisecond and each level above has 64 slots
+// as wide as the whole level below, six levels spanning about two years;
+// later deadlines wait in an overflow list. A timer sits at the lowest level
+// whose slot tells its deadline apart from the current time, and drops to a
+// lower level when the wheel reaches its slot, so scheduling and cancelling
+// take constant time and a timer moves at most once per level before it
+// fires. Each level keeps a bitmap of its occupied slots, so advancing over
+// an idle stretch costs nothing however long it is.
+//
+// Not thread-safe.
+class TimingWheel {
+ public:
+  // Intrusive list node, owned by the caller, e.g. as a base of its entries
+  struct Timer {
+    Timer* prev = nullptr;
+    Timer* next = nullptr;
+    int64_t deadline = 0;  // Milliseconds
+  };
+
+  static constexpr int kLevels = 6;
+  static constexpr int kSlotBits = 6;
+  static constexpr int kSlots = 1 << kSlotBits;
+
+  // Starts the wheel at `now`, in milliseconds
+  explicit TimingWheel(int64_t now);
+
+  // Disallow copy and assign.
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  // Schedules `timer`, which must not be scheduled already, to fire at its
+  // deadline. A deadline already past fires on the next Advance().
+  void Schedule(Timer* timer);
+
+  void Cancel(Timer* timer);
+
+  static bool IsScheduled(const Timer* timer) { return timer->next != nullptr; }
+
+  // Moves the wheel to `now`, unscheduling the timers due by then and
+  // appending them to `*expired`
+  void Advance(int64_t now, std::vector<Timer*>* expired);
+
+  // A time no later than the earliest deadline, when Advance() should next
+  // be called, or INT64_MAX if nothing is scheduled
+  int64_t NextDeadline() const;
+
+  // Forgets every timer without touching them
+  void Clear();
+
+ private:
+  // The list `timer` belongs in at the current time, setting `*level` to
+  // its level, -1 for the due and overflow lists
+  Timer* ListFor(const Timer* timer, int* level, int* slot);
+
+  // The start of the earliest occupied slot, setting `*level` and `*slot`
+  // to it, with a `*level` of -1 for the overflow list
+  int64_t EarliestSlot(int* level, int* slot) const;
+
+  static void InitList(Timer* list);
+  static void Push(Timer* list, Timer* timer);
+  static void Unlink(Timer* timer);
+
+  int64_t now_;
+  Timer slots_[kLevels][kSlots];  // Sentinels of circular lists
+  uint64_t occupied_[kLevels];    // Bit per non-empty slot
+  Timer due_;
+  Timer overflow_;
+};
+
+#endif  // TIMING_WHEEL_H_
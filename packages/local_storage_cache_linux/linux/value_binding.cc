@@ -0,0 +1,81 @@
+#include "value_binding.h"
+
+namespace {
+
+int BindBlob(sqlite3_stmt* statement, int index, const void* data,
+             size_t length) {
+  // SQLite binds a null pointer as NULL, which an empty list may well carry
+  if (length == 0) {
+    return sqlite3_bind_zeroblob(statement, index, 0);
+  }
+  return sqlite3_bind_blob64(statement, index, data, length, SQLITE_STATIC);
+}
+
+}  // namespace
+
+bool BindValue(sqlite3_stmt* statement, int index, FlValue* value) {
+  int result;
+
+  switch (value ? fl_value_get_type(value) : FL_VALUE_TYPE_NULL) {
+    case FL_VALUE_TYPE_NULL:
+      result = sqlite3_bind_null(statement, index);
+      break;
+    case FL_VALUE_TYPE_BOOL:
+      result = sqlite3_bind_int(statement, index, fl_value_get_bool(value) ? 1 : 0);
+      break;
+    case FL_VALUE_TYPE_INT:
+      result = sqlite3_bind_int64(statement, index, fl_value_get_int(value));
+      break;
+    case FL_VALUE_TYPE_FLOAT:
+      result = sqlite3_bind_double(statement, index, fl_value_get_float(value));
+      break;
+    case FL_VALUE_TYPE_STRING:
+      result = sqlite3_bind_text(statement, index, fl_value_get_string(value),
+                                 -1, SQLITE_STATIC);
+      break;
+    case FL_VALUE_TYPE_UINT8_LIST:
+      result = BindBlob(statement, index, fl_value_get_uint8_list(value),
+                        fl_value_get_length(value));
+      break;
+    case FL_VALUE_TYPE_INT32_LIST:
+      result = BindBlob(statement, index, fl_value_get_int32_list(value),
+                        fl_value_get_length(value) * sizeof(int32_t));
+      break;
+    case FL_VALUE_TYPE_INT64_LIST:
+      result = BindBlob(statement, index, fl_value_get_int64_list(value),
+                        fl_value_get_length(value) * sizeof(int64_t));
+      break;
+    case FL_VALUE_TYPE_FLOAT32_LIST:
+      result = BindBlob(statement, index, fl_value_get_float32_list(value),
+                        fl_value_get_length(value) * sizeof(float));
+      break;
+    case FL_VALUE_TYPE_FLOAT_LIST:
+      result = BindBlob(statement, index, fl_value_get_float_list(value),
+                        fl_value_get_length(value) * sizeof(double));
+      break;
+    default:
+      // Lists, maps and custom values have no SQLite representation
+      return false;
+  }
+
+  return result == SQLITE_OK;
+}
+
+bool BindArguments(sqlite3_stmt* statement, FlValue* arguments) {
+  if (arguments == nullptr || fl_value_get_type(arguments) == FL_VALUE_TYPE_NULL) {
+    return true;
+  }
+  if (fl_value_get_type(arguments) != FL_VALUE_TYPE_LIST) {
+    return false;
+  }
+
+  size_t count = fl_value_get_length(arguments);
+  for (size_t i = 0; i < count; i++) {
+    if (!BindValue(statement, static_cast<int>(i + 1),
+                   fl_value_get_list_value(arguments, i))) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,19 @@
+#ifndef VALUE_BINDING_H_
+#define VALUE_BINDING_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+// Binds `value` to the 1-based parameter `index` of `statement`.
+//
+// Strings and typed lists are bound with SQLITE_STATIC straight from the
+// FlValue buffers, so `value` must outlive the statement's current execution.
+// Typed lists (Uint8List, Int32List, Int64List, Float32List, Float64List) are
+// stored as BLOBs of their raw bytes.
+bool BindValue(sqlite3_stmt* statement, int index, FlValue* value);
+
+// Binds every element of the FlValue list `arguments` positionally.
+// A null `arguments` (or FlValue null) binds nothing.
+bool BindArguments(sqlite3_stmt* statement, FlValue* arguments);
+
+#endif  // VALUE_BINDING_H_
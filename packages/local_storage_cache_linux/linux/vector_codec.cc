@@ -0,0 +1,182 @@
+#include "vector_codec.h"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+bool ParseVectorType(const char* declared_type, VectorElementType* type) {
+  if (declared_type == nullptr) {
+    return false;
+  }
+  
+  if (strncasecmp(declared_type, "F32_BLOB", 8) == 0) {
+    *type = VectorElementType::kFloat32;
+  } else if (strncasecmp(declared_type, "F64_BLOB", 8) == 0) {
+    *type = VectorElementType::kFloat64;
+  } else if (strncasecmp(declared_type, "F16_BLOB", 8) == 0) {
+    *type = VectorElementType::kFloat16;
+  } else if (strncasecmp(declared_type, "I8_BLOB", 7) == 0) {
+    *type = VectorElementType::kInt8;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+size_t VectorBlobSize(VectorElementType type, size_t dimensions) {
+  switch (type) {
+    case VectorElementType::kFloat16:
+      return dimensions * sizeof(uint16_t);
+    case VectorElementType::kFloat64:
+      return dimensions * sizeof(double);
+    case VectorElementType::kInt8:
+      return sizeof(float) + dimensions;
+    case VectorElementType::kFloat32:
+    default:
+      return dimensions * sizeof(float);
+  }
+}
+
+bool VectorBlobDimensions(VectorElementType type, size_t bytes, size_t* dimensions) {
+  if (type == VectorElementType::kInt8) {
+    if (bytes < sizeof(float)) {
+      return false;
+    }
+    *dimensions = bytes - sizeof(float);
+    return true;
+  }
+  
+  size_t element_size = VectorBlobSize(type, 1);
+  if (bytes % element_size != 0) {
+    return false;
+  }
+  *dimensions = bytes / element_size;
+  return true;
+}
+
+void QuantizeInt8(const float* values, size_t count, float* scale, int8_t* codes) {
+  float max_magnitude = 0;
+  for (size_t i = 0; i < count; i++) {
+    max_magnitude = std::max(max_magnitude, std::fabs(values[i]));
+  }
+  
+  *scale = max_magnitude / 127;
+  float inverse = max_magnitude > 0 ? 127 / max_magnitude : 0;
+  for (size_t i = 0; i < count; i++) {
+    codes[i] = static_cast<int8_t>(std::lround(values[i] * inverse));
+  }
+}
+
+float HalfToFloat(uint16_t half) {
+  uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  uint32_t exponent = (half >> 10) & 0x1f;
+  uint32_t mantissa = half & 0x3ff;
+  uint32_t bits;
+  
+  if (exponent == 0) {
+    if (mantissa == 0) {
+      bits = sign;
+    } else {
+      // Subnormal; renormalize for the wider exponent
+      exponent = 127 - 15 + 1;
+      while ((mantissa & 0x400) == 0) {
+        mantissa <<= 1;
+        exponent--;
+      }
+      bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+  } else if (exponent == 0x1f) {
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+  
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+uint16_t FloatToHalf(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  
+  uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff);
+  uint32_t mantissa = bits & 0x7fffff;
+  
+  if (exponent == 0xff) {
+    // Infinity stays infinity, NaN stays a (quiet) NaN
+    return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+  }
+  
+  exponent = exponent - 127 + 15;
+  if (exponent >= 0x1f) {
+    return sign | 0x7c00;
+  }
+  
+  if (exponent <= 0) {
+    if (exponent < -10) {
+      return sign;
+    }
+    mantissa = (mantissa | 0x800000) >> (1 - exponent);
+    return sign | static_cast<uint16_t>((mantissa + 0x1000) >> 13);
+  }
+  
+  // Round to nearest; a carry out of the mantissa bumps the exponent
+  mantissa += 0x1000;
+  if (mantissa & 0x800000) {
+    mantissa = 0;
+    exponent++;
+    if (exponent >= 0x1f) {
+      return sign | 0x7c00;
+    }
+  }
+  return sign | static_cast<uint16_t>(exponent << 10) | static_cast<uint16_t>(mantissa >> 13);
+}
+
+void HalfsToFloats(const void* data, size_t count, float* out) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < count; i++) {
+    uint16_t half;
+    memcpy(&half, bytes + i * sizeof(half), sizeof(half));
+    out[i] = HalfToFloat(half);
+  }
+}
+
+const float* DecodeVector(const void* blob,
+                          VectorElementType type,
+                          std::vector<float>* scratch) {
+  size_t count = scratch->size();
+  switch (type) {
+    case VectorElementType::kFloat16:
+      HalfsToFloats(blob, count, scratch->data());
+      return scratch->data();
+    case VectorElementType::kFloat64: {
+      const uint8_t* bytes = static_cast<const uint8_t*>(blob);
+      for (size_t i = 0; i < count; i++) {
+        double element;
+        memcpy(&element, bytes + i * sizeof(element), sizeof(element));
+        (*scratch)[i] = static_cast<float>(element);
+      }
+      return scratch->data();
+    }
+    case VectorElementType::kInt8: {
+      float scale;
+      memcpy(&scale, blob, sizeof(scale));
+      const int8_t* codes = static_cast<const int8_t*>(blob) + sizeof(scale);
+      for (size_t i = 0; i < count; i++) {
+        (*scratch)[i] = scale * codes[i];
+      }
+      return scratch->data();
+    }
+    case VectorElementType::kFloat32:
+    default:
+      if (reinterpret_cast<uintptr_t>(blob) % alignof(float) == 0) {
+        return static_cast<const float*>(blob);
+      }
+      memcpy(scratch->data(), blob, count * sizeof(float));
+      return scratch->data();
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef VECTOR_CODEC_H_
+#define VECTOR_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Element type of a vector column, taken from its declared type:
+// F16_BLOB(n), F32_BLOB(n), F64_BLOB(n) or I8_BLOB(n). Vectors are stored as
+// BLOBs of little-endian elements; int8 vectors are a float32 scale followed
+// by one signed code per element, each element being scale * code.
+enum class VectorElementType {
+  kFloat16,
+  kFloat32,
+  kFloat64,
+  kInt8,
+};
+
+// Returns false if `declared_type` is not a vector column type.
+bool ParseVectorType(const char* declared_type, VectorElementType* type);
+
+// Size of the BLOB of a vector of `dimensions` elements
+size_t VectorBlobSize(VectorElementType type, size_t dimensions);
+
+// Returns false if no vector of `type` is stored in `bytes` bytes.
+bool VectorBlobDimensions(VectorElementType type, size_t bytes, size_t* dimensions);
+
+// Symmetric int8 quantization: `*scale` is max |value| / 127, and each code
+// the value divided by it, rounded. A zero vector gets a zero scale.
+void QuantizeInt8(const float* values, size_t count, float* scale, int8_t* codes);
+
+// IEEE 754 half-precision conversions
+float HalfToFloat(uint16_t half);
+uint16_t FloatToHalf(float value);
+
+// Decodes `count` half-precision values from the possibly unaligned `data`
+void HalfsToFloats(const void* data, size_t count, float* out);
+
+// Returns the `scratch->size()` elements of the vector BLOB as floats,
+// decoding into `scratch` unless the BLOB can be used in place.
+const float* DecodeVector(const void* blob,
+                          VectorElementType type,
+                          std::vector<float>* scratch);
+
+#endif  // VECTOR_CODEC_H_
@@ -0,0 +1,190 @@
+#include "vector_functions.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vector_codec.h"
+#include "vector_kernels.h"
+#include "vector_search.h"
+
+namespace {
+
+struct VectorFunction {
+  const char* name;
+  DistanceMetric metric;
+};
+
+const VectorFunction kVectorFunctions[] = {
+    {"vec_cosine", DistanceMetric::kCosine},
+    {"vec_l2", DistanceMetric::kEuclidean},
+    {"vec_dot", DistanceMetric::kDotProduct},
+};
+
+// The second argument of a vector function, decoded once and kept as SQLite
+// auxiliary data for as long as it stays constant, as a bound query does
+struct QueryVector {
+  VectorElementType type;
+  std::vector<float> values;
+  float norm;
+  std::vector<float> scratch;  // Rows that cannot be compared in place
+};
+
+void DeleteQueryVector(void* query) {
+  delete static_cast<QueryVector*>(query);
+}
+
+void ResultError(sqlite3_context* context, const char* function, const char* message) {
+  std::string error = std::string(function) + ": " + message;
+  sqlite3_result_error(context, error.c_str(), -1);
+}
+
+// Reads a declared vector type such as 'F16_BLOB' or 'F16_BLOB(384)'
+bool ReadVectorType(sqlite3_value* value, VectorElementType* type) {
+  return sqlite3_value_type(value) == SQLITE_TEXT &&
+         ParseVectorType(reinterpret_cast<const char*>(sqlite3_value_text(value)), type);
+}
+
+bool DecodeQueryVector(sqlite3_value* value, VectorElementType type, QueryVector* query) {
+  const void* blob = sqlite3_value_blob(value);
+  size_t dimensions;
+  if (!VectorBlobDimensions(type, sqlite3_value_bytes(value), &dimensions)) {
+    return false;
+  }
+
+  query->type = type;
+  query->scratch.resize(dimensions);
+  const float* values = DecodeVector(blob, type, &query->scratch);
+  query->values.assign(values, values + dimensions);
+  query->norm = std::sqrt(GetVectorKernels().dot(values, values, dimensions));
+  return true;
+}
+
+// vec_cosine(a, b [, a_type [, b_type]]) and its siblings
+void CompareVectors(sqlite3_context* context, int argc, sqlite3_value** argv) {
+  const VectorFunction& function =
+      *static_cast<const VectorFunction*>(sqlite3_user_data(context));
+  if (sqlite3_value_type(argv[0]) == SQLITE_NULL ||
+      sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+    sqlite3_result_null(context);
+    return;
+  }
+  if (sqlite3_value_type(argv[0]) != SQLITE_BLOB ||
+      sqlite3_value_type(argv[1]) != SQLITE_BLOB) {
+    ResultError(context, function.name, "vectors must be BLOBs");
+    return;
+  }
+
+  VectorElementType row_type = VectorElementType::kFloat32;
+  VectorElementType query_type = VectorElementType::kFloat32;
+  if ((argc > 2 && !ReadVectorType(argv[2], &row_type)) ||
+      (argc > 3 && !ReadVectorType(argv[3], &query_type))) {
+    ResultError(context, function.name, "unknown vector type");
+    return;
+  }
+
+  std::unique_ptr<QueryVector> decoded;
+  QueryVector* query = static_cast<QueryVector*>(sqlite3_get_auxdata(context, 1));
+  if (query == nullptr || query->type != query_type) {
+    decoded.reset(new QueryVector());
+    if (!DecodeQueryVector(argv[1], query_type, decoded.get())) {
+      ResultError(context, function.name, "malformed vector");
+      return;
+    }
+    query = decoded.get();
+  }
+
+  const void* row = sqlite3_value_blob(argv[0]);
+  size_t row_bytes = static_cast<size_t>(sqlite3_value_bytes(argv[0]));
+  if (row_bytes != VectorBlobSize(row_type, query->values.size())) {
+    ResultError(context, function.name, "vectors differ in length");
+    return;
+  }
+
+  float distance = VectorBlobDistance(GetVectorKernels(), function.metric, query->values,
+                                      query->norm, row_type, row, &query->scratch);
+  if (std::isnan(distance)) {
+    sqlite3_result_null(context);
+  } else {
+    // The dot product metric is a distance, -a . b
+    sqlite3_result_double(context,
+                          function.metric == DistanceMetric::kDotProduct ? -distance : distance);
+  }
+
+  // SQLite may free the query as soon as it is handed over
+  if (decoded) {
+    sqlite3_set_auxdata(context, 1, decoded.release(), DeleteQueryVector);
+  }
+}
+
+// vec_top_k(id, distance, k) keeps a TopK in its aggregate context
+void TopKStep(sqlite3_context* context, int argc, sqlite3_value** argv) {
+  TopK** top = static_cast<TopK**>(sqlite3_aggregate_context(context, sizeof(TopK*)));
+  if (top == nullptr) {
+    sqlite3_result_error_nomem(context);
+    return;
+  }
+  if (*top == nullptr) {
+    sqlite3_int64 k = sqlite3_value_int64(argv[2]);
+    if (sqlite3_value_type(argv[2]) != SQLITE_INTEGER || k <= 0) {
+      ResultError(context, "vec_top_k", "k must be a positive integer");
+      return;
+    }
+    *top = new TopK(static_cast<size_t>(k));
+  }
+
+  if (sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+    return;
+  }
+  if (sqlite3_value_type(argv[0]) != SQLITE_INTEGER) {
+    ResultError(context, "vec_top_k", "id must be an integer");
+    return;
+  }
+
+  float distance = static_cast<float>(sqlite3_value_double(argv[1]));
+  if (std::isfinite(distance) && (*top)->Accepts(distance)) {
+    (*top)->Push(distance, sqlite3_value_int64(argv[0]));
+  }
+}
+
+void TopKFinal(sqlite3_context* context) {
+  // No context means no rows were aggregated
+  TopK** top = static_cast<TopK**>(sqlite3_aggregate_context(context, 0));
+  std::string json = "[";
+  if (top != nullptr && *top != nullptr) {
+    char element[64];
+    for (const VectorMatch& match : (*top)->Sorted()) {
+      snprintf(element, sizeof(element), "%s{\"id\":%" PRId64 ",\"distance\":%.9g}",
+               json.size() > 1 ? "," : "", match.rowid, match.distance);
+      json += element;
+    }
+    delete *top;
+    *top = nullptr;
+  }
+  json += "]";
+  sqlite3_result_text(context, json.c_str(), static_cast<int>(json.size()), SQLITE_TRANSIENT);
+}
+
+}  // namespace
+
+bool RegisterVectorFunctions(sqlite3* database) {
+  // Innocuous functions may also be used in views, triggers and generated
+  // columns
+  int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+  for (const VectorFunction& function : kVectorFunctions) {
+    for (int arguments = 2; arguments <= 4; arguments++) {
+      if (sqlite3_create_function_v2(database, function.name, arguments, flags,
+                                     const_cast<VectorFunction*>(&function), CompareVectors,
+                                     nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return false;
+      }
+    }
+  }
+
+  return sqlite3_create_function_v2(database, "vec_top_k", 3, SQLITE_UTF8 | SQLITE_INNOCUOUS,
+                                    nullptr, nullptr, TopKStep, TopKFinal,
+                                    nullptr) == SQLITE_OK;
+}
@@ -0,0 +1,22 @@
+#ifndef VECTOR_FUNCTIONS_H_
+#define VECTOR_FUNCTIONS_H_
+
+#include <sqlite3.h>
+
+// Registers the vector SQL functions on `database`, so that any query can
+// rank rows by similarity with the same kernels as vectorSearch:
+//
+//  - vec_cosine(a, b), vec_l2(a, b) and vec_dot(a, b) return the cosine
+//    distance, Euclidean distance and dot product of two vector BLOBs.
+//    Both are read as float32 unless a third and fourth argument give their
+//    declared types, e.g. vec_cosine(embedding, ?, 'F16_BLOB'). They return
+//    NULL if either vector is NULL, or for vec_cosine a zero vector, and
+//    fail if the vectors differ in length.
+//  - vec_top_k(id, distance, k) is an aggregate returning the `k` ids with
+//    the smallest distances as a JSON array of {"id", "distance"} objects,
+//    closest first. Rows with a NULL distance are left out.
+//
+// Returns false if a function could not be registered.
+bool RegisterVectorFunctions(sqlite3* database);
+
+#endif  // VECTOR_FUNCTIONS_H_
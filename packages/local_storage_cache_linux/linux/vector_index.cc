@@ -0,0 +1,103 @@
+#include "vector_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+bool ParseVectorIndexKind(const char* name, VectorIndexKind* kind) {
+  if (strcmp(name, "hnsw") == 0) {
+    *kind = VectorIndexKind::kHnsw;
+  } else if (strcmp(name, "ivfFlat") == 0) {
+    *kind = VectorIndexKind::kIvfFlat;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* VectorIndexKindName(VectorIndexKind kind) {
+  switch (kind) {
+    case VectorIndexKind::kIvfFlat:
+      return "ivfFlat";
+    case VectorIndexKind::kHnsw:
+    default:
+      return "hnsw";
+  }
+}
+
+VectorIndex::VectorIndex(size_t dimensions, DistanceMetric metric)
+    : dimensions_(dimensions), metric_(metric), kernels_(GetVectorKernels()) {}
+
+VectorIndex::~VectorIndex() {}
+
+std::vector<VectorMatch> VectorIndex::ExactSearch(const float* query, size_t k) const {
+  std::vector<float> prepared;
+  Prepare(query, &prepared);
+
+  TopK top(k);
+  ForEach([&](int64_t rowid, const float* vector) {
+    float distance = Distance(prepared.data(), vector);
+    if (top.Accepts(distance)) {
+      top.Push(distance, rowid);
+    }
+  });
+
+  std::vector<VectorMatch> matches = top.Sorted();
+  for (VectorMatch& match : matches) {
+    match.distance = ToPublicDistance(match.distance);
+  }
+  return matches;
+}
+
+float VectorIndex::Distance(const float* a, const float* b) const {
+  switch (metric_) {
+    case DistanceMetric::kEuclidean:
+      return kernels_.squared_l2(a, b, dimensions_);
+    case DistanceMetric::kDotProduct:
+      return -kernels_.dot(a, b, dimensions_);
+    case DistanceMetric::kCosine:
+    default:
+      return 1.0f - kernels_.dot(a, b, dimensions_);
+  }
+}
+
+float VectorIndex::ToPublicDistance(float distance) const {
+  return metric_ == DistanceMetric::kEuclidean ? std::sqrt(distance) : distance;
+}
+
+void VectorIndex::Prepare(const float* vector, std::vector<float>* out) const {
+  out->assign(vector, vector + dimensions_);
+  if (metric_ != DistanceMetric::kCosine) {
+    return;
+  }
+
+  // A zero vector stays zero, 1 away from everything like VectorDistance()
+  float norm = std::sqrt(kernels_.dot(out->data(), out->data(), dimensions_));
+  if (norm > 0) {
+    for (float& element : *out) {
+      element /= norm;
+    }
+  }
+}
+
+void ParallelFor(size_t count,
+                 size_t min_items_per_thread,
+                 const std::function<void(size_t begin, size_t end)>& body) {
+  size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  threads = std::min(threads, (count + min_items_per_thread - 1) / min_items_per_thread);
+  if (threads <= 1) {
+    body(0, count);
+    return;
+  }
+
+  size_t chunk = (count + threads - 1) / threads;
+  std::vector<std::thread> workers;
+  for (size_t begin = chunk; begin < count; begin += chunk) {
+    workers.emplace_back(body, begin, std::min(count, begin + chunk));
+  }
+  body(0, chunk);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
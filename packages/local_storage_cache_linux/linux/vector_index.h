@@ -0,0 +1,97 @@
+#ifndef VECTOR_INDEX_H_
+#define VECTOR_INDEX_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "vector_kernels.h"
+#include "vector_search.h"
+
+// Kinds of VectorIndexType with a native implementation.
+enum class VectorIndexKind {
+  kHnsw,
+  kIvfFlat,
+};
+
+// Parses a VectorIndexType name ("hnsw", "ivfFlat").
+bool ParseVectorIndexKind(const char* name, VectorIndexKind* kind);
+
+const char* VectorIndexKindName(VectorIndexKind kind);
+
+// An in-memory approximate nearest neighbour index over single-precision
+// vectors, keyed by rowid.
+//
+// Vectors are stored prepared: normalized for cosine, so distances reduce to
+// a dot product. Internal distances are monotonic in the public ones of
+// VectorDistance() (squared for euclidean) and only converted on output.
+//
+// Not thread-safe; VectorIndexManager serializes writers against searches.
+class VectorIndex {
+ public:
+  VectorIndex(size_t dimensions, DistanceMetric metric);
+  virtual ~VectorIndex();
+
+  // Disallow copy and assign.
+  VectorIndex(const VectorIndex&) = delete;
+  VectorIndex& operator=(const VectorIndex&) = delete;
+
+  // Adds the vector of `rowid`, replacing any previous one.
+  virtual void Upsert(int64_t rowid, const float* vector) = 0;
+
+  // Returns false if `rowid` is not indexed.
+  virtual bool Remove(int64_t rowid) = 0;
+
+  // Approximate `k` nearest neighbours, closest first. `breadth` is how much
+  // of the index to explore (efSearch for HNSW, nprobe for IVF); 0 uses the
+  // index default. Distances are on the same scale as VectorDistance().
+  virtual std::vector<VectorMatch> Search(const float* query,
+                                          size_t k,
+                                          size_t breadth) const = 0;
+
+  // Calls `visit` with every indexed vector, as stored.
+  virtual void ForEach(
+      const std::function<void(int64_t rowid, const float* vector)>& visit) const = 0;
+
+  virtual size_t size() const = 0;
+
+  virtual bool Save(FILE* file) const = 0;
+
+  // Exact `k` nearest neighbours by brute force over the indexed vectors,
+  // as ground truth for benchmarks.
+  std::vector<VectorMatch> ExactSearch(const float* query, size_t k) const;
+
+  size_t dimensions() const { return dimensions_; }
+  DistanceMetric metric() const { return metric_; }
+
+ protected:
+  float Distance(const float* a, const float* b) const;
+  float ToPublicDistance(float distance) const;
+
+  // Copies `vector` into `out`, normalized for cosine
+  void Prepare(const float* vector, std::vector<float>* out) const;
+
+  size_t dimensions_;
+  DistanceMetric metric_;
+  const VectorKernels& kernels_;
+};
+
+// Runs `body` over [0, count) split into ranges across threads, giving each
+// thread at least `min_items_per_thread` items.
+void ParallelFor(size_t count,
+                 size_t min_items_per_thread,
+                 const std::function<void(size_t begin, size_t end)>& body);
+
+// Stream helpers for the side files of the indexes.
+template <typename T>
+bool WriteValue(FILE* file, const T& value) {
+  return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+template <typename T>
+bool ReadValue(FILE* file, T* value) {
+  return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+#endif  // VECTOR_INDEX_H_
@@ -0,0 +1,804 @@
+#include "vector_index_manager.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <unordered_set>
+
+#include "sql_util.h"
+#include "vector_codec.h"
+
+namespace {
+
+const char kCreateTableSql[] =
+    "CREATE TABLE IF NOT EXISTS _vector_indexes ("
+    "name TEXT PRIMARY KEY, "
+    "table_name TEXT NOT NULL, "
+    "column_name TEXT NOT NULL, "
+    "dimensions INTEGER NOT NULL, "
+    "metric TEXT NOT NULL, "
+    "m INTEGER NOT NULL, "
+    "ef_construction INTEGER NOT NULL, "
+    "ef_search INTEGER NOT NULL, "
+    "generation INTEGER NOT NULL DEFAULT 0, "
+    "index_type TEXT NOT NULL DEFAULT 'hnsw', "
+    "nlist INTEGER NOT NULL DEFAULT 0, "
+    "nprobe INTEGER NOT NULL DEFAULT 0, "
+    "quantization TEXT NOT NULL DEFAULT 'none', "
+    "pq_subvectors INTEGER NOT NULL DEFAULT 0, "
+    "rerank INTEGER NOT NULL DEFAULT 4)";
+
+// Index names become part of a file name
+bool IsValidIndexName(const std::string& name) {
+  if (name.empty()) {
+    return false;
+  }
+  for (char c : name) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsInMemoryPath(const std::string& path) {
+  return path.empty() || path == ":memory:";
+}
+
+bool ReadPositiveInt(FlValue* args, const char* key, size_t* value, std::string* error) {
+  FlValue* entry = fl_value_lookup_string(args, key);
+  if (entry == nullptr || fl_value_get_type(entry) == FL_VALUE_TYPE_NULL) {
+    return true;
+  }
+  if (fl_value_get_type(entry) != FL_VALUE_TYPE_INT || fl_value_get_int(entry) <= 0) {
+    *error = std::string(key) + " must be a positive integer";
+    return false;
+  }
+  *value = static_cast<size_t>(fl_value_get_int(entry));
+  return true;
+}
+
+VectorIndexDefinition ClampDefinition(const VectorIndexDefinition& definition) {
+  VectorIndexDefinition clamped = definition;
+  clamped.hnsw = HnswIndex::ClampParams(clamped.hnsw);
+  clamped.ivf = IvfFlatIndex::ClampParams(clamped.ivf);
+  return clamped;
+}
+
+bool SameDefinition(const VectorIndexDefinition& a, const VectorIndexDefinition& b) {
+  if (a.table_name != b.table_name || a.column != b.column || a.dimensions != b.dimensions ||
+      a.metric != b.metric || a.kind != b.kind) {
+    return false;
+  }
+  if (a.kind == VectorIndexKind::kIvfFlat) {
+    return a.ivf.nlist == b.ivf.nlist && a.ivf.nprobe == b.ivf.nprobe &&
+           a.ivf.quantization == b.ivf.quantization &&
+           a.ivf.pq_subvectors == b.ivf.pq_subvectors && a.ivf.rerank == b.ivf.rerank;
+  }
+  return a.hnsw.m == b.hnsw.m && a.hnsw.ef_construction == b.hnsw.ef_construction &&
+         a.hnsw.ef_search == b.hnsw.ef_search;
+}
+
+std::unique_ptr<VectorIndex> NewIndex(const VectorIndexDefinition& definition) {
+  if (definition.kind == VectorIndexKind::kIvfFlat) {
+    return std::unique_ptr<VectorIndex>(
+        new IvfFlatIndex(definition.dimensions, definition.metric, definition.ivf));
+  }
+  return std::unique_ptr<VectorIndex>(
+      new HnswIndex(definition.dimensions, definition.metric, definition.hnsw));
+}
+
+// Loads an index saved by VectorIndex::Save(). Returns nullptr unless it is
+// valid and was built with `definition`.
+std::unique_ptr<VectorIndex> LoadIndex(const VectorIndexDefinition& definition, FILE* file) {
+  std::unique_ptr<VectorIndex> index;
+  if (definition.kind == VectorIndexKind::kIvfFlat) {
+    std::unique_ptr<IvfFlatIndex> ivf = IvfFlatIndex::Load(file);
+    if (ivf != nullptr && ivf->params().nlist == definition.ivf.nlist &&
+        ivf->params().quantization == definition.ivf.quantization &&
+        (definition.ivf.pq_subvectors == 0 ||
+         ivf->params().pq_subvectors == definition.ivf.pq_subvectors)) {
+      index = std::move(ivf);
+    }
+  } else {
+    std::unique_ptr<HnswIndex> hnsw = HnswIndex::Load(file);
+    if (hnsw != nullptr && hnsw->params().m == definition.hnsw.m &&
+        hnsw->params().ef_construction == definition.hnsw.ef_construction) {
+      index = std::move(hnsw);
+    }
+  }
+
+  if (index == nullptr || index->dimensions() != definition.dimensions ||
+      index->metric() != definition.metric) {
+    return nullptr;
+  }
+  return index;
+}
+
+bool TableExists(sqlite3* database, const char* table_name) {
+  sqlite3_stmt* statement = nullptr;
+  sqlite3_prepare_v2(database,
+                     "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?", -1,
+                     &statement, nullptr);
+  sqlite3_bind_text(statement, 1, table_name, -1, SQLITE_STATIC);
+  bool exists = sqlite3_step(statement) == SQLITE_ROW;
+  sqlite3_finalize(statement);
+  return exists;
+}
+
+// Reads vectors of `definition.dimensions` elements from column 1 of
+// `statement` (column 0 being the rowid), in the column's declared precision
+class VectorReader {
+ public:
+  VectorReader(sqlite3_stmt* statement, int column, size_t dimensions)
+      : column_(column), scratch_(dimensions) {
+    ParseVectorType(sqlite3_column_decltype(statement, column), &type_);
+  }
+
+  // Returns nullptr if the row holds no vector of the right length
+  const float* Read(sqlite3_stmt* statement) {
+    const void* blob = sqlite3_column_blob(statement, column_);
+    if (blob == nullptr || static_cast<size_t>(sqlite3_column_bytes(statement, column_)) !=
+                               VectorBlobSize(type_, scratch_.size())) {
+      return nullptr;
+    }
+    return DecodeVector(blob, type_, &scratch_);
+  }
+
+ private:
+  int column_;
+  // Plain BLOB columns are read as float32, the layout Float32List binds as
+  VectorElementType type_ = VectorElementType::kFloat32;
+  std::vector<float> scratch_;
+};
+
+}  // namespace
+
+bool ParseVectorIndexDefinition(FlValue* args,
+                                VectorIndexDefinition* definition,
+                                std::string* error) {
+  FlValue* name = fl_value_lookup_string(args, "indexName");
+  FlValue* table_name = fl_value_lookup_string(args, "tableName");
+  FlValue* column = fl_value_lookup_string(args, "column");
+  if (name == nullptr || table_name == nullptr || column == nullptr ||
+      fl_value_get_type(name) != FL_VALUE_TYPE_STRING ||
+      fl_value_get_type(table_name) != FL_VALUE_TYPE_STRING ||
+      fl_value_get_type(column) != FL_VALUE_TYPE_STRING) {
+    *error = "indexName, tableName and column are required";
+    return false;
+  }
+  definition->name = fl_value_get_string(name);
+  definition->table_name = fl_value_get_string(table_name);
+  definition->column = fl_value_get_string(column);
+  if (!IsValidIndexName(definition->name)) {
+    *error = "indexName may only contain letters, digits and underscores";
+    return false;
+  }
+
+  FlValue* kind = fl_value_lookup_string(args, "indexType");
+  if (kind != nullptr && fl_value_get_type(kind) == FL_VALUE_TYPE_STRING &&
+      !ParseVectorIndexKind(fl_value_get_string(kind), &definition->kind)) {
+    *error = std::string("Unsupported vector index type: ") + fl_value_get_string(kind);
+    return false;
+  }
+
+  FlValue* metric = fl_value_lookup_string(args, "metric");
+  if (metric != nullptr && fl_value_get_type(metric) == FL_VALUE_TYPE_STRING &&
+      !ParseDistanceMetric(fl_value_get_string(metric), &definition->metric)) {
+    *error = std::string("Unknown distance metric: ") + fl_value_get_string(metric);
+    return false;
+  }
+
+  FlValue* quantization = fl_value_lookup_string(args, "quantization");
+  if (quantization != nullptr && fl_value_get_type(quantization) == FL_VALUE_TYPE_STRING &&
+      !ParseVectorQuantization(fl_value_get_string(quantization),
+                               &definition->ivf.quantization)) {
+    *error = std::string("Unsupported quantization: ") + fl_value_get_string(quantization);
+    return false;
+  }
+
+  return ReadPositiveInt(args, "dimensions", &definition->dimensions, error) &&
+         ReadPositiveInt(args, "m", &definition->hnsw.m, error) &&
+         ReadPositiveInt(args, "efConstruction", &definition->hnsw.ef_construction, error) &&
+         ReadPositiveInt(args, "efSearch", &definition->hnsw.ef_search, error) &&
+         ReadPositiveInt(args, "nlist", &definition->ivf.nlist, error) &&
+         ReadPositiveInt(args, "nprobe", &definition->ivf.nprobe, error) &&
+         ReadPositiveInt(args, "pqSubvectors", &definition->ivf.pq_subvectors, error) &&
+         ReadPositiveInt(args, "rerank", &definition->ivf.rerank, error);
+}
+
+VectorIndexManager::VectorIndexManager(sqlite3* database, const std::string& database_path)
+    : database_(database),
+      database_path_(IsInMemoryPath(database_path) ? "" : database_path) {}
+
+VectorIndexManager::~VectorIndexManager() {
+  for (auto& it : entries_) {
+    JoinTrainer(it.second.get());
+  }
+}
+
+void VectorIndexManager::Load() {
+  if (!TableExists(database_, "_vector_indexes")) {
+    return;
+  }
+
+  std::vector<std::pair<VectorIndexDefinition, int64_t>> recorded;
+  sqlite3_stmt* statement = nullptr;
+  sqlite3_prepare_v2(database_,
+                     "SELECT name, table_name, column_name, dimensions, metric, m, "
+                     "ef_construction, ef_search, generation, index_type, nlist, nprobe, "
+                     "quantization, pq_subvectors, rerank FROM _vector_indexes",
+                     -1, &statement, nullptr);
+  while (sqlite3_step(statement) == SQLITE_ROW) {
+    VectorIndexDefinition definition;
+    definition.name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    definition.table_name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
+    definition.column = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
+    definition.dimensions = static_cast<size_t>(sqlite3_column_int64(statement, 3));
+    ParseDistanceMetric(reinterpret_cast<const char*>(sqlite3_column_text(statement, 4)),
+                        &definition.metric);
+    definition.hnsw.m = static_cast<size_t>(sqlite3_column_int64(statement, 5));
+    definition.hnsw.ef_construction = static_cast<size_t>(sqlite3_column_int64(statement, 6));
+    definition.hnsw.ef_search = static_cast<size_t>(sqlite3_column_int64(statement, 7));
+    if (!ParseVectorIndexKind(reinterpret_cast<const char*>(sqlite3_column_text(statement, 9)),
+                              &definition.kind)) {
+      continue;
+    }
+    definition.ivf.nlist = static_cast<size_t>(sqlite3_column_int64(statement, 10));
+    definition.ivf.nprobe = static_cast<size_t>(sqlite3_column_int64(statement, 11));
+    if (!ParseVectorQuantization(
+            reinterpret_cast<const char*>(sqlite3_column_text(statement, 12)),
+            &definition.ivf.quantization)) {
+      continue;
+    }
+    definition.ivf.pq_subvectors = static_cast<size_t>(sqlite3_column_int64(statement, 13));
+    definition.ivf.rerank = static_cast<size_t>(sqlite3_column_int64(statement, 14));
+    recorded.emplace_back(ClampDefinition(definition), sqlite3_column_int64(statement, 8));
+  }
+  sqlite3_finalize(statement);
+
+  for (auto& record : recorded) {
+    auto entry = std::make_shared<Entry>();
+    entry->definition = record.first;
+
+    std::string error;
+    if (!ReadSideFile(entry.get(), record.second)) {
+      if (!Build(entry.get(), &error)) {
+        continue;
+      }
+      entry->dirty = true;
+    }
+
+    // Recorded as open until saved
+    entry->generation = record.second + 1;
+    RecordGeneration(entry->definition.name, entry->generation);
+
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    entries_[entry->definition.name] = entry;
+  }
+}
+
+void VectorIndexManager::Save() {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  for (auto& it : entries_) {
+    Entry* entry = it.second.get();
+    JoinTrainer(entry);
+    if (database_path_.empty()) {
+      continue;
+    }
+
+    // An unchanged index keeps its side file; only the record moves back
+    if (!entry->dirty && entry->file_generation >= 0) {
+      if (RecordGeneration(entry->definition.name, entry->file_generation)) {
+        entry->generation = entry->file_generation;
+      }
+      continue;
+    }
+
+    std::shared_lock<std::shared_timed_mutex> index_lock(entry->mutex);
+    if (WriteSideFile(*entry)) {
+      entry->file_generation = entry->generation;
+      entry->dirty = false;
+    }
+  }
+}
+
+bool VectorIndexManager::Create(const VectorIndexDefinition& definition, std::string* error) {
+  std::shared_ptr<Entry> existing = Find(definition.name);
+  if (existing != nullptr) {
+    VectorIndexDefinition requested = ClampDefinition(definition);
+    if (requested.dimensions == 0) {
+      requested.dimensions = existing->definition.dimensions;
+    }
+    if (SameDefinition(existing->definition, requested)) {
+      return true;
+    }
+  }
+
+  auto entry = std::make_shared<Entry>();
+  entry->definition = ClampDefinition(definition);
+  if (!Build(entry.get(), error)) {
+    return false;
+  }
+
+  if (sqlite3_exec(database_, kCreateTableSql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database_);
+    return false;
+  }
+
+  // A side file left by a replaced index may carry the generation recorded
+  // below, and would be loaded as this index after a crash
+  if (!database_path_.empty()) {
+    unlink(SideFilePath(definition.name, VectorIndexKind::kHnsw).c_str());
+    unlink(SideFilePath(definition.name, VectorIndexKind::kIvfFlat).c_str());
+  }
+
+  sqlite3_stmt* statement = nullptr;
+  sqlite3_prepare_v2(database_,
+                     "INSERT OR REPLACE INTO _vector_indexes (name, table_name, column_name, "
+                     "dimensions, metric, m, ef_construction, ef_search, generation, "
+                     "index_type, nlist, nprobe, quantization, pq_subvectors, rerank) "
+                     "VALUES (?, ?, ?, ?, ?, ?, ?, ?, 1, ?, ?, ?, ?, ?, ?)",
+                     -1, &statement, nullptr);
+  const VectorIndexDefinition& built = entry->definition;
+  sqlite3_bind_text(statement, 1, built.name.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(statement, 2, built.table_name.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(statement, 3, built.column.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_int64(statement, 4, static_cast<int64_t>(built.dimensions));
+  sqlite3_bind_text(statement, 5, DistanceMetricName(built.metric), -1, SQLITE_STATIC);
+  sqlite3_bind_int64(statement, 6, static_cast<int64_t>(built.hnsw.m));
+  sqlite3_bind_int64(statement, 7, static_cast<int64_t>(built.hnsw.ef_construction));
+  sqlite3_bind_int64(statement, 8, static_cast<int64_t>(built.hnsw.ef_search));
+  sqlite3_bind_text(statement, 9, VectorIndexKindName(built.kind), -1, SQLITE_STATIC);
+  sqlite3_bind_int64(statement, 10, static_cast<int64_t>(built.ivf.nlist));
+  sqlite3_bind_int64(statement, 11, static_cast<int64_t>(built.ivf.nprobe));
+  sqlite3_bind_text(statement, 12, VectorQuantizationName(built.ivf.quantization), -1,
+                    SQLITE_STATIC);
+  sqlite3_bind_int64(statement, 13, static_cast<int64_t>(built.ivf.pq_subvectors));
+  sqlite3_bind_int64(statement, 14, static_cast<int64_t>(built.ivf.rerank));
+  bool recorded = sqlite3_step(statement) == SQLITE_DONE;
+  sqlite3_finalize(statement);
+  if (!recorded) {
+    *error = sqlite3_errmsg(database_);
+    return false;
+  }
+
+  // Open and unsaved
+  entry->generation = 1;
+  entry->dirty = true;
+
+  if (existing != nullptr) {
+    JoinTrainer(existing.get());
+  }
+
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  entries_[built.name] = entry;
+  return true;
+}
+
+bool VectorIndexManager::Drop(const std::string& name, std::string* error) {
+  if (TableExists(database_, "_vector_indexes")) {
+    sqlite3_stmt* statement = nullptr;
+    sqlite3_prepare_v2(database_, "DELETE FROM _vector_indexes WHERE name = ?", -1, &statement,
+                       nullptr);
+    sqlite3_bind_text(statement, 1, name.c_str(), -1, SQLITE_STATIC);
+    bool deleted = sqlite3_step(statement) == SQLITE_DONE;
+    sqlite3_finalize(statement);
+    if (!deleted) {
+      *error = sqlite3_errmsg(database_);
+      return false;
+    }
+  }
+
+  std::shared_ptr<Entry> entry = Find(name);
+  if (entry != nullptr) {
+    JoinTrainer(entry.get());
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    entries_.erase(name);
+  }
+  if (!database_path_.empty() && IsValidIndexName(name)) {
+    unlink(SideFilePath(name, VectorIndexKind::kHnsw).c_str());
+    unlink(SideFilePath(name, VectorIndexKind::kIvfFlat).c_str());
+  }
+  return true;
+}
+
+void VectorIndexManager::ApplyChanges(const std::vector<RowChange>& changes) {
+  std::vector<std::shared_ptr<Entry>> entries;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    for (auto& it : entries_) {
+      entries.push_back(it.second);
+    }
+  }
+
+  for (auto& entry : entries) {
+    const VectorIndexDefinition& definition = entry->definition;
+    std::unordered_set<int64_t> rowids;
+    for (const RowChange& change : changes) {
+      if (change.table_name == definition.table_name) {
+        rowids.insert(change.rowid);
+      }
+    }
+    if (rowids.empty()) {
+      continue;
+    }
+
+    // The change only says which rows moved; their current vector decides
+    std::string sql = "SELECT rowid, " + QuoteIdentifier(definition.column) + " FROM " +
+                      QuoteIdentifier(definition.table_name) + " WHERE rowid = ?";
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+      sqlite3_finalize(statement);
+      continue;
+    }
+
+    VectorReader reader(statement, 1, definition.dimensions);
+    std::unique_lock<std::shared_timed_mutex> lock(entry->mutex);
+    for (int64_t rowid : rowids) {
+      sqlite3_bind_int64(statement, 1, rowid);
+      const float* vector =
+          sqlite3_step(statement) == SQLITE_ROW ? reader.Read(statement) : nullptr;
+      if (vector != nullptr) {
+        entry->index->Upsert(rowid, vector);
+      } else {
+        entry->index->Remove(rowid);
+      }
+      if (entry->training) {
+        entry->written_while_training.insert(rowid);
+      }
+      sqlite3_reset(statement);
+    }
+    sqlite3_finalize(statement);
+    entry->dirty = true;
+
+    if (definition.kind == VectorIndexKind::kIvfFlat) {
+      MaybeStartTraining(entry.get());
+    }
+  }
+}
+
+bool VectorIndexManager::Search(sqlite3* database,
+                                const VectorSearchRequest& request,
+                                std::vector<VectorMatch>* matches,
+                                std::string* error) const {
+  if (request.exact || !request.filter.empty()) {
+    return false;
+  }
+
+  std::shared_ptr<Entry> match;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    for (auto& it : entries_) {
+      const VectorIndexDefinition& definition = it.second->definition;
+      if (definition.table_name == request.table_name && definition.column == request.column &&
+          definition.metric == request.metric &&
+          definition.dimensions == request.query.size()) {
+        match = it.second;
+        break;
+      }
+    }
+  }
+  if (match == nullptr) {
+    return false;
+  }
+
+  size_t breadth = match->definition.kind == VectorIndexKind::kIvfFlat ? request.nprobe
+                                                                      : request.ef_search;
+  SearchEntry(*match, database, request, breadth, matches, error);
+  return true;
+}
+
+bool VectorIndexManager::SearchEntry(const Entry& entry,
+                                     sqlite3* database,
+                                     const VectorSearchRequest& request,
+                                     size_t breadth,
+                                     std::vector<VectorMatch>* matches,
+                                     std::string* error) {
+  std::vector<VectorMatch> candidates;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(entry.mutex);
+    const auto* ivf = entry.definition.kind == VectorIndexKind::kIvfFlat
+        ? static_cast<const IvfFlatIndex*>(entry.index.get())
+        : nullptr;
+    if (ivf == nullptr || !ivf->compressed()) {
+      *matches = entry.index->Search(request.query.data(), request.k, breadth);
+      return true;
+    }
+    candidates = ivf->Search(request.query.data(), request.k * ivf->params().rerank, breadth);
+  }
+
+  // Compressed distances only shortlist; the stored vectors decide
+  return RerankVectors(database, request, candidates, matches, error);
+}
+
+FlValue* VectorIndexManager::Benchmark(sqlite3* database,
+                                       const std::string& name,
+                                       size_t queries,
+                                       size_t k,
+                                       const std::vector<size_t>& ef_values,
+                                       const std::vector<size_t>& nprobe_values,
+                                       std::string* error) const {
+  std::shared_ptr<Entry> entry = Find(name);
+  if (entry == nullptr) {
+    *error = "No vector index named " + name;
+    return nullptr;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto micros = [](Clock::duration elapsed) {
+    return std::chrono::duration<double, std::micro>(elapsed).count();
+  };
+
+  bool ivf = entry->definition.kind == VectorIndexKind::kIvfFlat;
+  const std::vector<size_t>& breadths = ivf ? nprobe_values : ef_values;
+
+  // Reservoir sample of stored vectors, reproducible across runs
+  size_t dimensions = entry->definition.dimensions;
+  size_t size = 0;
+  std::vector<float> samples;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(entry->mutex);
+    size = entry->index->size();
+    size_t seen = 0;
+    std::mt19937_64 generator(42);
+    entry->index->ForEach([&](int64_t rowid, const float* vector) {
+      size_t slot = seen < queries ? seen : generator() % (seen + 1);
+      if (slot < queries) {
+        if (seen < queries) {
+          samples.insert(samples.end(), vector, vector + dimensions);
+        } else {
+          std::copy(vector, vector + dimensions, samples.begin() + slot * dimensions);
+        }
+      }
+      seen++;
+    });
+  }
+  size_t count = samples.size() / dimensions;
+
+  // Ground truth is a scan of the table, so compressed indexes are measured
+  // against the vectors they approximate
+  std::vector<VectorSearchRequest> requests(count);
+  std::vector<std::unordered_set<int64_t>> truth(count);
+  Clock::duration exact_time = Clock::duration::zero();
+  for (size_t q = 0; q < count; q++) {
+    VectorSearchRequest& request = requests[q];
+    request.table_name = entry->definition.table_name;
+    request.column = entry->definition.column;
+    request.metric = entry->definition.metric;
+    request.k = k;
+    request.query.assign(&samples[q * dimensions], &samples[(q + 1) * dimensions]);
+    request.query_norm = std::sqrt(GetVectorKernels().dot(request.query.data(),
+                                                          request.query.data(), dimensions));
+
+    Clock::time_point start = Clock::now();
+    TopK top(k);
+    if (!ScanVectors(database, request, INT64_MIN, INT64_MAX, &top, error)) {
+      return nullptr;
+    }
+    exact_time += Clock::now() - start;
+    for (const VectorMatch& match : top.Sorted()) {
+      truth[q].insert(match.rowid);
+    }
+  }
+
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "size", fl_value_new_int(static_cast<int64_t>(size)));
+  fl_value_set_string_take(result, "queries", fl_value_new_int(static_cast<int64_t>(count)));
+  fl_value_set_string_take(result, "exactMicros",
+                           fl_value_new_float(count ? micros(exact_time) / count : 0));
+
+  FlValue* runs = fl_value_new_list();
+  for (size_t breadth : breadths) {
+    std::vector<double> latencies;
+    size_t found = 0;
+    size_t expected = 0;
+    for (size_t q = 0; q < count; q++) {
+      Clock::time_point start = Clock::now();
+      std::vector<VectorMatch> approximate;
+      if (!SearchEntry(*entry, database, requests[q], breadth, &approximate, error)) {
+        fl_value_unref(result);
+        return nullptr;
+      }
+      latencies.push_back(micros(Clock::now() - start));
+
+      for (const VectorMatch& match : approximate) {
+        found += truth[q].count(match.rowid);
+      }
+      expected += truth[q].size();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double latency : latencies) {
+      total += latency;
+    }
+
+    FlValue* run = fl_value_new_map();
+    fl_value_set_string_take(run, ivf ? "nprobe" : "efSearch",
+                             fl_value_new_int(static_cast<int64_t>(breadth)));
+    fl_value_set_string_take(run, "recall",
+                             fl_value_new_float(expected ? double(found) / expected : 1.0));
+    fl_value_set_string_take(run, "meanMicros",
+                             fl_value_new_float(count ? total / count : 0));
+    fl_value_set_string_take(
+        run, "p99Micros",
+        fl_value_new_float(count ? latencies[std::min(count - 1, count * 99 / 100)] : 0));
+    fl_value_append_take(runs, run);
+  }
+  fl_value_set_string_take(result, "runs", runs);
+  return result;
+}
+
+std::shared_ptr<VectorIndexManager::Entry> VectorIndexManager::Find(
+    const std::string& name) const {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  auto it = entries_.find(name);
+  return it == entries_.end() ? nullptr : it->second;
+}
+
+bool VectorIndexManager::Build(Entry* entry, std::string* error) {
+  VectorIndexDefinition& definition = entry->definition;
+  std::string sql = "SELECT rowid, " + QuoteIdentifier(definition.column) + " FROM " +
+                    QuoteIdentifier(definition.table_name);
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database_, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database_);
+    sqlite3_finalize(statement);
+    return false;
+  }
+
+  VectorElementType type = VectorElementType::kFloat32;
+  ParseVectorType(sqlite3_column_decltype(statement, 1), &type);
+
+  std::unique_ptr<VectorReader> reader;
+  int result;
+  while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
+    if (reader == nullptr) {
+      if (definition.dimensions == 0) {
+        if (sqlite3_column_type(statement, 1) != SQLITE_BLOB ||
+            !VectorBlobDimensions(type, static_cast<size_t>(sqlite3_column_bytes(statement, 1)),
+                                  &definition.dimensions)) {
+          continue;
+        }
+      }
+      reader.reset(new VectorReader(statement, 1, definition.dimensions));
+      entry->index = NewIndex(definition);
+    }
+
+    const float* vector = reader->Read(statement);
+    if (vector != nullptr) {
+      entry->index->Upsert(sqlite3_column_int64(statement, 0), vector);
+    }
+  }
+
+  if (result != SQLITE_DONE) {
+    *error = sqlite3_errmsg(database_);
+    sqlite3_finalize(statement);
+    return false;
+  }
+  sqlite3_finalize(statement);
+
+  if (definition.dimensions == 0) {
+    *error = "dimensions is required while " + definition.table_name + " has no vectors";
+    return false;
+  }
+  if (entry->index == nullptr) {
+    entry->index = NewIndex(definition);
+  }
+
+  // Cheap to fill, so IVF-Flat trains once with every vector at hand
+  if (definition.kind == VectorIndexKind::kIvfFlat) {
+    static_cast<IvfFlatIndex*>(entry->index.get())->Train();
+  }
+  return true;
+}
+
+void VectorIndexManager::MaybeStartTraining(Entry* entry) {
+  auto* index = static_cast<IvfFlatIndex*>(entry->index.get());
+  if (entry->training || !index->NeedsTraining()) {
+    return;
+  }
+
+  // The previous run has installed its index and is only winding down
+  if (entry->trainer.joinable()) {
+    entry->trainer.join();
+  }
+  entry->training = true;
+  std::unique_ptr<IvfFlatIndex> copy = index->Clone();
+  entry->trainer = std::thread(&VectorIndexManager::Train, entry, std::move(copy));
+}
+
+void VectorIndexManager::Train(Entry* entry, std::unique_ptr<IvfFlatIndex> index) {
+  index->Train();
+
+  std::unique_lock<std::shared_timed_mutex> lock(entry->mutex);
+  const auto& live = static_cast<const IvfFlatIndex&>(*entry->index);
+  std::vector<float> vector;
+  for (int64_t rowid : entry->written_while_training) {
+    if (live.Find(rowid, &vector)) {
+      index->Upsert(rowid, vector.data());
+    } else {
+      index->Remove(rowid);
+    }
+  }
+  entry->written_while_training.clear();
+  entry->index = std::move(index);
+  entry->training = false;
+  entry->dirty = true;
+}
+
+void VectorIndexManager::JoinTrainer(Entry* entry) {
+  if (entry->trainer.joinable()) {
+    entry->trainer.join();
+  }
+}
+
+bool VectorIndexManager::ReadSideFile(Entry* entry, int64_t generation) {
+  if (database_path_.empty()) {
+    return false;
+  }
+
+  FILE* file = fopen(SideFilePath(entry->definition.name, entry->definition.kind).c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  int64_t file_generation = -1;
+  std::unique_ptr<VectorIndex> index;
+  if (fread(&file_generation, sizeof(file_generation), 1, file) == 1 &&
+      file_generation == generation) {
+    index = LoadIndex(entry->definition, file);
+  }
+  fclose(file);
+
+  if (index == nullptr) {
+    return false;
+  }
+
+  entry->index = std::move(index);
+  entry->file_generation = generation;
+  return true;
+}
+
+bool VectorIndexManager::WriteSideFile(const Entry& entry) {
+  // Written aside and renamed over, so a crash never leaves half a file
+  std::string path = SideFilePath(entry.definition.name, entry.definition.kind);
+  std::string temp_path = path + ".tmp";
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  bool written = fwrite(&entry.generation, sizeof(entry.generation), 1, file) == 1 &&
+                 entry.index->Save(file);
+  written = fclose(file) == 0 && written;
+  if (!written || rename(temp_path.c_str(), path.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool VectorIndexManager::RecordGeneration(const std::string& name, int64_t generation) {
+  sqlite3_stmt* statement = nullptr;
+  sqlite3_prepare_v2(database_, "UPDATE _vector_indexes SET generation = ? WHERE name = ?", -1,
+                     &statement, nullptr);
+  sqlite3_bind_int64(statement, 1, generation);
+  sqlite3_bind_text(statement, 2, name.c_str(), -1, SQLITE_STATIC);
+  bool updated = sqlite3_step(statement) == SQLITE_DONE;
+  sqlite3_finalize(statement);
+  return updated;
+}
+
+std::string VectorIndexManager::SideFilePath(const std::string& name,
+                                             VectorIndexKind kind) const {
+  return database_path_ + "-" + name + (kind == VectorIndexKind::kIvfFlat ? ".ivf" : ".hnsw");
+}
@@ -0,0 +1,157 @@
+#ifndef VECTOR_INDEX_MANAGER_H_
+#define VECTOR_INDEX_MANAGER_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "change_tracker.h"
+#include "hnsw_index.h"
+#include "ivf_flat_index.h"
+#include "vector_index.h"
+#include "vector_kernels.h"
+#include "vector_search.h"
+
+// An approximate nearest neighbour index over a vector column, as recorded in
+// the _vector_indexes table.
+struct VectorIndexDefinition {
+  std::string name;
+  std::string table_name;
+  std::string column;
+  size_t dimensions = 0;  // 0 takes the length of the first vector found
+  DistanceMetric metric = DistanceMetric::kCosine;
+  VectorIndexKind kind = VectorIndexKind::kHnsw;
+  HnswParams hnsw;   // Used by kHnsw
+  IvfFlatParams ivf;  // Used by kIvfFlat
+};
+
+// Parses the createVectorIndex arguments. Returns false with `*error` set if
+// they are missing or malformed.
+bool ParseVectorIndexDefinition(FlValue* args,
+                                VectorIndexDefinition* definition,
+                                std::string* error);
+
+// The HNSW and IVF-Flat indexes of a database. Each index lives in memory and
+// is persisted next to the database in a `<database>-<name>.hnsw` or `.ivf`
+// side file; in-memory databases rebuild theirs instead.
+//
+// A side file is only trusted if its generation matches the one recorded in
+// _vector_indexes. The recorded generation is bumped while the index is open
+// and put back on a clean Save(), so a crash leaves the file stale and the
+// index is rebuilt from its table on the next Load().
+//
+// Load, Create, Drop, ApplyChanges and Save run on the writer thread. Search
+// and Benchmark may run on any thread, concurrently with each other; writers
+// hold an index exclusively only while applying changes.
+//
+// An IVF-Flat index whose data drifts away from its centroids is retrained on
+// a copy in a background thread. Rows written meanwhile are replayed into the
+// copy before it replaces the live index.
+class VectorIndexManager {
+ public:
+  // `database` is the writer connection, `database_path` its file
+  VectorIndexManager(sqlite3* database, const std::string& database_path);
+  ~VectorIndexManager();
+
+  // Disallow copy and assign.
+  VectorIndexManager(const VectorIndexManager&) = delete;
+  VectorIndexManager& operator=(const VectorIndexManager&) = delete;
+
+  // Opens every recorded index, rebuilding those whose side file is missing
+  // or stale. Indexes whose table is gone are skipped.
+  void Load();
+
+  // Waits for background training, then writes changed indexes to their
+  // side files and marks them clean.
+  void Save();
+
+  // Builds the index from its table and records it. Creating an index that
+  // already exists with the same definition does nothing; a different
+  // definition replaces it.
+  bool Create(const VectorIndexDefinition& definition, std::string* error);
+
+  bool Drop(const std::string& name, std::string* error);
+
+  // Re-reads the changed rows of indexed tables into their indexes. A
+  // ChangeTracker listener.
+  void ApplyChanges(const std::vector<RowChange>& changes);
+
+  // Answers `request` from an index over its table, column and metric.
+  // Returns false if there is none, or the request asks for an exact or
+  // filtered search, which only a scan can answer. Candidates of compressed
+  // indexes are re-ranked by reading their vectors through `database`, which
+  // may fail with `*error` set.
+  bool Search(sqlite3* database,
+              const VectorSearchRequest& request,
+              std::vector<VectorMatch>* matches,
+              std::string* error) const;
+
+  // Measures recall@k and latency of index `name` against a scan of its
+  // table through `database`, using `queries` vectors sampled from the
+  // index: at each efSearch value for HNSW, at each nprobe value for
+  // IVF-Flat.
+  FlValue* Benchmark(sqlite3* database,
+                     const std::string& name,
+                     size_t queries,
+                     size_t k,
+                     const std::vector<size_t>& ef_values,
+                     const std::vector<size_t>& nprobe_values,
+                     std::string* error) const;
+
+ private:
+  struct Entry {
+    VectorIndexDefinition definition;
+    std::unique_ptr<VectorIndex> index;
+    mutable std::shared_timed_mutex mutex;  // Guards `index` and training state
+
+    // Background training of IVF-Flat indexes
+    bool training = false;
+    std::unordered_set<int64_t> written_while_training;
+    std::thread trainer;  // Joined on the writer thread
+
+    // Writer thread only
+    int64_t generation = 0;       // Recorded in _vector_indexes
+    int64_t file_generation = -1;  // Of the side file, -1 if there is none
+    std::atomic<bool> dirty{false};  // Also set once training completes
+  };
+
+  std::shared_ptr<Entry> Find(const std::string& name) const;
+
+  // Searches the index of `entry` at `breadth`, re-ranking compressed
+  // candidates against the table
+  static bool SearchEntry(const Entry& entry,
+                          sqlite3* database,
+                          const VectorSearchRequest& request,
+                          size_t breadth,
+                          std::vector<VectorMatch>* matches,
+                          std::string* error);
+  bool Build(Entry* entry, std::string* error);
+
+  // Starts retraining the IVF-Flat index of `entry` if it needs it. Called
+  // with `entry->mutex` held exclusively.
+  void MaybeStartTraining(Entry* entry);
+  static void Train(Entry* entry, std::unique_ptr<IvfFlatIndex> index);
+  static void JoinTrainer(Entry* entry);
+
+  bool ReadSideFile(Entry* entry, int64_t generation);
+  bool WriteSideFile(const Entry& entry);
+  bool RecordGeneration(const std::string& name, int64_t generation);
+  std::string SideFilePath(const std::string& name, VectorIndexKind kind) const;
+
+  sqlite3* database_;
+  std::string database_path_;  // Empty for in-memory databases
+
+  mutable std::shared_timed_mutex mutex_;  // Guards `entries_`
+  std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+};
+
+#endif  // VECTOR_INDEX_MANAGER_H_
@@ -0,0 +1,791 @@
+#include "vector_kernels.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "vector_codec.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Portable kernels. Four accumulators keep the adds independent so the loop
+// is not bound by floating point latency.
+float DotScalar(const float* a, const float* b, size_t count) {
+  float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    sum0 += a[i] * b[i];
+    sum1 += a[i + 1] * b[i + 1];
+    sum2 += a[i + 2] * b[i + 2];
+    sum3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < count; i++) {
+    sum0 += a[i] * b[i];
+  }
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+float SquaredL2Scalar(const float* a, const float* b, size_t count) {
+  float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float d0 = a[i] - b[i];
+    float d1 = a[i + 1] - b[i + 1];
+    float d2 = a[i + 2] - b[i + 2];
+    float d3 = a[i + 3] - b[i + 3];
+    sum0 += d0 * d0;
+    sum1 += d1 * d1;
+    sum2 += d2 * d2;
+    sum3 += d3 * d3;
+  }
+  for (; i < count; i++) {
+    float d = a[i] - b[i];
+    sum0 += d * d;
+  }
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+void DotAndNormScalar(const float* a, const float* b, size_t count,
+                      float* dot, float* b_norm_squared) {
+  float dot0 = 0, dot1 = 0, norm0 = 0, norm1 = 0;
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    dot0 += a[i] * b[i];
+    dot1 += a[i + 1] * b[i + 1];
+    norm0 += b[i] * b[i];
+    norm1 += b[i + 1] * b[i + 1];
+  }
+  for (; i < count; i++) {
+    dot0 += a[i] * b[i];
+    norm0 += b[i] * b[i];
+  }
+  *dot = dot0 + dot1;
+  *b_norm_squared = norm0 + norm1;
+}
+
+float LoadHalf(const void* data, size_t index) {
+  uint16_t half;
+  memcpy(&half, static_cast<const uint8_t*>(data) + index * sizeof(half), sizeof(half));
+  return HalfToFloat(half);
+}
+
+void HalfDotAndNormScalar(const float* a, const void* b, size_t count,
+                          float* dot, float* b_norm_squared) {
+  float dot_total = 0, norm_total = 0;
+  for (size_t i = 0; i < count; i++) {
+    float element = LoadHalf(b, i);
+    dot_total += a[i] * element;
+    norm_total += element * element;
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+float HalfSquaredL2Scalar(const float* a, const void* b, size_t count) {
+  float sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    float d = a[i] - LoadHalf(b, i);
+    sum += d * d;
+  }
+  return sum;
+}
+
+void Int8DotAndNormScalar(const float* a, const int8_t* b, size_t count,
+                          float* dot, float* b_norm_squared) {
+  float dot0 = 0, dot1 = 0;
+  int32_t norm = 0;
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    dot0 += a[i] * b[i];
+    dot1 += a[i + 1] * b[i + 1];
+    norm += b[i] * b[i] + b[i + 1] * b[i + 1];
+  }
+  for (; i < count; i++) {
+    dot0 += a[i] * b[i];
+    norm += b[i] * b[i];
+  }
+  *dot = dot0 + dot1;
+  *b_norm_squared = static_cast<float>(norm);
+}
+
+float Int8SquaredL2Scalar(const float* a, const int8_t* b, float scale, size_t count) {
+  float sum0 = 0, sum1 = 0;
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    float d0 = a[i] - scale * b[i];
+    float d1 = a[i + 1] - scale * b[i + 1];
+    sum0 += d0 * d0;
+    sum1 += d1 * d1;
+  }
+  for (; i < count; i++) {
+    float d = a[i] - scale * b[i];
+    sum0 += d * d;
+  }
+  return sum0 + sum1;
+}
+
+const VectorKernels kScalarKernels = {
+    "scalar", DotScalar, SquaredL2Scalar, DotAndNormScalar,
+    HalfDotAndNormScalar, HalfSquaredL2Scalar, Int8DotAndNormScalar, Int8SquaredL2Scalar};
+
+#if defined(__x86_64__)
+
+// Compiled for AVX2 + FMA regardless of the build flags and only called after
+// the CPU has been checked, so one binary runs everywhere
+
+__attribute__((target("avx2,fma"))) float HorizontalSum(__m256 value) {
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+  return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma"))) float DotAvx2(const float* a, const float* b,
+                                                   size_t count) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+  }
+  for (; i + 8 <= count; i += 8) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+  }
+  
+  float sum = HorizontalSum(_mm256_add_ps(sum0, sum1));
+  for (; i < count; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+__attribute__((target("avx2,fma"))) float SquaredL2Avx2(const float* a, const float* b,
+                                                         size_t count) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+    sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+  }
+  for (; i + 8 <= count; i += 8) {
+    __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    sum0 = _mm256_fmadd_ps(d, d, sum0);
+  }
+  
+  float sum = HorizontalSum(_mm256_add_ps(sum0, sum1));
+  for (; i < count; i++) {
+    float d = a[i] - b[i];
+    sum += d * d;
+  }
+  return sum;
+}
+
+__attribute__((target("avx2,fma"))) void DotAndNormAvx2(const float* a, const float* b,
+                                                         size_t count, float* dot,
+                                                         float* b_norm_squared) {
+  __m256 dot_sum = _mm256_setzero_ps();
+  __m256 norm_sum = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 vb = _mm256_loadu_ps(b + i);
+    dot_sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), vb, dot_sum);
+    norm_sum = _mm256_fmadd_ps(vb, vb, norm_sum);
+  }
+  
+  float dot_total = HorizontalSum(dot_sum);
+  float norm_total = HorizontalSum(norm_sum);
+  for (; i < count; i++) {
+    dot_total += a[i] * b[i];
+    norm_total += b[i] * b[i];
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+// Half-precision loads need F16C, which every AVX2 CPU has
+
+__attribute__((target("avx2,fma,f16c"))) __m256 LoadHalfsAvx2(const void* data, size_t index) {
+  return _mm256_cvtph_ps(_mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(static_cast<const uint8_t*>(data) + index * 2)));
+}
+
+__attribute__((target("avx2,fma"))) __m256 LoadInt8sAvx2(const int8_t* data) {
+  return _mm256_cvtepi32_ps(
+      _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data))));
+}
+
+__attribute__((target("avx2,fma,f16c"))) void HalfDotAndNormAvx2(const float* a, const void* b,
+                                                                 size_t count, float* dot,
+                                                                 float* b_norm_squared) {
+  __m256 dot_sum = _mm256_setzero_ps();
+  __m256 norm_sum = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 vb = LoadHalfsAvx2(b, i);
+    dot_sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), vb, dot_sum);
+    norm_sum = _mm256_fmadd_ps(vb, vb, norm_sum);
+  }
+  
+  float dot_total = HorizontalSum(dot_sum);
+  float norm_total = HorizontalSum(norm_sum);
+  for (; i < count; i++) {
+    float element = LoadHalf(b, i);
+    dot_total += a[i] * element;
+    norm_total += element * element;
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+__attribute__((target("avx2,fma,f16c"))) float HalfSquaredL2Avx2(const float* a, const void* b,
+                                                                 size_t count) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), LoadHalfsAvx2(b, i));
+    __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), LoadHalfsAvx2(b, i + 8));
+    sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+    sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+  }
+  for (; i + 8 <= count; i += 8) {
+    __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), LoadHalfsAvx2(b, i));
+    sum0 = _mm256_fmadd_ps(d, d, sum0);
+  }
+  
+  float sum = HorizontalSum(_mm256_add_ps(sum0, sum1));
+  for (; i < count; i++) {
+    float d = a[i] - LoadHalf(b, i);
+    sum += d * d;
+  }
+  return sum;
+}
+
+__attribute__((target("avx2,fma"))) void Int8DotAndNormAvx2(const float* a, const int8_t* b,
+                                                             size_t count, float* dot,
+                                                             float* b_norm_squared) {
+  __m256 dot_sum = _mm256_setzero_ps();
+  __m256 norm_sum = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 vb = LoadInt8sAvx2(b + i);
+    dot_sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), vb, dot_sum);
+    norm_sum = _mm256_fmadd_ps(vb, vb, norm_sum);
+  }
+  
+  float dot_total = HorizontalSum(dot_sum);
+  float norm_total = HorizontalSum(norm_sum);
+  for (; i < count; i++) {
+    dot_total += a[i] * b[i];
+    norm_total += static_cast<float>(b[i] * b[i]);
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+__attribute__((target("avx2,fma"))) float Int8SquaredL2Avx2(const float* a, const int8_t* b,
+                                                             float scale, size_t count) {
+  __m256 vscale = _mm256_set1_ps(scale);
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256 d0 = _mm256_fnmadd_ps(vscale, LoadInt8sAvx2(b + i), _mm256_loadu_ps(a + i));
+    __m256 d1 = _mm256_fnmadd_ps(vscale, LoadInt8sAvx2(b + i + 8), _mm256_loadu_ps(a + i + 8));
+    sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+    sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+  }
+  for (; i + 8 <= count; i += 8) {
+    __m256 d = _mm256_fnmadd_ps(vscale, LoadInt8sAvx2(b + i), _mm256_loadu_ps(a + i));
+    sum0 = _mm256_fmadd_ps(d, d, sum0);
+  }
+  
+  float sum = HorizontalSum(_mm256_add_ps(sum0, sum1));
+  for (; i < count; i++) {
+    float d = a[i] - scale * b[i];
+    sum += d * d;
+  }
+  return sum;
+}
+
+// AVX-512 handles the tail with a masked load instead of a scalar loop
+
+const __mmask16 kAllLanes = 0xFFFF;
+
+__attribute__((target("avx512f"))) __mmask16 TailMask(size_t remaining) {
+  return static_cast<__mmask16>((1u << remaining) - 1);
+}
+
+// Spills the lanes rather than shuffling: the AVX-512 extract and shuffle
+// intrinsics (and _mm512_reduce_add_ps) trip a spurious -Wuninitialized in
+// GCC 12, which -Werror builds cannot afford. Runs once per vector.
+__attribute__((target("avx512f"))) float HorizontalSum(__m512 value) {
+  float lanes[16];
+  _mm512_storeu_ps(lanes, value);
+  float sum = 0;
+  for (float lane : lanes) {
+    sum += lane;
+  }
+  return sum;
+}
+
+__attribute__((target("avx512f"))) float DotAvx512(const float* a, const float* b,
+                                                    size_t count) {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+    sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+  }
+  for (; i + 16 <= count; i += 16) {
+    sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+  }
+  if (i < count) {
+    __mmask16 mask = TailMask(count - i);
+    sum1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                           _mm512_maskz_loadu_ps(mask, b + i), sum1);
+  }
+  return HorizontalSum(_mm512_add_ps(sum0, sum1));
+}
+
+__attribute__((target("avx512f"))) float SquaredL2Avx512(const float* a, const float* b,
+                                                          size_t count) {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+    sum0 = _mm512_fmadd_ps(d0, d0, sum0);
+    sum1 = _mm512_fmadd_ps(d1, d1, sum1);
+  }
+  for (; i + 16 <= count; i += 16) {
+    __m512 d = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    sum0 = _mm512_fmadd_ps(d, d, sum0);
+  }
+  if (i < count) {
+    __mmask16 mask = TailMask(count - i);
+    __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                             _mm512_maskz_loadu_ps(mask, b + i));
+    sum1 = _mm512_fmadd_ps(d, d, sum1);
+  }
+  return HorizontalSum(_mm512_add_ps(sum0, sum1));
+}
+
+__attribute__((target("avx512f"))) void DotAndNormAvx512(const float* a, const float* b,
+                                                          size_t count, float* dot,
+                                                          float* b_norm_squared) {
+  __m512 dot_sum = _mm512_setzero_ps();
+  __m512 norm_sum = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512 vb = _mm512_loadu_ps(b + i);
+    dot_sum = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), vb, dot_sum);
+    norm_sum = _mm512_fmadd_ps(vb, vb, norm_sum);
+  }
+  if (i < count) {
+    __mmask16 mask = TailMask(count - i);
+    __m512 vb = _mm512_maskz_loadu_ps(mask, b + i);
+    dot_sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), vb, dot_sum);
+    norm_sum = _mm512_fmadd_ps(vb, vb, norm_sum);
+  }
+  *dot = HorizontalSum(dot_sum);
+  *b_norm_squared = HorizontalSum(norm_sum);
+}
+
+// Code conversions only have full-width loads in AVX-512F, so their tails
+// fall back to scalar code. The conversions use their zero-masked forms with
+// every lane set: the plain ones pass an undefined vector through, which
+// GCC 12 reports as -Wmaybe-uninitialized once they are inlined.
+
+__attribute__((target("avx512f"))) __m512 LoadHalfsAvx512(const void* data, size_t index) {
+  return _mm512_maskz_cvtph_ps(kAllLanes, _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(static_cast<const uint8_t*>(data) + index * 2)));
+}
+
+__attribute__((target("avx512f"))) __m512 LoadInt8sAvx512(const int8_t* data) {
+  return _mm512_maskz_cvtepi32_ps(
+      kAllLanes, _mm512_maskz_cvtepi8_epi32(
+                     kAllLanes, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))));
+}
+
+__attribute__((target("avx512f"))) void HalfDotAndNormAvx512(const float* a, const void* b,
+                                                              size_t count, float* dot,
+                                                              float* b_norm_squared) {
+  __m512 dot_sum = _mm512_setzero_ps();
+  __m512 norm_sum = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512 vb = LoadHalfsAvx512(b, i);
+    dot_sum = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), vb, dot_sum);
+    norm_sum = _mm512_fmadd_ps(vb, vb, norm_sum);
+  }
+  
+  float dot_total = HorizontalSum(dot_sum);
+  float norm_total = HorizontalSum(norm_sum);
+  for (; i < count; i++) {
+    float element = LoadHalf(b, i);
+    dot_total += a[i] * element;
+    norm_total += element * element;
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+__attribute__((target("avx512f"))) float HalfSquaredL2Avx512(const float* a, const void* b,
+                                                              size_t count) {
+  __m512 sum = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512 d = _mm512_sub_ps(_mm512_loadu_ps(a + i), LoadHalfsAvx512(b, i));
+    sum = _mm512_fmadd_ps(d, d, sum);
+  }
+  
+  float total = HorizontalSum(sum);
+  for (; i < count; i++) {
+    float d = a[i] - LoadHalf(b, i);
+    total += d * d;
+  }
+  return total;
+}
+
+__attribute__((target("avx512f"))) void Int8DotAndNormAvx512(const float* a, const int8_t* b,
+                                                              size_t count, float* dot,
+                                                              float* b_norm_squared) {
+  __m512 dot_sum = _mm512_setzero_ps();
+  __m512 norm_sum = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512 vb = LoadInt8sAvx512(b + i);
+    dot_sum = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), vb, dot_sum);
+    norm_sum = _mm512_fmadd_ps(vb, vb, norm_sum);
+  }
+  
+  float dot_total = HorizontalSum(dot_sum);
+  float norm_total = HorizontalSum(norm_sum);
+  for (; i < count; i++) {
+    dot_total += a[i] * b[i];
+    norm_total += static_cast<float>(b[i] * b[i]);
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+__attribute__((target("avx512f"))) float Int8SquaredL2Avx512(const float* a, const int8_t* b,
+                                                              float scale, size_t count) {
+  __m512 vscale = _mm512_set1_ps(scale);
+  __m512 sum = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m512 d = _mm512_fnmadd_ps(vscale, LoadInt8sAvx512(b + i), _mm512_loadu_ps(a + i));
+    sum = _mm512_fmadd_ps(d, d, sum);
+  }
+  
+  float total = HorizontalSum(sum);
+  for (; i < count; i++) {
+    float d = a[i] - scale * b[i];
+    total += d * d;
+  }
+  return total;
+}
+
+const VectorKernels kAvx2Kernels = {
+    "avx2", DotAvx2, SquaredL2Avx2, DotAndNormAvx2,
+    HalfDotAndNormAvx2, HalfSquaredL2Avx2, Int8DotAndNormAvx2, Int8SquaredL2Avx2};
+const VectorKernels kAvx512Kernels = {
+    "avx512", DotAvx512, SquaredL2Avx512, DotAndNormAvx512,
+    HalfDotAndNormAvx512, HalfSquaredL2Avx512, Int8DotAndNormAvx512, Int8SquaredL2Avx512};
+
+#elif defined(__aarch64__)
+
+// NEON is part of the AArch64 baseline, so no runtime check is needed
+
+float DotNeon(const float* a, const float* b, size_t count) {
+  float32x4_t sum0 = vdupq_n_f32(0);
+  float32x4_t sum1 = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    sum0 = vfmaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+    sum1 = vfmaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+  }
+  for (; i + 4 <= count; i += 4) {
+    sum0 = vfmaq_f32(sum0, vld1q_f32(a + i), vld1q_f32(b + i));
+  }
+  
+  float sum = vaddvq_f32(vaddq_f32(sum0, sum1));
+  for (; i < count; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+float SquaredL2Neon(const float* a, const float* b, size_t count) {
+  float32x4_t sum0 = vdupq_n_f32(0);
+  float32x4_t sum1 = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    sum0 = vfmaq_f32(sum0, d0, d0);
+    sum1 = vfmaq_f32(sum1, d1, d1);
+  }
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t d = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    sum0 = vfmaq_f32(sum0, d, d);
+  }
+  
+  float sum = vaddvq_f32(vaddq_f32(sum0, sum1));
+  for (; i < count; i++) {
+    float d = a[i] - b[i];
+    sum += d * d;
+  }
+  return sum;
+}
+
+void DotAndNormNeon(const float* a, const float* b, size_t count,
+                    float* dot, float* b_norm_squared) {
+  float32x4_t dot_sum = vdupq_n_f32(0);
+  float32x4_t norm_sum = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t vb = vld1q_f32(b + i);
+    dot_sum = vfmaq_f32(dot_sum, vld1q_f32(a + i), vb);
+    norm_sum = vfmaq_f32(norm_sum, vb, vb);
+  }
+  
+  float dot_total = vaddvq_f32(dot_sum);
+  float norm_total = vaddvq_f32(norm_sum);
+  for (; i < count; i++) {
+    dot_total += a[i] * b[i];
+    norm_total += b[i] * b[i];
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+float32x4_t LoadHalfsNeon(const void* data, size_t index) {
+  uint8x8_t bytes = vld1_u8(static_cast<const uint8_t*>(data) + index * 2);
+  return vcvt_f32_f16(vreinterpret_f16_u8(bytes));
+}
+
+void HalfDotAndNormNeon(const float* a, const void* b, size_t count,
+                        float* dot, float* b_norm_squared) {
+  float32x4_t dot_sum = vdupq_n_f32(0);
+  float32x4_t norm_sum = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t vb = LoadHalfsNeon(b, i);
+    dot_sum = vfmaq_f32(dot_sum, vld1q_f32(a + i), vb);
+    norm_sum = vfmaq_f32(norm_sum, vb, vb);
+  }
+  
+  float dot_total = vaddvq_f32(dot_sum);
+  float norm_total = vaddvq_f32(norm_sum);
+  for (; i < count; i++) {
+    float element = LoadHalf(b, i);
+    dot_total += a[i] * element;
+    norm_total += element * element;
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+float HalfSquaredL2Neon(const float* a, const void* b, size_t count) {
+  float32x4_t sum = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t d = vsubq_f32(vld1q_f32(a + i), LoadHalfsNeon(b, i));
+    sum = vfmaq_f32(sum, d, d);
+  }
+  
+  float total = vaddvq_f32(sum);
+  for (; i < count; i++) {
+    float d = a[i] - LoadHalf(b, i);
+    total += d * d;
+  }
+  return total;
+}
+
+// Widens eight int8 codes to two vectors of four floats
+void LoadInt8sNeon(const int8_t* data, float32x4_t* low, float32x4_t* high) {
+  int16x8_t wide = vmovl_s8(vld1_s8(data));
+  *low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(wide)));
+  *high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(wide)));
+}
+
+void Int8DotAndNormNeon(const float* a, const int8_t* b, size_t count,
+                        float* dot, float* b_norm_squared) {
+  float32x4_t dot_sum = vdupq_n_f32(0);
+  float32x4_t norm_sum = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t low, high;
+    LoadInt8sNeon(b + i, &low, &high);
+    dot_sum = vfmaq_f32(dot_sum, vld1q_f32(a + i), low);
+    dot_sum = vfmaq_f32(dot_sum, vld1q_f32(a + i + 4), high);
+    norm_sum = vfmaq_f32(norm_sum, low, low);
+    norm_sum = vfmaq_f32(norm_sum, high, high);
+  }
+  
+  float dot_total = vaddvq_f32(dot_sum);
+  float norm_total = vaddvq_f32(norm_sum);
+  for (; i < count; i++) {
+    dot_total += a[i] * b[i];
+    norm_total += static_cast<float>(b[i] * b[i]);
+  }
+  *dot = dot_total;
+  *b_norm_squared = norm_total;
+}
+
+float Int8SquaredL2Neon(const float* a, const int8_t* b, float scale, size_t count) {
+  float32x4_t sum = vdupq_n_f32(0);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t low, high;
+    LoadInt8sNeon(b + i, &low, &high);
+    float32x4_t d0 = vmlsq_n_f32(vld1q_f32(a + i), low, scale);
+    float32x4_t d1 = vmlsq_n_f32(vld1q_f32(a + i + 4), high, scale);
+    sum = vfmaq_f32(sum, d0, d0);
+    sum = vfmaq_f32(sum, d1, d1);
+  }
+  
+  float total = vaddvq_f32(sum);
+  for (; i < count; i++) {
+    float d = a[i] - scale * b[i];
+    total += d * d;
+  }
+  return total;
+}
+
+const VectorKernels kNeonKernels = {
+    "neon", DotNeon, SquaredL2Neon, DotAndNormNeon,
+    HalfDotAndNormNeon, HalfSquaredL2Neon, Int8DotAndNormNeon, Int8SquaredL2Neon};
+
+#endif
+
+const VectorKernels& SelectKernels() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return kAvx512Kernels;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+      __builtin_cpu_supports("f16c")) {
+    return kAvx2Kernels;
+  }
+#elif defined(__aarch64__)
+  return kNeonKernels;
+#endif
+  return kScalarKernels;
+}
+
+// Cosine distance from a . b, ||a|| and ||b||^2
+float CosineDistance(float dot, float query_norm, float row_norm_squared) {
+  float denominator = query_norm * std::sqrt(row_norm_squared);
+  // A zero vector is equally far from everything
+  return denominator > 0 ? 1 - dot / denominator : 1;
+}
+
+}  // namespace
+
+bool ParseDistanceMetric(const char* name, DistanceMetric* metric) {
+  if (name == nullptr) {
+    return false;
+  }
+  
+  if (strcmp(name, "cosine") == 0) {
+    *metric = DistanceMetric::kCosine;
+  } else if (strcmp(name, "euclidean") == 0) {
+    *metric = DistanceMetric::kEuclidean;
+  } else if (strcmp(name, "dotProduct") == 0) {
+    *metric = DistanceMetric::kDotProduct;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* DistanceMetricName(DistanceMetric metric) {
+  switch (metric) {
+    case DistanceMetric::kEuclidean:
+      return "euclidean";
+    case DistanceMetric::kDotProduct:
+      return "dotProduct";
+    case DistanceMetric::kCosine:
+    default:
+      return "cosine";
+  }
+}
+
+const VectorKernels& GetVectorKernels() {
+  static const VectorKernels& kernels = SelectKernels();
+  return kernels;
+}
+
+float VectorDistance(const VectorKernels& kernels,
+                     DistanceMetric metric,
+                     const float* query,
+                     float query_norm,
+                     const float* row,
+                     size_t count) {
+  switch (metric) {
+    case DistanceMetric::kEuclidean:
+      return std::sqrt(kernels.squared_l2(query, row, count));
+    case DistanceMetric::kDotProduct:
+      return -kernels.dot(query, row, count);
+    case DistanceMetric::kCosine:
+    default: {
+      float dot = 0;
+      float row_norm_squared = 0;
+      kernels.dot_and_norm(query, row, count, &dot, &row_norm_squared);
+      return CosineDistance(dot, query_norm, row_norm_squared);
+    }
+  }
+}
+
+float HalfVectorDistance(const VectorKernels& kernels,
+                         DistanceMetric metric,
+                         const float* query,
+                         float query_norm,
+                         const void* row,
+                         size_t count) {
+  if (metric == DistanceMetric::kEuclidean) {
+    return std::sqrt(kernels.half_squared_l2(query, row, count));
+  }
+  
+  float dot = 0;
+  float row_norm_squared = 0;
+  kernels.half_dot_and_norm(query, row, count, &dot, &row_norm_squared);
+  return metric == DistanceMetric::kDotProduct
+      ? -dot
+      : CosineDistance(dot, query_norm, row_norm_squared);
+}
+
+float Int8VectorDistance(const VectorKernels& kernels,
+                         DistanceMetric metric,
+                         const float* query,
+                         float query_norm,
+                         const int8_t* codes,
+                         float scale,
+                         size_t count) {
+  if (metric == DistanceMetric::kEuclidean) {
+    return std::sqrt(kernels.int8_squared_l2(query, codes, scale, count));
+  }
+  
+  float dot = 0;
+  float row_norm_squared = 0;
+  kernels.int8_dot_and_norm(query, codes, count, &dot, &row_norm_squared);
+  return metric == DistanceMetric::kDotProduct
+      ? -dot * scale
+      : CosineDistance(dot * scale, query_norm, row_norm_squared * scale * scale);
+}
@@ -0,0 +1,89 @@
+#ifndef VECTOR_KERNELS_H_
+#define VECTOR_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Distance metrics of VectorDistanceMetric. Every metric is turned into a
+// distance where smaller means closer:
+//   cosine      1 - cos(query, row)
+//   euclidean   ||query - row||
+//   dotProduct  -(query . row)
+enum class DistanceMetric {
+  kCosine,
+  kEuclidean,
+  kDotProduct,
+};
+
+// Parses a VectorDistanceMetric name ("cosine", "euclidean", "dotProduct").
+bool ParseDistanceMetric(const char* name, DistanceMetric* metric);
+
+const char* DistanceMetricName(DistanceMetric metric);
+
+// Single-precision distance kernels. Inputs need no particular alignment.
+struct VectorKernels {
+  // Instruction set the kernels were built for: "avx512", "avx2", "neon" or
+  // "scalar"
+  const char* name;
+
+  float (*dot)(const float* a, const float* b, size_t count);
+  float (*squared_l2)(const float* a, const float* b, size_t count);
+
+  // Computes a . b and b . b in a single pass over `b`
+  void (*dot_and_norm)(const float* a,
+                       const float* b,
+                       size_t count,
+                       float* dot,
+                       float* b_norm_squared);
+
+  // The same against `count` half-precision values, converted in registers
+  void (*half_dot_and_norm)(const float* a,
+                            const void* b,
+                            size_t count,
+                            float* dot,
+                            float* b_norm_squared);
+  float (*half_squared_l2)(const float* a, const void* b, size_t count);
+
+  // The same against `count` int8 codes. The dot product and norm are of the
+  // codes themselves, for the caller to scale; the distance is to the codes
+  // times `scale`.
+  void (*int8_dot_and_norm)(const float* a,
+                            const int8_t* b,
+                            size_t count,
+                            float* dot,
+                            float* b_norm_squared);
+  float (*int8_squared_l2)(const float* a, const int8_t* b, float scale, size_t count);
+};
+
+// The fastest kernels the CPU supports, picked on first use.
+const VectorKernels& GetVectorKernels();
+
+// Distance from `query` to `row` under `metric`. `query_norm` is ||query||
+// and only used for cosine.
+float VectorDistance(const VectorKernels& kernels,
+                     DistanceMetric metric,
+                     const float* query,
+                     float query_norm,
+                     const float* row,
+                     size_t count);
+
+// VectorDistance() to a row of `count` half-precision values, which need no
+// alignment.
+float HalfVectorDistance(const VectorKernels& kernels,
+                         DistanceMetric metric,
+                         const float* query,
+                         float query_norm,
+                         const void* row,
+                         size_t count);
+
+// VectorDistance() to a row of `count` int8 codes, each standing for
+// `scale` * code.
+float Int8VectorDistance(const VectorKernels& kernels,
+                         DistanceMetric metric,
+                         const float* query,
+                         float query_norm,
+                         const int8_t* codes,
+                         float scale,
+                         size_t count);
+
+#endif  // VECTOR_KERNELS_H_
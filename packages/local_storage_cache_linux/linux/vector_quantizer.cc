@@ -0,0 +1,324 @@
+#include "vector_quantizer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include "vector_codec.h"
+#include "vector_index.h"
+
+namespace {
+
+// Codebooks are small, so k-means settles on a few dozen points per codeword
+// within a few iterations
+constexpr size_t kCodebookIterations = 10;
+constexpr size_t kMaxPointsPerCodeword = 48;
+
+// Codebooks are stored transposed: element `t` of codeword `c` is at
+// codebook[t * codewords + c], so a subvector is compared with every
+// codeword in passes that vectorize across codewords.
+
+// Squared distances from `subvector` to each codeword of `codebook`
+void CodewordDistances(const float* __restrict subvector,
+                       const float* __restrict codebook,
+                       size_t width,
+                       size_t codewords,
+                       float* __restrict distances) {
+  std::fill(distances, distances + codewords, 0.0f);
+  for (size_t t = 0; t < width; t++) {
+    float element = subvector[t];
+    const float* elements = codebook + t * codewords;
+    for (size_t c = 0; c < codewords; c++) {
+      float d = element - elements[c];
+      distances[c] += d * d;
+    }
+  }
+}
+
+// Dot products of `subvector` with each codeword of `codebook`
+void CodewordDots(const float* __restrict subvector,
+                  const float* __restrict codebook,
+                  size_t width,
+                  size_t codewords,
+                  float* __restrict dots) {
+  std::fill(dots, dots + codewords, 0.0f);
+  for (size_t t = 0; t < width; t++) {
+    float element = subvector[t];
+    const float* elements = codebook + t * codewords;
+    for (size_t c = 0; c < codewords; c++) {
+      dots[c] += element * elements[c];
+    }
+  }
+}
+
+uint32_t Nearest(const float* distances, size_t count) {
+  return static_cast<uint32_t>(std::min_element(distances, distances + count) - distances);
+}
+
+// Runs k-means for `codewords` centroids over the subvectors of `width`
+// elements starting at `begin` in each of the `count` vectors of `sample`
+void TrainCodebook(const float* sample,
+                   size_t count,
+                   size_t dimensions,
+                   size_t begin,
+                   size_t width,
+                   size_t codewords,
+                   float* codebook) {
+  // The sample is in random order, so its head makes a random start
+  for (size_t c = 0; c < codewords; c++) {
+    const float* vector = sample + (c % count) * dimensions + begin;
+    for (size_t t = 0; t < width; t++) {
+      codebook[t * codewords + c] = vector[t];
+    }
+  }
+
+  std::vector<uint32_t> assignments(count);
+  std::vector<float> distances(codewords);
+  std::vector<double> sums(codewords * width);
+  std::vector<size_t> sizes(codewords);
+  std::mt19937_64 random(begin);
+  for (size_t iteration = 0; iteration < kCodebookIterations; iteration++) {
+    for (size_t i = 0; i < count; i++) {
+      CodewordDistances(sample + i * dimensions + begin, codebook, width, codewords,
+                        distances.data());
+      assignments[i] = Nearest(distances.data(), codewords);
+    }
+
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(sizes.begin(), sizes.end(), 0);
+    for (size_t i = 0; i < count; i++) {
+      const float* vector = sample + i * dimensions + begin;
+      double* sum = &sums[assignments[i] * width];
+      for (size_t t = 0; t < width; t++) {
+        sum[t] += vector[t];
+      }
+      sizes[assignments[i]]++;
+    }
+
+    // An unused codeword restarts at a random sample
+    for (size_t c = 0; c < codewords; c++) {
+      const float* vector = sample + (random() % count) * dimensions + begin;
+      for (size_t t = 0; t < width; t++) {
+        codebook[t * codewords + c] = sizes[c] == 0
+            ? vector[t]
+            : static_cast<float>(sums[c * width + t] / sizes[c]);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+bool ParseVectorQuantization(const char* name, VectorQuantization* quantization) {
+  if (strcmp(name, "none") == 0) {
+    *quantization = VectorQuantization::kNone;
+  } else if (strcmp(name, "int8") == 0) {
+    *quantization = VectorQuantization::kInt8;
+  } else if (strcmp(name, "pq") == 0) {
+    *quantization = VectorQuantization::kProduct;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* VectorQuantizationName(VectorQuantization quantization) {
+  switch (quantization) {
+    case VectorQuantization::kInt8:
+      return "int8";
+    case VectorQuantization::kProduct:
+      return "pq";
+    case VectorQuantization::kNone:
+    default:
+      return "none";
+  }
+}
+
+VectorQuantizer::VectorQuantizer(size_t dimensions,
+                                 DistanceMetric metric,
+                                 VectorQuantization quantization,
+                                 size_t subvectors)
+    : dimensions_(dimensions),
+      metric_(metric),
+      quantization_(quantization),
+      subvectors_(subvectors == 0 ? std::max<size_t>(dimensions / 2, 1)
+                                  : std::min(subvectors, dimensions)),
+      kernels_(&GetVectorKernels()) {}
+
+size_t VectorQuantizer::code_words() const {
+  if (quantization_ == VectorQuantization::kInt8) {
+    return 1 + (dimensions_ + sizeof(float) - 1) / sizeof(float);
+  }
+  if (quantization_ == VectorQuantization::kProduct && compressed()) {
+    return (subvectors_ + sizeof(float) - 1) / sizeof(float);
+  }
+  return dimensions_;
+}
+
+void VectorQuantizer::Train(const float* sample, size_t count) {
+  if (!NeedsTraining() || count == 0) {
+    return;
+  }
+
+  count = std::min(count, kCodewords * kMaxPointsPerCodeword);
+  std::vector<float> codebooks(kCodewords * dimensions_);
+  ParallelFor(subvectors_, 1, [&](size_t begin, size_t end) {
+    for (size_t j = begin; j < end; j++) {
+      TrainCodebook(sample, count, dimensions_, SubvectorBegin(j),
+                    SubvectorBegin(j + 1) - SubvectorBegin(j), kCodewords,
+                    &codebooks[kCodewords * SubvectorBegin(j)]);
+    }
+  });
+  codebooks_ = std::move(codebooks);
+}
+
+void VectorQuantizer::Encode(const float* vector, float* code) const {
+  if (!compressed()) {
+    std::copy(vector, vector + dimensions_, code);
+    return;
+  }
+
+  // Padding is zeroed so saved indexes are reproducible
+  std::fill(code, code + code_words(), 0.0f);
+  if (quantization_ == VectorQuantization::kInt8) {
+    QuantizeInt8(vector, dimensions_, code, reinterpret_cast<int8_t*>(code + 1));
+    return;
+  }
+
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(code);
+  float distances[kCodewords];
+  for (size_t j = 0; j < subvectors_; j++) {
+    CodewordDistances(vector + SubvectorBegin(j), Codebook(j),
+                      SubvectorBegin(j + 1) - SubvectorBegin(j), kCodewords, distances);
+    bytes[j] = static_cast<uint8_t>(Nearest(distances, kCodewords));
+  }
+}
+
+void VectorQuantizer::Decode(const float* code, float* vector) const {
+  if (!compressed()) {
+    std::copy(code, code + dimensions_, vector);
+    return;
+  }
+
+  if (quantization_ == VectorQuantization::kInt8) {
+    const int8_t* codes = reinterpret_cast<const int8_t*>(code + 1);
+    for (size_t i = 0; i < dimensions_; i++) {
+      vector[i] = code[0] * codes[i];
+    }
+    return;
+  }
+
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(code);
+  for (size_t j = 0; j < subvectors_; j++) {
+    const float* codebook = Codebook(j);
+    for (size_t i = SubvectorBegin(j); i < SubvectorBegin(j + 1); i++) {
+      vector[i] = codebook[bytes[j]];
+      codebook += kCodewords;
+    }
+  }
+}
+
+VectorQuantizer::Scanner::Scanner(const VectorQuantizer& quantizer, const float* query)
+    : quantizer_(quantizer), query_(query) {
+  if (quantizer.quantization_ != VectorQuantization::kProduct || !quantizer.compressed()) {
+    return;
+  }
+
+  // Asymmetric distances: the query stays exact, and its partial distance to
+  // every codeword is looked up rather than recomputed per code
+  table_.resize(quantizer.subvectors_ * kCodewords);
+  for (size_t j = 0; j < quantizer.subvectors_; j++) {
+    size_t width = quantizer.SubvectorBegin(j + 1) - quantizer.SubvectorBegin(j);
+    const float* subvector = query + quantizer.SubvectorBegin(j);
+    float* row = &table_[j * kCodewords];
+    if (quantizer.metric_ == DistanceMetric::kDotProduct) {
+      CodewordDots(subvector, quantizer.Codebook(j), width, kCodewords, row);
+      for (size_t c = 0; c < kCodewords; c++) {
+        row[c] = -row[c];
+      }
+      continue;
+    }
+
+    CodewordDistances(subvector, quantizer.Codebook(j), width, kCodewords, row);
+    if (quantizer.metric_ == DistanceMetric::kCosine) {
+      // Between unit vectors 1 - a . b is half the squared distance, which
+      // unlike the dot product does not reward codes that overshoot
+      for (size_t c = 0; c < kCodewords; c++) {
+        row[c] /= 2;
+      }
+    }
+  }
+}
+
+float VectorQuantizer::Scanner::Distance(const float* code) const {
+  const VectorKernels& kernels = *quantizer_.kernels_;
+  size_t dimensions = quantizer_.dimensions_;
+  DistanceMetric metric = quantizer_.metric_;
+
+  if (!table_.empty()) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(code);
+    const float* row = table_.data();
+    float sum = 0;
+    for (size_t j = 0; j < quantizer_.subvectors_; j++, row += kCodewords) {
+      sum += row[bytes[j]];
+    }
+    return sum;
+  }
+
+  if (quantizer_.quantization_ == VectorQuantization::kInt8) {
+    const int8_t* codes = reinterpret_cast<const int8_t*>(code + 1);
+    if (metric == DistanceMetric::kEuclidean) {
+      return kernels.int8_squared_l2(query_, codes, code[0], dimensions);
+    }
+    float dot = 0;
+    float norm_squared = 0;
+    kernels.int8_dot_and_norm(query_, codes, dimensions, &dot, &norm_squared);
+    return metric == DistanceMetric::kDotProduct ? -dot * code[0] : 1.0f - dot * code[0];
+  }
+
+  switch (metric) {
+    case DistanceMetric::kEuclidean:
+      return kernels.squared_l2(query_, code, dimensions);
+    case DistanceMetric::kDotProduct:
+      return -kernels.dot(query_, code, dimensions);
+    case DistanceMetric::kCosine:
+    default:
+      return 1.0f - kernels.dot(query_, code, dimensions);
+  }
+}
+
+bool VectorQuantizer::Save(FILE* file) const {
+  return WriteValue(file, static_cast<uint32_t>(quantization_)) &&
+         WriteValue(file, static_cast<uint32_t>(subvectors_)) &&
+         WriteValue(file, static_cast<uint8_t>(!codebooks_.empty())) &&
+         (codebooks_.empty() ||
+          fwrite(codebooks_.data(), sizeof(float), codebooks_.size(), file) ==
+              codebooks_.size());
+}
+
+std::unique_ptr<VectorQuantizer> VectorQuantizer::Load(FILE* file,
+                                                       size_t dimensions,
+                                                       DistanceMetric metric) {
+  uint32_t quantization, subvectors;
+  uint8_t trained;
+  if (!ReadValue(file, &quantization) || !ReadValue(file, &subvectors) ||
+      !ReadValue(file, &trained)) {
+    return nullptr;
+  }
+  if (quantization > static_cast<uint32_t>(VectorQuantization::kProduct) || subvectors == 0 ||
+      subvectors > dimensions ||
+      (trained && quantization != static_cast<uint32_t>(VectorQuantization::kProduct))) {
+    return nullptr;
+  }
+
+  std::unique_ptr<VectorQuantizer> quantizer(new VectorQuantizer(
+      dimensions, metric, static_cast<VectorQuantization>(quantization), subvectors));
+  if (trained) {
+    quantizer->codebooks_.resize(kCodewords * dimensions);
+    if (fread(quantizer->codebooks_.data(), sizeof(float), quantizer->codebooks_.size(),
+              file) != quantizer->codebooks_.size()) {
+      return nullptr;
+    }
+  }
+  return quantizer;
+}
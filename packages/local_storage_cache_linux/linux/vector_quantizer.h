@@ -0,0 +1,103 @@
+#ifndef VECTOR_QUANTIZER_H_
+#define VECTOR_QUANTIZER_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "vector_kernels.h"
+
+// How an index compresses the vectors it stores.
+enum class VectorQuantization {
+  kNone,
+  kInt8,     // Scalar quantization, one byte per element
+  kProduct,  // Product quantization, one byte per subvector
+};
+
+// Parses a quantization name ("none", "int8", "pq").
+bool ParseVectorQuantization(const char* name, VectorQuantization* quantization);
+
+const char* VectorQuantizationName(VectorQuantization quantization);
+
+// Encodes prepared vectors (see VectorIndex) into compact codes and computes
+// distances against the codes without decoding them.
+//
+// Codes are padded to whole float words, so a block of codes has the layout
+// and alignment of a block of vectors:
+//  - kNone stores the vector itself.
+//  - kInt8 stores a float scale followed by one int8 per element.
+//  - kProduct splits the vector into subvectors and stores, for each, the
+//    index of the closest of 256 codewords learned by k-means. Until Train()
+//    has learned the codebooks it stores vectors uncompressed.
+class VectorQuantizer {
+ public:
+  // `subvectors` is used by kProduct; 0 picks one per two dimensions
+  VectorQuantizer(size_t dimensions,
+                  DistanceMetric metric,
+                  VectorQuantization quantization,
+                  size_t subvectors);
+
+  VectorQuantization quantization() const { return quantization_; }
+  size_t subvectors() const { return subvectors_; }
+
+  // Whether codes are smaller than the vectors they encode
+  bool compressed() const {
+    return quantization_ == VectorQuantization::kInt8 || !codebooks_.empty();
+  }
+
+  // Floats per code
+  size_t code_words() const;
+
+  // Whether Train() has anything left to learn
+  bool NeedsTraining() const {
+    return quantization_ == VectorQuantization::kProduct && codebooks_.empty();
+  }
+
+  // Learns the product quantization codebooks from the `count` vectors of
+  // `sample`, which should be in random order, on several threads.
+  void Train(const float* sample, size_t count);
+
+  void Encode(const float* vector, float* code) const;
+  void Decode(const float* code, float* vector) const;
+
+  // Distances from one prepared query to codes, on the scale of
+  // VectorIndex::Distance(). Borrows the quantizer and the query.
+  class Scanner {
+   public:
+    Scanner(const VectorQuantizer& quantizer, const float* query);
+
+    float Distance(const float* code) const;
+
+   private:
+    const VectorQuantizer& quantizer_;
+    const float* query_;
+    std::vector<float> table_;  // kProduct: per subvector, per codeword
+  };
+
+  bool Save(FILE* file) const;
+
+  // Returns nullptr if `file` does not hold a quantizer for `dimensions`.
+  static std::unique_ptr<VectorQuantizer> Load(FILE* file,
+                                               size_t dimensions,
+                                               DistanceMetric metric);
+
+ private:
+  // Subvector `j` spans [SubvectorBegin(j), SubvectorBegin(j + 1))
+  size_t SubvectorBegin(size_t j) const { return j * dimensions_ / subvectors_; }
+
+  // Codewords of subvector `j`, transposed: kCodewords values of each
+  // element in turn
+  const float* Codebook(size_t j) const { return &codebooks_[kCodewords * SubvectorBegin(j)]; }
+
+  static constexpr size_t kCodewords = 256;
+
+  size_t dimensions_;
+  DistanceMetric metric_;
+  VectorQuantization quantization_;
+  size_t subvectors_;
+  std::vector<float> codebooks_;  // kCodewords * dimensions_ once trained
+  const VectorKernels* kernels_;
+};
+
+#endif  // VECTOR_QUANTIZER_H_
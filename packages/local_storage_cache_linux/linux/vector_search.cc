@@ -0,0 +1,374 @@
+#include "vector_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "result_encoder.h"
+#include "sql_util.h"
+#include "value_binding.h"
+#include "vector_codec.h"
+
+namespace {
+
+// Fewer rowids than this are scanned faster than a thread can be handed them
+constexpr uint64_t kMinRowidsPerSlice = 8192;
+
+bool IsCloser(const VectorMatch& a, const VectorMatch& b) {
+  return a.distance < b.distance;
+}
+
+bool ReadQueryVector(FlValue* value, std::vector<float>* query) {
+  if (value == nullptr) {
+    return false;
+  }
+  
+  switch (fl_value_get_type(value)) {
+    case FL_VALUE_TYPE_FLOAT32_LIST: {
+      const float* data = fl_value_get_float32_list(value);
+      query->assign(data, data + fl_value_get_length(value));
+      return true;
+    }
+    case FL_VALUE_TYPE_FLOAT_LIST: {
+      const double* data = fl_value_get_float_list(value);
+      query->assign(data, data + fl_value_get_length(value));
+      return true;
+    }
+    case FL_VALUE_TYPE_LIST: {
+      size_t length = fl_value_get_length(value);
+      query->resize(length);
+      for (size_t i = 0; i < length; i++) {
+        FlValue* element = fl_value_get_list_value(value, i);
+        if (fl_value_get_type(element) == FL_VALUE_TYPE_FLOAT) {
+          (*query)[i] = static_cast<float>(fl_value_get_float(element));
+        } else if (fl_value_get_type(element) == FL_VALUE_TYPE_INT) {
+          (*query)[i] = static_cast<float>(fl_value_get_int(element));
+        } else {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+const char* LookupString(FlValue* args, const char* key) {
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+    return nullptr;
+  }
+  return fl_value_get_string(value);
+}
+
+}  // namespace
+
+float VectorBlobDistance(const VectorKernels& kernels,
+                         DistanceMetric metric,
+                         const std::vector<float>& query,
+                         float query_norm,
+                         VectorElementType type,
+                         const void* blob,
+                         std::vector<float>* scratch) {
+  size_t dimensions = query.size();
+  switch (type) {
+    case VectorElementType::kFloat16:
+      return HalfVectorDistance(kernels, metric, query.data(), query_norm, blob, dimensions);
+    case VectorElementType::kInt8: {
+      float scale;
+      memcpy(&scale, blob, sizeof(scale));
+      return Int8VectorDistance(kernels, metric, query.data(), query_norm,
+                                static_cast<const int8_t*>(blob) + sizeof(scale), scale,
+                                dimensions);
+    }
+    case VectorElementType::kFloat32:
+    case VectorElementType::kFloat64:
+    default:
+      return VectorDistance(kernels, metric, query.data(), query_norm,
+                            DecodeVector(blob, type, scratch), dimensions);
+  }
+}
+
+bool ParseVectorSearchRequest(FlValue* args,
+                              VectorSearchRequest* request,
+                              std::string* error) {
+  const char* table_name = LookupString(args, "tableName");
+  const char* column = LookupString(args, "column");
+  if (table_name == nullptr || column == nullptr) {
+    *error = "tableName and column are required";
+    return false;
+  }
+  request->table_name = table_name;
+  request->column = column;
+  
+  if (!ReadQueryVector(fl_value_lookup_string(args, "queryVector"), &request->query) ||
+      request->query.empty()) {
+    *error = "queryVector must be a non-empty list of numbers";
+    return false;
+  }
+  
+  FlValue* k_value = fl_value_lookup_string(args, "k");
+  if (k_value != nullptr) {
+    if (fl_value_get_type(k_value) != FL_VALUE_TYPE_INT || fl_value_get_int(k_value) <= 0) {
+      *error = "k must be a positive integer";
+      return false;
+    }
+    request->k = static_cast<size_t>(fl_value_get_int(k_value));
+  }
+  
+  const char* metric = LookupString(args, "metric");
+  if (metric != nullptr && !ParseDistanceMetric(metric, &request->metric)) {
+    *error = std::string("Unknown distance metric: ") + metric;
+    return false;
+  }
+  
+  const char* filter = LookupString(args, "filterSql");
+  request->filter = filter ? filter : "";
+  request->filter_arguments = fl_value_lookup_string(args, "filterArguments");
+  
+  FlValue* ef_search = fl_value_lookup_string(args, "efSearch");
+  if (ef_search != nullptr && fl_value_get_type(ef_search) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(ef_search) > 0) {
+    request->ef_search = static_cast<size_t>(fl_value_get_int(ef_search));
+  }
+  FlValue* nprobe = fl_value_lookup_string(args, "nprobe");
+  if (nprobe != nullptr && fl_value_get_type(nprobe) == FL_VALUE_TYPE_INT &&
+      fl_value_get_int(nprobe) > 0) {
+    request->nprobe = static_cast<size_t>(fl_value_get_int(nprobe));
+  }
+  FlValue* exact = fl_value_lookup_string(args, "exact");
+  request->exact = exact != nullptr && fl_value_get_type(exact) == FL_VALUE_TYPE_BOOL &&
+                   fl_value_get_bool(exact);
+  
+  const VectorKernels& kernels = GetVectorKernels();
+  request->query_norm = std::sqrt(
+      kernels.dot(request->query.data(), request->query.data(), request->query.size()));
+  return true;
+}
+
+void TopK::Push(float distance, int64_t rowid) {
+  if (k_ == 0) {
+    return;
+  }
+  
+  if (heap_.size() == k_) {
+    std::pop_heap(heap_.begin(), heap_.end(), IsCloser);
+    heap_.pop_back();
+  }
+  heap_.push_back(VectorMatch{distance, rowid});
+  std::push_heap(heap_.begin(), heap_.end(), IsCloser);
+}
+
+void TopK::Merge(const TopK& other) {
+  for (const VectorMatch& match : other.heap_) {
+    if (Accepts(match.distance)) {
+      Push(match.distance, match.rowid);
+    }
+  }
+}
+
+std::vector<VectorMatch> TopK::Sorted() const {
+  std::vector<VectorMatch> matches = heap_;
+  std::sort(matches.begin(), matches.end(), IsCloser);
+  return matches;
+}
+
+bool GetRowidRange(sqlite3* database,
+                   const std::string& table_name,
+                   int64_t* first_rowid,
+                   int64_t* last_rowid,
+                   std::string* error) {
+  // Both ends come straight off the table's b-tree
+  std::string sql = "SELECT min(rowid), max(rowid) FROM " + QuoteIdentifier(table_name);
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database);
+    sqlite3_finalize(statement);
+    return false;
+  }
+  
+  *first_rowid = 1;
+  *last_rowid = 0;
+  if (sqlite3_step(statement) == SQLITE_ROW &&
+      sqlite3_column_type(statement, 0) != SQLITE_NULL) {
+    *first_rowid = sqlite3_column_int64(statement, 0);
+    *last_rowid = sqlite3_column_int64(statement, 1);
+  }
+  sqlite3_finalize(statement);
+  return true;
+}
+
+std::vector<std::pair<int64_t, int64_t>> SplitRowidRange(int64_t first_rowid,
+                                                         int64_t last_rowid,
+                                                         size_t max_slices) {
+  std::vector<std::pair<int64_t, int64_t>> slices;
+  if (first_rowid > last_rowid) {
+    return slices;
+  }
+  
+  // Unsigned, so the span of any two int64 rowids fits
+  uint64_t span = static_cast<uint64_t>(last_rowid) - static_cast<uint64_t>(first_rowid);
+  uint64_t count = std::min<uint64_t>(std::max<size_t>(max_slices, 1),
+                                      span / kMinRowidsPerSlice + 1);
+  if (count == 1) {
+    slices.emplace_back(first_rowid, last_rowid);
+    return slices;
+  }
+  
+  uint64_t step = span / count + 1;
+  uint64_t begin = static_cast<uint64_t>(first_rowid);
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t end = i + 1 == count ? static_cast<uint64_t>(last_rowid) : begin + step - 1;
+    slices.emplace_back(static_cast<int64_t>(begin), static_cast<int64_t>(end));
+    begin = end + 1;
+  }
+  return slices;
+}
+
+bool ScanVectors(sqlite3* database,
+                 const VectorSearchRequest& request,
+                 int64_t first_rowid,
+                 int64_t last_rowid,
+                 TopK* top,
+                 std::string* error) {
+  // The filter comes first so its positional arguments bind from 1; the
+  // rowid bounds are always the last two parameters
+  std::string sql = "SELECT rowid, " + QuoteIdentifier(request.column) + " FROM " +
+                    QuoteIdentifier(request.table_name) + " WHERE ";
+  if (!request.filter.empty()) {
+    sql += "(" + request.filter + ") AND ";
+  }
+  sql += "rowid BETWEEN ? AND ?";
+  
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database);
+    sqlite3_finalize(statement);
+    return false;
+  }
+  
+  int parameter_count = sqlite3_bind_parameter_count(statement);
+  if (!BindArguments(statement, request.filter_arguments) ||
+      sqlite3_bind_int64(statement, parameter_count - 1, first_rowid) != SQLITE_OK ||
+      sqlite3_bind_int64(statement, parameter_count, last_rowid) != SQLITE_OK) {
+    *error = "Failed to bind filter arguments";
+    sqlite3_finalize(statement);
+    return false;
+  }
+  
+  // Plain BLOB columns are read as float32, the layout Float32List binds as
+  VectorElementType type = VectorElementType::kFloat32;
+  ParseVectorType(sqlite3_column_decltype(statement, 1), &type);
+  
+  const VectorKernels& kernels = GetVectorKernels();
+  size_t dimensions = request.query.size();
+  size_t vector_bytes = VectorBlobSize(type, dimensions);
+  std::vector<float> scratch(dimensions);
+  
+  int result;
+  while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
+    const void* blob = sqlite3_column_blob(statement, 1);
+    if (blob == nullptr ||
+        static_cast<size_t>(sqlite3_column_bytes(statement, 1)) != vector_bytes) {
+      continue;
+    }
+  
+    float distance = VectorBlobDistance(kernels, request.metric, request.query,
+                                        request.query_norm, type, blob, &scratch);
+    if (!std::isnan(distance) && top->Accepts(distance)) {
+      top->Push(distance, sqlite3_column_int64(statement, 0));
+    }
+  }
+  
+  if (result != SQLITE_DONE) {
+    *error = sqlite3_errmsg(database);
+  }
+  sqlite3_finalize(statement);
+  return result == SQLITE_DONE;
+}
+
+bool RerankVectors(sqlite3* database,
+                   const VectorSearchRequest& request,
+                   const std::vector<VectorMatch>& candidates,
+                   std::vector<VectorMatch>* matches,
+                   std::string* error) {
+  std::string sql = "SELECT " + QuoteIdentifier(request.column) + " FROM " +
+                    QuoteIdentifier(request.table_name) + " WHERE rowid = ?";
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database);
+    sqlite3_finalize(statement);
+    return false;
+  }
+  
+  VectorElementType type = VectorElementType::kFloat32;
+  ParseVectorType(sqlite3_column_decltype(statement, 0), &type);
+  
+  const VectorKernels& kernels = GetVectorKernels();
+  size_t vector_bytes = VectorBlobSize(type, request.query.size());
+  std::vector<float> scratch(request.query.size());
+  
+  TopK top(request.k);
+  for (const VectorMatch& candidate : candidates) {
+    sqlite3_bind_int64(statement, 1, candidate.rowid);
+    if (sqlite3_step(statement) == SQLITE_ROW) {
+      const void* blob = sqlite3_column_blob(statement, 0);
+      if (blob != nullptr &&
+          static_cast<size_t>(sqlite3_column_bytes(statement, 0)) == vector_bytes) {
+        float distance = VectorBlobDistance(kernels, request.metric, request.query,
+                                            request.query_norm, type, blob, &scratch);
+        if (!std::isnan(distance) && top.Accepts(distance)) {
+          top.Push(distance, candidate.rowid);
+        }
+      }
+    }
+    sqlite3_reset(statement);
+  }
+  sqlite3_finalize(statement);
+  
+  *matches = top.Sorted();
+  return true;
+}
+
+FlValue* LoadVectorMatches(sqlite3* database,
+                           const VectorSearchRequest& request,
+                           const std::vector<VectorMatch>& matches,
+                           std::string* error) {
+  std::string sql = "SELECT * FROM " + QuoteIdentifier(request.table_name) + " WHERE rowid = ?";
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    *error = sqlite3_errmsg(database);
+    sqlite3_finalize(statement);
+    return nullptr;
+  }
+  
+  FlValue* results = fl_value_new_list();
+  for (const VectorMatch& match : matches) {
+    sqlite3_bind_int64(statement, 1, match.rowid);
+  
+    bool done = false;
+    g_autoptr(FlValue) rows = EncodeRows(statement, 1, &done);
+    sqlite3_reset(statement);
+    if (fl_value_get_length(rows) == 0) {
+      continue;
+    }
+  
+    FlValue* result = fl_value_new_map();
+    fl_value_set_string_take(result, "distance", fl_value_new_float(match.distance));
+    fl_value_set_string(result, "row", fl_value_get_list_value(rows, 0));
+    fl_value_append_take(results, result);
+  }
+  
+  sqlite3_finalize(statement);
+  return results;
+}
+
+bool VectorSearchJob::Complete(const TopK& top, const std::string& error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!error.empty() && error_.empty()) {
+    error_ = error;
+  }
+  top_.Merge(top);
+  return --remaining_ == 0;
+}
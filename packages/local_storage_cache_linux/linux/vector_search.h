@@ -0,0 +1,146 @@
+#ifndef VECTOR_SEARCH_H_
+#define VECTOR_SEARCH_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vector_codec.h"
+#include "vector_kernels.h"
+
+// Arguments of a vectorSearch call. `filter_arguments` is borrowed from the
+// method call, which outlives the search.
+struct VectorSearchRequest {
+  std::string table_name;
+  std::string column;
+  std::vector<float> query;
+  float query_norm = 0;
+  size_t k = 10;
+  DistanceMetric metric = DistanceMetric::kCosine;
+  std::string filter;  // SQL expression rows must satisfy, may be empty.
+  FlValue* filter_arguments = nullptr;
+  size_t ef_search = 0;  // HNSW candidate list size, 0 for the index default
+  size_t nprobe = 0;     // IVF-Flat lists to scan, 0 for the index default
+  bool exact = false;    // Scan even if an index covers the column
+};
+
+// Parses the vectorSearch arguments. Returns false with `*error` set if they
+// are missing or malformed.
+bool ParseVectorSearchRequest(FlValue* args,
+                              VectorSearchRequest* request,
+                              std::string* error);
+
+// VectorDistance() from `query` to a vector BLOB of `type` with as many
+// elements. Half-precision and int8 vectors are compared without decoding
+// them first; others are decoded into `scratch` if they cannot be used in
+// place.
+float VectorBlobDistance(const VectorKernels& kernels,
+                         DistanceMetric metric,
+                         const std::vector<float>& query,
+                         float query_norm,
+                         VectorElementType type,
+                         const void* blob,
+                         std::vector<float>* scratch);
+
+struct VectorMatch {
+  float distance;
+  int64_t rowid;
+};
+
+// The `k` closest matches seen so far, kept in a bounded max-heap so the
+// current cut-off is always at the top.
+class TopK {
+ public:
+  explicit TopK(size_t k) : k_(k) {}
+
+  // Whether a match at `distance` would make it into the top k
+  bool Accepts(float distance) const {
+    return heap_.size() < k_ || distance < heap_.front().distance;
+  }
+
+  void Push(float distance, int64_t rowid);
+  void Merge(const TopK& other);
+
+  // Matches ordered closest first
+  std::vector<VectorMatch> Sorted() const;
+
+ private:
+  size_t k_;
+  std::vector<VectorMatch> heap_;
+};
+
+// Reads the smallest and largest rowid of `table_name`. An empty table
+// yields `*first_rowid > *last_rowid`.
+bool GetRowidRange(sqlite3* database,
+                   const std::string& table_name,
+                   int64_t* first_rowid,
+                   int64_t* last_rowid,
+                   std::string* error);
+
+// Splits [first_rowid, last_rowid] into at most `max_slices` contiguous
+// ranges, each spanning enough rowids to be worth a thread of its own.
+std::vector<std::pair<int64_t, int64_t>> SplitRowidRange(int64_t first_rowid,
+                                                         int64_t last_rowid,
+                                                         size_t max_slices);
+
+// Scans the vectors of rows with a rowid in [first_rowid, last_rowid] that
+// pass the request's filter, adding them to `top`. Rows whose vector is NULL
+// or has the wrong number of dimensions are skipped.
+bool ScanVectors(sqlite3* database,
+                 const VectorSearchRequest& request,
+                 int64_t first_rowid,
+                 int64_t last_rowid,
+                 TopK* top,
+                 std::string* error);
+
+// Recomputes the exact distances of `candidates` from the stored vectors and
+// keeps the request's `k` closest, for indexes that search on approximations.
+// Rows deleted since the index search are left out.
+bool RerankVectors(sqlite3* database,
+                   const VectorSearchRequest& request,
+                   const std::vector<VectorMatch>& candidates,
+                   std::vector<VectorMatch>* matches,
+                   std::string* error);
+
+// Loads the matched rows as a list of {"distance": double, "row": {...}}
+// maps, closest first. Rows deleted since the scan are left out.
+FlValue* LoadVectorMatches(sqlite3* database,
+                           const VectorSearchRequest& request,
+                           const std::vector<VectorMatch>& matches,
+                           std::string* error);
+
+// A search whose scan is split into rowid slices, each run on its own
+// connection and thread. Whichever slice completes last gathers the result.
+class VectorSearchJob {
+ public:
+  VectorSearchJob(std::shared_ptr<const VectorSearchRequest> request, size_t slices)
+      : request_(std::move(request)), top_(request_->k), remaining_(slices) {}
+
+  // Disallow copy and assign.
+  VectorSearchJob(const VectorSearchJob&) = delete;
+  VectorSearchJob& operator=(const VectorSearchJob&) = delete;
+
+  const VectorSearchRequest& request() const { return *request_; }
+
+  // Merges the matches of a finished slice, or records why it failed.
+  // Returns true for the last slice, after which top() and error() are final.
+  bool Complete(const TopK& top, const std::string& error);
+
+  const TopK& top() const { return top_; }
+  const std::string& error() const { return error_; }
+
+ private:
+  std::shared_ptr<const VectorSearchRequest> request_;
+  std::mutex mutex_;
+  TopK top_;
+  std::string error_;
+  size_t remaining_;
+};
+
+#endif  // VECTOR_SEARCH_H_
@@ -6,3 +6,11 @@ library local_storage_cache_platform_interface;
 export 'src/local_storage_cache_platform.dart';
 export 'src/method_channel_local_storage_cache.dart';
 export 'src/models/batch_operation.dart';
+export 'src/models/batch_result.dart';
+export 'src/models/columnar_result.dart';
+export 'src/models/cursor_page.dart';
+export 'src/models/full_text_match.dart';
+export 'src/models/packed_result.dart';
+export 'src/models/query_diff.dart';
+export 'src/models/vector_index_benchmark.dart';
+export 'src/models/vector_match.dart';
@@ -1,5 +1,12 @@
 import 'package:local_storage_cache_platform_interface/src/method_channel_local_storage_cache.dart';
 import 'package:local_storage_cache_platform_interface/src/models/batch_operation.dart';
+import 'package:local_storage_cache_platform_interface/src/models/batch_result.dart';
+import 'package:local_storage_cache_platform_interface/src/models/columnar_result.dart';
+import 'package:local_storage_cache_platform_interface/src/models/cursor_page.dart';
+import 'package:local_storage_cache_platform_interface/src/models/packed_result.dart';
+import 'package:local_storage_cache_platform_interface/src/models/query_diff.dart';
+import 'package:local_storage_cache_platform_interface/src/models/vector_index_benchmark.dart';
+import 'package:local_storage_cache_platform_interface/src/models/vector_match.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 /// The interface that platform-specific implementations of local_storage_cache must extend.
@@ -43,6 +50,9 @@ abstract class LocalStorageCachePlatform extends PlatformInterface {
 
   /// Inserts [data] into [tableName] in the specified [space].
   ///
+  /// [tableName] is the table's full name, with the prefix of [space]
+  /// already applied if the table has one.
+  ///
   /// Returns the ID of the inserted record.
   Future<dynamic> insert(
     String tableName,
@@ -63,6 +73,25 @@ abstract class LocalStorageCachePlatform extends PlatformInterface {
     throw UnimplementedError('query() has not been implemented.');
   }
 
+  /// Executes a query like [query], but returns the result in columnar form.
+  Future<ColumnarResult> queryColumnar(
+    String sql,
+    List<dynamic> arguments,
+    String space,
+  ) {
+    throw UnimplementedError('queryColumnar() has not been implemented.');
+  }
+
+  /// Executes a query like [query], but returns the whole result packed into
+  /// one buffer that is decoded lazily.
+  Future<PackedResult> queryPacked(
+    String sql,
+    List<dynamic> arguments,
+    String space,
+  ) {
+    throw UnimplementedError('queryPacked() has not been implemented.');
+  }
+
   /// Executes an update with the given [sql] and [arguments] in the specified [space].
   ///
   /// Returns the number of rows affected.
@@ -85,9 +114,283 @@ abstract class LocalStorageCachePlatform extends PlatformInterface {
     throw UnimplementedError('delete() has not been implemented.');
   }
 
+  // Cursors
+
+  /// Opens a cursor over the query [sql] with [arguments] in the specified
+  /// [space].
+  ///
+  /// Returns the ID of the cursor. Rows are read with [fetch], so large
+  /// result sets never have to be held in memory at once.
+  Future<int> openCursor(
+    String sql,
+    List<dynamic> arguments,
+    String space,
+  ) {
+    throw UnimplementedError('openCursor() has not been implemented.');
+  }
+
+  /// Reads up to [pageSize] rows from the cursor [cursorId].
+  ///
+  /// Cursors that are not read from for a while are closed by the platform.
+  Future<CursorPage> fetch(int cursorId, int pageSize) {
+    throw UnimplementedError('fetch() has not been implemented.');
+  }
+
+  /// Closes the cursor [cursorId] before it is done.
+  Future<void> closeCursor(int cursorId) {
+    throw UnimplementedError('closeCursor() has not been implemented.');
+  }
+
+  // Vector search
+
+  /// Finds the [k] rows of [tableName] whose vector [column] is closest to
+  /// [queryVector], closest first.
+  ///
+  /// [metric] is the name of a `VectorDistanceMetric`: `cosine`, `euclidean`
+  /// or `dotProduct`. [filterSql] is an optional SQL expression, with
+  /// positional [filterArguments], that rows must satisfy to be considered.
+  ///
+  /// Unfiltered searches are answered approximately from a vector index over
+  /// [column] with the same metric, if there is one; [efSearch] overrides the
+  /// candidate list size of an HNSW index and [nprobe] the number of lists an
+  /// IVF-Flat index scans. [exact] forces a full scan.
+  Future<List<VectorMatch>> vectorSearch(
+    String tableName,
+    String column,
+    List<double> queryVector, {
+    int k = 10,
+    String metric = 'cosine',
+    String? filterSql,
+    List<dynamic> filterArguments = const [],
+    int? efSearch,
+    int? nprobe,
+    bool exact = false,
+  }) {
+    throw UnimplementedError('vectorSearch() has not been implemented.');
+  }
+
+  /// Builds a vector index named [indexName] over the vector [column] of
+  /// [tableName], kept up to date as rows change.
+  ///
+  /// [indexType] is the name of a `VectorIndexType`: `hnsw` or `ivfFlat`.
+  /// [dimensions] defaults to the length of the first stored vector.
+  /// [parameters] may set `m`, `efConstruction` and `efSearch` for HNSW, and
+  /// `nlist`, `nprobe`, `quantization`, `pqSubvectors` and `rerank` for
+  /// IVF-Flat. Creating an index that already exists with the same settings
+  /// does nothing.
+  Future<void> createVectorIndex(
+    String indexName,
+    String tableName,
+    String column, {
+    String indexType = 'hnsw',
+    int? dimensions,
+    String metric = 'cosine',
+    Map<String, dynamic> parameters = const {},
+  }) {
+    throw UnimplementedError('createVectorIndex() has not been implemented.');
+  }
+
+  /// Drops the vector index [indexName] and its side file.
+  Future<void> dropVectorIndex(String indexName) {
+    throw UnimplementedError('dropVectorIndex() has not been implemented.');
+  }
+
+  /// Measures recall@[k] and latency of the vector index [indexName], using
+  /// [queries] vectors sampled from it: at each of the [efSearch] values for
+  /// an HNSW index, at each of the [nprobe] values for an IVF-Flat index.
+  Future<VectorIndexBenchmark> benchmarkVectorIndex(
+    String indexName, {
+    List<int> efSearch = const [16, 32, 64, 128, 256],
+    List<int> nprobe = const [1, 4, 16, 64],
+    int queries = 100,
+    int k = 10,
+  }) {
+    throw UnimplementedError(
+      'benchmarkVectorIndex() has not been implemented.',
+    );
+  }
+
+  // Full-text search
+
+  /// Finds the rows of [tableName] matching [query] in its full-text index,
+  /// best match first, ranked by bm25.
+  ///
+  /// [query] uses the FTS5 query syntax, e.g. `apple AND pie` or `app*`.
+  /// [filterSql] is an optional SQL expression, with positional
+  /// [filterArguments], that rows must satisfy. Matched terms are wrapped in
+  /// [highlightStart] and [highlightEnd], and snippets are about
+  /// [snippetTokens] tokens long.
+  Future<List<FullTextMatch>> fullTextSearch(
+    String tableName,
+    String query, {
+    int limit = 20,
+    String? filterSql,
+    List<dynamic> filterArguments = const [],
+    String highlightStart = '<b>',
+    String highlightEnd = '</b>',
+    int snippetTokens = 16,
+  }) {
+    throw UnimplementedError('fullTextSearch() has not been implemented.');
+  }
+
+  /// Creates the full-text index of [tableName] over its text [columns],
+  /// kept up to date as rows change.
+  ///
+  /// Rows already in the table are indexed in the background, and are only
+  /// found once indexed. [tokenizer] is an FTS5 tokenizer such as
+  /// `unicode61` or `porter unicode61`; each of [prefixes] is a prefix length
+  /// indexed to speed up `term*` queries. Creating an index that already
+  /// exists with the same settings does nothing.
+  Future<void> createFullTextIndex(
+    String tableName,
+    List<String> columns, {
+    String tokenizer = 'unicode61',
+    List<int> prefixes = const [],
+  }) {
+    throw UnimplementedError(
+      'createFullTextIndex() has not been implemented.',
+    );
+  }
+
+  /// Drops the full-text index of [tableName].
+  Future<void> dropFullTextIndex(String tableName) {
+    throw UnimplementedError('dropFullTextIndex() has not been implemented.');
+  }
+
+  /// Reindexes every row of [tableName] in the background.
+  Future<void> rebuildFullTextIndex(String tableName) {
+    throw UnimplementedError(
+      'rebuildFullTextIndex() has not been implemented.',
+    );
+  }
+
+  // Key-value storage
+
+  /// Gets the JSON-encoded value of [key] in the key-value table
+  /// [tableName], or null if there is none.
+  ///
+  /// Key-value tables are `(key, value, updated_at)` tables created on first
+  /// use. Platforms may serve repeated lookups from memory.
+  Future<String?> kvGet(String tableName, String key) {
+    throw UnimplementedError('kvGet() has not been implemented.');
+  }
+
+  /// Sets [key] to the JSON-encoded [value] in the key-value table
+  /// [tableName].
+  Future<void> kvSet(String tableName, String key, String value) {
+    throw UnimplementedError('kvSet() has not been implemented.');
+  }
+
+  /// Deletes [key] from the key-value table [tableName]. Returns whether it
+  /// was there.
+  Future<bool> kvDelete(String tableName, String key) {
+    throw UnimplementedError('kvDelete() has not been implemented.');
+  }
+
+  /// Gets the JSON-encoded values of [keys] in the key-value table
+  /// [tableName]. Missing keys are left out.
+  Future<Map<String, String>> kvMultiGet(
+    String tableName,
+    List<String> keys,
+  ) {
+    throw UnimplementedError('kvMultiGet() has not been implemented.');
+  }
+
+  /// Sets every key of [entries] to its JSON-encoded value in the key-value
+  /// table [tableName], in one transaction.
+  Future<void> kvMultiSet(String tableName, Map<String, String> entries) {
+    throw UnimplementedError('kvMultiSet() has not been implemented.');
+  }
+
+  // Disk cache
+
+  /// Opens the persistent disk cache kept in [directory], creating it if
+  /// needed, holding at most [maxEntries] entries evicted by
+  /// [evictionPolicy] (an EvictionPolicy name). Opening an open cache again
+  /// only changes its size.
+  ///
+  /// The other disk cache methods act on a cache opened this way. Values are
+  /// JSON-encoded strings.
+  Future<void> diskCacheOpen(
+    String directory, {
+    required int maxEntries,
+    String evictionPolicy = 'lru',
+  }) {
+    throw UnimplementedError('diskCacheOpen() has not been implemented.');
+  }
+
+  /// Gets the value of [key] in the disk cache in [directory], or null if
+  /// there is none or it has expired.
+  Future<String?> diskCacheGet(String directory, String key) {
+    throw UnimplementedError('diskCacheGet() has not been implemented.');
+  }
+
+  /// Sets [key] to [value] in the disk cache in [directory], expiring at
+  /// [expiresAt] milliseconds since the epoch if given.
+  Future<void> diskCachePut(
+    String directory,
+    String key,
+    String value, {
+    int? expiresAt,
+  }) {
+    throw UnimplementedError('diskCachePut() has not been implemented.');
+  }
+
+  /// Removes [key] from the disk cache in [directory]. Returns whether it
+  /// was there.
+  Future<bool> diskCacheRemove(String directory, String key) {
+    throw UnimplementedError('diskCacheRemove() has not been implemented.');
+  }
+
+  /// Removes every entry of the disk cache in [directory].
+  Future<void> diskCacheClear(String directory) {
+    throw UnimplementedError('diskCacheClear() has not been implemented.');
+  }
+
+  /// Gets the keys of the unexpired entries of the disk cache in
+  /// [directory].
+  Future<List<String>> diskCacheKeys(String directory) {
+    throw UnimplementedError('diskCacheKeys() has not been implemented.');
+  }
+
+  /// Gets the values of the unexpired entries of the disk cache in
+  /// [directory].
+  Future<List<String>> diskCacheValues(String directory) {
+    throw UnimplementedError('diskCacheValues() has not been implemented.');
+  }
+
+  /// Gets the number of entries of the disk cache in [directory], expired
+  /// ones not yet removed included.
+  Future<int> diskCacheSize(String directory) {
+    throw UnimplementedError('diskCacheSize() has not been implemented.');
+  }
+
+  /// Removes the expired entries of the disk cache in [directory]. Returns
+  /// how many there were.
+  Future<int> diskCacheRemoveExpired(String directory) {
+    throw UnimplementedError(
+      'diskCacheRemoveExpired() has not been implemented.',
+    );
+  }
+
+  /// Batches of disk cache entries removed on expiry, each a map holding
+  /// the cache `directory`, the expired `keys` and when each one expired
+  /// (`expiredAt`, milliseconds since the epoch).
+  ///
+  /// Platforms push a batch as soon as entries fall due, so that nothing
+  /// needs to poll for them.
+  Stream<Map<String, dynamic>> diskCacheExpirations() {
+    throw UnimplementedError(
+      'diskCacheExpirations() has not been implemented.',
+    );
+  }
+
   // Batch operations
 
   /// Executes a batch of [operations] in the specified [space].
+  ///
+  /// The table name of each operation is the table's full name, with the
+  /// prefix of [space] already applied if the table has one.
   Future<void> executeBatch(
     List<BatchOperation> operations,
     String space,
@@ -95,6 +398,17 @@ abstract class LocalStorageCachePlatform extends PlatformInterface {
     throw UnimplementedError('executeBatch() has not been implemented.');
   }
 
+  /// Executes a batch of [operations] in the specified [space] and returns
+  /// the row ID and change count of every operation.
+  Future<BatchResult> executeBatchWithResults(
+    List<BatchOperation> operations,
+    String space,
+  ) {
+    throw UnimplementedError(
+      'executeBatchWithResults() has not been implemented.',
+    );
+  }
+
   // Transaction
 
   /// Executes [action] within a transaction in the specified [space].
@@ -180,4 +494,99 @@ abstract class LocalStorageCachePlatform extends PlatformInterface {
   Future<Map<String, dynamic>> getStorageInfo() {
     throw UnimplementedError('getStorageInfo() has not been implemented.');
   }
+
+  /// Gets hit, miss and eviction counters of the native prepared statement
+  /// cache.
+  Future<Map<String, dynamic>> getStatementCacheStats() {
+    throw UnimplementedError(
+      'getStatementCacheStats() has not been implemented.',
+    );
+  }
+
+  /// Gets hit, miss and eviction counters and the size of the native memory
+  /// cache shared by key-value and query lookups.
+  ///
+  /// The map holds `hits`, `misses`, `evictions`, `size` (entries), `bytes`,
+  /// `capacity` (maximum entries) and `maxBytes`.
+  Future<Map<String, dynamic>> getMemoryCacheStats() {
+    throw UnimplementedError(
+      'getMemoryCacheStats() has not been implemented.',
+    );
+  }
+
+  /// Replays lookups through an empty native memory cache of the same size
+  /// under each eviction policy, and returns each policy's hit rate by name
+  /// (`lru`, `lfu`, `fifo` and `wTinyLfu`).
+  ///
+  /// Replays [trace], a list of keys in lookup order, if given, and otherwise
+  /// the last lookups the cache recorded.
+  Future<Map<String, double>> compareEvictionPolicies({List<String>? trace}) {
+    throw UnimplementedError(
+      'compareEvictionPolicies() has not been implemented.',
+    );
+  }
+
+  /// Invalidates the native query results that read any of [tables], or
+  /// every result if [tables] is null.
+  ///
+  /// Results are already invalidated by every committed write through this
+  /// plugin to a table they read, so this is only needed after the database
+  /// file was written by something else.
+  Future<void> invalidateQueryCache({List<String>? tables}) {
+    throw UnimplementedError(
+      'invalidateQueryCache() has not been implemented.',
+    );
+  }
+
+  /// Starts or stops reporting committed row changes on [dataChanges].
+  ///
+  /// Batches are only built while enabled, so that writes cost nothing
+  /// extra when nobody listens.
+  Future<void> setDataChangesEnabled({required bool enabled}) {
+    throw UnimplementedError(
+      'setDataChangesEnabled() has not been implemented.',
+    );
+  }
+
+  /// Batches of rows changed by committed writes, whatever made them, each
+  /// a map holding a `tables` list of maps with the table `name` and the
+  /// rowids it had `inserted`, `updated` and `deleted`, and an
+  /// `unknownTables` bool telling whether rows the platform could not
+  /// attribute to a table changed as well.
+  ///
+  /// Platforms push one batch per call that committed anything, with each
+  /// row listed once under its net change.
+  Stream<Map<String, dynamic>> dataChanges() {
+    throw UnimplementedError(
+      'dataChanges() has not been implemented.',
+    );
+  }
+
+  // Watched queries
+
+  /// Runs the query [sql] with [arguments] in the specified [space] and
+  /// watches it from then on.
+  ///
+  /// Returns the first result as a [QueryDiff] holding the watch ID and the
+  /// whole result. The platform re-runs the query only once a committed
+  /// write touches a table it reads, and pushes what changed on
+  /// [queryDiffs], matching rows by [keyColumn].
+  Future<QueryDiff> watchQuery(
+    String sql,
+    List<dynamic> arguments,
+    String space, {
+    String keyColumn = 'id',
+  }) {
+    throw UnimplementedError('watchQuery() has not been implemented.');
+  }
+
+  /// Stops watching the query [watchId].
+  Future<void> unwatchQuery(int watchId) {
+    throw UnimplementedError('unwatchQuery() has not been implemented.');
+  }
+
+  /// Diffs of every watched query, told apart by [QueryDiff.watchId].
+  Stream<QueryDiff> queryDiffs() {
+    throw UnimplementedError('queryDiffs() has not been implemented.');
+  }
 }
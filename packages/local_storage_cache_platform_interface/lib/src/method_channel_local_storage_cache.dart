@@ -1,12 +1,43 @@
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:local_storage_cache_platform_interface/src/local_storage_cache_platform.dart';
 import 'package:local_storage_cache_platform_interface/src/models/batch_operation.dart';
+import 'package:local_storage_cache_platform_interface/src/models/batch_result.dart';
+import 'package:local_storage_cache_platform_interface/src/models/columnar_result.dart';
+import 'package:local_storage_cache_platform_interface/src/models/cursor_page.dart';
+import 'package:local_storage_cache_platform_interface/src/models/full_text_match.dart';
+import 'package:local_storage_cache_platform_interface/src/models/packed_result.dart';
+import 'package:local_storage_cache_platform_interface/src/models/query_diff.dart';
+import 'package:local_storage_cache_platform_interface/src/models/vector_index_benchmark.dart';
+import 'package:local_storage_cache_platform_interface/src/models/vector_match.dart';
 
 /// An implementation of [LocalStorageCachePlatform] that uses method channels.
 class MethodChannelLocalStorageCache extends LocalStorageCachePlatform {
   /// The method channel used to interact with the native platform.
   final MethodChannel _channel = const MethodChannel('local_storage_cache');
 
+  /// The event channel carrying disk cache expirations.
+  final EventChannel _expirationChannel =
+      const EventChannel('local_storage_cache/cache_expirations');
+
+  /// Shared by every listener, since the platform side holds one sink.
+  Stream<Map<String, dynamic>>? _diskCacheExpirations;
+
+  /// The event channel carrying committed row changes.
+  final EventChannel _dataChangeChannel =
+      const EventChannel('local_storage_cache/data_changes');
+
+  /// Shared by every listener, like [_diskCacheExpirations].
+  Stream<Map<String, dynamic>>? _dataChanges;
+
+  /// The event channel carrying the diffs of watched queries.
+  final EventChannel _queryDiffChannel =
+      const EventChannel('local_storage_cache/query_diffs');
+
+  /// Shared by every watch, like [_diskCacheExpirations].
+  Stream<QueryDiff>? _queryDiffs;
+
   @override
   Future<void> initialize(
     String databasePath,
@@ -51,6 +82,39 @@ class MethodChannelLocalStorageCache extends LocalStorageCachePlatform {
     return result.map((e) => Map<String, dynamic>.from(e as Map)).toList();
   }
 
+  @override
+  Future<ColumnarResult> queryColumnar(
+    String sql,
+    List<dynamic> arguments,
+    String space,
+  ) async {
+    final result =
+        await _channel.invokeMethod<Map<dynamic, dynamic>>('queryColumnar', {
+      'sql': sql,
+      'arguments': arguments,
+      'space': space,
+    });
+    if (result == null) {
+      return const ColumnarResult(columns: [], rows: []);
+    }
+    return ColumnarResult.fromMap(result);
+  }
+
+  @override
+  Future<PackedResult> queryPacked(
+    String sql,
+    List<dynamic> arguments,
+    String space,
+  ) async {
+    final result = await _channel.invokeMethod<Uint8List>('queryPacked', {
+      'sql': sql,
+      'arguments': arguments,
+      'space': space,
+    });
+    if (result == null) return PackedResult.empty();
+    return PackedResult.decode(result);
+  }
+
   @override
   Future<int> update(
     String sql,
@@ -79,6 +143,333 @@ class MethodChannelLocalStorageCache extends LocalStorageCachePlatform {
     return result ?? 0;
   }
 
+  @override
+  Future<int> openCursor(
+    String sql,
+    List<dynamic> arguments,
+    String space,
+  ) async {
+    final result = await _channel.invokeMethod<int>('openCursor', {
+      'sql': sql,
+      'arguments': arguments,
+      'space': space,
+    });
+    if (result == null) {
+      throw PlatformException(
+        code: 'CURSOR_ERROR',
+        message: 'openCursor did not return a cursor',
+      );
+    }
+    return result;
+  }
+
+  @override
+  Future<CursorPage> fetch(int cursorId, int pageSize) async {
+    final result =
+        await _channel.invokeMethod<Map<dynamic, dynamic>>('fetch', {
+      'cursorId': cursorId,
+      'pageSize': pageSize,
+    });
+    if (result == null) {
+      return const CursorPage(rows: [], isDone: true);
+    }
+    return CursorPage.fromMap(result);
+  }
+
+  @override
+  Future<void> closeCursor(int cursorId) async {
+    await _channel.invokeMethod<void>('closeCursor', {'cursorId': cursorId});
+  }
+
+  @override
+  Future<List<VectorMatch>> vectorSearch(
+    String tableName,
+    String column,
+    List<double> queryVector, {
+    int k = 10,
+    String metric = 'cosine',
+    String? filterSql,
+    List<dynamic> filterArguments = const [],
+    int? efSearch,
+    int? nprobe,
+    bool exact = false,
+  }) async {
+    final result = await _channel.invokeMethod<List<dynamic>>('vectorSearch', {
+      'tableName': tableName,
+      'column': column,
+      'queryVector': queryVector is Float32List
+          ? queryVector
+          : Float32List.fromList(queryVector),
+      'k': k,
+      'metric': metric,
+      if (filterSql != null) 'filterSql': filterSql,
+      'filterArguments': filterArguments,
+      if (efSearch != null) 'efSearch': efSearch,
+      if (nprobe != null) 'nprobe': nprobe,
+      'exact': exact,
+    });
+    if (result == null) return [];
+    return result.map((e) => VectorMatch.fromMap(e as Map)).toList();
+  }
+
+  @override
+  Future<void> createVectorIndex(
+    String indexName,
+    String tableName,
+    String column, {
+    String indexType = 'hnsw',
+    int? dimensions,
+    String metric = 'cosine',
+    Map<String, dynamic> parameters = const {},
+  }) async {
+    await _channel.invokeMethod<void>('createVectorIndex', {
+      'indexName': indexName,
+      'tableName': tableName,
+      'column': column,
+      'indexType': indexType,
+      if (dimensions != null) 'dimensions': dimensions,
+      'metric': metric,
+      if (parameters['m'] != null) 'm': parameters['m'],
+      if (parameters['efConstruction'] != null)
+        'efConstruction': parameters['efConstruction'],
+      if (parameters['efSearch'] != null) 'efSearch': parameters['efSearch'],
+      if (parameters['nlist'] != null) 'nlist': parameters['nlist'],
+      if (parameters['nprobe'] != null) 'nprobe': parameters['nprobe'],
+      if (parameters['quantization'] != null)
+        'quantization': parameters['quantization'],
+      if (parameters['pqSubvectors'] != null)
+        'pqSubvectors': parameters['pqSubvectors'],
+      if (parameters['rerank'] != null) 'rerank': parameters['rerank'],
+    });
+  }
+
+  @override
+  Future<void> dropVectorIndex(String indexName) async {
+    await _channel.invokeMethod<void>('dropVectorIndex', {
+      'indexName': indexName,
+    });
+  }
+
+  @override
+  Future<VectorIndexBenchmark> benchmarkVectorIndex(
+    String indexName, {
+    List<int> efSearch = const [16, 32, 64, 128, 256],
+    List<int> nprobe = const [1, 4, 16, 64],
+    int queries = 100,
+    int k = 10,
+  }) async {
+    final result = await _channel.invokeMethod<Map<dynamic, dynamic>>(
+      'benchmarkVectorIndex',
+      {
+        'indexName': indexName,
+        'efSearch': efSearch,
+        'nprobe': nprobe,
+        'queries': queries,
+        'k': k,
+      },
+    );
+    return VectorIndexBenchmark.fromMap(result!);
+  }
+
+  @override
+  Future<List<FullTextMatch>> fullTextSearch(
+    String tableName,
+    String query, {
+    int limit = 20,
+    String? filterSql,
+    List<dynamic> filterArguments = const [],
+    String highlightStart = '<b>',
+    String highlightEnd = '</b>',
+    int snippetTokens = 16,
+  }) async {
+    final result =
+        await _channel.invokeMethod<List<dynamic>>('fullTextSearch', {
+      'tableName': tableName,
+      'query': query,
+      'limit': limit,
+      if (filterSql != null) 'filterSql': filterSql,
+      'filterArguments': filterArguments,
+      'highlightStart': highlightStart,
+      'highlightEnd': highlightEnd,
+      'snippetTokens': snippetTokens,
+    });
+    if (result == null) return [];
+    return result.map((e) => FullTextMatch.fromMap(e as Map)).toList();
+  }
+
+  @override
+  Future<void> createFullTextIndex(
+    String tableName,
+    List<String> columns, {
+    String tokenizer = 'unicode61',
+    List<int> prefixes = const [],
+  }) async {
+    await _channel.invokeMethod<void>('createFullTextIndex', {
+      'tableName': tableName,
+      'columns': columns,
+      'tokenizer': tokenizer,
+      'prefixes': prefixes,
+    });
+  }
+
+  @override
+  Future<void> dropFullTextIndex(String tableName) async {
+    await _channel.invokeMethod<void>('dropFullTextIndex', {
+      'tableName': tableName,
+    });
+  }
+
+  @override
+  Future<void> rebuildFullTextIndex(String tableName) async {
+    await _channel.invokeMethod<void>('rebuildFullTextIndex', {
+      'tableName': tableName,
+    });
+  }
+
+  @override
+  Future<String?> kvGet(String tableName, String key) {
+    return _channel.invokeMethod<String>('kvGet', {
+      'tableName': tableName,
+      'key': key,
+    });
+  }
+
+  @override
+  Future<void> kvSet(String tableName, String key, String value) async {
+    await _channel.invokeMethod<void>('kvSet', {
+      'tableName': tableName,
+      'key': key,
+      'value': value,
+    });
+  }
+
+  @override
+  Future<bool> kvDelete(String tableName, String key) async {
+    final result = await _channel.invokeMethod<bool>('kvDelete', {
+      'tableName': tableName,
+      'key': key,
+    });
+    return result ?? false;
+  }
+
+  @override
+  Future<Map<String, String>> kvMultiGet(
+    String tableName,
+    List<String> keys,
+  ) async {
+    final result =
+        await _channel.invokeMethod<Map<dynamic, dynamic>>('kvMultiGet', {
+      'tableName': tableName,
+      'keys': keys,
+    });
+    return result == null ? {} : Map<String, String>.from(result);
+  }
+
+  @override
+  Future<void> kvMultiSet(
+    String tableName,
+    Map<String, String> entries,
+  ) async {
+    await _channel.invokeMethod<void>('kvMultiSet', {
+      'tableName': tableName,
+      'entries': entries,
+    });
+  }
+
+  @override
+  Future<void> diskCacheOpen(
+    String directory, {
+    required int maxEntries,
+    String evictionPolicy = 'lru',
+  }) async {
+    await _channel.invokeMethod<void>('diskCacheOpen', {
+      'directory': directory,
+      'maxEntries': maxEntries,
+      'evictionPolicy': evictionPolicy,
+    });
+  }
+
+  @override
+  Future<String?> diskCacheGet(String directory, String key) {
+    return _channel.invokeMethod<String>('diskCacheGet', {
+      'directory': directory,
+      'key': key,
+    });
+  }
+
+  @override
+  Future<void> diskCachePut(
+    String directory,
+    String key,
+    String value, {
+    int? expiresAt,
+  }) async {
+    await _channel.invokeMethod<void>('diskCachePut', {
+      'directory': directory,
+      'key': key,
+      'value': value,
+      if (expiresAt != null) 'expiresAt': expiresAt,
+    });
+  }
+
+  @override
+  Future<bool> diskCacheRemove(String directory, String key) async {
+    final result = await _channel.invokeMethod<bool>('diskCacheRemove', {
+      'directory': directory,
+      'key': key,
+    });
+    return result ?? false;
+  }
+
+  @override
+  Future<void> diskCacheClear(String directory) async {
+    await _channel.invokeMethod<void>('diskCacheClear', {
+      'directory': directory,
+    });
+  }
+
+  @override
+  Future<List<String>> diskCacheKeys(String directory) async {
+    final result = await _channel.invokeMethod<List<dynamic>>(
+      'diskCacheKeys',
+      {'directory': directory},
+    );
+    return result == null ? [] : result.cast<String>();
+  }
+
+  @override
+  Future<List<String>> diskCacheValues(String directory) async {
+    final result = await _channel.invokeMethod<List<dynamic>>(
+      'diskCacheValues',
+      {'directory': directory},
+    );
+    return result == null ? [] : result.cast<String>();
+  }
+
+  @override
+  Future<int> diskCacheSize(String directory) async {
+    final result = await _channel.invokeMethod<int>('diskCacheSize', {
+      'directory': directory,
+    });
+    return result ?? 0;
+  }
+
+  @override
+  Future<int> diskCacheRemoveExpired(String directory) async {
+    final result = await _channel.invokeMethod<int>(
+      'diskCacheRemoveExpired',
+      {'directory': directory},
+    );
+    return result ?? 0;
+  }
+
+  @override
+  Stream<Map<String, dynamic>> diskCacheExpirations() {
+    return _diskCacheExpirations ??= _expirationChannel
+        .receiveBroadcastStream()
+        .map((event) => Map<String, dynamic>.from(event as Map));
+  }
+
   @override
   Future<void> executeBatch(
     List<BatchOperation> operations,
@@ -90,6 +481,22 @@ class MethodChannelLocalStorageCache extends LocalStorageCachePlatform {
     });
   }
 
+  @override
+  Future<BatchResult> executeBatchWithResults(
+    List<BatchOperation> operations,
+    String space,
+  ) async {
+    final result =
+        await _channel.invokeMethod<Map<dynamic, dynamic>>('executeBatch', {
+      'operations': operations.map((op) => op.toMap()).toList(),
+      'space': space,
+    });
+    if (result == null) {
+      return const BatchResult(rowIds: [], changes: []);
+    }
+    return BatchResult.fromMap(result);
+  }
+
   @override
   Future<T> transaction<T>(
     Future<T> Function() action,
@@ -193,4 +600,94 @@ class MethodChannelLocalStorageCache extends LocalStorageCachePlatform {
     if (result == null) return {};
     return Map<String, dynamic>.from(result);
   }
+
+  @override
+  Future<Map<String, dynamic>> getStatementCacheStats() async {
+    final result = await _channel
+        .invokeMethod<Map<dynamic, dynamic>>('getStatementCacheStats');
+    if (result == null) return {};
+    return Map<String, dynamic>.from(result);
+  }
+
+  @override
+  Future<Map<String, dynamic>> getMemoryCacheStats() async {
+    final result = await _channel
+        .invokeMethod<Map<dynamic, dynamic>>('getMemoryCacheStats');
+    if (result == null) return {};
+    return Map<String, dynamic>.from(result);
+  }
+
+  @override
+  Future<Map<String, double>> compareEvictionPolicies({
+    List<String>? trace,
+  }) async {
+    final result = await _channel.invokeMethod<Map<dynamic, dynamic>>(
+      'compareEvictionPolicies',
+      {if (trace != null) 'trace': trace},
+    );
+    if (result == null) return {};
+    return result.map(
+      (key, value) => MapEntry(key as String, (value as num).toDouble()),
+    );
+  }
+
+  @override
+  Future<void> invalidateQueryCache({List<String>? tables}) async {
+    await _channel.invokeMethod<void>(
+      'invalidateQueryCache',
+      {if (tables != null) 'tables': tables},
+    );
+  }
+
+  @override
+  Future<void> setDataChangesEnabled({required bool enabled}) async {
+    await _channel.invokeMethod<void>(
+      'setDataChangesEnabled',
+      {'enabled': enabled},
+    );
+  }
+
+  @override
+  Stream<Map<String, dynamic>> dataChanges() {
+    return _dataChanges ??= _dataChangeChannel
+        .receiveBroadcastStream()
+        .map((event) => Map<String, dynamic>.from(event as Map));
+  }
+
+  @override
+  Future<QueryDiff> watchQuery(
+    String sql,
+    List<dynamic> arguments,
+    String space, {
+    String keyColumn = 'id',
+  }) async {
+    final result = await _channel.invokeMethod<Map<dynamic, dynamic>>(
+      'watchQuery',
+      {
+        'sql': sql,
+        'arguments': arguments,
+        'space': space,
+        'keyColumn': keyColumn,
+      },
+    );
+    if (result == null) {
+      throw PlatformException(
+        code: 'WATCH_ERROR',
+        message: 'watchQuery did not return a watch',
+      );
+    }
+    return QueryDiff.fromMap(result);
+  }
+
+  @override
+  Future<void> unwatchQuery(int watchId) async {
+    await _channel.invokeMethod<void>('unwatchQuery', {'watchId': watchId});
+  }
+
+  @override
+  Stream<QueryDiff> queryDiffs() {
+    return _queryDiffs ??= _queryDiffChannel
+        .receiveBroadcastStream()
+        .map((event) => QueryDiff.fromMap(event as Map));
+  }
 }
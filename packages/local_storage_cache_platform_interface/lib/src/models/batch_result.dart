@@ -0,0 +1,30 @@
+/// Per-operation results of a batch execution.
+class BatchResult {
+  /// Creates a batch result.
+  const BatchResult({
+    required this.rowIds,
+    required this.changes,
+  });
+
+  /// Creates a batch result from a platform response map.
+  factory BatchResult.fromMap(Map<dynamic, dynamic> map) {
+    return BatchResult(
+      rowIds: List<int>.from((map['rowIds'] as List?) ?? const <int>[]),
+      changes: List<int>.from((map['changes'] as List?) ?? const <int>[]),
+    );
+  }
+
+  /// Row ID of each inserted record, or -1 for updates and deletes.
+  ///
+  /// Indexed in the same order as the submitted operations.
+  final List<int> rowIds;
+
+  /// Number of rows changed by each operation.
+  final List<int> changes;
+
+  /// Number of operations in the batch.
+  int get length => rowIds.length;
+
+  /// Total number of rows changed by the batch.
+  int get totalChanges => changes.fold(0, (sum, count) => sum + count);
+}
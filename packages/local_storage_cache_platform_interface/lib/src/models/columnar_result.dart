@@ -0,0 +1,54 @@
+/// Query results in columnar form.
+///
+/// Column names are transferred once rather than once per row, which makes
+/// wide results cheaper to encode and decode. Rows are only turned into maps
+/// when asked for with [rowAt] or [toMaps].
+class ColumnarResult {
+  /// Creates a columnar result.
+  const ColumnarResult({
+    required this.columns,
+    required this.rows,
+  });
+
+  /// Creates a columnar result from a platform response map.
+  factory ColumnarResult.fromMap(Map<dynamic, dynamic> map) {
+    final rows = (map['rows'] as List?) ?? const [];
+    return ColumnarResult(
+      columns: List<String>.from((map['columns'] as List?) ?? const []),
+      rows: rows.map((row) => row as List<dynamic>).toList(),
+    );
+  }
+
+  /// Column names, in select order.
+  final List<String> columns;
+
+  /// Row values, each in the same order as [columns].
+  final List<List<dynamic>> rows;
+
+  /// Number of rows.
+  int get length => rows.length;
+
+  /// Whether the result has no rows.
+  bool get isEmpty => rows.isEmpty;
+
+  /// Returns the values of column [name], or an empty list if there is no
+  /// such column.
+  List<dynamic> column(String name) {
+    final index = columns.indexOf(name);
+    if (index < 0) return const [];
+    return rows.map((row) => row[index]).toList();
+  }
+
+  /// Returns the row at [index] as a column-name to value map.
+  Map<String, dynamic> rowAt(int index) {
+    final row = rows[index];
+    return {
+      for (var i = 0; i < columns.length; i++) columns[i]: row[i],
+    };
+  }
+
+  /// Returns every row as a column-name to value map.
+  List<Map<String, dynamic>> toMaps() {
+    return [for (var i = 0; i < rows.length; i++) rowAt(i)];
+  }
+}
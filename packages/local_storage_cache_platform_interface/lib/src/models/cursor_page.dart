@@ -0,0 +1,26 @@
+/// A page of rows read from a native cursor.
+class CursorPage {
+  /// Creates a cursor page.
+  const CursorPage({
+    required this.rows,
+    required this.isDone,
+  });
+
+  /// Creates a cursor page from a platform response map.
+  factory CursorPage.fromMap(Map<dynamic, dynamic> map) {
+    final rows = (map['rows'] as List?) ?? const [];
+    return CursorPage(
+      rows: rows.map((e) => Map<String, dynamic>.from(e as Map)).toList(),
+      isDone: (map['done'] as bool?) ?? true,
+    );
+  }
+
+  /// Rows of this page, in cursor order.
+  final List<Map<String, dynamic>> rows;
+
+  /// Whether the cursor has no more rows.
+  ///
+  /// The platform closes a cursor once it is done, so it does not need to be
+  /// closed explicitly.
+  final bool isDone;
+}
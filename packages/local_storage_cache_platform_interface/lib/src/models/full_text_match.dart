@@ -0,0 +1,38 @@
+/// A row returned by a full-text search.
+class FullTextMatch {
+  /// Creates a full-text match.
+  const FullTextMatch({
+    required this.row,
+    required this.score,
+    required this.snippet,
+    this.highlights = const {},
+  });
+
+  /// Creates a full-text match from a platform response map.
+  factory FullTextMatch.fromMap(Map<dynamic, dynamic> map) {
+    return FullTextMatch(
+      row: Map<String, dynamic>.from(map['row'] as Map),
+      score: (map['score'] as num).toDouble(),
+      snippet: map['snippet'] as String? ?? '',
+      highlights: map['highlights'] == null
+          ? const {}
+          : Map<String, String?>.from(map['highlights'] as Map),
+    );
+  }
+
+  /// The matched row.
+  final Map<String, dynamic> row;
+
+  /// Relevance of the row to the query; larger is better.
+  ///
+  /// This is the negated bm25 rank, so scores are only comparable between
+  /// matches of the same search.
+  final double score;
+
+  /// The best matching fragment of the indexed text, with the matched terms
+  /// marked.
+  final String snippet;
+
+  /// Each indexed column of the row in full, with the matched terms marked.
+  final Map<String, String?> highlights;
+}
@@ -0,0 +1,210 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Storage type of a column in a [PackedResult].
+enum PackedColumnType {
+  /// Every value in the column is null.
+  nullValue,
+
+  /// 64-bit integers.
+  int64,
+
+  /// 64-bit floats. Columns mixing integers and floats are widened to this.
+  float64,
+
+  /// UTF-8 text. Columns mixing text and numbers fall back to this.
+  text,
+
+  /// Raw bytes. Columns mixing blobs with other storage classes fall back to
+  /// this, holding numbers in text form and text as UTF-8.
+  blob,
+}
+
+/// Query results packed into a single buffer by the platform.
+///
+/// Cells are not decoded up front: numeric columns are viewed in place as
+/// [Int64List] / [Float64List], and text and blob cells are only read when
+/// accessed.
+///
+/// Buffer layout (little-endian, offsets from the start of the buffer):
+///
+/// * Header, 16 bytes: magic `LSCP`, u16 version, u16 column count,
+///   u32 row count, u32 reserved.
+/// * One 24-byte descriptor per column: u8 type, 3 reserved bytes, u32 name
+///   offset, u32 name length, u32 null bitmap offset (0 if the column has no
+///   nulls), u32 data offset, u32 heap offset.
+/// * Column data. Numeric columns hold one 8-byte value per row; text and
+///   blob columns hold `rowCount + 1` u32 offsets into their heap.
+class PackedResult {
+  PackedResult._(this._bytes, this.columns, this.length, this._columns);
+
+  /// Decodes a packed result produced by the platform.
+  ///
+  /// Throws a [FormatException] if [bytes] is not a packed result.
+  factory PackedResult.decode(Uint8List bytes) {
+    if (bytes.lengthInBytes < _headerSize ||
+        String.fromCharCodes(bytes, 0, 4) != _magic) {
+      throw const FormatException('Not a packed query result');
+    }
+
+    final data = ByteData.sublistView(bytes);
+    final version = data.getUint16(4, Endian.little);
+    if (version != _version) {
+      throw FormatException('Unsupported packed result version $version');
+    }
+
+    final columnCount = data.getUint16(6, Endian.little);
+    final rowCount = data.getUint32(8, Endian.little);
+
+    final names = <String>[];
+    final columns = <_PackedColumn>[];
+    for (var i = 0; i < columnCount; i++) {
+      final descriptor = _headerSize + _descriptorSize * i;
+      final typeIndex = data.getUint8(descriptor);
+      final nameOffset = data.getUint32(descriptor + 4, Endian.little);
+      final nameLength = data.getUint32(descriptor + 8, Endian.little);
+
+      names.add(
+        utf8.decode(
+          Uint8List.sublistView(bytes, nameOffset, nameOffset + nameLength),
+        ),
+      );
+      columns.add(
+        _PackedColumn(
+          type: typeIndex < PackedColumnType.values.length
+              ? PackedColumnType.values[typeIndex]
+              : PackedColumnType.nullValue,
+          nullOffset: data.getUint32(descriptor + 12, Endian.little),
+          dataOffset: data.getUint32(descriptor + 16, Endian.little),
+          heapOffset: data.getUint32(descriptor + 20, Endian.little),
+        ),
+      );
+    }
+
+    return PackedResult._(bytes, names, rowCount, columns);
+  }
+
+  /// A result with no columns and no rows.
+  factory PackedResult.empty() {
+    return PackedResult._(Uint8List(0), const [], 0, const []);
+  }
+
+  static const String _magic = 'LSCP';
+  static const int _version = 1;
+  static const int _headerSize = 16;
+  static const int _descriptorSize = 24;
+
+  final Uint8List _bytes;
+  final List<_PackedColumn> _columns;
+
+  /// Column names, in select order.
+  final List<String> columns;
+
+  /// Number of rows.
+  final int length;
+
+  /// Whether the result has no rows.
+  bool get isEmpty => length == 0;
+
+  /// Storage type of the column at [column].
+  PackedColumnType typeOf(int column) => _columns[column].type;
+
+  /// Whether the cell at [row], [column] is null.
+  bool isNull(int row, int column) {
+    final info = _columns[column];
+    if (info.type == PackedColumnType.nullValue) return true;
+    if (info.nullOffset == 0) return false;
+    return (_bytes[info.nullOffset + (row >> 3)] >> (row & 7)) & 1 == 1;
+  }
+
+  /// Values of an [PackedColumnType.int64] column, or null for any other
+  /// type. Null cells read as 0; check them with [isNull].
+  ///
+  /// The list is a view of the packed buffer when it is suitably aligned.
+  Int64List? int64Column(int column) {
+    final info = _columns[column];
+    if (info.type != PackedColumnType.int64) return null;
+    final bytes = _numericBytes(info);
+    return bytes.buffer.asInt64List(bytes.offsetInBytes, length);
+  }
+
+  /// Values of a [PackedColumnType.float64] column, or null for any other
+  /// type. Null cells read as 0; check them with [isNull].
+  ///
+  /// The list is a view of the packed buffer when it is suitably aligned.
+  Float64List? float64Column(int column) {
+    final info = _columns[column];
+    if (info.type != PackedColumnType.float64) return null;
+    final bytes = _numericBytes(info);
+    return bytes.buffer.asFloat64List(bytes.offsetInBytes, length);
+  }
+
+  /// Returns the value of the cell at [row], [column].
+  ///
+  /// Integers are returned as [int], floats as [double], text as [String]
+  /// and blobs as a [Uint8List] view of the packed buffer.
+  dynamic valueAt(int row, int column) {
+    if (isNull(row, column)) return null;
+
+    final info = _columns[column];
+    final data = ByteData.sublistView(_bytes);
+    switch (info.type) {
+      case PackedColumnType.nullValue:
+        return null;
+      case PackedColumnType.int64:
+        return data.getInt64(info.dataOffset + 8 * row, Endian.little);
+      case PackedColumnType.float64:
+        return data.getFloat64(info.dataOffset + 8 * row, Endian.little);
+      case PackedColumnType.text:
+      case PackedColumnType.blob:
+        final start = data.getUint32(info.dataOffset + 4 * row, Endian.little);
+        final end =
+            data.getUint32(info.dataOffset + 4 * (row + 1), Endian.little);
+        final cell = Uint8List.sublistView(
+          _bytes,
+          info.heapOffset + start,
+          info.heapOffset + end,
+        );
+        return info.type == PackedColumnType.text ? utf8.decode(cell) : cell;
+    }
+  }
+
+  /// Returns the row at [index] as a column-name to value map.
+  Map<String, dynamic> rowAt(int index) {
+    return {
+      for (var i = 0; i < columns.length; i++) columns[i]: valueAt(index, i),
+    };
+  }
+
+  /// Returns every row as a column-name to value map.
+  List<Map<String, dynamic>> toMaps() {
+    return [for (var i = 0; i < length; i++) rowAt(i)];
+  }
+
+  // Typed views need 8-byte alignment within the underlying buffer; the
+  // bytes are copied when the platform message does not provide it. Views
+  // use host byte order, which is little-endian on every supported target.
+  Uint8List _numericBytes(_PackedColumn info) {
+    final view = Uint8List.sublistView(
+      _bytes,
+      info.dataOffset,
+      info.dataOffset + 8 * length,
+    );
+    if (view.offsetInBytes % 8 == 0) return view;
+    return Uint8List.fromList(view);
+  }
+}
+
+class _PackedColumn {
+  const _PackedColumn({
+    required this.type,
+    required this.nullOffset,
+    required this.dataOffset,
+    required this.heapOffset,
+  });
+
+  final PackedColumnType type;
+  final int nullOffset;
+  final int dataOffset;
+  final int heapOffset;
+}
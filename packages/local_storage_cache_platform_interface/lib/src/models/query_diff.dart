@@ -0,0 +1,76 @@
+/// What changed in the result of a watched query since it last ran.
+///
+/// Rows are matched across runs by a key column. The first result of a
+/// watch, and any result whose rows cannot be told apart by key, comes whole
+/// as [rows] instead.
+class QueryDiff {
+  /// Creates a query diff.
+  const QueryDiff({
+    required this.watchId,
+    this.inserted = const [],
+    this.changed = const [],
+    this.removed = const [],
+    this.order,
+    this.rows,
+  });
+
+  /// Creates a query diff from a platform response or event map.
+  factory QueryDiff.fromMap(Map<dynamic, dynamic> map) {
+    List<Map<String, dynamic>> toRows(Object? list) => ((list as List?) ?? [])
+        .map((e) => Map<String, dynamic>.from(e as Map))
+        .toList();
+
+    return QueryDiff(
+      watchId: map['watchId'] as int,
+      inserted: toRows(map['inserted']),
+      changed: toRows(map['changed']),
+      removed: List<dynamic>.from((map['removed'] as List?) ?? const []),
+      order: map['order'] == null
+          ? null
+          : List<dynamic>.from(map['order'] as List),
+      rows: map['rows'] == null ? null : toRows(map['rows']),
+    );
+  }
+
+  /// ID of the watch this diff belongs to.
+  final int watchId;
+
+  /// Rows new to the result.
+  final List<Map<String, dynamic>> inserted;
+
+  /// Rows still in the result whose values changed.
+  final List<Map<String, dynamic>> changed;
+
+  /// Keys of the rows no longer in the result.
+  final List<dynamic> removed;
+
+  /// Keys of every row in result order, sent only when [apply] would
+  /// otherwise leave the rows in another order.
+  final List<dynamic>? order;
+
+  /// The whole result, if it is not sent as a diff.
+  final List<Map<String, dynamic>>? rows;
+
+  /// Returns the result this diff leads to from [previous], the result it
+  /// follows, whose rows are keyed by [keyColumn].
+  ///
+  /// Removed rows are dropped, changed rows replaced in place and inserted
+  /// rows appended, before [order] is applied.
+  List<Map<String, dynamic>> apply(
+    List<Map<String, dynamic>> previous,
+    String keyColumn,
+  ) {
+    if (rows != null) return rows!;
+
+    final byKey = <dynamic, Map<String, dynamic>>{
+      for (final row in previous) row[keyColumn]: row,
+    };
+    removed.forEach(byKey.remove);
+    for (final row in [...changed, ...inserted]) {
+      byKey[row[keyColumn]] = row;
+    }
+
+    if (order == null) return byKey.values.toList();
+    return [for (final key in order!) byKey[key]!];
+  }
+}
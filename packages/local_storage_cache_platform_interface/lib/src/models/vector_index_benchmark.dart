@@ -0,0 +1,73 @@
+/// Recall and latency of a vector index, measured against exact search.
+class VectorIndexBenchmark {
+  /// Creates a vector index benchmark result.
+  const VectorIndexBenchmark({
+    required this.size,
+    required this.queries,
+    required this.exactMicros,
+    required this.runs,
+  });
+
+  /// Creates a vector index benchmark result from a platform response map.
+  factory VectorIndexBenchmark.fromMap(Map<dynamic, dynamic> map) {
+    return VectorIndexBenchmark(
+      size: map['size'] as int,
+      queries: map['queries'] as int,
+      exactMicros: (map['exactMicros'] as num).toDouble(),
+      runs: (map['runs'] as List)
+          .map((e) => VectorIndexBenchmarkRun.fromMap(e as Map))
+          .toList(),
+    );
+  }
+
+  /// Number of vectors in the index.
+  final int size;
+
+  /// Number of query vectors, sampled from the index.
+  final int queries;
+
+  /// Mean latency of an exact search, in microseconds.
+  final double exactMicros;
+
+  /// One run per efSearch (HNSW) or nprobe (IVF-Flat) value, in the order
+  /// requested.
+  final List<VectorIndexBenchmarkRun> runs;
+}
+
+/// Recall and latency of a vector index at one search width.
+class VectorIndexBenchmarkRun {
+  /// Creates a vector index benchmark run.
+  const VectorIndexBenchmarkRun({
+    this.efSearch,
+    this.nprobe,
+    required this.recall,
+    required this.meanMicros,
+    required this.p99Micros,
+  });
+
+  /// Creates a vector index benchmark run from a platform response map.
+  factory VectorIndexBenchmarkRun.fromMap(Map<dynamic, dynamic> map) {
+    return VectorIndexBenchmarkRun(
+      efSearch: map['efSearch'] as int?,
+      nprobe: map['nprobe'] as int?,
+      recall: (map['recall'] as num).toDouble(),
+      meanMicros: (map['meanMicros'] as num).toDouble(),
+      p99Micros: (map['p99Micros'] as num).toDouble(),
+    );
+  }
+
+  /// Candidate list size the searches ran with, for an HNSW index.
+  final int? efSearch;
+
+  /// Number of lists the searches scanned, for an IVF-Flat index.
+  final int? nprobe;
+
+  /// Fraction of the exact k nearest neighbours that were found.
+  final double recall;
+
+  /// Mean search latency, in microseconds.
+  final double meanMicros;
+
+  /// 99th percentile search latency, in microseconds.
+  final double p99Micros;
+}
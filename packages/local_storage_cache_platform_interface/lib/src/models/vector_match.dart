@@ -0,0 +1,25 @@
+/// A row returned by a vector similarity search.
+class VectorMatch {
+  /// Creates a vector match.
+  const VectorMatch({
+    required this.row,
+    required this.distance,
+  });
+
+  /// Creates a vector match from a platform response map.
+  factory VectorMatch.fromMap(Map<dynamic, dynamic> map) {
+    return VectorMatch(
+      row: Map<String, dynamic>.from(map['row'] as Map),
+      distance: (map['distance'] as num).toDouble(),
+    );
+  }
+
+  /// The matched row.
+  final Map<String, dynamic> row;
+
+  /// Distance from the query vector; smaller is closer.
+  ///
+  /// This is `1 - cosine similarity` for cosine, the L2 distance for
+  /// euclidean and the negated dot product for dotProduct.
+  final double distance;
+}
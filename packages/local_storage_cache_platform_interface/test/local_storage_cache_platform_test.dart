@@ -1,6 +1,8 @@
 // Copyright (c) 2024-2026 local_storage_cache authors
 // SPDX-License-Identifier: MIT
 
+import 'dart:typed_data';
+
 import 'package:flutter_test/flutter_test.dart';
 import 'package:local_storage_cache_platform_interface/local_storage_cache_platform_interface.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
@@ -217,6 +219,174 @@ void main() {
           completes,
         );
       });
+
+      test('ColumnarResult should rehydrate rows on demand', () {
+        final result = ColumnarResult.fromMap({
+          'columns': ['id', 'name'],
+          'rows': [
+            [1, 'a'],
+            [2, 'b'],
+          ],
+        });
+
+        expect(result.length, equals(2));
+        expect(result.column('name'), equals(['a', 'b']));
+        expect(result.rowAt(1), equals({'id': 2, 'name': 'b'}));
+        expect(result.toMaps().first, equals({'id': 1, 'name': 'a'}));
+      });
+
+      test('PackedResult.decode should read typed columns lazily', () {
+        // Two rows of (id INTEGER, name TEXT); the second name is null
+        final data = ByteData(112)
+          ..setUint8(0, 0x4C)
+          ..setUint8(1, 0x53)
+          ..setUint8(2, 0x43)
+          ..setUint8(3, 0x50)
+          ..setUint16(4, 1, Endian.little)
+          ..setUint16(6, 2, Endian.little)
+          ..setUint32(8, 2, Endian.little)
+          // id: int64, name at 64, data at 72
+          ..setUint8(16, 1)
+          ..setUint32(20, 64, Endian.little)
+          ..setUint32(24, 2, Endian.little)
+          ..setUint32(32, 72, Endian.little)
+          // name: text, name at 66, nulls at 88, offsets at 96, heap at 108
+          ..setUint8(40, 3)
+          ..setUint32(44, 66, Endian.little)
+          ..setUint32(48, 4, Endian.little)
+          ..setUint32(52, 88, Endian.little)
+          ..setUint32(56, 96, Endian.little)
+          ..setUint32(60, 108, Endian.little)
+          ..setInt64(72, 1, Endian.little)
+          ..setInt64(80, 2, Endian.little)
+          ..setUint8(88, 0x02)
+          ..setUint32(100, 1, Endian.little)
+          ..setUint32(104, 1, Endian.little)
+          ..setUint8(108, 0x61);
+        final bytes = data.buffer.asUint8List();
+        bytes.setRange(64, 70, 'idname'.codeUnits);
+
+        final result = PackedResult.decode(bytes);
+
+        expect(result.columns, equals(['id', 'name']));
+        expect(result.length, equals(2));
+        expect(result.typeOf(0), equals(PackedColumnType.int64));
+        expect(result.int64Column(0), equals([1, 2]));
+        expect(result.rowAt(0), equals({'id': 1, 'name': 'a'}));
+        expect(result.isNull(1, 1), isTrue);
+        expect(result.toMaps().last, equals({'id': 2, 'name': null}));
+      });
+
+      test('CursorPage.fromMap should parse rows and completion', () {
+        final page = CursorPage.fromMap({
+          'rows': [
+            {'id': 1},
+            {'id': 2},
+          ],
+          'done': false,
+        });
+
+        expect(page.rows.length, equals(2));
+        expect(page.rows.first['id'], equals(1));
+        expect(page.isDone, isFalse);
+      });
+
+      test('VectorMatch.fromMap should parse the row and distance', () {
+        final match = VectorMatch.fromMap({
+          'row': {'id': 7, 'title': 'doc'},
+          'distance': 0.25,
+        });
+
+        expect(match.row['id'], equals(7));
+        expect(match.distance, equals(0.25));
+      });
+
+      test('VectorIndexBenchmark.fromMap should parse every run', () {
+        final benchmark = VectorIndexBenchmark.fromMap({
+          'size': 1000,
+          'queries': 100,
+          'exactMicros': 850.0,
+          'runs': [
+            {
+              'efSearch': 16,
+              'recall': 0.82,
+              'meanMicros': 40.5,
+              'p99Micros': 90,
+            },
+            {
+              'efSearch': 64,
+              'recall': 0.97,
+              'meanMicros': 110.0,
+              'p99Micros': 200.0,
+            },
+          ],
+        });
+
+        expect(benchmark.size, equals(1000));
+        expect(benchmark.runs, hasLength(2));
+        expect(benchmark.runs.first.efSearch, equals(16));
+        expect(benchmark.runs.first.p99Micros, equals(90.0));
+        expect(benchmark.runs.last.recall, equals(0.97));
+      });
+
+      test('VectorIndexBenchmarkRun.fromMap should parse nprobe runs', () {
+        final run = VectorIndexBenchmarkRun.fromMap({
+          'nprobe': 8,
+          'recall': 0.91,
+          'meanMicros': 75.0,
+          'p99Micros': 130.0,
+        });
+
+        expect(run.nprobe, equals(8));
+        expect(run.efSearch, isNull);
+      });
+
+      test('BatchResult.fromMap should parse per-operation results', () {
+        final result = BatchResult.fromMap({
+          'rowIds': [1, 2, -1],
+          'changes': [1, 1, 3],
+        });
+
+        expect(result.length, equals(3));
+        expect(result.rowIds, equals([1, 2, -1]));
+        expect(result.totalChanges, equals(5));
+      });
+
+      test('QueryDiff.apply should remove, replace and insert rows', () {
+        final previous = [
+          {'id': 1, 'name': 'a'},
+          {'id': 2, 'name': 'b'},
+          {'id': 3, 'name': 'c'},
+        ];
+        final diff = QueryDiff.fromMap({
+          'watchId': 4,
+          'inserted': [
+            {'id': 4, 'name': 'd'},
+          ],
+          'changed': [
+            {'id': 3, 'name': 'cc'},
+          ],
+          'removed': [1],
+        });
+
+        expect(diff.watchId, equals(4));
+        expect(
+          diff.apply(previous, 'id').map((row) => row['name']),
+          equals(['b', 'cc', 'd']),
+        );
+
+        final reordered = QueryDiff.fromMap({
+          'watchId': 4,
+          'changed': [
+            {'id': 2, 'name': 'z'},
+          ],
+          'order': [3, 2],
+        });
+        expect(
+          reordered.apply(previous.sublist(1), 'id').map((row) => row['id']),
+          equals([3, 2]),
+        );
+      });
     });
 
     group('Transaction', () {
@@ -466,6 +636,281 @@ void main() {
           throwsUnimplementedError,
         );
       });
+
+      test('getStatementCacheStats should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.getStatementCacheStats(),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('executeBatchWithResults should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.executeBatchWithResults([], 'default'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('openCursor should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.openCursor('SELECT 1', [], 'default'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('fetch should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.fetch(1, 100),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('closeCursor should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.closeCursor(1),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('queryColumnar should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.queryColumnar('SELECT 1', [], 'default'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('queryPacked should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.queryPacked('SELECT 1', [], 'default'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('vectorSearch should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.vectorSearch('docs', 'embedding', [1]),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('createVectorIndex should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.createVectorIndex(
+            'docs_embedding_hnsw',
+            'docs',
+            'embedding',
+          ),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('dropVectorIndex should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.dropVectorIndex('docs_embedding_hnsw'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('benchmarkVectorIndex should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.benchmarkVectorIndex(
+            'docs_embedding_hnsw',
+          ),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('fullTextSearch should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.fullTextSearch('docs', 'apple'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('createFullTextIndex should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.createFullTextIndex('docs', ['body']),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('dropFullTextIndex should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.dropFullTextIndex('docs'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('rebuildFullTextIndex should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.rebuildFullTextIndex('docs'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('kvGet should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.kvGet('default__kv', 'key'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('kvSet should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.kvSet('default__kv', 'key', '1'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('kvDelete should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.kvDelete('default__kv', 'key'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('kvMultiGet should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.kvMultiGet('default__kv', ['key']),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('kvMultiSet should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.kvMultiSet('default__kv', {'key': '1'}),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheOpen should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheOpen(
+            '/tmp/cache',
+            maxEntries: 10,
+          ),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheGet should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheGet('/tmp/cache', 'key'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCachePut should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCachePut('/tmp/cache', 'key', '1'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheRemove should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheRemove('/tmp/cache', 'key'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheClear should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheClear('/tmp/cache'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheKeys should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheKeys('/tmp/cache'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheValues should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheValues('/tmp/cache'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheSize should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheSize('/tmp/cache'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheRemoveExpired should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheRemoveExpired('/tmp/cache'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('diskCacheExpirations should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.diskCacheExpirations(),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('getMemoryCacheStats should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.getMemoryCacheStats(),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('compareEvictionPolicies should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.compareEvictionPolicies(),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('invalidateQueryCache should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.invalidateQueryCache(),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('setDataChangesEnabled should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.setDataChangesEnabled(enabled: true),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('dataChanges should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.dataChanges(),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('watchQuery should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.watchQuery('SELECT 1', [], 'default'),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('unwatchQuery should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.unwatchQuery(1),
+          throwsUnimplementedError,
+        );
+      });
+
+      test('queryDiffs should throw UnimplementedError', () {
+        expect(
+          () => unimplementedPlatform.queryDiffs(),
+          throwsUnimplementedError,
+        );
+      });
     });
   });
 }